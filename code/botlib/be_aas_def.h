@@ -32,7 +32,9 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 //debugging on
 #define AAS_DEBUG
 
+#ifndef MAX_CLIENTS
 #define MAX_CLIENTS			64
+#endif
 #define	MAX_MODELS			256		// these are sent over the net as 8 bits
 #define	MAX_SOUNDS			256		// so they cannot be blindly increased
 #define	MAX_CONFIGSTRINGS	1024
@@ -191,6 +193,25 @@ typedef struct aas_reachabilityareas_s
 	int firstarea, numareas;
 } aas_reachabilityareas_t;
 
+//flattened bsp node with the split plane packed in (32 bytes, 16 byte aligned)
+typedef struct aas_tracenode_s
+{
+	vec3_t normal;								//normal vector of the split plane
+	float dist;									//distance of the split plane from the origin
+	int children[2];							//child nodes, negative are areas, zero is solid
+	int planenum;								//number of the split plane in aasworld.planes
+	int nodenum;								//number of the node in aasworld.nodes
+} aas_tracenode_t;
+
+//recorded trace for the trace benchmark
+typedef struct aas_tracerecord_s
+{
+	vec3_t start;
+	vec3_t end;
+	int presencetype;							//presence type, zero for an area trace
+	int passent;								//entity to pass, maximum areas for an area trace
+} aas_tracerecord_t;
+
 typedef struct aas_s
 {
 	int loaded;									//true when an AAS file is loaded
@@ -236,6 +257,10 @@ typedef struct aas_s
 	//nodes of the bsp tree
 	int numnodes;
 	aas_node_t *nodes;
+	//breadth-first flattened copy of the bsp tree used for tracing
+	int numtracenodes;
+	aas_tracenode_t *tracenodes;
+	void *tracenodesmemory;
 	//cluster portals
 	int numportals;
 	aas_portal_t *portals;
@@ -284,6 +309,10 @@ typedef struct aas_s
 	//areas the reachabilities go through
 	int *reachabilityareaindex;
 	aas_reachabilityareas_t *reachabilityareas;
+	//traces recorded for the trace benchmark
+	int numtracerecords;
+	int maxtracerecords;
+	aas_tracerecord_t *tracerecords;
 } aas_t;
 
 #define AASINTERN
@@ -225,6 +225,8 @@ void AAS_DumpAASData(void)
 	if (aasworld.clusters) FreeMemory(aasworld.clusters);
 	aasworld.clusters = NULL;
 	aasworld.numclusters = 0;
+	AAS_FreeTraceNodes();
+	AAS_FreeTraceRecords();
 	//
 	aasworld.loaded = qfalse;
 	aasworld.initialized = qfalse;
@@ -476,6 +478,8 @@ int AAS_LoadAASFile(char *filename)
 	if (aasworld.numclusters && !aasworld.clusters) return BLERR_CANNOTREADAASLUMP;
 	//swap everything
 	AAS_SwapAASData();
+	//flatten the bsp tree for tracing
+	AAS_CreateTraceNodes();
 	//aas file is loaded
 	aasworld.loaded = qtrue;
 	//close the file
@@ -272,6 +272,17 @@ int AAS_StartFrame(float time)
 		LibVarSet("saveroutingcache", "0");
 	} //end if
 	//
+	if (LibVarGetValue("aastracerecord"))
+	{
+		AAS_RecordTraces((int) LibVarGetValue("aastracerecord"));
+		LibVarSet("aastracerecord", "0");
+	} //end if
+	if (LibVarGetValue("aastracebench"))
+	{
+		AAS_TraceBenchmark((int) LibVarGetValue("aastracebench"));
+		LibVarSet("aastracebench", "0");
+	} //end if
+	//
 	aasworld.numframes++;
 	return BLERR_NOERROR;
 } //end of the function AAS_StartFrame
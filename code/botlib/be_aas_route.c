@@ -58,6 +58,9 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 //maximum number of routing updates each frame
 #define MAX_FRAMEROUTINGUPDATES		10
 
+//number of routing caches remembered during a batch of route queries
+#define MAX_BATCHROUTINGCACHES		64
+
 
 /*
 
@@ -84,6 +87,21 @@ int numportalcacheupdates;
 int routingcachesize;
 int max_routingcachesize;
 
+//routing cache looked up during a batch of route queries
+typedef struct aas_batchroutingcache_s
+{
+	int type;
+	int cluster;
+	int areanum;
+	int travelflags;
+	aas_routingcache_t *cache;
+} aas_batchroutingcache_t;
+
+//true while a batch of route queries is being processed, no routing
+//caches are freed during a batch so the remembered caches stay valid
+static int routingbatch;
+static aas_batchroutingcache_t batchroutingcaches[MAX_BATCHROUTINGCACHES];
+
 //===========================================================================
 //
 // Parameter:			-
@@ -1391,6 +1409,31 @@ void AAS_UpdateAreaRoutingCache(aas_routingcache_t *areacache)
 	} //end while
 } //end of the function AAS_UpdateAreaRoutingCache
 //===========================================================================
+// returns the batch slot for the given routing cache, the slot is emptied
+// when it remembers another routing cache
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+static aas_batchroutingcache_t *AAS_BatchRoutingCache(int type, int clusternum, int areanum, int travelflags)
+{
+	aas_batchroutingcache_t *batchcache;
+
+	batchcache = &batchroutingcaches[(areanum * 31 + travelflags + type) & (MAX_BATCHROUTINGCACHES - 1)];
+	if (batchcache->cache && batchcache->type == type && batchcache->cluster == clusternum &&
+			batchcache->areanum == areanum && batchcache->travelflags == travelflags)
+	{
+		return batchcache;
+	} //end if
+	batchcache->type = type;
+	batchcache->cluster = clusternum;
+	batchcache->areanum = areanum;
+	batchcache->travelflags = travelflags;
+	batchcache->cache = NULL;
+	return batchcache;
+} //end of the function AAS_BatchRoutingCache
+//===========================================================================
 //
 // Parameter:			-
 // Returns:				-
@@ -1400,7 +1443,14 @@ aas_routingcache_t *AAS_GetAreaRoutingCache(int clusternum, int areanum, int tra
 {
 	int clusterareanum;
 	aas_routingcache_t *cache, *clustercache;
+	aas_batchroutingcache_t *batchcache;
 
+	batchcache = NULL;
+	if (routingbatch)
+	{
+		batchcache = AAS_BatchRoutingCache(CACHETYPE_AREA, clusternum, areanum, travelflags);
+		if (batchcache->cache) return batchcache->cache;
+	} //end if
 	//number of the area in the cluster
 	clusterareanum = AAS_ClusterAreaNum(clusternum, areanum);
 	//pointer to the cache for the area in the cluster
@@ -1434,6 +1484,7 @@ aas_routingcache_t *AAS_GetAreaRoutingCache(int clusternum, int areanum, int tra
 	cache->time = AAS_RoutingTime();
 	cache->type = CACHETYPE_AREA;
 	AAS_LinkCache(cache);
+	if (batchcache) batchcache->cache = cache;
 	return cache;
 } //end of the function AAS_GetAreaRoutingCache
 //===========================================================================
@@ -1543,7 +1594,14 @@ void AAS_UpdatePortalRoutingCache(aas_routingcache_t *portalcache)
 aas_routingcache_t *AAS_GetPortalRoutingCache(int clusternum, int areanum, int travelflags)
 {
 	aas_routingcache_t *cache;
+	aas_batchroutingcache_t *batchcache;
 
+	batchcache = NULL;
+	if (routingbatch)
+	{
+		batchcache = AAS_BatchRoutingCache(CACHETYPE_PORTAL, clusternum, areanum, travelflags);
+		if (batchcache->cache) return batchcache->cache;
+	} //end if
 	//find the cached portal routing if existing
 	for (cache = aasworld.portalcache[areanum]; cache; cache = cache->next)
 	{
@@ -1574,6 +1632,7 @@ aas_routingcache_t *AAS_GetPortalRoutingCache(int clusternum, int areanum, int t
 	cache->time = AAS_RoutingTime();
 	cache->type = CACHETYPE_PORTAL;
 	AAS_LinkCache(cache);
+	if (batchcache) batchcache->cache = cache;
 	return cache;
 } //end of the function AAS_GetPortalRoutingCache
 //===========================================================================
@@ -1617,8 +1676,11 @@ int AAS_AreaRouteToGoalArea(int areanum, vec3_t origin, int goalareanum, int tra
 		return qfalse;
 	} //end if
 	// make sure the routing cache doesn't grow to large
-	while(AvailableMemory() < 1 * 1024 * 1024) {
-		if (!AAS_FreeOldestCache()) break;
+	// (a batch of queries does this once before the first query)
+	if (!routingbatch) {
+		while(AvailableMemory() < 1 * 1024 * 1024) {
+			if (!AAS_FreeOldestCache()) break;
+		}
 	}
 	//
 	if (AAS_AreaDoNotEnter(areanum) || AAS_AreaDoNotEnter(goalareanum))
@@ -1775,6 +1837,44 @@ int AAS_AreaTravelTimeToGoalArea(int areanum, vec3_t origin, int goalareanum, in
 	return 0;
 } //end of the function AAS_AreaTravelTimeToGoalArea
 //===========================================================================
+// calculates the travel times for a batch of (area, goal area) pairs,
+// the routing caches are looked up once for all queries in the batch
+//
+// Parameter:			origins	: start origins within the areas or NULL
+// Returns:				number of queries with a route to the goal area
+// Changes Globals:		-
+//===========================================================================
+int AAS_AreaTravelTimesToGoalAreas(int *areanums, vec3_t *origins, int *goalareanums,
+									int travelflags, int *traveltimes, int numqueries)
+{
+	int i, numroutes, traveltime, reachnum;
+
+	if (!aasworld.initialized) return 0;
+	// make sure the routing cache doesn't grow to large
+	while(AvailableMemory() < 1 * 1024 * 1024) {
+		if (!AAS_FreeOldestCache()) break;
+	}
+	//
+	Com_Memset(batchroutingcaches, 0, sizeof(batchroutingcaches));
+	routingbatch = qtrue;
+	numroutes = 0;
+	for (i = 0; i < numqueries; i++)
+	{
+		if (AAS_AreaRouteToGoalArea(areanums[i], origins ? origins[i] : NULL,
+									goalareanums[i], travelflags, &traveltime, &reachnum))
+		{
+			traveltimes[i] = traveltime;
+			numroutes++;
+		} //end if
+		else
+		{
+			traveltimes[i] = 0;
+		} //end else
+	} //end for
+	routingbatch = qfalse;
+	return numroutes;
+} //end of the function AAS_AreaTravelTimesToGoalAreas
+//===========================================================================
 //
 // Parameter:			-
 // Returns:				-
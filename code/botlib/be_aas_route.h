@@ -59,6 +59,9 @@ int AAS_EnableRoutingArea(int areanum, int enable);
 unsigned short int AAS_AreaTravelTime(int areanum, vec3_t start, vec3_t end);
 //returns the travel time from the area to the goal area using the given travel flags
 int AAS_AreaTravelTimeToGoalArea(int areanum, vec3_t origin, int goalareanum, int travelflags);
+//calculates the travel times for a batch of (area, goal area) pairs
+int AAS_AreaTravelTimesToGoalAreas(int *areanums, vec3_t *origins, int *goalareanums,
+									int travelflags, int *traveltimes, int numqueries);
 //predict a route up to a stop event
 int AAS_PredictRoute(struct aas_predictroute_s *route, int areanum, vec3_t origin,
 							int goalareanum, int travelflags, int maxareas, int maxtime,
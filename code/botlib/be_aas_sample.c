@@ -54,6 +54,8 @@ extern botlib_import_t botimport;
 
 #define TRACEPLANE_EPSILON			0.125
 
+#define MAX_BENCHMARK_TRACEAREAS	64
+
 typedef struct aas_tracestack_s
 {
 	vec3_t start;		//start point of the piece of line to trace
@@ -204,6 +206,279 @@ void AAS_FreeAASLinkedEntities(void)
 	aasworld.arealinkedentities = NULL;
 } //end of the function AAS_InitAASLinkedEntities
 //===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void AAS_FreeTraceNodes(void)
+{
+	if (aasworld.tracenodesmemory) FreeMemory(aasworld.tracenodesmemory);
+	aasworld.tracenodesmemory = NULL;
+	aasworld.tracenodes = NULL;
+	aasworld.numtracenodes = 0;
+} //end of the function AAS_FreeTraceNodes
+//===========================================================================
+// stores the BSP tree breadth-first in one 16 byte aligned block with
+// the split planes packed into the nodes so the traces only touch one
+// cache line per node and the top of the tree stays in the cache
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void AAS_CreateTraceNodes(void)
+{
+	int i, j, head, tail, child;
+	int *newnodenum, *queue;
+	aas_node_t *node;
+	aas_plane_t *plane;
+	aas_tracenode_t *tnode;
+
+	AAS_FreeTraceNodes();
+#ifndef BSPC
+	if (!LibVarValue("aas_flatnodes", "1")) return;
+#endif //BSPC
+	//node zero is a dummy for solid leafs and node one is the root
+	if (aasworld.numnodes < 2) return;
+	newnodenum = (int *) GetClearedMemory(aasworld.numnodes * sizeof(int));
+	queue = (int *) GetMemory(aasworld.numnodes * sizeof(int));
+	//number the nodes in breadth-first order
+	head = tail = 0;
+	queue[tail++] = 1;
+	newnodenum[1] = 1;
+	while (head < tail)
+	{
+		node = &aasworld.nodes[queue[head++]];
+		for (i = 0; i < 2; i++)
+		{
+			child = node->children[i];
+			if (child <= 0) continue;
+			if (child >= aasworld.numnodes)
+			{
+				botimport.Print(PRT_ERROR, "AAS_CreateTraceNodes: node %d out of range\n", child);
+				FreeMemory(newnodenum);
+				FreeMemory(queue);
+				return;
+			} //end if
+			if (newnodenum[child]) continue;
+			newnodenum[child] = tail + 1;
+			queue[tail++] = child;
+		} //end for
+	} //end while
+	//allocate the flattened nodes with room for alignment
+	aasworld.numtracenodes = tail + 1;
+	aasworld.tracenodesmemory = GetClearedHunkMemory(aasworld.numtracenodes * sizeof(aas_tracenode_t) + 15);
+	aasworld.tracenodes = (aas_tracenode_t *) (((size_t) aasworld.tracenodesmemory + 15) & ~15);
+	for (i = 0; i < tail; i++)
+	{
+		node = &aasworld.nodes[queue[i]];
+		plane = &aasworld.planes[node->planenum];
+		tnode = &aasworld.tracenodes[i + 1];
+		VectorCopy(plane->normal, tnode->normal);
+		tnode->dist = plane->dist;
+		tnode->planenum = node->planenum;
+		tnode->nodenum = queue[i];
+		for (j = 0; j < 2; j++)
+		{
+			child = node->children[j];
+			if (child > 0) tnode->children[j] = newnodenum[child];
+			else tnode->children[j] = child;
+		} //end for
+	} //end for
+	FreeMemory(newnodenum);
+	FreeMemory(queue);
+} //end of the function AAS_CreateTraceNodes
+//===========================================================================
+// calculates the distance of the start and end point to the split plane of
+// the given node and returns the children of the node
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+static ID_INLINE int *AAS_TraceNodeSplit(int nodenum, vec3_t start, vec3_t end,
+											float *front, float *back, int *planenum)
+{
+	aas_tracenode_t *tnode;
+	aas_node_t *node;
+	aas_plane_t *plane;
+
+	if (aasworld.tracenodes)
+	{
+		tnode = &aasworld.tracenodes[nodenum];
+		*front = DotProduct(start, tnode->normal) - tnode->dist;
+		*back = DotProduct(end, tnode->normal) - tnode->dist;
+		*planenum = tnode->planenum;
+		return tnode->children;
+	} //end if
+	node = &aasworld.nodes[nodenum];
+	plane = &aasworld.planes[node->planenum];
+	*front = DotProduct(start, plane->normal) - plane->dist;
+	*back = DotProduct(end, plane->normal) - plane->dist;
+	*planenum = node->planenum;
+	return node->children;
+} //end of the function AAS_TraceNodeSplit
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void AAS_FreeTraceRecords(void)
+{
+	if (aasworld.tracerecords) FreeMemory(aasworld.tracerecords);
+	aasworld.tracerecords = NULL;
+	aasworld.numtracerecords = 0;
+	aasworld.maxtracerecords = 0;
+} //end of the function AAS_FreeTraceRecords
+//===========================================================================
+// starts recording the next maxtraces traces for the trace benchmark
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void AAS_RecordTraces(int maxtraces)
+{
+	AAS_FreeTraceRecords();
+	if (maxtraces <= 0) return;
+	aasworld.tracerecords = (aas_tracerecord_t *) GetMemory(maxtraces * sizeof(aas_tracerecord_t));
+	aasworld.maxtracerecords = maxtraces;
+	botimport.Print(PRT_MESSAGE, "recording %d AAS traces\n", maxtraces);
+} //end of the function AAS_RecordTraces
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+static void AAS_RecordTrace(vec3_t start, vec3_t end, int presencetype, int passent)
+{
+	aas_tracerecord_t *record;
+
+	if (aasworld.numtracerecords >= aasworld.maxtracerecords) return;
+	record = &aasworld.tracerecords[aasworld.numtracerecords++];
+	VectorCopy(start, record->start);
+	VectorCopy(end, record->end);
+	record->presencetype = presencetype;
+	record->passent = passent;
+	if (aasworld.numtracerecords >= aasworld.maxtracerecords)
+	{
+		botimport.Print(PRT_MESSAGE, "recorded %d AAS traces\n", aasworld.numtracerecords);
+	} //end if
+} //end of the function AAS_RecordTrace
+//===========================================================================
+// replays the recorded traces with the original and the flattened BSP
+// tree layout, reports the time per trace and checks the results match
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void AAS_TraceBenchmark(int passes)
+{
+	int i, pass, layout, numtraces, mismatches, starttime, msec[2];
+	int areas[2][MAX_BENCHMARK_TRACEAREAS];
+	int numareas[2];
+	aas_tracerecord_t *record;
+	aas_tracenode_t *tracenodes;
+	aas_trace_t trace[2];
+
+	if (!aasworld.loaded) return;
+	numtraces = aasworld.numtracerecords;
+	if (!numtraces)
+	{
+		botimport.Print(PRT_MESSAGE, "no AAS traces recorded\n");
+		return;
+	} //end if
+	if (!aasworld.tracenodes)
+	{
+		botimport.Print(PRT_MESSAGE, "flattened trace nodes disabled\n");
+		return;
+	} //end if
+	if (passes < 1) passes = 1;
+	for (i = 0; i < numtraces; i++)
+	{
+		record = &aasworld.tracerecords[i];
+		if (!record->presencetype && record->passent > MAX_BENCHMARK_TRACEAREAS)
+		{
+			record->passent = MAX_BENCHMARK_TRACEAREAS;
+		} //end if
+	} //end for
+	//don't record the replayed traces
+	aasworld.numtracerecords = aasworld.maxtracerecords;
+	tracenodes = aasworld.tracenodes;
+	//time both layouts, the original tree first
+	for (layout = 0; layout < 2; layout++)
+	{
+		aasworld.tracenodes = layout ? tracenodes : NULL;
+		starttime = Sys_MilliSeconds();
+		for (pass = 0; pass < passes; pass++)
+		{
+			for (i = 0; i < numtraces; i++)
+			{
+				record = &aasworld.tracerecords[i];
+				if (record->presencetype)
+				{
+					AAS_TraceClientBBox(record->start, record->end, record->presencetype, record->passent);
+				} //end if
+				else
+				{
+					AAS_TraceAreas(record->start, record->end, areas[0], NULL, record->passent);
+				} //end else
+			} //end for
+		} //end for
+		msec[layout] = Sys_MilliSeconds() - starttime;
+	} //end for
+	//compare the results of both layouts
+	mismatches = 0;
+	for (i = 0; i < numtraces; i++)
+	{
+		record = &aasworld.tracerecords[i];
+		for (layout = 0; layout < 2; layout++)
+		{
+			aasworld.tracenodes = layout ? tracenodes : NULL;
+			if (record->presencetype)
+			{
+				trace[layout] = AAS_TraceClientBBox(record->start, record->end, record->presencetype, record->passent);
+			} //end if
+			else
+			{
+				Com_Memset(areas[layout], 0, sizeof(areas[layout]));
+				numareas[layout] = AAS_TraceAreas(record->start, record->end, areas[layout], NULL, record->passent);
+			} //end else
+		} //end for
+		if (record->presencetype)
+		{
+			if (trace[0].startsolid != trace[1].startsolid ||
+					trace[0].fraction != trace[1].fraction ||
+					!VectorCompare(trace[0].endpos, trace[1].endpos) ||
+					trace[0].ent != trace[1].ent ||
+					trace[0].lastarea != trace[1].lastarea ||
+					trace[0].area != trace[1].area ||
+					trace[0].planenum != trace[1].planenum) mismatches++;
+		} //end if
+		else
+		{
+			if (numareas[0] != numareas[1] ||
+					memcmp(areas[0], areas[1], sizeof(areas[0]))) mismatches++;
+		} //end else
+	} //end for
+	aasworld.tracenodes = tracenodes;
+	aasworld.numtracerecords = numtraces;
+	//
+	botimport.Print(PRT_MESSAGE, "%d AAS traces x %d passes, %d nodes\n", numtraces, passes, aasworld.numtracenodes);
+	botimport.Print(PRT_MESSAGE, "bsp tree: %d msec (%.3f usec per trace)\n",
+						msec[0], (float) msec[0] * 1000 / ((float) numtraces * passes));
+	botimport.Print(PRT_MESSAGE, "flattened: %d msec (%.3f usec per trace)\n",
+						msec[1], (float) msec[1] * 1000 / ((float) numtraces * passes));
+	if (mismatches)
+	{
+		botimport.Print(PRT_ERROR, "%d traces differ between the layouts\n", mismatches);
+	} //end if
+} //end of the function AAS_TraceBenchmark
+//===========================================================================
 // returns the AAS area the point is in
 //
 // Parameter:				-
@@ -216,6 +491,7 @@ int AAS_PointAreaNum(vec3_t point)
 	vec_t	dist;
 	aas_node_t *node;
 	aas_plane_t *plane;
+	aas_tracenode_t *tnode;
 
 	if (!aasworld.loaded)
 	{
@@ -225,6 +501,16 @@ int AAS_PointAreaNum(vec3_t point)
 
 	//start with node 1 because node zero is a dummy used for solid leafs
 	nodenum = 1;
+	if (aasworld.tracenodes)
+	{
+		while (nodenum > 0)
+		{
+			tnode = &aasworld.tracenodes[nodenum];
+			dist = DotProduct(point, tnode->normal) - tnode->dist;
+			if (dist > 0) nodenum = tnode->children[0];
+			else nodenum = tnode->children[1];
+		} //end while
+	} //end if
 	while (nodenum > 0)
 	{
 //		botimport.Print(PRT_MESSAGE, "[%d]", nodenum);
@@ -258,6 +544,31 @@ int AAS_PointAreaNum(vec3_t point)
 	return -nodenum;
 } //end of the function AAS_PointAreaNum
 //===========================================================================
+// stores the AAS area of every point and returns the number of points
+// that are inside an area
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+int AAS_PointAreaNums(vec3_t *points, int *areanums, int numpoints)
+{
+	int i, numinarea;
+
+	if (!aasworld.loaded)
+	{
+		botimport.Print(PRT_ERROR, "AAS_PointAreaNums: aas not loaded\n");
+		return 0;
+	} //end if
+	numinarea = 0;
+	for (i = 0; i < numpoints; i++)
+	{
+		areanums[i] = AAS_PointAreaNum(points[i]);
+		if (areanums[i]) numinarea++;
+	} //end for
+	return numinarea;
+} //end of the function AAS_PointAreaNums
+//===========================================================================
 //
 // Parameter:			-
 // Returns:				-
@@ -453,8 +764,8 @@ aas_trace_t AAS_TraceClientBBox(vec3_t start, vec3_t end, int presencetype,
 	float front, back, frac;
 	vec3_t cur_start, cur_end, cur_mid, v1, v2;
 	aas_tracestack_t tracestack[127];
+	int nodeplanenum, *children;
 	aas_tracestack_t *tstack_p;
-	aas_node_t *aasnode;
 	aas_plane_t *plane;
 	aas_trace_t trace;
 
@@ -462,6 +773,7 @@ aas_trace_t AAS_TraceClientBBox(vec3_t start, vec3_t end, int presencetype,
 	Com_Memset(&trace, 0, sizeof(aas_trace_t));
 
 	if (!aasworld.loaded) return trace;
+	if (aasworld.tracerecords) AAS_RecordTrace(start, end, presencetype, passent);
 	
 	tstack_p = tracestack;
 	//we start with the whole line on the stack
@@ -597,43 +909,12 @@ aas_trace_t AAS_TraceClientBBox(vec3_t start, vec3_t end, int presencetype,
 			return trace;
 		} //end if
 #endif //AAS_SAMPLE_DEBUG
-		//the node to test against
-		aasnode = &aasworld.nodes[nodenum];
 		//start point of current line to test against node
 		VectorCopy(tstack_p->start, cur_start);
 		//end point of the current line to test against node
 		VectorCopy(tstack_p->end, cur_end);
-		//the current node plane
-		plane = &aasworld.planes[aasnode->planenum];
-
-		switch(plane->type)
-		{/*FIXME: wtf doesn't this work? obviously the axial node planes aren't always facing positive!!!
-			//check for axial planes
-			case PLANE_X:
-			{
-				front = cur_start[0] - plane->dist;
-				back = cur_end[0] - plane->dist;
-				break;
-			} //end case
-			case PLANE_Y:
-			{
-				front = cur_start[1] - plane->dist;
-				back = cur_end[1] - plane->dist;
-				break;
-			} //end case
-			case PLANE_Z:
-			{
-				front = cur_start[2] - plane->dist;
-				back = cur_end[2] - plane->dist;
-				break;
-			} //end case*/
-			default: //gee it's not an axial plane
-			{
-				front = DotProduct(cur_start, plane->normal) - plane->dist;
-				back = DotProduct(cur_end, plane->normal) - plane->dist;
-				break;
-			} //end default
-		} //end switch
+		//distances to the node plane and the children of the node
+		children = AAS_TraceNodeSplit(nodenum, cur_start, cur_end, &front, &back, &nodeplanenum);
 		// bk010221 - old location of FPE hack and divide by zero expression
 		//if the whole to be traced line is totally at the front of this node
 		//only go down the tree with the front child
@@ -641,7 +922,7 @@ aas_trace_t AAS_TraceClientBBox(vec3_t start, vec3_t end, int presencetype,
 		{
 			//keep the current start and end point on the stack
 			//and go down the tree with the front child
-			tstack_p->nodenum = aasnode->children[0];
+			tstack_p->nodenum = children[0];
 			tstack_p++;
 			if (tstack_p >= &tracestack[127])
 			{
@@ -655,7 +936,7 @@ aas_trace_t AAS_TraceClientBBox(vec3_t start, vec3_t end, int presencetype,
 		{
 			//keep the current start and end point on the stack
 			//and go down the tree with the back child
-			tstack_p->nodenum = aasnode->children[1];
+			tstack_p->nodenum = children[1];
 			tstack_p++;
 			if (tstack_p >= &tracestack[127])
 			{
@@ -691,8 +972,8 @@ aas_trace_t AAS_TraceClientBBox(vec3_t start, vec3_t end, int presencetype,
 			VectorCopy(cur_mid, tstack_p->start);
 			//not necesary to store because still on stack
 			//VectorCopy(cur_end, tstack_p->end);
-			tstack_p->planenum = aasnode->planenum;
-			tstack_p->nodenum = aasnode->children[!side];
+			tstack_p->planenum = nodeplanenum;
+			tstack_p->nodenum = children[!side];
 			tstack_p++;
 			if (tstack_p >= &tracestack[127])
 			{
@@ -705,7 +986,7 @@ aas_trace_t AAS_TraceClientBBox(vec3_t start, vec3_t end, int presencetype,
 			VectorCopy(cur_start, tstack_p->start);
 			VectorCopy(cur_mid, tstack_p->end);
 			tstack_p->planenum = tmpplanenum;
-			tstack_p->nodenum = aasnode->children[side];
+			tstack_p->nodenum = children[side];
 			tstack_p++;
 			if (tstack_p >= &tracestack[127])
 			{
@@ -730,13 +1011,13 @@ int AAS_TraceAreas(vec3_t start, vec3_t end, int *areas, vec3_t *points, int max
 	float front, back, frac;
 	vec3_t cur_start, cur_end, cur_mid;
 	aas_tracestack_t tracestack[127];
+	int nodeplanenum, *children;
 	aas_tracestack_t *tstack_p;
-	aas_node_t *aasnode;
-	aas_plane_t *plane;
 
 	numareas = 0;
 	areas[0] = 0;
 	if (!aasworld.loaded) return numareas;
+	if (aasworld.tracerecords) AAS_RecordTrace(start, end, 0, maxareas);
 
 	tstack_p = tracestack;
 	//we start with the whole line on the stack
@@ -788,43 +1069,12 @@ int AAS_TraceAreas(vec3_t start, vec3_t end, int *areas, vec3_t *points, int max
 			return numareas;
 		} //end if
 #endif //AAS_SAMPLE_DEBUG
-		//the node to test against
-		aasnode = &aasworld.nodes[nodenum];
 		//start point of current line to test against node
 		VectorCopy(tstack_p->start, cur_start);
 		//end point of the current line to test against node
 		VectorCopy(tstack_p->end, cur_end);
-		//the current node plane
-		plane = &aasworld.planes[aasnode->planenum];
-
-		switch(plane->type)
-		{/*FIXME: wtf doesn't this work? obviously the node planes aren't always facing positive!!!
-			//check for axial planes
-			case PLANE_X:
-			{
-				front = cur_start[0] - plane->dist;
-				back = cur_end[0] - plane->dist;
-				break;
-			} //end case
-			case PLANE_Y:
-			{
-				front = cur_start[1] - plane->dist;
-				back = cur_end[1] - plane->dist;
-				break;
-			} //end case
-			case PLANE_Z:
-			{
-				front = cur_start[2] - plane->dist;
-				back = cur_end[2] - plane->dist;
-				break;
-			} //end case*/
-			default: //gee it's not an axial plane
-			{
-				front = DotProduct(cur_start, plane->normal) - plane->dist;
-				back = DotProduct(cur_end, plane->normal) - plane->dist;
-				break;
-			} //end default
-		} //end switch
+		//distances to the node plane and the children of the node
+		children = AAS_TraceNodeSplit(nodenum, cur_start, cur_end, &front, &back, &nodeplanenum);
 
 		//if the whole to be traced line is totally at the front of this node
 		//only go down the tree with the front child
@@ -832,7 +1082,7 @@ int AAS_TraceAreas(vec3_t start, vec3_t end, int *areas, vec3_t *points, int max
 		{
 			//keep the current start and end point on the stack
 			//and go down the tree with the front child
-			tstack_p->nodenum = aasnode->children[0];
+			tstack_p->nodenum = children[0];
 			tstack_p++;
 			if (tstack_p >= &tracestack[127])
 			{
@@ -846,7 +1096,7 @@ int AAS_TraceAreas(vec3_t start, vec3_t end, int *areas, vec3_t *points, int max
 		{
 			//keep the current start and end point on the stack
 			//and go down the tree with the back child
-			tstack_p->nodenum = aasnode->children[1];
+			tstack_p->nodenum = children[1];
 			tstack_p++;
 			if (tstack_p >= &tracestack[127])
 			{
@@ -877,8 +1127,8 @@ int AAS_TraceAreas(vec3_t start, vec3_t end, int *areas, vec3_t *points, int max
 			VectorCopy(cur_mid, tstack_p->start);
 			//not necesary to store because still on stack
 			//VectorCopy(cur_end, tstack_p->end);
-			tstack_p->planenum = aasnode->planenum;
-			tstack_p->nodenum = aasnode->children[!side];
+			tstack_p->planenum = nodeplanenum;
+			tstack_p->nodenum = children[!side];
 			tstack_p++;
 			if (tstack_p >= &tracestack[127])
 			{
@@ -891,7 +1141,7 @@ int AAS_TraceAreas(vec3_t start, vec3_t end, int *areas, vec3_t *points, int max
 			VectorCopy(cur_start, tstack_p->start);
 			VectorCopy(cur_mid, tstack_p->end);
 			tstack_p->planenum = tmpplanenum;
-			tstack_p->nodenum = aasnode->children[side];
+			tstack_p->nodenum = children[side];
 			tstack_p++;
 			if (tstack_p >= &tracestack[127])
 			{
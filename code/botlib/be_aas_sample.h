@@ -42,6 +42,11 @@ aas_link_t *AAS_LinkEntityClientBBox(vec3_t absmins, vec3_t absmaxs, int entnum,
 qboolean AAS_PointInsideFace(int facenum, vec3_t point, float epsilon);
 qboolean AAS_InsideFace(aas_face_t *face, vec3_t pnormal, vec3_t point, float epsilon);
 void AAS_UnlinkFromAreas(aas_link_t *areas);
+void AAS_CreateTraceNodes(void);
+void AAS_FreeTraceNodes(void);
+void AAS_RecordTraces(int maxtraces);
+void AAS_FreeTraceRecords(void);
+void AAS_TraceBenchmark(int passes);
 #endif //AASINTERN
 
 //returns the mins and maxs of the bounding box for the given presence type
@@ -62,6 +67,8 @@ int AAS_BBoxAreas(vec3_t absmins, vec3_t absmaxs, int *areas, int maxareas);
 int AAS_AreaInfo( int areanum, aas_areainfo_t *info );
 //returns the area the point is in
 int AAS_PointAreaNum(vec3_t point);
+//stores the area of every point and returns the number of points inside an area
+int AAS_PointAreaNums(vec3_t *points, int *areanums, int numpoints);
 //
 int AAS_PointReachabilityAreaIndex( vec3_t point );
 //returns the plane the given face is in
@@ -37,6 +37,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include "l_precomp.h"
 #include "l_struct.h"
 #include "l_libvar.h"
+#include "l_cache.h"
 #include "aasfile.h"
 #include "../game/botlib.h"
 #include "../game/be_aas.h"
@@ -144,6 +145,49 @@ void BotFreeCharacterStrings(bot_character_t *ch)
 // Returns:				-
 // Changes Globals:		-
 //========================================================================
+void BotFreeCachedCharacter(void *ch)
+{
+	BotFreeCharacterStrings((bot_character_t *) ch);
+	FreeMemory(ch);
+} //end of the function BotFreeCachedCharacter
+//========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//========================================================================
+void BotReleaseCharacter(bot_character_t *ch)
+{
+	if (ParseCacheRelease(ch)) return;
+	BotFreeCachedCharacter(ch);
+} //end of the function BotReleaseCharacter
+//========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//========================================================================
+int BotAllocCharacterHandle(bot_character_t *ch)
+{
+	int handle;
+
+	for (handle = 1; handle <= MAX_CLIENTS; handle++)
+	{
+		if (!botcharacters[handle])
+		{
+			botcharacters[handle] = ch;
+			return handle;
+		} //end if
+	} //end for
+	BotReleaseCharacter(ch);
+	return 0;
+} //end of the function BotAllocCharacterHandle
+//========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//========================================================================
 void BotFreeCharacter2(int handle)
 {
 	if (handle <= 0 || handle > MAX_CLIENTS)
@@ -156,11 +200,11 @@ void BotFreeCharacter2(int handle)
 		botimport.Print(PRT_FATAL, "invalid character %d\n", handle);
 		return;
 	} //end if
-	BotFreeCharacterStrings(botcharacters[handle]);
-	FreeMemory(botcharacters[handle]);
+	BotReleaseCharacter(botcharacters[handle]);
 	botcharacters[handle] = NULL;
 } //end of the function BotFreeCharacter2
 //========================================================================
+// every bot has its own handle, the character itself stays cached
 //
 // Parameter:			-
 // Returns:				-
@@ -168,7 +212,6 @@ void BotFreeCharacter2(int handle)
 //========================================================================
 void BotFreeCharacter(int handle)
 {
-	if (!LibVarGetValue("bot_reloadcharacters")) return;
 	BotFreeCharacter2(handle);
 } //end of the function BotFreeCharacter
 //===========================================================================
@@ -354,138 +397,96 @@ bot_character_t *BotLoadCharacterFromFile(char *charfile, int skill)
 	return ch;
 } //end of the function BotLoadCharacterFromFile
 //===========================================================================
+// returns a character shared through the parse cache, the characteristics
+// not in the character file are taken from the default character
 //
 // Parameter:			-
 // Returns:				-
 // Changes Globals:		-
 //===========================================================================
-int BotFindCachedCharacter(char *charfile, float skill)
+bot_character_t *BotLoadCachedCharacter(char *charfile, float skill, int reload)
 {
-	int handle;
+	int intskill, starttime, parsetime;
+	char section[MAX_QPATH];
+	bot_character_t *ch, *defaultch;
 
-	for (handle = 1; handle <= MAX_CLIENTS; handle++)
-	{
-		if ( !botcharacters[handle] ) continue;
-		if ( strcmp( botcharacters[handle]->filename, charfile ) == 0 &&
-			(skill < 0 || fabs(botcharacters[handle]->skill - skill) < 0.01) )
-		{
-			return handle;
-		} //end if
-	} //end for
-	return 0;
-} //end of the function BotFindCachedCharacter
-//===========================================================================
-//
-// Parameter:			-
-// Returns:				-
-// Changes Globals:		-
-//===========================================================================
-int BotLoadCachedCharacter(char *charfile, float skill, int reload)
-{
-	int handle, cachedhandle, intskill;
-	bot_character_t *ch = NULL;
-#ifdef DEBUG
-	int starttime;
-
-	starttime = Sys_MilliSeconds();
-#endif //DEBUG
-
-	//find a free spot for a character
-	for (handle = 1; handle <= MAX_CLIENTS; handle++)
-	{
-		if (!botcharacters[handle]) break;
-	} //end for
-	if (handle > MAX_CLIENTS) return 0;
+	Com_sprintf(section, sizeof(section), "skill %1.2f", skill);
 	//try to load a cached character with the given skill
 	if (!reload)
 	{
-		cachedhandle = BotFindCachedCharacter(charfile, skill);
-		if (cachedhandle)
+		ch = (bot_character_t *) ParseCacheFind(charfile, section);
+		if (ch)
 		{
 			botimport.Print(PRT_MESSAGE, "loaded cached skill %f from %s\n", skill, charfile);
-			return cachedhandle;
+			return ch;
 		} //end if
-	} //end else
+	} //end if
 	//
+	starttime = Sys_MilliSeconds();
 	intskill = (int) (skill + 0.5);
 	//try to load the character with the given skill
 	ch = BotLoadCharacterFromFile(charfile, intskill);
 	if (ch)
 	{
-		botcharacters[handle] = ch;
-		//
 		botimport.Print(PRT_MESSAGE, "loaded skill %d from %s\n", intskill, charfile);
-#ifdef DEBUG
-		if (bot_developer)
+	} //end if
+	else
+	{
+		botimport.Print(PRT_WARNING, "couldn't find skill %d in %s\n", intskill, charfile);
+		//try to load the default character with the given skill
+		ch = BotLoadCharacterFromFile(DEFAULT_CHARACTER, intskill);
+		if (ch)
 		{
-			botimport.Print(PRT_MESSAGE, "skill %d loaded in %d msec from %s\n", intskill, Sys_MilliSeconds() - starttime, charfile);
+			botimport.Print(PRT_MESSAGE, "loaded default skill %d from %s\n", intskill, charfile);
 		} //end if
-#endif //DEBUG
-		return handle;
-	} //end if
-	//
-	botimport.Print(PRT_WARNING, "couldn't find skill %d in %s\n", intskill, charfile);
-	//
-	if (!reload)
+	} //end else
+	//try to load a character with any skill
+	if (!ch)
 	{
-		//try to load a cached default character with the given skill
-		cachedhandle = BotFindCachedCharacter(DEFAULT_CHARACTER, skill);
-		if (cachedhandle)
+		ch = BotLoadCharacterFromFile(charfile, -1);
+		if (ch)
 		{
-			botimport.Print(PRT_MESSAGE, "loaded cached default skill %d from %s\n", intskill, charfile);
-			return cachedhandle;
+			botimport.Print(PRT_MESSAGE, "loaded skill %f from %s\n", ch->skill, charfile);
 		} //end if
 	} //end if
-	//try to load the default character with the given skill
-	ch = BotLoadCharacterFromFile(DEFAULT_CHARACTER, intskill);
-	if (ch)
+	//try to load the default character with any skill
+	if (!ch)
 	{
-		botcharacters[handle] = ch;
-		botimport.Print(PRT_MESSAGE, "loaded default skill %d from %s\n", intskill, charfile);
-		return handle;
+		ch = BotLoadCharacterFromFile(DEFAULT_CHARACTER, -1);
+		if (ch)
+		{
+			botimport.Print(PRT_MESSAGE, "loaded default skill %f from %s\n", ch->skill, charfile);
+		} //end if
 	} //end if
 	//
-	if (!reload)
+	if (!ch)
 	{
-		//try to load a cached character with any skill
-		cachedhandle = BotFindCachedCharacter(charfile, -1);
-		if (cachedhandle)
-		{
-			botimport.Print(PRT_MESSAGE, "loaded cached skill %f from %s\n", botcharacters[cachedhandle]->skill, charfile);
-			return cachedhandle;
-		} //end if
+		botimport.Print(PRT_WARNING, "couldn't load any skill from %s\n", charfile);
+		return NULL;
 	} //end if
-	//try to load a character with any skill
-	ch = BotLoadCharacterFromFile(charfile, -1);
-	if (ch)
+	parsetime = Sys_MilliSeconds() - starttime;
+#ifdef DEBUG
+	if (bot_developer)
 	{
-		botcharacters[handle] = ch;
-		botimport.Print(PRT_MESSAGE, "loaded skill %f from %s\n", ch->skill, charfile);
-		return handle;
+		botimport.Print(PRT_MESSAGE, "skill %d loaded in %d msec from %s\n", intskill, parsetime, charfile);
 	} //end if
-	//
-	if (!reload)
+#endif //DEBUG
+	//fill in the characteristics the character file doesn't set
+	if (Q_stricmp(charfile, DEFAULT_CHARACTER))
 	{
-		//try to load a cached character with any skill
-		cachedhandle = BotFindCachedCharacter(DEFAULT_CHARACTER, -1);
-		if (cachedhandle)
+		defaultch = BotLoadCachedCharacter(DEFAULT_CHARACTER, skill, qfalse);
+		if (defaultch)
 		{
-			botimport.Print(PRT_MESSAGE, "loaded cached default skill %f from %s\n", botcharacters[cachedhandle]->skill, charfile);
-			return cachedhandle;
+			BotDefaultCharacteristics(ch, defaultch);
+			BotReleaseCharacter(defaultch);
 		} //end if
 	} //end if
-	//try to load a character with any skill
-	ch = BotLoadCharacterFromFile(DEFAULT_CHARACTER, -1);
-	if (ch)
+	//from here on the character is shared and shouldn't be changed
+	if (!reload)
 	{
-		botcharacters[handle] = ch;
-		botimport.Print(PRT_MESSAGE, "loaded default skill %f from %s\n", ch->skill, charfile);
-		return handle;
+		ParseCacheAdd(charfile, section, ch, parsetime, BotFreeCachedCharacter);
 	} //end if
-	//
-	botimport.Print(PRT_WARNING, "couldn't load any skill from %s\n", charfile);
-	//couldn't load any character
-	return 0;
+	return ch;
 } //end of the function BotLoadCachedCharacter
 //===========================================================================
 //
@@ -495,17 +496,11 @@ int BotLoadCachedCharacter(char *charfile, float skill, int reload)
 //===========================================================================
 int BotLoadCharacterSkill(char *charfile, float skill)
 {
-	int ch, defaultch;
+	bot_character_t *ch;
 
-	defaultch = BotLoadCachedCharacter(DEFAULT_CHARACTER, skill, qfalse);
 	ch = BotLoadCachedCharacter(charfile, skill, LibVarGetValue("bot_reloadcharacters"));
-
-	if (defaultch && ch)
-	{
-		BotDefaultCharacteristics(botcharacters[ch], botcharacters[defaultch]);
-	} //end if
-
-	return ch;
+	if (!ch) return 0;
+	return BotAllocCharacterHandle(ch);
 } //end of the function BotLoadCharacterSkill
 //===========================================================================
 //
@@ -513,27 +508,16 @@ int BotLoadCharacterSkill(char *charfile, float skill)
 // Returns:				-
 // Changes Globals:		-
 //===========================================================================
-int BotInterpolateCharacters(int handle1, int handle2, float desiredskill)
+bot_character_t *BotInterpolateCharacters(bot_character_t *ch1, bot_character_t *ch2, float desiredskill)
 {
-	bot_character_t *ch1, *ch2, *out;
-	int i, handle;
+	bot_character_t *out;
+	int i;
 	float scale;
 
-	ch1 = BotCharacterFromHandle(handle1);
-	ch2 = BotCharacterFromHandle(handle2);
-	if (!ch1 || !ch2)
-		return 0;
-	//find a free spot for a character
-	for (handle = 1; handle <= MAX_CLIENTS; handle++)
-	{
-		if (!botcharacters[handle]) break;
-	} //end for
-	if (handle > MAX_CLIENTS) return 0;
 	out = (bot_character_t *) GetClearedMemory(sizeof(bot_character_t) +
 					MAX_CHARACTERISTICS * sizeof(bot_characteristic_t));
 	out->skill = desiredskill;
 	strcpy(out->filename, ch1->filename);
-	botcharacters[handle] = out;
 
 	scale = (float) (desiredskill - ch1->skill) / (ch2->skill - ch1->skill);
 	for (i = 0; i < MAX_CHARACTERISTICS; i++)
@@ -557,7 +541,7 @@ int BotInterpolateCharacters(int handle1, int handle2, float desiredskill)
 			strcpy(out->c[i].value.string, ch1->c[i].value.string);
 		} //end else if
 	} //end for
-	return handle;
+	return out;
 } //end of the function BotInterpolateCharacters
 //===========================================================================
 //
@@ -567,7 +551,9 @@ int BotInterpolateCharacters(int handle1, int handle2, float desiredskill)
 //===========================================================================
 int BotLoadCharacter(char *charfile, float skill)
 {
-	int firstskill, secondskill, handle;
+	int reload, starttime;
+	char section[MAX_QPATH];
+	bot_character_t *ch, *firstch, *secondch;
 
 	//make sure the skill is in the valid range
 	if (skill < 1.0) skill = 1.0;
@@ -578,35 +564,46 @@ int BotLoadCharacter(char *charfile, float skill)
 		return BotLoadCharacterSkill(charfile, skill);
 	} //end if
 	//check if there's a cached skill
-	handle = BotFindCachedCharacter(charfile, skill);
-	if (handle)
+	reload = LibVarGetValue("bot_reloadcharacters");
+	Com_sprintf(section, sizeof(section), "skill %1.2f", skill);
+	if (!reload)
 	{
-		botimport.Print(PRT_MESSAGE, "loaded cached skill %f from %s\n", skill, charfile);
-		return handle;
+		ch = (bot_character_t *) ParseCacheFind(charfile, section);
+		if (ch)
+		{
+			botimport.Print(PRT_MESSAGE, "loaded cached skill %f from %s\n", skill, charfile);
+			return BotAllocCharacterHandle(ch);
+		} //end if
 	} //end if
 	if (skill < 4.0)
 	{
 		//load skill 1 and 4
-		firstskill = BotLoadCharacterSkill(charfile, 1);
-		if (!firstskill) return 0;
-		secondskill = BotLoadCharacterSkill(charfile, 4);
-		if (!secondskill) return firstskill;
+		firstch = BotLoadCachedCharacter(charfile, 1, reload);
+		if (!firstch) return 0;
+		secondch = BotLoadCachedCharacter(charfile, 4, reload);
+		if (!secondch) return BotAllocCharacterHandle(firstch);
 	} //end if
 	else
 	{
 		//load skill 4 and 5
-		firstskill = BotLoadCharacterSkill(charfile, 4);
-		if (!firstskill) return 0;
-		secondskill = BotLoadCharacterSkill(charfile, 5);
-		if (!secondskill) return firstskill;
+		firstch = BotLoadCachedCharacter(charfile, 4, reload);
+		if (!firstch) return 0;
+		secondch = BotLoadCachedCharacter(charfile, 5, reload);
+		if (!secondch) return BotAllocCharacterHandle(firstch);
 	} //end else
 	//interpolate between the two skills
-	handle = BotInterpolateCharacters(firstskill, secondskill, skill);
-	if (!handle) return 0;
+	starttime = Sys_MilliSeconds();
+	ch = BotInterpolateCharacters(firstch, secondch, skill);
+	BotReleaseCharacter(firstch);
+	BotReleaseCharacter(secondch);
 	//write the character to the log file
-	BotDumpCharacter(botcharacters[handle]);
+	BotDumpCharacter(ch);
 	//
-	return handle;
+	if (!reload)
+	{
+		ParseCacheAdd(charfile, section, ch, Sys_MilliSeconds() - starttime, BotFreeCachedCharacter);
+	} //end if
+	return BotAllocCharacterHandle(ch);
 } //end of the function BotLoadCharacter
 //===========================================================================
 //
@@ -32,6 +32,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include "../game/q_shared.h"
 #include "l_memory.h"
 #include "l_libvar.h"
+#include "l_cache.h"
 #include "l_script.h"
 #include "l_precomp.h"
 #include "l_struct.h"
@@ -126,6 +127,7 @@ typedef struct bot_synonymlist_s
 typedef struct bot_matchstring_s
 {
 	char *string;
+	int id;									//string number in the match automaton or -1
 	struct bot_matchstring_s *next;
 } bot_matchstring_t;
 
@@ -147,6 +149,21 @@ typedef struct bot_matchtemplate_s
 	struct bot_matchtemplate_s *next;
 } bot_matchtemplate_t;
 
+//multi-pattern (Aho-Corasick) automaton over the fixed strings of all
+//match templates, one scan of a message finds all strings it contains
+typedef struct bot_matchautomaton_s
+{
+	int numstrings;							//number of different match strings
+	int numstates;							//number of automaton states
+	int numclasses;							//number of character classes
+	unsigned char charclass[256];			//character class of every upper case character
+	int *transitions;						//numstates * numclasses state transitions
+	int *output;							//match string ending in the state or -1
+	int *outputlink;						//next state on the failure chain with output or -1
+	int *stringseen;						//last scan each match string was found in
+	int scancount;							//number of scanned messages
+} bot_matchautomaton_t;
+
 //reply chat key
 typedef struct bot_replychatkey_s
 {
@@ -189,20 +206,14 @@ typedef struct bot_chatstate_s
 	bot_chat_t *chat;
 } bot_chatstate_t;
 
-typedef struct {
-	bot_chat_t	*chat;
-	char		filename[MAX_QPATH];
-	char		chatname[MAX_QPATH];
-} bot_ichatdata_t;
-
-bot_ichatdata_t	*ichatdata[MAX_CLIENTS];
-
 bot_chatstate_t *botchatstates[MAX_CLIENTS+1];
 //console message heap
 bot_consolemessage_t *consolemessageheap = NULL;
 bot_consolemessage_t *freeconsolemessages = NULL;
 //list with match strings
 bot_matchtemplate_t *matchtemplates = NULL;
+//automaton over the match strings
+bot_matchautomaton_t *matchautomaton = NULL;
 //list with synonyms
 bot_synonymlist_t *synonyms = NULL;
 //list with random strings
@@ -1206,6 +1217,7 @@ bot_matchpiece_t *BotLoadMatchPieces(source_t *source, char *endtoken)
 				matchstring = (bot_matchstring_t *) GetClearedHunkMemory(sizeof(bot_matchstring_t) + strlen(token.string) + 1);
 				matchstring->string = (char *) matchstring + sizeof(bot_matchstring_t);
 				strcpy(matchstring->string, token.string);
+				matchstring->id = -1;
 				if (!strlen(token.string)) emptystring = qtrue;
 				matchstring->next = NULL;
 				if (lastmatchstring) lastmatchstring->next = matchstring;
@@ -1354,6 +1366,183 @@ bot_matchtemplate_t *BotLoadMatchTemplates(char *matchfile)
 // Returns:					-
 // Changes Globals:		-
 //===========================================================================
+void BotFreeMatchAutomaton(bot_matchautomaton_t *ma)
+{
+	if (!ma) return;
+	FreeMemory(ma->transitions);
+	FreeMemory(ma->output);
+	FreeMemory(ma->outputlink);
+	FreeMemory(ma->stringseen);
+	FreeMemory(ma);
+} //end of the function BotFreeMatchAutomaton
+//===========================================================================
+// compiles the fixed strings of the match templates into one automaton
+// and stores the string number of every match string in the templates,
+// strings are matched case insensitive just like StringContains
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+bot_matchautomaton_t *BotCreateMatchAutomaton(bot_matchtemplate_t *matches)
+{
+	int i, k, state, next, maxstates, head, tail, c;
+	int *fail, *queue;
+	char *ptr;
+	bot_matchautomaton_t *ma;
+	bot_matchtemplate_t *mt;
+	bot_matchpiece_t *mp;
+	bot_matchstring_t *ms;
+
+	ma = (bot_matchautomaton_t *) GetClearedMemory(sizeof(bot_matchautomaton_t));
+	//character classes and an upper bound for the number of states
+	maxstates = 1;
+	ma->numclasses = 1;
+	for (mt = matches; mt; mt = mt->next)
+	{
+		for (mp = mt->first; mp; mp = mp->next)
+		{
+			if (mp->type != MT_STRING) continue;
+			for (ms = mp->firststring; ms; ms = ms->next)
+			{
+				for (ptr = ms->string; *ptr; ptr++)
+				{
+					c = (unsigned char) toupper(*ptr);
+					if (!ma->charclass[c]) ma->charclass[c] = ma->numclasses++;
+					maxstates++;
+				} //end for
+			} //end for
+		} //end for
+	} //end for
+	ma->transitions = (int *) GetClearedMemory(maxstates * ma->numclasses * sizeof(int));
+	ma->output = (int *) GetMemory(maxstates * sizeof(int));
+	ma->outputlink = (int *) GetMemory(maxstates * sizeof(int));
+	for (i = 0; i < maxstates; i++)
+	{
+		ma->output[i] = -1;
+		ma->outputlink[i] = -1;
+	} //end for
+	//build the trie, state zero is the root and no trie edge leads back to it
+	ma->numstates = 1;
+	for (mt = matches; mt; mt = mt->next)
+	{
+		for (mp = mt->first; mp; mp = mp->next)
+		{
+			if (mp->type != MT_STRING) continue;
+			for (ms = mp->firststring; ms; ms = ms->next)
+			{
+				if (!*ms->string) continue;
+				state = 0;
+				for (ptr = ms->string; *ptr; ptr++)
+				{
+					k = ma->charclass[(unsigned char) toupper(*ptr)];
+					next = ma->transitions[state * ma->numclasses + k];
+					if (!next)
+					{
+						next = ma->numstates++;
+						ma->transitions[state * ma->numclasses + k] = next;
+					} //end if
+					state = next;
+				} //end for
+				//equal strings share the same string number
+				if (ma->output[state] < 0) ma->output[state] = ma->numstrings++;
+				ms->id = ma->output[state];
+			} //end for
+		} //end for
+	} //end for
+	//breadth-first calculation of the failure links and the full transition table
+	fail = (int *) GetClearedMemory(ma->numstates * sizeof(int));
+	queue = (int *) GetMemory(ma->numstates * sizeof(int));
+	head = tail = 0;
+	for (k = 0; k < ma->numclasses; k++)
+	{
+		next = ma->transitions[k];
+		if (next) queue[tail++] = next;
+	} //end for
+	while (head < tail)
+	{
+		state = queue[head++];
+		for (k = 0; k < ma->numclasses; k++)
+		{
+			next = ma->transitions[state * ma->numclasses + k];
+			if (next)
+			{
+				fail[next] = ma->transitions[fail[state] * ma->numclasses + k];
+				if (ma->output[fail[next]] >= 0) ma->outputlink[next] = fail[next];
+				else ma->outputlink[next] = ma->outputlink[fail[next]];
+				queue[tail++] = next;
+			} //end if
+			else
+			{
+				ma->transitions[state * ma->numclasses + k] = ma->transitions[fail[state] * ma->numclasses + k];
+			} //end else
+		} //end for
+	} //end while
+	FreeMemory(fail);
+	FreeMemory(queue);
+	//
+	ma->stringseen = (int *) GetClearedMemory((ma->numstrings + 1) * sizeof(int));
+	ma->scancount = 0;
+	return ma;
+} //end of the function BotCreateMatchAutomaton
+//===========================================================================
+// marks all match strings the message contains
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void BotMatchAutomatonScan(bot_matchautomaton_t *ma, char *str, int maxlen)
+{
+	int i, state, s, id;
+
+	ma->scancount++;
+	state = 0;
+	for (i = 0; i < maxlen && str[i]; i++)
+	{
+		state = ma->transitions[state * ma->numclasses + ma->charclass[(unsigned char) toupper(str[i])]];
+		s = (ma->output[state] >= 0) ? state : ma->outputlink[state];
+		for (; s >= 0; s = ma->outputlink[s])
+		{
+			id = ma->output[s];
+			//the rest of the failure chain was marked together with this string
+			if (ma->stringseen[id] == ma->scancount) break;
+			ma->stringseen[id] = ma->scancount;
+		} //end for
+	} //end for
+} //end of the function BotMatchAutomatonScan
+//===========================================================================
+// returns qfalse when the last scanned message can't match the template
+// because one of the fixed pieces of the template isn't in the message
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+int BotMatchTemplatePossible(bot_matchautomaton_t *ma, bot_matchtemplate_t *mt)
+{
+	bot_matchpiece_t *mp;
+	bot_matchstring_t *ms;
+
+	for (mp = mt->first; mp; mp = mp->next)
+	{
+		if (mp->type != MT_STRING) continue;
+		for (ms = mp->firststring; ms; ms = ms->next)
+		{
+			//empty strings always match
+			if (ms->id < 0) break;
+			if (ma->stringseen[ms->id] == ma->scancount) break;
+		} //end for
+		if (!ms) return qfalse;
+	} //end for
+	return qtrue;
+} //end of the function BotMatchTemplatePossible
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
 int StringsMatch(bot_matchpiece_t *pieces, bot_match_t *match)
 {
 	int lastvariable, index;
@@ -1443,10 +1632,14 @@ int BotFindMatch(char *str, bot_match_t *match, unsigned long int context)
 	{
 		match->string[strlen(match->string)-1] = '\0';
 	} //end while
+	//find all the fixed match strings in the message at once
+	if (matchautomaton) BotMatchAutomatonScan(matchautomaton, match->string, MAX_MESSAGE_SIZE);
 	//compare the string with all the match strings
 	for (ms = matchtemplates; ms; ms = ms->next)
 	{
 		if (!(ms->context & context)) continue;
+		//skip templates with fixed strings that aren't in the message
+		if (matchautomaton && !BotMatchTemplatePossible(matchautomaton, ms)) continue;
 		//reset the match variable offsets
 		for (i = 0; i < MAX_MATCHVARIABLES; i++) match->variables[i].offset = -1;
 		//
@@ -2188,7 +2381,7 @@ void BotFreeChatFile(int chatstate)
 
 	cs = BotChatStateFromHandle(chatstate);
 	if (!cs) return;
-	if (cs->chat) FreeMemory(cs->chat);
+	if (cs->chat && !ParseCacheRelease(cs->chat)) FreeMemory(cs->chat);
 	cs->chat = NULL;
 } //end of the function BotFreeChatFile
 //===========================================================================
@@ -2197,10 +2390,20 @@ void BotFreeChatFile(int chatstate)
 // Returns:					-
 // Changes Globals:		-
 //===========================================================================
+void BotFreeCachedChat(void *chat)
+{
+	FreeMemory(chat);
+} //end of the function BotFreeCachedChat
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
 int BotLoadChatFile(int chatstate, char *chatfile, char *chatname)
 {
 	bot_chatstate_t *cs;
-	int n, avail = 0;
+	int starttime;
 
 	cs = BotChatStateFromHandle(chatstate);
 	if (!cs) return BLERR_CANNOTLOADICHAT;
@@ -2208,31 +2411,11 @@ int BotLoadChatFile(int chatstate, char *chatfile, char *chatname)
 
 	if (!LibVarGetValue("bot_reloadcharacters"))
 	{
-		avail = -1;
-		for( n = 0; n < MAX_CLIENTS; n++ ) {
-			if( !ichatdata[n] ) {
-				if( avail == -1 ) {
-					avail = n;
-				}
-				continue;
-			}
-			if( strcmp( chatfile, ichatdata[n]->filename ) != 0 ) { 
-				continue;
-			}
-			if( strcmp( chatname, ichatdata[n]->chatname ) != 0 ) { 
-				continue;
-			}
-			cs->chat = ichatdata[n]->chat;
-		//		botimport.Print( PRT_MESSAGE, "retained %s from %s\n", chatname, chatfile );
-			return BLERR_NOERROR;
-		}
-
-		if( avail == -1 ) {
-			botimport.Print(PRT_FATAL, "ichatdata table full; couldn't load chat %s from %s\n", chatname, chatfile);
-			return BLERR_CANNOTLOADICHAT;
-		}
-	}
+		cs->chat = (bot_chat_t *) ParseCacheFind(chatfile, chatname);
+		if (cs->chat) return BLERR_NOERROR;
+	} //end if
 
+	starttime = Sys_MilliSeconds();
 	cs->chat = BotLoadInitialChat(chatfile, chatname);
 	if (!cs->chat)
 	{
@@ -2241,10 +2424,7 @@ int BotLoadChatFile(int chatstate, char *chatfile, char *chatname)
 	} //end if
 	if (!LibVarGetValue("bot_reloadcharacters"))
 	{
-		ichatdata[avail] = GetClearedMemory( sizeof(bot_ichatdata_t) );
-		ichatdata[avail]->chat = cs->chat;
-		Q_strncpyz( ichatdata[avail]->chatname, chatname, sizeof(ichatdata[avail]->chatname) );
-		Q_strncpyz( ichatdata[avail]->filename, chatfile, sizeof(ichatdata[avail]->filename) );
+		ParseCacheAdd(chatfile, chatname, cs->chat, Sys_MilliSeconds() - starttime, BotFreeCachedChat);
 	} //end if
 
 	return BLERR_NOERROR;
@@ -2929,10 +3109,7 @@ void BotFreeChatState(int handle)
 		return;
 	} //end if
 	cs = botchatstates[handle];
-	if (LibVarGetValue("bot_reloadcharacters"))
-	{
-		BotFreeChatFile(handle);
-	} //end if
+	BotFreeChatFile(handle);
 	//free all the console messages left in the chat state
 	for (h = BotNextConsoleMessage(handle, &m); h; h = BotNextConsoleMessage(handle, &m))
 	{
@@ -2962,6 +3139,7 @@ int BotSetupChatAI(void)
 	randomstrings = BotLoadRandomStrings(file);
 	file = LibVarString("matchfile", "match.c");
 	matchtemplates = BotLoadMatchTemplates(file);
+	if (matchtemplates) matchautomaton = BotCreateMatchAutomaton(matchtemplates);
 	//
 	if (!LibVarValue("nochat", "0"))
 	{
@@ -2994,20 +3172,12 @@ void BotShutdownChatAI(void)
 			BotFreeChatState(i);
 		} //end if
 	} //end for
-	//free all cached chats
-	for(i = 0; i < MAX_CLIENTS; i++)
-	{
-		if (ichatdata[i])
-		{
-			FreeMemory(ichatdata[i]->chat);
-			FreeMemory(ichatdata[i]);
-			ichatdata[i] = NULL;
-		} //end if
-	} //end for
 	if (consolemessageheap) FreeMemory(consolemessageheap);
 	consolemessageheap = NULL;
 	if (matchtemplates) BotFreeMatchTemplates(matchtemplates);
 	matchtemplates = NULL;
+	BotFreeMatchAutomaton(matchautomaton);
+	matchautomaton = NULL;
 	if (randomstrings) FreeMemory(randomstrings);
 	randomstrings = NULL;
 	if (synonyms) FreeMemory(synonyms);
@@ -222,10 +222,15 @@ bot_goalstate_t *BotGoalStateFromHandle(int handle)
 void BotInterbreedGoalFuzzyLogic(int parent1, int parent2, int child)
 {
 	bot_goalstate_t *p1, *p2, *c;
+	weightconfig_t *config;
 
 	p1 = BotGoalStateFromHandle(parent1);
 	p2 = BotGoalStateFromHandle(parent2);
 	c = BotGoalStateFromHandle(child);
+	//the child gets its own weights instead of changing the shared ones
+	config = CopyWeightConfig(c->itemweightconfig);
+	FreeWeightConfig(c->itemweightconfig);
+	c->itemweightconfig = config;
 
 	InterbreedWeightConfigs(p1->itemweightconfig, p2->itemweightconfig,
 									c->itemweightconfig);
@@ -253,8 +258,13 @@ void BotSaveGoalFuzzyLogic(int goalstate, char *filename)
 void BotMutateGoalFuzzyLogic(int goalstate, float range)
 {
 	bot_goalstate_t *gs;
+	weightconfig_t *config;
 
 	gs = BotGoalStateFromHandle(goalstate);
+	//evolve a private copy of the shared weights
+	config = CopyWeightConfig(gs->itemweightconfig);
+	FreeWeightConfig(gs->itemweightconfig);
+	gs->itemweightconfig = config;
 
 	EvolveWeightConfig(gs->itemweightconfig);
 } //end of the function BotMutateGoalFuzzyLogic
@@ -37,6 +37,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include "l_precomp.h"
 #include "l_struct.h"
 #include "l_libvar.h"
+#include "l_cache.h"
 #include "aasfile.h"
 #include "../game/botlib.h"
 #include "../game/be_aas.h"
@@ -47,9 +48,6 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #define MAX_INVENTORYVALUE			999999
 #define EVALUATERECURSIVELY
 
-#define MAX_WEIGHT_FILES			128
-weightconfig_t	*weightFileList[MAX_WEIGHT_FILES];
-
 //===========================================================================
 //
 // Parameter:				-
@@ -141,7 +139,7 @@ void FreeWeightConfig2(weightconfig_t *config)
 //===========================================================================
 void FreeWeightConfig(weightconfig_t *config)
 {
-	if (!LibVarGetValue("bot_reloadcharacters")) return;
+	if (ParseCacheRelease(config)) return;
 	FreeWeightConfig2(config);
 } //end of the function FreeWeightConfig
 //===========================================================================
@@ -150,6 +148,51 @@ void FreeWeightConfig(weightconfig_t *config)
 // Returns:				-
 // Changes Globals:		-
 //===========================================================================
+fuzzyseperator_t *CopyFuzzySeperators_r(fuzzyseperator_t *fs)
+{
+	fuzzyseperator_t *newfs;
+
+	if (!fs) return NULL;
+	newfs = (fuzzyseperator_t *) GetMemory(sizeof(fuzzyseperator_t));
+	memcpy(newfs, fs, sizeof(fuzzyseperator_t));
+	newfs->child = CopyFuzzySeperators_r(fs->child);
+	newfs->next = CopyFuzzySeperators_r(fs->next);
+	return newfs;
+} //end of the function CopyFuzzySeperators_r
+//===========================================================================
+// cached weight configs are shared between bots, a bot that changes its
+// weights should change a private copy
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+weightconfig_t *CopyWeightConfig(weightconfig_t *config)
+{
+	weightconfig_t *newconfig;
+	int i;
+
+	if (!config) return NULL;
+	newconfig = (weightconfig_t *) GetClearedMemory(sizeof(weightconfig_t));
+	newconfig->numweights = config->numweights;
+	Q_strncpyz(newconfig->filename, config->filename, sizeof(newconfig->filename));
+	for (i = 0; i < config->numweights; i++)
+	{
+		if (config->weights[i].name)
+		{
+			newconfig->weights[i].name = (char *) GetMemory(strlen(config->weights[i].name) + 1);
+			strcpy(newconfig->weights[i].name, config->weights[i].name);
+		} //end if
+		newconfig->weights[i].firstseperator = CopyFuzzySeperators_r(config->weights[i].firstseperator);
+	} //end for
+	return newconfig;
+} //end of the function CopyWeightConfig
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
 fuzzyseperator_t *ReadFuzzySeperators_r(source_t *source)
 {
 	int newindent, index, def, founddefault;
@@ -278,44 +321,18 @@ fuzzyseperator_t *ReadFuzzySeperators_r(source_t *source)
 //===========================================================================
 weightconfig_t *ReadWeightConfig(char *filename)
 {
-	int newindent, avail = 0, n;
+	int newindent, starttime;
 	token_t token;
 	source_t *source;
 	fuzzyseperator_t *fs;
 	weightconfig_t *config = NULL;
-#ifdef DEBUG
-	int starttime;
-
-	starttime = Sys_MilliSeconds();
-#endif //DEBUG
 
 	if (!LibVarGetValue("bot_reloadcharacters"))
 	{
-		avail = -1;
-		for( n = 0; n < MAX_WEIGHT_FILES; n++ )
-		{
-			config = weightFileList[n];
-			if( !config )
-			{
-				if( avail == -1 )
-				{
-					avail = n;
-				} //end if
-				continue;
-			} //end if
-			if( strcmp( filename, config->filename ) == 0 )
-			{
-				//botimport.Print( PRT_MESSAGE, "retained %s\n", filename );
-				return config;
-			} //end if
-		} //end for
-
-		if( avail == -1 )
-		{
-			botimport.Print( PRT_ERROR, "weightFileList was full trying to load %s\n", filename );
-			return NULL;
-		} //end if
+		config = (weightconfig_t *) ParseCacheFind(filename, "");
+		if (config) return config;
 	} //end if
+	starttime = Sys_MilliSeconds();
 
 	PC_SetBaseFolder(BOTFILESBASEFOLDER);
 	source = LoadSourceFile(filename);
@@ -430,7 +447,7 @@ weightconfig_t *ReadWeightConfig(char *filename)
 	//
 	if (!LibVarGetValue("bot_reloadcharacters"))
 	{
-		weightFileList[avail] = config;
+		ParseCacheAdd(filename, "", config, Sys_MilliSeconds() - starttime, (cachefreefunc_t) FreeWeightConfig2);
 	} //end if
 	//
 	return config;
@@ -891,22 +908,3 @@ void InterbreedWeightConfigs(weightconfig_t *config1, weightconfig_t *config2,
 									configout->weights[i].firstseperator);
 	} //end for
 } //end of the function InterbreedWeightConfigs
-//===========================================================================
-//
-// Parameter:			-
-// Returns:				-
-// Changes Globals:		-
-//===========================================================================
-void BotShutdownWeights(void)
-{
-	int i;
-
-	for( i = 0; i < MAX_WEIGHT_FILES; i++ )
-	{
-		if (weightFileList[i])
-		{
-			FreeWeightConfig2(weightFileList[i]);
-			weightFileList[i] = NULL;
-		} //end if
-	} //end for
-} //end of the function BotShutdownWeights
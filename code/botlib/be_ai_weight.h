@@ -64,6 +64,8 @@ typedef struct weightconfig_s
 weightconfig_t *ReadWeightConfig(char *filename);
 //free a weight configuration
 void FreeWeightConfig(weightconfig_t *config);
+//returns a private copy of the weight configuration
+weightconfig_t *CopyWeightConfig(weightconfig_t *config);
 //writes a weight configuration, returns true if successfull
 qboolean WriteWeightConfig(char *filename, weightconfig_t *config);
 //find the fuzzy weight with the given name
@@ -79,5 +81,3 @@ void ScaleBalanceRange(weightconfig_t *config, float scale);
 void EvolveWeightConfig(weightconfig_t *config);
 //interbreed the weight configurations and stores the interbreeded one in configout
 void InterbreedWeightConfigs(weightconfig_t *config1, weightconfig_t *config2, weightconfig_t *configout);
-//frees cached weight configurations
-void BotShutdownWeights(void);
@@ -36,6 +36,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include "l_script.h"
 #include "l_precomp.h"
 #include "l_struct.h"
+#include "l_cache.h"
 #include "aasfile.h"
 #include "../game/botlib.h"
 #include "../game/be_aas.h"
@@ -183,8 +184,8 @@ int Export_BotLibShutdown(void)
 	BotShutdownMoveAI();		//be_ai_move.c
 	BotShutdownGoalAI();		//be_ai_goal.c
 	BotShutdownWeaponAI();		//be_ai_weap.c
-	BotShutdownWeights();		//be_ai_weight.c
 	BotShutdownCharacters();	//be_ai_char.c
+	ParseCacheShutdown();		//l_cache.c
 	//shud down aas
 	AAS_Shutdown();
 	//shut down bot elemantary actions
@@ -193,6 +194,7 @@ int Export_BotLibShutdown(void)
 	LibVarDeAllocAll();
 	//remove all global defines from the pre compiler
 	PC_RemoveAllGlobalDefines();
+	PC_FreeTokenHeap();
 
 	//dump all allocated memory
 //	DumpMemory();
@@ -241,9 +243,38 @@ int Export_BotLibVarGet(char *var_name, char *value, int size)
 // Returns:					-
 // Changes Globals:		-
 //===========================================================================
+void BotParseBenchmark(int passes)
+{
+	PC_SetBaseFolder(BOTFILESBASEFOLDER);
+	PC_ParseBenchmark(LibVarString("itemconfig", "items.c"), passes);
+	PC_ParseBenchmark(LibVarString("weaponconfig", "weapons.c"), passes);
+	PC_ParseBenchmark(LibVarString("synfile", "syn.c"), passes);
+	PC_ParseBenchmark(LibVarString("rndfile", "rnd.c"), passes);
+	PC_ParseBenchmark(LibVarString("matchfile", "match.c"), passes);
+	PC_ParseBenchmark(LibVarString("rchatfile", "rchat.c"), passes);
+	PC_ParseBenchmark("bots/default_c.c", passes);
+} //end of the function BotParseBenchmark
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
 int Export_BotLibStartFrame(float time)
 {
 	if (!BotLibSetup("BotStartFrame")) return BLERR_LIBRARYNOTSETUP;
+	//print the shared character, chat and weight files
+	if (LibVarGetValue("parsecachestats"))
+	{
+		ParseCachePrintStats();
+		LibVarSet("parsecachestats", "0");
+	} //end if
+	//compare and time the lexers on the bot files
+	if (LibVarGetValue("parsebench"))
+	{
+		BotParseBenchmark((int) LibVarGetValue("parsebench"));
+		LibVarSet("parsebench", "0");
+	} //end if
 	return AAS_StartFrame(time);
 } //end of the function Export_BotLibStartFrame
 //===========================================================================
@@ -699,6 +730,11 @@ static void Init_AAS_Export( aas_export_t *aas ) {
 	//--------------------------------------------
 	aas->AAS_Swimming = AAS_Swimming;
 	aas->AAS_PredictClientMovement = AAS_PredictClientMovement;
+	//--------------------------------------------
+	// batched queries
+	//--------------------------------------------
+	aas->AAS_PointAreaNums = AAS_PointAreaNums;
+	aas->AAS_AreaTravelTimesToGoalAreas = AAS_AreaTravelTimesToGoalAreas;
 }
 
   
@@ -0,0 +1,205 @@
+/*
+===========================================================================
+Copyright (C) 1999-2005 Id Software, Inc.
+
+This file is part of Quake III Arena source code.
+
+Quake III Arena source code is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the License,
+or (at your option) any later version.
+
+Quake III Arena source code is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Foobar; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+===========================================================================
+*/
+
+/*****************************************************************************
+ * name:		l_cache.c
+ *
+ * desc:		shared cache for parsed bot files
+ *
+ * $Archive: /MissionPack/code/botlib/l_cache.c $
+ *
+ *****************************************************************************/
+
+#include "../game/q_shared.h"
+#include "../game/botlib.h"
+#include "l_memory.h"
+#include "l_cache.h"
+#include "be_interface.h"
+
+#define PARSECACHE_HASHSIZE		64
+
+//a cached parse result
+typedef struct parsecache_s
+{
+	char filename[MAX_QPATH];
+	char section[MAX_QPATH];
+	void *data;						//parsed structure shared by all users
+	cachefreefunc_t freefunc;		//frees the data
+	int refcount;					//number of users of the data
+	int parsetime;					//msec it took to parse the data
+	int hits;						//number of times the data was reused
+	struct parsecache_s *next;		//next in hash chain
+} parsecache_t;
+
+parsecache_t *parsecachehash[PARSECACHE_HASHSIZE];
+//cache statistics
+int parsecache_hits;
+int parsecache_misses;
+int parsecache_parsetime;
+int parsecache_savedtime;
+
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+int ParseCacheHashValue(char *filename, char *section)
+{
+	int hash;
+	char *ptr;
+
+	hash = 0;
+	for (ptr = filename; *ptr; ptr++) hash = hash * 31 + tolower(*ptr);
+	for (ptr = section; *ptr; ptr++) hash = hash * 31 + *ptr;
+	return (hash & 0x7fffffff) % PARSECACHE_HASHSIZE;
+} //end of the function ParseCacheHashValue
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void *ParseCacheFind(char *filename, char *section)
+{
+	parsecache_t *pc;
+
+	for (pc = parsecachehash[ParseCacheHashValue(filename, section)]; pc; pc = pc->next)
+	{
+		if (Q_stricmp(pc->filename, filename)) continue;
+		if (strcmp(pc->section, section)) continue;
+		pc->refcount++;
+		pc->hits++;
+		parsecache_hits++;
+		parsecache_savedtime += pc->parsetime;
+		return pc->data;
+	} //end for
+	return NULL;
+} //end of the function ParseCacheFind
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void ParseCacheAdd(char *filename, char *section, void *data, int parsetime, cachefreefunc_t freefunc)
+{
+	parsecache_t *pc;
+	int hash;
+
+	pc = (parsecache_t *) GetClearedMemory(sizeof(parsecache_t));
+	Q_strncpyz(pc->filename, filename, sizeof(pc->filename));
+	Q_strncpyz(pc->section, section, sizeof(pc->section));
+	pc->data = data;
+	pc->freefunc = freefunc;
+	pc->refcount = 1;
+	pc->parsetime = parsetime;
+	//
+	hash = ParseCacheHashValue(filename, section);
+	pc->next = parsecachehash[hash];
+	parsecachehash[hash] = pc;
+	//
+	parsecache_misses++;
+	parsecache_parsetime += parsetime;
+} //end of the function ParseCacheAdd
+//===========================================================================
+// cached data stays around without references so bots added later on
+// don't parse the files again, it's freed at shutdown
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+qboolean ParseCacheRelease(void *data)
+{
+	parsecache_t *pc;
+	int i;
+
+	if (!data) return qtrue;
+	for (i = 0; i < PARSECACHE_HASHSIZE; i++)
+	{
+		for (pc = parsecachehash[i]; pc; pc = pc->next)
+		{
+			if (pc->data != data) continue;
+			if (pc->refcount <= 0)
+			{
+				botimport.Print(PRT_ERROR, "ParseCacheRelease: %s %s not referenced\n", pc->filename, pc->section);
+				return qtrue;
+			} //end if
+			pc->refcount--;
+			return qtrue;
+		} //end for
+	} //end for
+	return qfalse;
+} //end of the function ParseCacheRelease
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void ParseCachePrintStats(void)
+{
+	parsecache_t *pc;
+	int i, numentries;
+
+	numentries = 0;
+	for (i = 0; i < PARSECACHE_HASHSIZE; i++)
+	{
+		for (pc = parsecachehash[i]; pc; pc = pc->next)
+		{
+			botimport.Print(PRT_MESSAGE, "%-32s %-16s %3d refs %3d hits %5d msec\n",
+						pc->filename, pc->section, pc->refcount, pc->hits, pc->parsetime);
+			numentries++;
+		} //end for
+	} //end for
+	botimport.Print(PRT_MESSAGE, "%d cached parse results, %d hits, %d misses\n",
+						numentries, parsecache_hits, parsecache_misses);
+	botimport.Print(PRT_MESSAGE, "%d msec parsing, %d msec saved\n",
+						parsecache_parsetime, parsecache_savedtime);
+} //end of the function ParseCachePrintStats
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void ParseCacheShutdown(void)
+{
+	parsecache_t *pc, *nextpc;
+	int i;
+
+	for (i = 0; i < PARSECACHE_HASHSIZE; i++)
+	{
+		for (pc = parsecachehash[i]; pc; pc = nextpc)
+		{
+			nextpc = pc->next;
+			if (pc->freefunc) pc->freefunc(pc->data);
+			FreeMemory(pc);
+		} //end for
+		parsecachehash[i] = NULL;
+	} //end for
+	parsecache_hits = 0;
+	parsecache_misses = 0;
+	parsecache_parsetime = 0;
+	parsecache_savedtime = 0;
+} //end of the function ParseCacheShutdown
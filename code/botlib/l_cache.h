@@ -0,0 +1,47 @@
+/*
+===========================================================================
+Copyright (C) 1999-2005 Id Software, Inc.
+
+This file is part of Quake III Arena source code.
+
+Quake III Arena source code is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the License,
+or (at your option) any later version.
+
+Quake III Arena source code is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Foobar; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+===========================================================================
+*/
+
+/*****************************************************************************
+ * name:		l_cache.h
+ *
+ * desc:		shared cache for parsed bot files
+ *
+ * $Archive: /source/code/botlib/l_cache.h $
+ *
+ *****************************************************************************/
+
+//frees the data of a cached parse result
+typedef void (*cachefreefunc_t)(void *data);
+
+//returns the cached parse result for the given file and section and
+//adds a reference to it, returns NULL if not cached
+void *ParseCacheFind(char *filename, char *section);
+//stores a parse result that took parsetime msec to create, the caller
+//holds the first reference, the data should not be changed afterwards
+void ParseCacheAdd(char *filename, char *section, void *data, int parsetime, cachefreefunc_t freefunc);
+//removes a reference to the data, returns qfalse if the data is not
+//cached in which case the caller owns and should free the data
+qboolean ParseCacheRelease(void *data);
+//prints the cache contents and the parse time saved
+void ParseCachePrintStats(void);
+//frees all cached parse results
+void ParseCacheShutdown(void);
@@ -107,14 +107,18 @@ typedef struct directive_s
 
 #define DEFINEHASHSIZE		1024
 
-#define TOKEN_HEAP_SIZE		4096
+#define TOKEN_POOL_SIZE		64
+
+//block of tokens
+typedef struct tokenpool_s
+{
+	struct tokenpool_s *next;				//next block of tokens
+	token_t tokens[TOKEN_POOL_SIZE];		//the tokens
+} tokenpool_t;
 
 int numtokens;
-/*
-int tokenheapinitialized;				//true when the token heap is initialized
-token_t token_heap[TOKEN_HEAP_SIZE];	//heap with tokens
-token_t *freetokens;					//free tokens from the heap
-*/
+tokenpool_t *tokenpools;				//all allocated token blocks
+token_t *freetokens;					//free tokens from the pools
 
 //list with global defines added to every source loaded
 define_t *globaldefines;
@@ -238,22 +242,29 @@ void PC_PushScript(source_t *source, script_t *script)
 // Returns:				-
 // Changes Globals:		-
 //============================================================================
-void PC_InitTokenHeap(void)
+// frees the token pools, there should be no tokens in use
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//============================================================================
+void PC_FreeTokenHeap(void)
 {
-	/*
-	int i;
+	tokenpool_t *pool;
 
-	if (tokenheapinitialized) return;
-	freetokens = NULL;
-	for (i = 0; i < TOKEN_HEAP_SIZE; i++)
+	for (pool = tokenpools; pool; pool = tokenpools)
 	{
-		token_heap[i].next = freetokens;
-		freetokens = &token_heap[i];
+		tokenpools = tokenpools->next;
+		FreeMemory(pool);
 	} //end for
-	tokenheapinitialized = qtrue;
-	*/
-} //end of the function PC_InitTokenHeap
+	freetokens = NULL;
+	numtokens = 0;
+	//the interned names of defines and tokens are gone as well
+	PS_FreeNames();
+} //end of the function PC_FreeTokenHeap
 //============================================================================
+// tokens come from pools of TOKEN_POOL_SIZE tokens instead of being
+// allocated one by one
 //
 // Parameter:			-
 // Returns:				-
@@ -262,21 +273,32 @@ void PC_InitTokenHeap(void)
 token_t *PC_CopyToken(token_t *token)
 {
 	token_t *t;
+	tokenpool_t *pool;
+	int i;
 
-//	t = (token_t *) malloc(sizeof(token_t));
-	t = (token_t *) GetMemory(sizeof(token_t));
-//	t = freetokens;
-	if (!t)
+	if (!freetokens)
 	{
+		pool = (tokenpool_t *) GetMemory(sizeof(tokenpool_t));
+		if (!pool)
+		{
 #ifdef BSPC
-		Error("out of token space\n");
+			Error("out of token space\n");
 #else
-		Com_Error(ERR_FATAL, "out of token space\n");
+			Com_Error(ERR_FATAL, "out of token space\n");
 #endif
-		return NULL;
+			return NULL;
+		} //end if
+		pool->next = tokenpools;
+		tokenpools = pool;
+		for (i = 0; i < TOKEN_POOL_SIZE; i++)
+		{
+			pool->tokens[i].next = freetokens;
+			freetokens = &pool->tokens[i];
+		} //end for
 	} //end if
-//	freetokens = freetokens->next;
-	Com_Memcpy(t, token, sizeof(token_t));
+	t = freetokens;
+	freetokens = freetokens->next;
+	PS_CopyToken(t, token);
 	t->next = NULL;
 	numtokens++;
 	return t;
@@ -289,10 +311,8 @@ token_t *PC_CopyToken(token_t *token)
 //============================================================================
 void PC_FreeToken(token_t *token)
 {
-	//free(token);
-	FreeMemory(token);
-//	token->next = freetokens;
-//	freetokens = token;
+	token->next = freetokens;
+	freetokens = token;
 	numtokens--;
 } //end of the function PC_FreeToken
 //============================================================================
@@ -331,7 +351,7 @@ int PC_ReadSourceToken(source_t *source, token_t *token)
 		FreeScript(script);
 	} //end while
 	//copy the already available token
-	Com_Memcpy(token, source->tokens, sizeof(token_t));
+	PS_CopyToken(token, source->tokens);
 	//free the read token
 	t = source->tokens;
 	source->tokens = source->tokens->next;
@@ -486,6 +506,7 @@ int PC_MergeTokens(token_t *t1, token_t *t2)
 	if (t1->type == TT_NAME && (t2->type == TT_NAME || t2->type == TT_NUMBER))
 	{
 		strcat(t1->string, t2->string);
+		t1->name = NULL;
 		return qtrue;
 	} //end if
 	//merging of two strings
@@ -549,17 +570,7 @@ void PC_PrintDefineHashTable(define_t **definehash)
 
 int PC_NameHash(char *name)
 {
-	int register hash, i;
-
-	hash = 0;
-	for (i = 0; name[i] != '\0'; i++)
-	{
-		hash += name[i] * (119 + i);
-		//hash += (name[i] << 7) + i;
-		//hash += (name[i] << (i&15));
-	} //end while
-	hash = (hash ^ (hash >> 10) ^ (hash >> 20)) & (DEFINEHASHSIZE-1);
-	return hash;
+	return PS_NameHash(name) & (DEFINEHASHSIZE-1);
 } //end of the function PC_NameHash
 //============================================================================
 //
@@ -593,6 +604,25 @@ define_t *PC_FindHashedDefine(define_t **definehash, char *name)
 	} //end for
 	return NULL;
 } //end of the function PC_FindHashedDefine
+//============================================================================
+// define names are interned so names read by the lexer can be compared
+// by pointer
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//============================================================================
+define_t *PC_FindHashedTokenDefine(define_t **definehash, token_t *token)
+{
+	define_t *d;
+
+	if (!token->name) return PC_FindHashedDefine(definehash, token->string);
+	for (d = definehash[token->namehash & (DEFINEHASHSIZE-1)]; d; d = d->hashnext)
+	{
+		if (d->name == token->name) return d;
+	} //end for
+	return NULL;
+} //end of the function PC_FindHashedTokenDefine
 #endif //DEFINEHASHING
 //============================================================================
 //
@@ -680,10 +710,9 @@ void PC_AddBuiltinDefines(source_t *source)
 
 	for (i = 0; builtin[i].string; i++)
 	{
-		define = (define_t *) GetMemory(sizeof(define_t) + strlen(builtin[i].string) + 1);
+		define = (define_t *) GetMemory(sizeof(define_t));
 		Com_Memset(define, 0, sizeof(define_t));
-		define->name = (char *) define + sizeof(define_t);
-		strcpy(define->name, builtin[i].string);
+		define->name = PS_InternName(builtin[i].string, PS_NameHash(builtin[i].string));
 		define->flags |= DEFINE_FIXED;
 		define->builtin = builtin[i].builtin;
 		//add the define to the source
@@ -709,6 +738,7 @@ int PC_ExpandBuiltinDefine(source_t *source, token_t *deftoken, define_t *define
 	char *curtime;
 
 	token = PC_CopyToken(deftoken);
+	token->name = NULL;
 	switch(define->builtin)
 	{
 		case BUILTIN_LINE:
@@ -1215,10 +1245,9 @@ int PC_Directive_define(source_t *source)
 #endif //DEFINEHASHING
 	} //end if
 	//allocate define
-	define = (define_t *) GetMemory(sizeof(define_t) + strlen(token.string) + 1);
+	define = (define_t *) GetMemory(sizeof(define_t));
 	Com_Memset(define, 0, sizeof(define_t));
-	define->name = (char *) define + sizeof(define_t);
-	strcpy(define->name, token.string);
+	define->name = PS_InternName(token.string, PS_NameHash(token.string));
 	//add the define to the source
 #if DEFINEHASHING
 	PC_AddDefineToHash(define, source->definehash);
@@ -1323,8 +1352,6 @@ define_t *PC_DefineFromString(char *string)
 	int res, i;
 	define_t *def;
 
-	PC_InitTokenHeap();
-
 	script = LoadScriptMemory(string, strlen(string), "*extern");
 	//create a new source
 	Com_Memset(&src, 0, sizeof(source_t));
@@ -1451,10 +1478,9 @@ define_t *PC_CopyDefine(source_t *source, define_t *define)
 	define_t *newdefine;
 	token_t *token, *newtoken, *lasttoken;
 
-	newdefine = (define_t *) GetMemory(sizeof(define_t) + strlen(define->name) + 1);
-	//copy the define name
-	newdefine->name = (char *) newdefine + sizeof(define_t);
-	strcpy(newdefine->name, define->name);
+	newdefine = (define_t *) GetMemory(sizeof(define_t));
+	//the define name is interned
+	newdefine->name = define->name;
 	newdefine->flags = define->flags;
 	newdefine->builtin = define->builtin;
 	newdefine->numparms = define->numparms;
@@ -2760,7 +2786,7 @@ int PC_ReadToken(source_t *source, token_t *token)
 		{
 			//check if the name is a define macro
 #if DEFINEHASHING
-			define = PC_FindHashedDefine(source->definehash, token->string);
+			define = PC_FindHashedTokenDefine(source->definehash, token);
 #else
 			define = PC_FindDefine(source->defines, token->string);
 #endif //DEFINEHASHING
@@ -2773,7 +2799,7 @@ int PC_ReadToken(source_t *source, token_t *token)
 			} //end if
 		} //end if
 		//copy token for unreading
-		Com_Memcpy(&source->token, token, sizeof(token_t));
+		PS_CopyToken(&source->token, token);
 		//found a token
 		return qtrue;
 	} //end while
@@ -2984,8 +3010,6 @@ source_t *LoadSourceFile(const char *filename)
 	source_t *source;
 	script_t *script;
 
-	PC_InitTokenHeap();
-
 	script = LoadScriptFile(filename);
 	if (!script) return NULL;
 
@@ -3018,8 +3042,6 @@ source_t *LoadSourceMemory(char *ptr, int length, char *name)
 	source_t *source;
 	script_t *script;
 
-	PC_InitTokenHeap();
-
 	script = LoadScriptMemory(ptr, length, name);
 	if (!script) return NULL;
 	script->next = NULL;
@@ -3226,3 +3248,92 @@ void PC_CheckOpenSourceHandles(void)
 	} //end for
 } //end of the function PC_CheckOpenSourceHandles
 
+#ifdef BOTLIB
+//============================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//============================================================================
+int PC_BenchmarkPass(char *filename, int fast, int passes)
+{
+	source_t *source;
+	token_t token;
+	int i, starttime, oldfast;
+
+	oldfast = PS_FastLexer();
+	PS_SetFastLexer(fast);
+	starttime = Sys_MilliSeconds();
+	for (i = 0; i < passes; i++)
+	{
+		source = LoadSourceFile(filename);
+		if (!source) break;
+		while(PC_ReadToken(source, &token));
+		FreeSource(source);
+	} //end for
+	PS_SetFastLexer(oldfast);
+	return Sys_MilliSeconds() - starttime;
+} //end of the function PC_BenchmarkPass
+//============================================================================
+// reads the file with both lexers side by side and compares the tokens
+//
+// Parameter:			-
+// Returns:				number of tokens read or -1 if the tokens differ
+// Changes Globals:		-
+//============================================================================
+int PC_BenchmarkCompare(char *filename)
+{
+	source_t *source1, *source2;
+	token_t token1, token2;
+	int r1, r2, numtokens, oldfast;
+
+	oldfast = PS_FastLexer();
+	source1 = LoadSourceFile(filename);
+	source2 = LoadSourceFile(filename);
+	numtokens = 0;
+	while(source1 && source2)
+	{
+		PS_SetFastLexer(qfalse);
+		r1 = PC_ReadToken(source1, &token1);
+		PS_SetFastLexer(qtrue);
+		r2 = PC_ReadToken(source2, &token2);
+		if (r1 != r2) numtokens = -1;
+		if (!r1 || !r2) break;
+		if (strcmp(token1.string, token2.string) ||
+			token1.type != token2.type || token1.subtype != token2.subtype ||
+			token1.intvalue != token2.intvalue || token1.floatvalue != token2.floatvalue ||
+			token1.line != token2.line || token1.linescrossed != token2.linescrossed)
+		{
+			SourceWarning(source2, "token %s differs from %s", token2.string, token1.string);
+			numtokens = -1;
+			break;
+		} //end if
+		numtokens++;
+	} //end while
+	PS_SetFastLexer(oldfast);
+	if (source1) FreeSource(source1);
+	if (source2) FreeSource(source2);
+	return numtokens;
+} //end of the function PC_BenchmarkCompare
+//============================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//============================================================================
+void PC_ParseBenchmark(char *filename, int passes)
+{
+	int numtokens, slowtime, fasttime;
+
+	numtokens = PC_BenchmarkCompare(filename);
+	if (numtokens < 0)
+	{
+		botimport.Print(PRT_ERROR, "%s: lexers produce different tokens\n", filename);
+		return;
+	} //end if
+	slowtime = PC_BenchmarkPass(filename, qfalse, passes);
+	fasttime = PC_BenchmarkPass(filename, qtrue, passes);
+	botimport.Print(PRT_MESSAGE, "%s: %d tokens identical, %d passes %d msec, table driven %d msec\n",
+								filename, numtokens, passes, slowtime, fasttime);
+} //end of the function PC_ParseBenchmark
+#endif //BOTLIB
@@ -137,6 +137,8 @@ int PC_AddGlobalDefine(char *string);
 int PC_RemoveGlobalDefine(char *name);
 //remove all globals defines
 void PC_RemoveAllGlobalDefines(void);
+//free the token pools and interned names
+void PC_FreeTokenHeap(void);
 //add builtin defines
 void PC_AddBuiltinDefines(source_t *source);
 //set the source include path
@@ -178,3 +180,5 @@ int PC_FreeSourceHandle(int handle);
 int PC_ReadTokenHandle(int handle, pc_token_t *pc_token);
 int PC_SourceFileAndLine(int handle, char *filename, int *line);
 void PC_CheckOpenSourceHandles(void);
+//compare the lexers and time them on the given file
+void PC_ParseBenchmark(char *filename, int passes);
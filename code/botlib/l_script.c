@@ -166,6 +166,157 @@ char basefolder[MAX_PATH];
 char basefolder[MAX_QPATH];
 #endif
 
+//character classes used by the table driven lexer
+#define CC_WHITESPACE			1
+#define CC_NAMESTART			2
+#define CC_NAME					4
+#define CC_DIGIT				8
+
+#define NAMEHASHSIZE			4096
+
+//interned name
+typedef struct internname_s
+{
+	int hash;						//hash value of the name
+	struct internname_s *next;		//next name with the same hash
+	char string[1];					//the name, variable sized
+} internname_t;
+
+//true when the table driven lexer is used
+int fastlexer = qtrue;
+//character class of every character
+int charclassesinitialized;
+unsigned char charclasses[256];
+//hash table with interned names
+internname_t *namehashtable[NAMEHASHSIZE];
+
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void PS_InitCharClasses(void)
+{
+	int i;
+	char c;
+
+	for (i = 0; i < 256; i++)
+	{
+		//same tests as the character by character lexer, char may be signed
+		c = (char) i;
+		charclasses[i] = 0;
+		if (c && c <= ' ') charclasses[i] |= CC_WHITESPACE;
+		if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_')
+		{
+			charclasses[i] |= CC_NAMESTART | CC_NAME;
+		} //end if
+		if (c >= '0' && c <= '9') charclasses[i] |= CC_DIGIT | CC_NAME;
+	} //end for
+	charclassesinitialized = qtrue;
+} //end of the function PS_InitCharClasses
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void PS_SetFastLexer(int fast)
+{
+	fastlexer = fast;
+} //end of the function PS_SetFastLexer
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+int PS_FastLexer(void)
+{
+	return fastlexer;
+} //end of the function PS_FastLexer
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+int PS_NameHash(char *name)
+{
+	int hash, i;
+
+	hash = 0;
+	for (i = 0; name[i] != '\0'; i++)
+	{
+		hash += name[i] * (119 + i);
+	} //end for
+	return hash ^ (hash >> 10) ^ (hash >> 20);
+} //end of the function PS_NameHash
+//===========================================================================
+// names are interned once and never change so they can be compared by
+// pointer, the hash should be the PS_NameHash of the name
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+char *PS_InternName(char *name, int hash)
+{
+	internname_t *n;
+	int index;
+
+	index = hash & (NAMEHASHSIZE-1);
+	for (n = namehashtable[index]; n; n = n->next)
+	{
+		if (n->hash == hash && !strcmp(n->string, name)) return n->string;
+	} //end for
+	n = (internname_t *) GetMemory(sizeof(internname_t) + strlen(name));
+	n->hash = hash;
+	strcpy(n->string, name);
+	n->next = namehashtable[index];
+	namehashtable[index] = n;
+	return n->string;
+} //end of the function PS_InternName
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void PS_FreeNames(void)
+{
+	internname_t *n, *nextn;
+	int i;
+
+	for (i = 0; i < NAMEHASHSIZE; i++)
+	{
+		for (n = namehashtable[i]; n; n = nextn)
+		{
+			nextn = n->next;
+			FreeMemory(n);
+		} //end for
+		namehashtable[i] = NULL;
+	} //end for
+} //end of the function PS_FreeNames
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
+void PS_CopyToken(token_t *dest, token_t *src)
+{
+	if (!fastlexer)
+	{
+		Com_Memcpy(dest, src, sizeof(token_t));
+		return;
+	} //end if
+	//the string is the first member of the token so everything
+	//from the type onwards can be copied in one go
+	strcpy(dest->string, src->string);
+	Com_Memcpy(&dest->type, &src->type, sizeof(token_t) - ((char *) &src->type - (char *) src));
+} //end of the function PS_CopyToken
+
 //===========================================================================
 //
 // Parameter:				-
@@ -282,6 +433,7 @@ void QDECL ScriptWarning(script_t *script, char *str, ...)
 //===========================================================================
 void SetScriptPunctuations(script_t *script, punctuation_t *p)
 {
+	if (!charclassesinitialized) PS_InitCharClasses();
 #ifdef PUNCTABLE
 	if (p) PS_CreatePunctuationTable(script, p);
 	else  PS_CreatePunctuationTable(script, default_punctuations);
@@ -349,6 +501,70 @@ int PS_ReadWhiteSpace(script_t *script)
 	return 1;
 } //end of the function PS_ReadWhiteSpace
 //============================================================================
+// same as PS_ReadWhiteSpace with the script pointer in a local
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//============================================================================
+int PS_ReadWhiteSpaceFast(script_t *script)
+{
+	char *p;
+	int line;
+
+	p = script->script_p;
+	line = script->line;
+	while(1)
+	{
+		//skip white space
+		while(charclasses[(unsigned char) *p] & CC_WHITESPACE)
+		{
+			if (*p == '\n') line++;
+			p++;
+		} //end while
+		if (!*p) break;
+		//skip comments
+		if (*p == '/')
+		{
+			//comments //
+			if (*(p+1) == '/')
+			{
+				p += 2;
+				while(*p && *p != '\n') p++;
+				if (!*p) break;
+				line++;
+				p++;
+				if (!*p) break;
+				continue;
+			} //end if
+			//comments /* */
+			else if (*(p+1) == '*')
+			{
+				p++;
+				do
+				{
+					p++;
+					if (!*p) break;
+					if (*p == '\n') line++;
+				} //end do
+				while(!(*p == '*' && *(p+1) == '/'));
+				if (!*p) break;
+				p++;
+				if (!*p) break;
+				p++;
+				if (!*p) break;
+				continue;
+			} //end if
+		} //end if
+		script->script_p = p;
+		script->line = line;
+		return 1;
+	} //end while
+	script->script_p = p;
+	script->line = line;
+	return 0;
+} //end of the function PS_ReadWhiteSpaceFast
+//============================================================================
 // Reads an escape character.
 //
 // Parameter:				script		: script to read from
@@ -548,6 +764,42 @@ int PS_ReadName(script_t *script, token_t *token)
 	return 1;
 } //end of the function PS_ReadName
 //============================================================================
+// reads a name with the character class table, the name is interned
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//============================================================================
+int PS_ReadNameFast(script_t *script, token_t *token)
+{
+	int len, hash;
+	char *p, c;
+
+	token->type = TT_NAME;
+	p = script->script_p;
+	len = 0;
+	hash = 0;
+	do
+	{
+		c = *p++;
+		hash += c * (119 + len);
+		token->string[len++] = c;
+		if (len >= MAX_TOKEN)
+		{
+			script->script_p = p;
+			ScriptError(script, "name longer than MAX_TOKEN = %d", MAX_TOKEN);
+			return 0;
+		} //end if
+	} while(charclasses[(unsigned char) *p] & CC_NAME);
+	script->script_p = p;
+	token->string[len] = '\0';
+	//the sub type is the length of the name
+	token->subtype = len;
+	token->namehash = hash ^ (hash >> 10) ^ (hash >> 20);
+	token->name = PS_InternName(token->string, token->namehash);
+	return 1;
+} //end of the function PS_ReadNameFast
+//============================================================================
 //
 // Parameter:				-
 // Returns:					-
@@ -842,6 +1094,124 @@ int PS_ReadPrimitive(script_t *script, token_t *token)
 	return 1;
 } //end of the function PS_ReadPrimitive
 //============================================================================
+// same as PS_ReadPunctuation without the string library calls
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//============================================================================
+int PS_ReadPunctuationFast(script_t *script, token_t *token)
+{
+	int len;
+	char *p;
+	punctuation_t *punc;
+
+	for (punc = script->punctuationtable[(unsigned int)*script->script_p]; punc; punc = punc->next)
+	{
+		p = punc->p;
+		for (len = 0; p[len] && script->script_p + len < script->end_p; len++)
+		{
+			if (script->script_p[len] != p[len]) break;
+		} //end for
+		//if the script contains the punctuation
+		if (!p[len])
+		{
+			Com_Memcpy(token->string, p, len + 1);
+			script->script_p += len;
+			token->type = TT_PUNCTUATION;
+			//sub type is the number of the punctuation
+			token->subtype = punc->n;
+			return 1;
+		} //end if
+	} //end for
+	return 0;
+} //end of the function PS_ReadPunctuationFast
+//============================================================================
+// same as PS_ReadToken but only clears the used part of the token and uses
+// the character class table to find out what kind of token follows
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//============================================================================
+int PS_ReadTokenFast(script_t *script, token_t *token)
+{
+	int c;
+
+	//if there is a token available (from UnreadToken)
+	if (script->tokenavailable)
+	{
+		script->tokenavailable = 0;
+		PS_CopyToken(token, &script->token);
+		return 1;
+	} //end if
+	//save script pointer
+	script->lastscript_p = script->script_p;
+	//save line counter
+	script->lastline = script->line;
+	//clear the token stuff
+	token->string[0] = '\0';
+	token->type = 0;
+	token->subtype = 0;
+#ifdef NUMBERVALUE
+	token->intvalue = 0;
+	token->floatvalue = 0;
+#endif //NUMBERVALUE
+	token->name = NULL;
+	token->namehash = 0;
+	token->next = NULL;
+	//start of the white space
+	script->whitespace_p = script->script_p;
+	token->whitespace_p = script->script_p;
+	//read unusefull stuff
+	if (!PS_ReadWhiteSpaceFast(script)) return 0;
+	//end of the white space
+	script->endwhitespace_p = script->script_p;
+	token->endwhitespace_p = script->script_p;
+	//line the token is on
+	token->line = script->line;
+	//number of lines crossed before token
+	token->linescrossed = script->line - script->lastline;
+	//
+	c = charclasses[(unsigned char) *script->script_p];
+	//if there is a leading double quote
+	if (*script->script_p == '\"')
+	{
+		if (!PS_ReadString(script, token, '\"')) return 0;
+	} //end if
+	//if an literal
+	else if (*script->script_p == '\'')
+	{
+		if (!PS_ReadString(script, token, '\'')) return 0;
+	} //end if
+	//if there is a number
+	else if ((c & CC_DIGIT) || (*script->script_p == '.' &&
+				(charclasses[(unsigned char) *(script->script_p + 1)] & CC_DIGIT)))
+	{
+		if (!PS_ReadNumber(script, token)) return 0;
+	} //end if
+	//if this is a primitive script
+	else if (script->flags & SCFL_PRIMITIVE)
+	{
+		return PS_ReadPrimitive(script, token);
+	} //end else if
+	//if there is a name
+	else if (c & CC_NAMESTART)
+	{
+		if (!PS_ReadNameFast(script, token)) return 0;
+	} //end if
+	//check for punctuations
+	else if (!PS_ReadPunctuationFast(script, token))
+	{
+		ScriptError(script, "can't read token");
+		return 0;
+	} //end if
+	//copy the token into the script structure
+	PS_CopyToken(&script->token, token);
+	//succesfully read a token
+	return 1;
+} //end of the function PS_ReadTokenFast
+//============================================================================
 //
 // Parameter:				-
 // Returns:					-
@@ -849,6 +1219,7 @@ int PS_ReadPrimitive(script_t *script, token_t *token)
 //============================================================================
 int PS_ReadToken(script_t *script, token_t *token)
 {
+	if (fastlexer) return PS_ReadTokenFast(script, token);
 	//if there is a token available (from UnreadToken)
 	if (script->tokenavailable)
 	{
@@ -1087,7 +1458,7 @@ void PS_UnreadLastToken(script_t *script)
 //============================================================================
 void PS_UnreadToken(script_t *script, token_t *token)
 {
-	Com_Memcpy(&script->token, token, sizeof(token_t));
+	PS_CopyToken(&script->token, token);
 	script->tokenavailable = 1;
 } //end of the function UnreadToken
 //============================================================================
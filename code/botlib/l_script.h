@@ -167,6 +167,8 @@ typedef struct token_s
 	char *endwhitespace_p;			//start of white space before token
 	int line;						//line the token was on
 	int linescrossed;				//lines crossed in white space
+	char *name;						//interned name of a TT_NAME token or NULL
+	int namehash;					//hash of the interned name
 	struct token_s *next;			//next token in chain
 } token_t;
 
@@ -239,6 +241,18 @@ script_t *LoadScriptMemory(char *ptr, int length, char *name);
 void FreeScript(script_t *script);
 //set the base folder to load files from
 void PS_SetBaseFolder(char *path);
+//copy a token, only copies the used part of the token string
+void PS_CopyToken(token_t *dest, token_t *src);
+//returns the hash value of a name
+int PS_NameHash(char *name);
+//returns the unique copy of the given name
+char *PS_InternName(char *name, int hash);
+//free all interned names
+void PS_FreeNames(void);
+//enable or disable the table driven lexer
+void PS_SetFastLexer(int fast);
+//returns true if the table driven lexer is enabled
+int PS_FastLexer(void);
 //print a script error with filename and line number
 void QDECL ScriptError(script_t *script, char *str, ...);
 //print a script warning with filename and line number
@@ -32,6 +32,7 @@ OBJS= be_aas_bspq2.obj \
 	be_ai_weight.obj \
 	be_ea.obj \
 	be_interface.obj \
+	l_cache.obj \
 	l_crc.obj \
 	l_libvar.obj \
 	l_log.obj \
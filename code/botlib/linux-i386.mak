@@ -58,6 +58,7 @@ GAME_OBJS = \
 	be_ai_weight.o\
 	be_ea.o\
 	be_interface.o\
+	l_cache.o\
 	l_crc.o\
 	l_libvar.o\
 	l_log.o\
@@ -345,6 +345,12 @@ void CG_RegisterCvars( void ) {
 	trap_Cvar_Register(NULL, "headmodel", DEFAULT_MODEL, CVAR_USERINFO | CVAR_ARCHIVE );
 	trap_Cvar_Register(NULL, "team_model", DEFAULT_TEAM_MODEL, CVAR_USERINFO | CVAR_ARCHIVE );
 	trap_Cvar_Register(NULL, "team_headmodel", DEFAULT_TEAM_HEAD, CVAR_USERINFO | CVAR_ARCHIVE );
+
+	// tells the server that "mcs" commands are handled, the client clears
+	// it again when this cgame is shut down, the server also needs
+	// cl_multiConfigstrings from the client, which rebuilds the gamestate
+	trap_Cvar_Register(NULL, "cg_multiConfigstrings", "1", CVAR_USERINFO | CVAR_ROM );
+	trap_Cvar_Set( "cg_multiConfigstrings", "1" );
 }
 
 /*																																			
@@ -1858,6 +1864,7 @@ Will perform callbacks to make the loading info screen update.
 */
 void CG_Init( int serverMessageNum, int serverCommandSequence, int clientNum ) {
 	const char	*s;
+	int			clientLimit;
 
 	// clear everything
 	memset( &cgs, 0, sizeof( cgs ) );
@@ -1902,6 +1909,16 @@ void CG_Init( int serverMessageNum, int serverCommandSequence, int clientNum ) {
 		CG_Error( "Client/Server game mismatch: %s/%s", GAME_VERSION, s );
 	}
 
+	// the configstrings after CS_PLAYERS move with MAX_CLIENTS, a server
+	// without sv_clientLimit is a stock 64 player one
+	clientLimit = atoi( Info_ValueForKey( CG_ConfigString( CS_SERVERINFO ), "sv_clientLimit" ) );
+	if ( !clientLimit ) {
+		clientLimit = 64;
+	}
+	if ( clientLimit != MAX_CLIENTS ) {
+		CG_Error( "Client/Server player limit mismatch: %i/%i", MAX_CLIENTS, clientLimit );
+	}
+
 	s = CG_ConfigString( CS_LEVEL_START_TIME );
 	cgs.levelStartTime = atoi( s );
 
@@ -263,17 +263,11 @@ void CG_ShaderStateChanged(void) {
 ================
 CG_ConfigStringModified
 
+cgs.gameState must already have the new string
 ================
 */
-static void CG_ConfigStringModified( void ) {
+static void CG_ConfigStringModified( int num ) {
 	const char	*str;
-	int		num;
-
-	num = atoi( CG_Argv( 1 ) );
-
-	// get the gamestate from the client system, which will have the
-	// new configstring already integrated
-	trap_GetGameState( &cgs.gameState );
 
 	// look up the individual string that was modified
 	str = CG_ConfigString( num );
@@ -978,6 +972,7 @@ Cmd_Argc() / Cmd_Argv()
 static void CG_ServerCommand( void ) {
 	const char	*cmd;
 	char		text[MAX_SAY_TEXT];
+	int			i;
 
 	cmd = CG_Argv(0);
 
@@ -992,7 +987,19 @@ static void CG_ServerCommand( void ) {
 	}
 
 	if ( !strcmp( cmd, "cs" ) ) {
-		CG_ConfigStringModified();
+		// get the gamestate from the client system, which will have the
+		// new configstring already integrated
+		trap_GetGameState( &cgs.gameState );
+		CG_ConfigStringModified( atoi( CG_Argv( 1 ) ) );
+		return;
+	}
+
+	// several configstrings that changed in the same server frame
+	if ( !strcmp( cmd, "mcs" ) ) {
+		trap_GetGameState( &cgs.gameState );
+		for ( i = 1 ; i + 1 < trap_Argc() ; i += 2 ) {
+			CG_ConfigStringModified( atoi( CG_Argv( i ) ) );
+		}
 		return;
 	}
 
@@ -5,6 +5,8 @@ set INCLUDE=
 mkdir vm
 cd vm
 set cc=lcc -DQ3_VM -DMISSIONPACK -DCGAME -S -Wf-target=bytecode -Wf-g -I..\..\cgame -I..\..\game -I..\..\ui %1
+rem set MAX_CLIENTS to 128 or 256 for a raised player limit, the engine has to match
+if not "%MAX_CLIENTS%"=="" set cc=%cc% -DMAX_CLIENTS=%MAX_CLIENTS%
 
 %cc% ../../game/bg_misc.c
 @if errorlevel 1 goto quit
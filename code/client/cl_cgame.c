@@ -195,6 +195,9 @@ void CL_CgameError( const char *string ) {
 /*
 =====================
 CL_ConfigstringModified
+
+Handles "cs <num> <string>" and "mcs <num> <string> <num> <string> ...",
+the gameState_t is only rebuilt once for all the strings
 =====================
 */
 void CL_ConfigstringModified( void ) {
@@ -203,17 +206,35 @@ void CL_ConfigstringModified( void ) {
 	char		*dup;
 	gameState_t	oldGs;
 	int			len;
+	char		*modified[MAX_CONFIGSTRINGS];
+	qboolean	changed;
+
+	Com_Memset( modified, 0, sizeof( modified ) );
+	changed = qfalse;
 
-	index = atoi( Cmd_Argv(1) );
-	if ( index < 0 || index >= MAX_CONFIGSTRINGS ) {
-		Com_Error( ERR_DROP, "configstring > MAX_CONFIGSTRINGS" );
+	for ( i = 1 ; i < Cmd_Argc() ; i += 2 ) {
+		index = atoi( Cmd_Argv(i) );
+		if ( index < 0 || index >= MAX_CONFIGSTRINGS ) {
+			Com_Error( ERR_DROP, "configstring > MAX_CONFIGSTRINGS" );
+		}
+		if ( !strcmp( Cmd_Argv(0), "cs" ) ) {
+			// get everything after "cs <num>"
+			s = Cmd_ArgsFrom(2);
+			i = Cmd_Argc();
+		} else {
+			s = Cmd_Argv(i + 1);
+		}
+
+		old = cl.gameState.stringData + cl.gameState.stringOffsets[ index ];
+		if ( !strcmp( old, s ) ) {
+			continue;		// unchanged
+		}
+		modified[ index ] = s;
+		changed = qtrue;
 	}
-	// get everything after "cs <num>"
-	s = Cmd_ArgsFrom(2);
 
-	old = cl.gameState.stringData + cl.gameState.stringOffsets[ index ];
-	if ( !strcmp( old, s ) ) {
-		return;		// unchanged
+	if ( !changed ) {
+		return;
 	}
 
 	// build the new gameState_t
@@ -225,8 +246,8 @@ void CL_ConfigstringModified( void ) {
 	cl.gameState.dataCount = 1;
 		
 	for ( i = 0 ; i < MAX_CONFIGSTRINGS ; i++ ) {
-		if ( i == index ) {
-			dup = s;
+		if ( modified[ i ] ) {
+			dup = modified[ i ];
 		} else {
 			dup = oldGs.stringData + oldGs.stringOffsets[ i ];
 		}
@@ -246,7 +267,7 @@ void CL_ConfigstringModified( void ) {
 		cl.gameState.dataCount += len + 1;
 	}
 
-	if ( index == CS_SYSTEMINFO ) {
+	if ( modified[ CS_SYSTEMINFO ] ) {
 		// parse serverId and other cvars
 		CL_SystemInfoChanged();
 	}
@@ -326,7 +347,7 @@ rescan:
 		goto rescan;
 	}
 
-	if ( !strcmp( cmd, "cs" ) ) {
+	if ( !strcmp( cmd, "cs" ) || !strcmp( cmd, "mcs" ) ) {
 		CL_ConfigstringModified();
 		// reparse the string, because CL_ConfigstringModified may have done another Cmd_TokenizeString()
 		Cmd_TokenizeString( s );
@@ -392,6 +413,10 @@ void CL_ShutdownCGame( void ) {
 	if ( !cgvm ) {
 		return;
 	}
+	// the next cgame may not understand "mcs", it sets this again if it does
+	if ( Cvar_VariableIntegerValue( "cg_multiConfigstrings" ) ) {
+		Cvar_Set( "cg_multiConfigstrings", "0" );
+	}
 	VM_Call( cgvm, CG_SHUTDOWN );
 	VM_Free( cgvm );
 	cgvm = NULL;
@@ -0,0 +1,501 @@
+/*
+===========================================================================
+Copyright (C) 1999-2005 Id Software, Inc.
+
+This file is part of Quake III Arena source code.
+
+Quake III Arena source code is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the License,
+or (at your option) any later version.
+
+Quake III Arena source code is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Foobar; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+===========================================================================
+*/
+// cl_http.c -- http transport for redirected downloads
+
+/*
+Servers that set sv_dlURL let clients fetch missing files from a plain
+web server instead of the game connection.  The first request asks for
+the first chunk of the file with a Range header.  If the web server
+answers with 206 Partial Content, the total size is known and the rest
+of the file is fetched in chunks over up to cl_httpConnections parallel
+connections, each chunk written at its own offset.  If it answers with
+200 and a Content-Length the whole file is streamed over that one
+connection.  A body of unknown length can't be told apart from a
+truncated one, so those are turned down like any other failure.
+
+Any failure is reported to the caller, which falls back to the in-band
+download from the game server.
+*/
+
+#include "../game/q_shared.h"
+#include "../qcommon/qcommon.h"
+#include "client.h"
+
+#define	HTTP_MAX_CONNECTIONS	8
+#define	HTTP_CHUNK_SIZE			(256*1024)
+#define	HTTP_MAX_HEADER			4096
+#define	HTTP_MAX_RECV			(256*1024)	// per connection per frame
+#define	HTTP_TIMEOUT			10000		// msec without any traffic
+
+typedef enum {
+	HC_FREE,
+	HC_REQUEST,		// connecting and sending the request
+	HC_HEADER,		// reading the response header
+	HC_BODY			// reading the file data
+} httpState_t;
+
+typedef struct {
+	httpState_t	state;
+	int			sock;
+	int			start, end;		// requested byte range, end is inclusive
+	int			offset;			// file offset of the next byte received
+	char		request[MAX_STRING_CHARS];
+	int			requestLength;
+	int			requestSent;
+	char		header[HTTP_MAX_HEADER];
+	int			headerLength;
+	int			lastActivity;
+} httpConnection_t;
+
+typedef struct {
+	qboolean		active;
+	netadr_t		adr;
+	char			host[MAX_OSPATH];
+	char			path[MAX_OSPATH*2];
+	fileHandle_t	f;
+	int				size;			// -1 until known
+	int				count;
+	int				nextOffset;		// first byte no connection has asked for yet
+	qboolean		ranges;			// web server honours Range requests
+	httpConnection_t	connections[HTTP_MAX_CONNECTIONS];
+} httpDownload_t;
+
+static httpDownload_t	http;
+
+/*
+=================
+HTTP_ParseURL
+
+Splits http://host[:port]/path, the port defaults to 80
+=================
+*/
+static qboolean HTTP_ParseURL( const char *url ) {
+	const char	*s, *path;
+	char		address[MAX_OSPATH];
+	int			len;
+
+	if ( Q_stricmpn( url, "http://", 7 ) ) {
+		return qfalse;
+	}
+	s = url + 7;
+
+	path = strchr( s, '/' );
+	if ( !path ) {
+		path = s + strlen( s );
+	}
+	len = path - s;
+	if ( !len || len >= sizeof( http.host ) ) {
+		return qfalse;
+	}
+	Com_Memcpy( http.host, s, len );
+	http.host[len] = 0;
+
+	if ( *path ) {
+		Q_strncpyz( http.path, path, sizeof( http.path ) );
+	} else {
+		Q_strncpyz( http.path, "/", sizeof( http.path ) );
+	}
+
+	if ( strchr( http.host, ':' ) ) {
+		Q_strncpyz( address, http.host, sizeof( address ) );
+	} else {
+		Com_sprintf( address, sizeof( address ), "%s:80", http.host );
+	}
+	if ( !NET_StringToAdr( address, &http.adr ) || http.adr.type != NA_IP ) {
+		Com_Printf( "HTTP download: couldn't resolve %s\n", http.host );
+		return qfalse;
+	}
+	return qtrue;
+}
+
+/*
+=================
+HTTP_OpenConnection
+
+Starts fetching bytes start through end
+=================
+*/
+static qboolean HTTP_OpenConnection( httpConnection_t *conn, int start, int end ) {
+	conn->sock = Sys_TCPConnect( http.adr );
+	if ( conn->sock == -1 ) {
+		return qfalse;
+	}
+
+	conn->state = HC_REQUEST;
+	conn->start = start;
+	conn->end = end;
+	conn->offset = start;
+	Com_sprintf( conn->request, sizeof( conn->request ),
+		"GET %s HTTP/1.0\r\n"
+		"Host: %s\r\n"
+		"User-Agent: " Q3_VERSION "\r\n"
+		"Range: bytes=%i-%i\r\n"
+		"Connection: close\r\n"
+		"\r\n", http.path, http.host, start, end );
+	conn->requestLength = strlen( conn->request );
+	conn->requestSent = 0;
+	conn->headerLength = 0;
+	conn->lastActivity = cls.realtime;
+	return qtrue;
+}
+
+/*
+=================
+HTTP_CloseConnection
+=================
+*/
+static void HTTP_CloseConnection( httpConnection_t *conn ) {
+	if ( conn->state != HC_FREE ) {
+		Sys_TCPClose( conn->sock );
+		conn->state = HC_FREE;
+	}
+}
+
+/*
+=================
+HTTP_HeaderValue
+
+Returns the value of a header line, or NULL if it isn't present
+=================
+*/
+static const char *HTTP_HeaderValue( const char *header, const char *name ) {
+	const char	*s;
+	int			len;
+
+	len = strlen( name );
+	for ( s = strchr( header, '\n' ) ; s ; s = strchr( s, '\n' ) ) {
+		s++;
+		if ( !Q_stricmpn( s, name, len ) && s[len] == ':' ) {
+			s += len + 1;
+			while ( *s == ' ' || *s == '\t' ) {
+				s++;
+			}
+			return s;
+		}
+	}
+	return NULL;
+}
+
+/*
+=================
+HTTP_ParseHeader
+
+Checks the status of a complete response header against what
+the connection asked for
+=================
+*/
+static qboolean HTTP_ParseHeader( httpConnection_t *conn ) {
+	const char	*s;
+	int			status, start, end, total;
+
+	if ( Q_stricmpn( conn->header, "HTTP/", 5 ) || !( s = strchr( conn->header, ' ' ) ) ) {
+		Com_Printf( "HTTP download: bad response\n" );
+		return qfalse;
+	}
+	status = atoi( s + 1 );
+
+	// HTTP/1.0 requests shouldn't get one, but the framing would end up in the file
+	s = HTTP_HeaderValue( conn->header, "Transfer-Encoding" );
+	if ( s && Q_stricmpn( s, "identity", 8 ) ) {
+		Com_Printf( "HTTP download: unsupported Transfer-Encoding\n" );
+		return qfalse;
+	}
+
+	if ( status == 206 ) {
+		s = HTTP_HeaderValue( conn->header, "Content-Range" );
+		if ( !s || sscanf( s, "bytes %i-%i/%i", &start, &end, &total ) != 3
+			|| start != conn->start || end < start || total <= end ) {
+			Com_Printf( "HTTP download: bad Content-Range\n" );
+			return qfalse;
+		}
+		if ( http.size == -1 ) {
+			// the first chunk tells us how much is left to spread out
+			http.size = total;
+			http.ranges = qtrue;
+			http.nextOffset = end + 1;
+		} else if ( total != http.size ) {
+			Com_Printf( "HTTP download: file changed on the server\n" );
+			return qfalse;
+		}
+		conn->end = end;
+		return qtrue;
+	}
+
+	if ( status == 200 && http.size == -1 ) {
+		// no range support, the whole file comes on this connection
+		s = HTTP_HeaderValue( conn->header, "Content-Length" );
+		if ( !s || atoi( s ) <= 0 ) {
+			Com_Printf( "HTTP download: no Content-Length\n" );
+			return qfalse;
+		}
+		http.size = atoi( s );
+		conn->end = http.size - 1;
+		http.nextOffset = http.size;
+		return qtrue;
+	}
+
+	Com_Printf( "HTTP download: server returned %i\n", status );
+	return qfalse;
+}
+
+/*
+=================
+HTTP_WriteData
+=================
+*/
+static qboolean HTTP_WriteData( httpConnection_t *conn, const byte *data, int length ) {
+	if ( conn->offset + length > conn->end + 1 ) {
+		Com_Printf( "HTTP download: server sent too much data\n" );
+		return qfalse;
+	}
+	if ( !length ) {
+		return qtrue;
+	}
+	FS_Seek( http.f, conn->offset, FS_SEEK_SET );
+	if ( FS_Write( data, length, http.f ) != length ) {
+		Com_Printf( "HTTP download: write failed\n" );
+		return qfalse;
+	}
+	conn->offset += length;
+	http.count += length;
+	return qtrue;
+}
+
+/*
+=================
+HTTP_ReadHeader
+
+Moves received bytes into the header buffer until the blank line,
+anything past it is the start of the body
+=================
+*/
+static qboolean HTTP_ReadHeader( httpConnection_t *conn, const byte *data, int length ) {
+	char	*end;
+	int		len, used;
+
+	len = sizeof( conn->header ) - 1 - conn->headerLength;
+	if ( len > length ) {
+		len = length;
+	}
+	Com_Memcpy( conn->header + conn->headerLength, data, len );
+	conn->headerLength += len;
+	conn->header[conn->headerLength] = 0;
+
+	end = strstr( conn->header, "\r\n\r\n" );
+	if ( !end ) {
+		if ( conn->headerLength == sizeof( conn->header ) - 1 ) {
+			Com_Printf( "HTTP download: response header too long\n" );
+			return qfalse;
+		}
+		return qtrue;
+	}
+
+	// work out how much of this read was header before cutting it off
+	used = ( end + 4 - conn->header ) - ( conn->headerLength - len );
+	end[2] = 0;
+
+	if ( !HTTP_ParseHeader( conn ) ) {
+		return qfalse;
+	}
+	conn->state = HC_BODY;
+	return HTTP_WriteData( conn, data + used, length - used );
+}
+
+/*
+=================
+HTTP_ConnectionFrame
+
+Returns qfalse if the download has to be abandoned
+=================
+*/
+static qboolean HTTP_ConnectionFrame( httpConnection_t *conn ) {
+	byte	buf[16384];
+	int		ret, total;
+
+	if ( conn->state == HC_REQUEST ) {
+		ret = Sys_TCPSend( conn->sock, conn->request + conn->requestSent,
+			conn->requestLength - conn->requestSent );
+		if ( ret == -1 ) {
+			Com_Printf( "HTTP download: couldn't connect to %s\n", http.host );
+			return qfalse;
+		}
+		if ( ret ) {
+			conn->lastActivity = cls.realtime;
+			conn->requestSent += ret;
+			if ( conn->requestSent == conn->requestLength ) {
+				conn->state = HC_HEADER;
+			}
+		}
+	}
+
+	total = 0;
+	while ( ( conn->state == HC_HEADER || conn->state == HC_BODY ) && total < HTTP_MAX_RECV ) {
+		ret = Sys_TCPRecv( conn->sock, buf, sizeof( buf ) );
+		if ( !ret ) {
+			break;
+		}
+		if ( ret == TCP_CLOSED ) {
+			Com_Printf( "HTTP download: connection closed early\n" );
+			return qfalse;
+		}
+		if ( ret < 0 ) {
+			Com_Printf( "HTTP download: connection to %s lost\n", http.host );
+			return qfalse;
+		}
+
+		conn->lastActivity = cls.realtime;
+		total += ret;
+
+		if ( conn->state == HC_HEADER ) {
+			if ( !HTTP_ReadHeader( conn, buf, ret ) ) {
+				return qfalse;
+			}
+		} else if ( !HTTP_WriteData( conn, buf, ret ) ) {
+			return qfalse;
+		}
+
+		if ( conn->state == HC_BODY && conn->offset > conn->end ) {
+			HTTP_CloseConnection( conn );
+			return qtrue;
+		}
+	}
+
+	if ( conn->state != HC_FREE && cls.realtime - conn->lastActivity > HTTP_TIMEOUT ) {
+		Com_Printf( "HTTP download: %s timed out\n", http.host );
+		return qfalse;
+	}
+	return qtrue;
+}
+
+/*
+=================
+HTTP_Abort
+=================
+*/
+static void HTTP_Abort( void ) {
+	int		i;
+
+	for ( i = 0 ; i < HTTP_MAX_CONNECTIONS ; i++ ) {
+		HTTP_CloseConnection( &http.connections[i] );
+	}
+	http.active = qfalse;
+}
+
+/*
+=================
+HTTP_Begin
+=================
+*/
+static qboolean HTTP_Begin( const char *url, fileHandle_t f ) {
+	if ( http.active ) {
+		HTTP_Abort();
+	}
+	Com_Memset( &http, 0, sizeof( http ) );
+
+	if ( !HTTP_ParseURL( url ) ) {
+		return qfalse;
+	}
+
+	http.f = f;
+	http.size = -1;
+	if ( !HTTP_OpenConnection( &http.connections[0], 0, HTTP_CHUNK_SIZE - 1 ) ) {
+		return qfalse;
+	}
+	http.active = qtrue;
+
+	Com_Printf( "HTTP download: %s\n", url );
+	return qtrue;
+}
+
+/*
+=================
+HTTP_Frame
+
+Runs all the connections and hands out the remaining chunks
+=================
+*/
+static downloadStatus_t HTTP_Frame( int *count, int *size ) {
+	httpConnection_t	*conn;
+	int					i, maxConnections, end;
+	qboolean			running;
+
+	if ( !http.active ) {
+		return DL_FAILED;
+	}
+
+	maxConnections = cl_httpConnections->integer;
+	if ( maxConnections < 1 ) {
+		maxConnections = 1;
+	} else if ( maxConnections > HTTP_MAX_CONNECTIONS ) {
+		maxConnections = HTTP_MAX_CONNECTIONS;
+	}
+
+	running = qfalse;
+	for ( i = 0 ; i < HTTP_MAX_CONNECTIONS ; i++ ) {
+		conn = &http.connections[i];
+
+		if ( conn->state == HC_FREE && http.ranges && i < maxConnections
+			&& http.nextOffset < http.size ) {
+			end = http.nextOffset + HTTP_CHUNK_SIZE;
+			if ( end > http.size ) {
+				end = http.size;
+			}
+			if ( !HTTP_OpenConnection( conn, http.nextOffset, end - 1 ) ) {
+				HTTP_Abort();
+				return DL_FAILED;
+			}
+			http.nextOffset = end;
+		}
+
+		if ( conn->state == HC_FREE ) {
+			continue;
+		}
+		if ( !HTTP_ConnectionFrame( conn ) ) {
+			HTTP_Abort();
+			return DL_FAILED;
+		}
+		if ( conn->state != HC_FREE ) {
+			running = qtrue;
+		}
+	}
+
+	*count = http.count;
+	*size = http.size;
+
+	if ( running || http.nextOffset < http.size ) {
+		return DL_RUNNING;
+	}
+
+	http.active = qfalse;
+	if ( http.count != http.size ) {
+		Com_Printf( "HTTP download: got %i of %i bytes\n", http.count, http.size );
+		return DL_FAILED;
+	}
+	return DL_DONE;
+}
+
+downloadTransport_t	cl_httpTransport = {
+	"http://",
+	HTTP_Begin,
+	HTTP_Frame,
+	HTTP_Abort
+};
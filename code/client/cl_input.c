@@ -718,6 +718,9 @@ void CL_WritePacket( void ) {
 	// write the last reliable message we received
 	MSG_WriteLong( &buf, clc.serverCommandSequence );
 
+	// tell the server which download blocks arrived since the last packet
+	CL_AddDownloadAck();
+
 	// write any unacknowledged clientCommands
 	for ( i = clc.reliableAcknowledge + 1 ; i <= clc.reliableSequence ; i++ ) {
 		MSG_WriteByte( &buf, clc_clientCommand );
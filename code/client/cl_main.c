@@ -63,6 +63,9 @@ cvar_t	*cl_activeAction;
 cvar_t	*cl_motdString;
 
 cvar_t	*cl_allowDownload;
+cvar_t	*cl_httpDownload;
+cvar_t	*cl_httpConnections;
+cvar_t	*cl_downloadWindow;
 cvar_t	*cl_conXOffset;
 cvar_t	*cl_inGameVideo;
 
@@ -732,10 +735,15 @@ void CL_Disconnect( qboolean showMainMenu ) {
 		CL_StopRecord_f ();
 	}
 
+	if ( clc.downloadTransport ) {
+		clc.downloadTransport->Abort();
+		clc.downloadTransport = NULL;
+	}
 	if (clc.download) {
 		FS_FCloseFile( clc.download );
 		clc.download = 0;
 	}
+	CL_ClearDownloadWindow();
 	*clc.downloadTempName = *clc.downloadName = 0;
 	Cvar_Set( "cl_downloadName", "" );
 
@@ -1366,6 +1374,153 @@ void CL_DownloadsComplete( void ) {
 	CL_WritePacket();
 }
 
+/*
+=================
+CL_RequestDownload
+
+Asks the server for the file, servers that don't know about the
+sliding window ignore the extra arguments
+=================
+*/
+static void CL_RequestDownload( const char *remoteName ) {
+	clc.downloadBlock = 0;
+	clc.downloadCount = 0;
+
+	CL_ClearDownloadWindow();
+	if ( cl_downloadWindow->integer ) {
+		clc.downloadWindowed = qtrue;
+		clc.downloadNumber++;
+		CL_AddReliableCommand( va("download %s %i %i", remoteName, DOWNLOAD_WINDOW_VERSION, clc.downloadNumber) );
+	} else {
+		CL_AddReliableCommand( va("download %s", remoteName) );
+	}
+}
+
+static downloadTransport_t	*cl_downloadTransports[] = {
+	&cl_httpTransport,
+	NULL
+};
+
+/*
+=================
+CL_BeginRedirectedDownload
+
+If the server points at a web server with sv_dlURL, fetches the file
+from there instead of tying up the game connection
+=================
+*/
+static qboolean CL_BeginRedirectedDownload( const char *remoteName ) {
+	downloadTransport_t	*transport;
+	char				base[MAX_STRING_CHARS];
+	char				url[MAX_STRING_CHARS];
+	const char			*s;
+	int					i, len;
+
+	if ( !cl_httpDownload->integer ) {
+		return qfalse;
+	}
+
+	Q_strncpyz( base, Info_ValueForKey( cl.gameState.stringData
+		+ cl.gameState.stringOffsets[ CS_SERVERINFO ], "sv_dlURL" ), sizeof( base ) );
+	if ( !base[0] ) {
+		return qfalse;
+	}
+
+	transport = NULL;
+	for ( i = 0 ; cl_downloadTransports[i] ; i++ ) {
+		s = cl_downloadTransports[i]->scheme;
+		if ( !Q_stricmpn( base, s, strlen( s ) ) ) {
+			transport = cl_downloadTransports[i];
+			break;
+		}
+	}
+	if ( !transport ) {
+		Com_Printf( "Can't download from %s\n", base );
+		return qfalse;
+	}
+
+	// base url, a single slash, then the escaped file name
+	len = strlen( base );
+	while ( len > 0 && base[len-1] == '/' ) {
+		base[--len] = 0;
+	}
+	Com_sprintf( url, sizeof( url ), "%s/", base );
+	len = strlen( url );
+	for ( s = remoteName ; *s && len < sizeof( url ) - 4 ; s++ ) {
+		if ( ( *s >= 'a' && *s <= 'z' ) || ( *s >= 'A' && *s <= 'Z' ) || ( *s >= '0' && *s <= '9' )
+			|| *s == '/' || *s == '.' || *s == '-' || *s == '_' ) {
+			url[len++] = *s;
+		} else {
+			Com_sprintf( url + len, sizeof( url ) - len, "%%%02X", *s & 255 );
+			len += 3;
+		}
+	}
+	url[len] = 0;
+
+	clc.download = FS_SV_FOpenFileWrite( clc.downloadTempName );
+	if ( !clc.download ) {
+		return qfalse;
+	}
+	if ( !transport->Begin( url, clc.download ) ) {
+		FS_FCloseFile( clc.download );
+		clc.download = 0;
+		return qfalse;
+	}
+
+	clc.downloadTransport = transport;
+	return qtrue;
+}
+
+/*
+=================
+CL_DownloadFrame
+
+Runs a redirected download, falling back to the server if it fails
+=================
+*/
+void CL_DownloadFrame( void ) {
+	downloadStatus_t	status;
+	char				remoteName[MAX_OSPATH];
+	int					count, size;
+
+	if ( !clc.downloadTransport ) {
+		return;
+	}
+
+	status = clc.downloadTransport->Frame( &count, &size );
+	if ( status == DL_RUNNING ) {
+		if ( size > 0 && size != clc.downloadSize ) {
+			clc.downloadSize = size;
+			Cvar_SetValue( "cl_downloadSize", size );
+		}
+		if ( count != clc.downloadCount ) {
+			clc.downloadCount = count;
+			Cvar_SetValue( "cl_downloadCount", count );
+		}
+		return;
+	}
+
+	clc.downloadTransport = NULL;
+	FS_FCloseFile( clc.download );
+	clc.download = 0;
+
+	if ( status == DL_DONE ) {
+		FS_SV_Rename( clc.downloadTempName, clc.downloadName );
+		*clc.downloadTempName = *clc.downloadName = 0;
+		Cvar_Set( "cl_downloadName", "" );
+
+		CL_NextDownload();
+		return;
+	}
+
+	// the in-band download reopens the temp file from the start
+	Q_strncpyz( remoteName, Cvar_VariableString( "cl_downloadName" ), sizeof( remoteName ) );
+	Com_Printf( "Redirected download failed, downloading %s from the server\n", remoteName );
+
+	Cvar_Set( "cl_downloadCount", "0" );
+	CL_RequestDownload( remoteName );
+}
+
 /*
 =================
 CL_BeginDownload
@@ -1393,7 +1548,11 @@ void CL_BeginDownload( const char *localName, const char *remoteName ) {
 	clc.downloadBlock = 0; // Starting new file
 	clc.downloadCount = 0;
 
-	CL_AddReliableCommand( va("download %s", remoteName) );
+	if ( CL_BeginRedirectedDownload( remoteName ) ) {
+		return;
+	}
+
+	CL_RequestDownload( remoteName );
 }
 
 /*
@@ -2043,6 +2202,9 @@ void CL_Frame ( int msec ) {
 	// drop the connection
 	CL_CheckTimeout();
 
+	// run any download that was redirected away from the server
+	CL_DownloadFrame();
+
 	// send intentions now
 	CL_SendCmd();
 
@@ -2312,6 +2474,9 @@ void CL_Init( void ) {
 	cl_showMouseRate = Cvar_Get ("cl_showmouserate", "0", 0);
 
 	cl_allowDownload = Cvar_Get ("cl_allowDownload", "0", CVAR_ARCHIVE);
+	cl_httpDownload = Cvar_Get ("cl_httpDownload", "1", CVAR_ARCHIVE);
+	cl_httpConnections = Cvar_Get ("cl_httpConnections", "4", CVAR_ARCHIVE);
+	cl_downloadWindow = Cvar_Get ("cl_downloadWindow", "1", CVAR_ARCHIVE);
 
 	cl_conXOffset = Cvar_Get ("cl_conXOffset", "0", 0);
 #ifdef MACOS_X
@@ -2363,6 +2528,10 @@ void CL_Init( void ) {
 	Cvar_Get ("password", "", CVAR_USERINFO);
 	Cvar_Get ("cg_predictItems", "1", CVAR_USERINFO | CVAR_ARCHIVE );
 
+	// CL_ConfigstringModified parses "mcs", the server only sends it
+	// when the cgame handles it as well
+	Cvar_Get ("cl_multiConfigstrings", "1", CVAR_USERINFO | CVAR_ROM );
+
 
 	// cgame might not be initialized before menu is used
 	Cvar_Get ("cg_viewsize", "100", CVAR_ARCHIVE );
@@ -32,7 +32,9 @@ char *svc_strings[256] = {
 	"svc_baseline",	
 	"svc_serverCommand",
 	"svc_download",
-	"svc_snapshot"
+	"svc_snapshot",
+	"svc_EOF",
+	"svc_downloadBlock"
 };
 
 void SHOWNET( msg_t *msg, char *s) {
@@ -463,6 +465,22 @@ void CL_ParseGamestate( msg_t *msg ) {
 
 //=====================================================================
 
+/*
+=====================
+CL_PrintDownloadTime
+=====================
+*/
+static void CL_PrintDownloadTime( void ) {
+	int		msec;
+
+	msec = cls.realtime - Cvar_VariableIntegerValue( "cl_downloadTime" );
+	if ( msec < 1 ) {
+		msec = 1;
+	}
+	Com_Printf( "%s: %i bytes in %i msec, %i KB/s\n", Cvar_VariableString( "cl_downloadName" ),
+		clc.downloadCount, msec, (int)( clc.downloadCount * 1000.0f / 1024 / msec ) );
+}
+
 /*
 =====================
 CL_ParseDownload
@@ -539,6 +557,7 @@ void CL_ParseDownload ( msg_t *msg ) {
 			// rename the file
 			FS_SV_Rename ( clc.downloadTempName, clc.downloadName );
 		}
+		CL_PrintDownloadTime();
 		*clc.downloadTempName = *clc.downloadName = 0;
 		Cvar_Set( "cl_downloadName", "" );
 
@@ -555,6 +574,164 @@ void CL_ParseDownload ( msg_t *msg ) {
 	}
 }
 
+/*
+=====================
+CL_ClearDownloadWindow
+=====================
+*/
+void CL_ClearDownloadWindow( void ) {
+	if ( clc.downloadReceived ) {
+		Z_Free( clc.downloadReceived );
+		clc.downloadReceived = NULL;
+	}
+	clc.downloadWindowed = qfalse;
+	clc.downloadNumBlocks = 0;
+	clc.downloadAckBlock = 0;
+	clc.downloadHighBlock = 0;
+	clc.downloadAckPending = qfalse;
+}
+
+/*
+=====================
+CL_AddDownloadAck
+
+Called by CL_WritePacket, so there is at most one dlack per packet.
+The hex digits flag the blocks received after the first missing one.
+=====================
+*/
+void CL_AddDownloadAck( void ) {
+	char	hex[MAX_DOWNLOAD_WINDOW_BLOCKS / 4 + 1];
+	int		i, j, bits, block, len;
+
+	if ( !clc.downloadAckPending ) {
+		return;
+	}
+
+	// on a very long round trip the acks could use up all the reliable
+	// commands, a later one covers everything anyway
+	if ( clc.downloadAckBlock < clc.downloadNumBlocks
+		&& clc.reliableSequence - clc.reliableAcknowledge >= MAX_RELIABLE_COMMANDS / 2 ) {
+		return;
+	}
+	clc.downloadAckPending = qfalse;
+
+	len = 0;
+	for ( i = 0 ; i < MAX_DOWNLOAD_WINDOW_BLOCKS / 4 ; i++ ) {
+		bits = 0;
+		for ( j = 0 ; j < 4 ; j++ ) {
+			block = clc.downloadAckBlock + 1 + i * 4 + j;
+			if ( block < clc.downloadHighBlock && ( clc.downloadReceived[block >> 3] & ( 1 << ( block & 7 ) ) ) ) {
+				bits |= 1 << j;
+			}
+		}
+		hex[i] = "0123456789abcdef"[bits];
+		if ( bits ) {
+			len = i + 1;
+		}
+	}
+	hex[len] = 0;
+
+	CL_AddReliableCommand( va( "dlack %i %s", clc.downloadAckBlock, hex ) );
+}
+
+/*
+=====================
+CL_ParseDownloadBlock
+
+A block of a sliding window download, they can come in any order
+and are written straight from the message to their place in the file
+=====================
+*/
+void CL_ParseDownloadBlock( msg_t *msg ) {
+	byte	*data;
+	int		number, block, size, length, numBlocks;
+
+	number = MSG_ReadLong( msg );
+	block = MSG_ReadLong( msg );
+	size = MSG_ReadLong( msg );
+	length = MSG_ReadShort( msg );
+	data = MSG_ReadAligned( msg, length );
+	if ( !data ) {
+		return;		// CL_ParseServerMessage will catch the overrun
+	}
+
+	// blocks still in flight for an earlier download
+	if ( !clc.downloadWindowed || !*clc.downloadTempName || number != clc.downloadNumber ) {
+		return;
+	}
+
+	numBlocks = size / DOWNLOAD_WINDOW_BLKSIZE + 1;
+	if ( size < 0 || block < 0 || block >= numBlocks
+		|| length != ( block == numBlocks - 1 ? size % DOWNLOAD_WINDOW_BLKSIZE : DOWNLOAD_WINDOW_BLKSIZE )
+		|| ( clc.downloadReceived && numBlocks != clc.downloadNumBlocks ) ) {
+		Com_DPrintf( "CL_ParseDownloadBlock: bad block %d\n", block );
+		return;
+	}
+
+	// the first block to arrive, whichever it is
+	if ( !clc.downloadReceived ) {
+		if ( !clc.download ) {
+			clc.download = FS_SV_FOpenFileWrite( clc.downloadTempName );
+			if ( !clc.download ) {
+				Com_Printf( "Could not create %s\n", clc.downloadTempName );
+				CL_AddReliableCommand( "stopdl" );
+				CL_ClearDownloadWindow();
+				CL_NextDownload();
+				return;
+			}
+		}
+		clc.downloadNumBlocks = numBlocks;
+		clc.downloadReceived = Z_Malloc( ( numBlocks + 7 ) / 8 );
+
+		clc.downloadSize = size;
+		Cvar_SetValue( "cl_downloadSize", clc.downloadSize );
+	}
+
+	if ( clc.downloadReceived[block >> 3] & ( 1 << ( block & 7 ) ) ) {
+		return;		// resent before our ack got there
+	}
+	clc.downloadReceived[block >> 3] |= 1 << ( block & 7 );
+
+	if ( length ) {
+		FS_Seek( clc.download, block * DOWNLOAD_WINDOW_BLKSIZE, FS_SEEK_SET );
+		FS_Write( data, length, clc.download );
+	}
+
+	clc.downloadCount += length;
+	Cvar_SetValue( "cl_downloadCount", clc.downloadCount );
+
+	while ( clc.downloadAckBlock < numBlocks
+		&& ( clc.downloadReceived[clc.downloadAckBlock >> 3] & ( 1 << ( clc.downloadAckBlock & 7 ) ) ) ) {
+		clc.downloadAckBlock++;
+	}
+	if ( block >= clc.downloadHighBlock ) {
+		clc.downloadHighBlock = block + 1;
+	}
+	clc.downloadAckPending = qtrue;
+
+	if ( clc.downloadAckBlock < numBlocks ) {
+		return;
+	}
+
+	// let the server know right away that it can stop
+	CL_AddDownloadAck();
+
+	FS_FCloseFile( clc.download );
+	clc.download = 0;
+	FS_SV_Rename( clc.downloadTempName, clc.downloadName );
+
+	CL_PrintDownloadTime();
+	CL_ClearDownloadWindow();
+	*clc.downloadTempName = *clc.downloadName = 0;
+	Cvar_Set( "cl_downloadName", "" );
+
+	CL_WritePacket();
+	CL_WritePacket();
+
+	// get another file if needed
+	CL_NextDownload();
+}
+
 /*
 =====================
 CL_ParseCommandString
@@ -648,6 +825,9 @@ void CL_ParseServerMessage( msg_t *msg ) {
 		case svc_download:
 			CL_ParseDownload( msg );
 			break;
+		case svc_downloadBlock:
+			CL_ParseDownloadBlock( msg );
+			break;
 		}
 	}
 }
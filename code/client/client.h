@@ -183,12 +183,21 @@ typedef struct {
 	fileHandle_t download;
 	char		downloadTempName[MAX_OSPATH];
 	char		downloadName[MAX_OSPATH];
-	int			downloadNumber;
+	int			downloadNumber;	// sent with sliding window requests, echoed in every block
 	int			downloadBlock;	// block we are waiting for
 	int			downloadCount;	// how many bytes we got
 	int			downloadSize;	// how many bytes we got
 	char		downloadList[MAX_INFO_STRING]; // list of paks we need to download
 	qboolean	downloadRestart;	// if true, we need to do another FS_Restart because we downloaded a pak
+	struct downloadTransport_s	*downloadTransport;	// non-NULL while redirected away from the server
+
+	// sliding window downloads, blocks arrive in any order
+	qboolean	downloadWindowed;	// asked for DOWNLOAD_WINDOW_VERSION
+	byte		*downloadReceived;	// a bit for every block, allocated with the first one
+	int			downloadNumBlocks;
+	int			downloadAckBlock;	// every block before this one has been received
+	int			downloadHighBlock;	// one past the highest block received
+	qboolean	downloadAckPending;	// received blocks the server hasn't been told about
 
 	// demo information
 	char		demoName[MAX_QPATH];
@@ -346,6 +355,9 @@ extern	cvar_t	*cl_timedemo;
 extern	cvar_t	*cl_activeAction;
 
 extern	cvar_t	*cl_allowDownload;
+extern	cvar_t	*cl_httpDownload;
+extern	cvar_t	*cl_httpConnections;
+extern	cvar_t	*cl_downloadWindow;
 extern	cvar_t	*cl_conXOffset;
 extern	cvar_t	*cl_inGameVideo;
 
@@ -372,6 +384,7 @@ void CL_ReadDemoMessage( void );
 
 void CL_InitDownloads(void);
 void CL_NextDownload(void);
+void CL_DownloadFrame(void);
 
 void CL_GetPing( int n, char *buf, int buflen, int *pingtime );
 void CL_GetPingInfo( int n, char *buf, int buflen );
@@ -419,6 +432,8 @@ extern int cl_connectedToPureServer;
 
 void CL_SystemInfoChanged( void );
 void CL_ParseServerMessage( msg_t *msg );
+void CL_ClearDownloadWindow( void );
+void CL_AddDownloadAck( void );
 
 //====================================================================
 
@@ -517,3 +532,23 @@ void LAN_SaveServersToCache();
 void CL_Netchan_Transmit( netchan_t *chan, msg_t* msg);	//int length, const byte *data );
 void CL_Netchan_TransmitNextFragment( netchan_t *chan );
 qboolean CL_Netchan_Process( netchan_t *chan, msg_t *msg );
+
+//
+// cl_http.c
+//
+typedef enum {
+	DL_RUNNING,
+	DL_DONE,
+	DL_FAILED
+} downloadStatus_t;
+
+// a way of fetching files from somewhere other than the game server,
+// picked by the scheme at the start of the url
+typedef struct downloadTransport_s {
+	const char			*scheme;
+	qboolean			(*Begin)( const char *url, fileHandle_t f );
+	downloadStatus_t	(*Frame)( int *count, int *size );
+	void				(*Abort)( void );
+} downloadTransport_t;
+
+extern	downloadTransport_t	cl_httpTransport;
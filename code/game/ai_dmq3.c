@@ -2976,7 +2976,8 @@ int BotFindEnemy(bot_state_t *bs, int curenemy) {
 		}
 	}
 #endif
-	//
+	//every bot checks every client, with a visibility trace for the
+	//candidates, this grows with bots * clients on big servers
 	for (i = 0; i < maxclients && i < MAX_CLIENTS; i++) {
 
 		if (i == bs->client) continue;
@@ -73,6 +73,10 @@ int bot_interbreedmatchcount;
 vmCvar_t bot_thinktime;
 vmCvar_t bot_memorydump;
 vmCvar_t bot_saveroutingcache;
+vmCvar_t bot_aastracerecord;
+vmCvar_t bot_aastracebench;
+vmCvar_t bot_parsecachestats;
+vmCvar_t bot_parsebench;
 vmCvar_t bot_pause;
 vmCvar_t bot_report;
 vmCvar_t bot_testsolid;
@@ -1393,6 +1397,10 @@ int BotAIStartFrame(int time) {
 	trap_Cvar_Update(&bot_thinktime);
 	trap_Cvar_Update(&bot_memorydump);
 	trap_Cvar_Update(&bot_saveroutingcache);
+	trap_Cvar_Update(&bot_aastracerecord);
+	trap_Cvar_Update(&bot_aastracebench);
+	trap_Cvar_Update(&bot_parsecachestats);
+	trap_Cvar_Update(&bot_parsebench);
 	trap_Cvar_Update(&bot_pause);
 	trap_Cvar_Update(&bot_report);
 
@@ -1429,6 +1437,22 @@ int BotAIStartFrame(int time) {
 		trap_BotLibVarSet("saveroutingcache", "1");
 		trap_Cvar_Set("bot_saveroutingcache", "0");
 	}
+	if (bot_aastracerecord.integer) {
+		trap_BotLibVarSet("aastracerecord", bot_aastracerecord.string);
+		trap_Cvar_Set("bot_aastracerecord", "0");
+	}
+	if (bot_aastracebench.integer) {
+		trap_BotLibVarSet("aastracebench", bot_aastracebench.string);
+		trap_Cvar_Set("bot_aastracebench", "0");
+	}
+	if (bot_parsecachestats.integer) {
+		trap_BotLibVarSet("parsecachestats", "1");
+		trap_Cvar_Set("bot_parsecachestats", "0");
+	}
+	if (bot_parsebench.integer) {
+		trap_BotLibVarSet("parsebench", bot_parsebench.string);
+		trap_Cvar_Set("bot_parsebench", "0");
+	}
 	//check if bot interbreeding is activated
 	BotInterbreeding();
 	//cap the bot think time
@@ -1610,6 +1634,9 @@ int BotInitLibrary(void) {
 	//no AAS optimization
 	trap_Cvar_VariableStringBuffer("bot_aasoptimize", buf, sizeof(buf));
 	if (strlen(buf)) trap_BotLibVarSet("aasoptimize", buf);
+	//breadth-first flattened AAS tree for tracing
+	trap_Cvar_VariableStringBuffer("bot_aasflatnodes", buf, sizeof(buf));
+	if (strlen(buf)) trap_BotLibVarSet("aas_flatnodes", buf);
 	//
 	trap_Cvar_VariableStringBuffer("bot_saveroutingcache", buf, sizeof(buf));
 	if (strlen(buf)) trap_BotLibVarSet("saveroutingcache", buf);
@@ -1645,6 +1672,10 @@ int BotAISetup( int restart ) {
 	trap_Cvar_Register(&bot_thinktime, "bot_thinktime", "100", CVAR_CHEAT);
 	trap_Cvar_Register(&bot_memorydump, "bot_memorydump", "0", CVAR_CHEAT);
 	trap_Cvar_Register(&bot_saveroutingcache, "bot_saveroutingcache", "0", CVAR_CHEAT);
+	trap_Cvar_Register(&bot_aastracerecord, "bot_aastracerecord", "0", CVAR_CHEAT);
+	trap_Cvar_Register(&bot_aastracebench, "bot_aastracebench", "0", CVAR_CHEAT);
+	trap_Cvar_Register(&bot_parsecachestats, "bot_parsecachestats", "0", CVAR_CHEAT);
+	trap_Cvar_Register(&bot_parsebench, "bot_parsebench", "0", CVAR_CHEAT);
 	trap_Cvar_Register(&bot_pause, "bot_pause", "0", CVAR_CHEAT);
 	trap_Cvar_Register(&bot_report, "bot_report", "0", CVAR_CHEAT);
 	trap_Cvar_Register(&bot_testsolid, "bot_testsolid", "0", CVAR_CHEAT);
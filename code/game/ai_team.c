@@ -103,21 +103,6 @@ int BotNumTeamMates(bot_state_t *bs) {
 	return numplayers;
 }
 
-/*
-==================
-BotClientTravelTimeToGoal
-==================
-*/
-int BotClientTravelTimeToGoal(int client, bot_goal_t *goal) {
-	playerState_t ps;
-	int areanum;
-
-	BotAI_GetClientState(client, &ps);
-	areanum = BotPointAreaNum(ps.origin);
-	if (!areanum) return 1;
-	return trap_AAS_AreaTravelTimeToGoalArea(areanum, ps.origin, goal->areanum, TFL_DEFAULT);
-}
-
 /*
 ==================
 BotSortTeamMatesByBaseTravelTime
@@ -125,10 +110,13 @@ BotSortTeamMatesByBaseTravelTime
 */
 int BotSortTeamMatesByBaseTravelTime(bot_state_t *bs, int *teammates, int maxteammates) {
 
-	int i, j, k, numteammates, traveltime;
+	int i, j, k, n, numclients, numteammates;
 	char buf[MAX_INFO_STRING];
 	static int maxclients;
-	int traveltimes[MAX_CLIENTS];
+	int clients[MAX_CLIENTS], areanums[MAX_CLIENTS], goalareanums[MAX_CLIENTS];
+	int clienttraveltimes[MAX_CLIENTS], traveltimes[MAX_CLIENTS];
+	vec3_t origins[MAX_CLIENTS];
+	playerState_t ps;
 	bot_goal_t *goal = NULL;
 
 	if (gametype == GT_CTF || gametype == GT_1FCTF) {
@@ -148,7 +136,7 @@ int BotSortTeamMatesByBaseTravelTime(bot_state_t *bs, int *teammates, int maxtea
 	if (!maxclients)
 		maxclients = trap_Cvar_VariableIntegerValue("sv_maxclients");
 
-	numteammates = 0;
+	numclients = 0;
 	for (i = 0; i < maxclients && i < MAX_CLIENTS; i++) {
 		trap_GetConfigstring(CS_PLAYERS+i, buf, sizeof(buf));
 		//if no config string or no name
@@ -157,23 +145,37 @@ int BotSortTeamMatesByBaseTravelTime(bot_state_t *bs, int *teammates, int maxtea
 		if (atoi(Info_ValueForKey(buf, "t")) == TEAM_SPECTATOR) continue;
 		//
 		if (BotSameTeam(bs, i)) {
-			//
-			traveltime = BotClientTravelTimeToGoal(i, goal);
-			//
-			for (j = 0; j < numteammates; j++) {
-				if (traveltime < traveltimes[j]) {
-					for (k = numteammates; k > j; k--) {
-						traveltimes[k] = traveltimes[k-1];
-						teammates[k] = teammates[k-1];
-					}
-					break;
+			BotAI_GetClientState(i, &ps);
+			VectorCopy(ps.origin, origins[numclients]);
+			goalareanums[numclients] = goal->areanum;
+			clients[numclients] = i;
+			numclients++;
+			if (numclients >= maxteammates) break;
+		}
+	}
+	//look up the areas and the travel times of all team mates at once
+	trap_AAS_PointAreaNums(origins, areanums, numclients);
+	for (n = 0; n < numclients; n++) {
+		if (!areanums[n]) areanums[n] = BotPointAreaNum(origins[n]);
+	}
+	trap_AAS_AreaTravelTimesToGoalAreas(areanums, origins, goalareanums, TFL_DEFAULT, clienttraveltimes, numclients);
+	//
+	numteammates = 0;
+	for (n = 0; n < numclients; n++) {
+		if (!areanums[n]) clienttraveltimes[n] = 1;
+		//
+		for (j = 0; j < numteammates; j++) {
+			if (clienttraveltimes[n] < traveltimes[j]) {
+				for (k = numteammates; k > j; k--) {
+					traveltimes[k] = traveltimes[k-1];
+					teammates[k] = teammates[k-1];
 				}
+				break;
 			}
-			traveltimes[j] = traveltime;
-			teammates[j] = i;
-			numteammates++;
-			if (numteammates >= maxteammates) break;
 		}
+		traveltimes[j] = clienttraveltimes[n];
+		teammates[j] = clients[n];
+		numteammates++;
 	}
 	return numteammates;
 }
@@ -313,6 +313,136 @@ void BG_DoSlide( playerState_t *ps, pmove_t *pm ) {
 // WALL RUNNING
 //=================
 
+//=================
+// WALL PROBES
+//=================
+
+/*
+Looking for a wall to run on needs the walls beside the player on every
+airborne command the wall run buttons are held.  Instead of tracing both
+sides each time, the world around a player is probed once per cell:
+for each horizontal quadrant a side test can go towards, one position
+test tells whether anything solid is in reach of the test from any point
+of the cell.  A side whose quadrant is empty can't hit anything, a side
+whose quadrant isn't is traced exactly as before, so the cache only ever
+saves traces and never changes their result.
+
+The probes use the tracemask and pass entity of the side tests, so other
+players and movers count the same way.  They are only kept while the
+world stamp of the move stays the same: the game changes it whenever an
+entity other than the player was linked, the predicting client on every
+frame.  Moves without a world stamp aren't cached.
+*/
+
+#define WALLPROBE_CELL			32		// horizontal size of the validity volume
+#define WALLPROBE_CELL_HEIGHT	16		// keeps the floor out of the probes of a jump
+#define WALLPROBE_EPSILON		1		// traces stop short of surfaces closer than SURFACE_CLIP_EPSILON
+
+#define WALLPROBE_QUADRANTS		4
+#define WALLPROBE_UNKNOWN		-1
+
+typedef struct {
+	qboolean	valid;
+	int			cell[3];
+	int			worldStamp;
+	vec3_t		mins, maxs;
+	int			tracemask;
+	void		(*trace)( trace_t *results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int passEntityNum, int contentMask );
+	int			occupied[WALLPROBE_QUADRANTS];	// probed on first use
+} wallProbeCache_t;
+
+static wallProbeCache_t	wallProbeCache[MAX_CLIENTS];
+
+/*
+=================
+BG_WallProbeCache
+
+Returns the probes of the cell the player is in, starting over when the
+player left the cell they were probed in or the world changed.  Returns
+NULL if the move can't be cached.
+=================
+*/
+static wallProbeCache_t *BG_WallProbeCache( pmove_t *pm ) {
+	wallProbeCache_t	*cache;
+	int			cell[3];
+	int			i;
+
+	if ( !pm->worldStamp ) {
+		return NULL;
+	}
+	if ( pm->ps->clientNum < 0 || pm->ps->clientNum >= MAX_CLIENTS ) {
+		return NULL;
+	}
+	cache = &wallProbeCache[pm->ps->clientNum];
+
+	cell[0] = (int)floor( pm->ps->origin[0] / WALLPROBE_CELL );
+	cell[1] = (int)floor( pm->ps->origin[1] / WALLPROBE_CELL );
+	cell[2] = (int)floor( pm->ps->origin[2] / WALLPROBE_CELL_HEIGHT );
+
+	if ( !cache->valid || cache->worldStamp != pm->worldStamp
+		|| cache->cell[0] != cell[0] || cache->cell[1] != cell[1] || cache->cell[2] != cell[2]
+		|| !VectorCompare( cache->mins, pm->mins ) || !VectorCompare( cache->maxs, pm->maxs )
+		|| cache->tracemask != pm->tracemask || cache->trace != pm->trace ) {
+		cache->valid = qtrue;
+		cache->worldStamp = pm->worldStamp;
+		VectorCopy( cell, cache->cell );
+		VectorCopy( pm->mins, cache->mins );
+		VectorCopy( pm->maxs, cache->maxs );
+		cache->tracemask = pm->tracemask;
+		cache->trace = pm->trace;
+		for ( i = 0 ; i < WALLPROBE_QUADRANTS ; i++ ) {
+			cache->occupied[i] = WALLPROBE_UNKNOWN;
+		}
+	}
+
+	return cache;
+}
+
+/*
+=================
+BG_WallProbeOccupied
+
+Returns qtrue if a side test along dir could hit something from anywhere
+in the cell, probing the quadrant of dir if it hasn't been yet
+=================
+*/
+static qboolean BG_WallProbeOccupied( wallProbeCache_t *cache, pmove_t *pm, const vec3_t dir ) {
+	trace_t		trace;
+	vec3_t		mins, maxs, center;
+	int			quadrant;
+	int			i;
+
+	quadrant = ( dir[0] < 0 ) | ( ( dir[1] < 0 ) << 1 );
+	if ( cache->occupied[quadrant] != WALLPROBE_UNKNOWN ) {
+		return cache->occupied[quadrant];
+	}
+
+	// everything the player bounds sweep through from any origin in the
+	// cell, with the whole side test distance towards the quadrant
+	for ( i = 0 ; i < 2 ; i++ ) {
+		mins[i] = cache->cell[i] * WALLPROBE_CELL + pm->mins[i] - WALLPROBE_EPSILON;
+		maxs[i] = ( cache->cell[i] + 1 ) * WALLPROBE_CELL + pm->maxs[i] + WALLPROBE_EPSILON;
+		if ( ( quadrant >> i ) & 1 ) {
+			mins[i] -= PM_WALLRUN_DETECT_DIST;
+		} else {
+			maxs[i] += PM_WALLRUN_DETECT_DIST;
+		}
+	}
+	mins[2] = cache->cell[2] * WALLPROBE_CELL_HEIGHT + pm->mins[2] - WALLPROBE_EPSILON;
+	maxs[2] = ( cache->cell[2] + 1 ) * WALLPROBE_CELL_HEIGHT + pm->maxs[2] + WALLPROBE_EPSILON;
+
+	for ( i = 0 ; i < 3 ; i++ ) {
+		center[i] = ( mins[i] + maxs[i] ) * 0.5f;
+		mins[i] -= center[i];
+		maxs[i] -= center[i];
+	}
+
+	pm->trace( &trace, center, mins, maxs, center, pm->ps->clientNum, pm->tracemask );
+	cache->occupied[quadrant] = trace.startsolid || trace.allsolid;
+
+	return cache->occupied[quadrant];
+}
+
 /*
 =================
 BG_FindWallRunSurface
@@ -322,6 +452,7 @@ Returns qtrue and sets wallNormal if found
 =================
 */
 qboolean BG_FindWallRunSurface( pmove_t *pm, vec3_t wallNormal ) {
+	wallProbeCache_t	*cache;
 	trace_t trace;
 	vec3_t point, forward, right;
 	int i;
@@ -334,7 +465,14 @@ qboolean BG_FindWallRunSurface( pmove_t *pm, vec3_t wallNormal ) {
 	VectorScale( right, -1, directions[0] ); // Left
 	VectorCopy( right, directions[1] ); // Right
 
+	// the probes only cover horizontal side tests, a rolled view isn't
+	cache = right[2] == 0 ? BG_WallProbeCache( pm ) : NULL;
+
 	for ( i = 0; i < 2; i++ ) {
+		if ( cache && !BG_WallProbeOccupied( cache, pm, directions[i] ) ) {
+			continue;	// nothing in reach on this side
+		}
+
 		VectorMA( pm->ps->origin, PM_WALLRUN_DETECT_DIST, directions[i], point );
 
 		pm->trace( &trace, pm->ps->origin, pm->mins, pm->maxs, point, pm->ps->clientNum, pm->tracemask );
@@ -28,8 +28,9 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include "bg_local.h"
 #include "bg_movement.h"
 
-pmove_t		*pm;
-pml_t		pml;
+// a native game can run several moves at once, see G_RunMovesAhead
+Q_THREADLOCAL pmove_t	*pm;
+Q_THREADLOCAL pml_t		pml;
 
 // movement parameters
 float	pm_stopspeed = 100.0f;
@@ -47,7 +48,7 @@ float	pm_waterfriction = 1.0f;
 float	pm_flightfriction = 3.0f;
 float	pm_spectatorfriction = 5.0f;
 
-int		c_pmove = 0;
+Q_THREADLOCAL int		c_pmove = 0;
 
 
 /*
@@ -650,7 +651,10 @@ static void PM_AirMove( void ) {
 	if ( (pm->cmd.buttons & BUTTON_MODIFIER2) &&
 		 (pm->cmd.buttons & BUTTON_DODGE) &&
 		 (pm->cmd.upmove > 0) ) {
-		if ( BG_FindWallRunSurface( pm, wallNormal ) ) {
+		// looking for a wall is the expensive part, skip it
+		// when a wall run couldn't start anyway
+		if ( !( pm->ps->pm_flags & PMF_WALL_RUNNING ) && BG_IsMoving( pm->ps, 100 )
+			&& BG_FindWallRunSurface( pm, wallNormal ) ) {
 			if ( BG_CanWallRun( pm->ps, wallNormal ) ) {
 				BG_DoWallRun( pm->ps, pm, wallNormal );
 			}
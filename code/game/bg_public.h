@@ -174,6 +174,8 @@ typedef struct {
 	int			debugLevel;			// if set, diagnostic output will be printed
 	qboolean	noFootsteps;		// if the game is setup for no footsteps by the server
 	qboolean	gauntletHit;		// true if a gauntlet attack would actually hit something
+	int			worldStamp;			// only changes when something the traces can hit moves,
+									// 0 if that isn't known
 
 	int			framecount;
 
@@ -262,6 +262,12 @@ typedef struct aas_export_s
 											int cmdframes,
 											int maxframes, float frametime,
 											int stopevent, int stopareanum, int visualize);
+	//--------------------------------------------
+	// batched queries
+	//--------------------------------------------
+	int			(*AAS_PointAreaNums)(vec3_t *points, int *areanums, int numpoints);
+	int			(*AAS_AreaTravelTimesToGoalAreas)(int *areanums, vec3_t *origins, int *goalareanums,
+											int travelflags, int *traveltimes, int numqueries);
 } aas_export_t;
 
 typedef struct ea_export_s
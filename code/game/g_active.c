@@ -259,10 +259,8 @@ void	G_TouchTriggers( gentity_t *ent ) {
 		return;
 	}
 
-	VectorSubtract( ent->client->ps.origin, range, mins );
-	VectorAdd( ent->client->ps.origin, range, maxs );
-
-	num = trap_EntitiesInBox( mins, maxs, touch, MAX_GENTITIES );
+	// the sphere encloses the range box, only triggers are returned
+	num = trap_EntitiesInRadius( ent->client->ps.origin, VectorLength( range ), CONTENTS_TRIGGER, touch, MAX_GENTITIES );
 
 	// can't use ent->absmin, because that has a one unit pad
 	VectorAdd( ent->client->ps.origin, ent->r.mins, mins );
@@ -744,27 +742,365 @@ void SendPendingPredictableEvents( playerState_t *ps ) {
 
 /*
 ==============
-ClientThink
+ClientMoveState
 
-This will be called once for each client frame, which will
-usually be a couple times for each server frame on fast clients.
+The playerState changes made every think before the move
+==============
+*/
+static void ClientMoveState( gclient_t *client, playerState_t *ps ) {
+	// clear the rewards if time
+	if ( level.time > client->rewardTime ) {
+		ps->eFlags &= ~(EF_AWARD_IMPRESSIVE | EF_AWARD_EXCELLENT | EF_AWARD_GAUNTLET | EF_AWARD_ASSIST | EF_AWARD_DEFEND | EF_AWARD_CAP );
+	}
 
-If "g_synchronousClients 1" is set, this will be called exactly
-once for each server frame, which makes for smooth demo recording.
+	if ( client->noclip ) {
+		ps->pm_type = PM_NOCLIP;
+	} else if ( ps->stats[STAT_HEALTH] <= 0 ) {
+		ps->pm_type = PM_DEAD;
+	} else {
+		ps->pm_type = PM_NORMAL;
+	}
+
+	ps->gravity = g_gravity.value;
+
+	// set speed
+	ps->speed = g_speed.value;
+
+#ifdef MISSIONPACK
+	if( bg_itemlist[ps->stats[STAT_PERSISTANT_POWERUP]].giTag == PW_SCOUT ) {
+		ps->speed *= 1.5;
+	}
+	else
+#endif
+	if ( ps->powerups[PW_HASTE] ) {
+		ps->speed *= 1.3;
+	}
+}
+
+/*
+==============
+ClientMoveSetup
+
+Fills in the pmove inputs, everything but gauntletHit and worldStamp
 ==============
 */
-void ClientThink_real( gentity_t *ent ) {
+static void ClientMoveSetup( gentity_t *ent, pmove_t *pm, playerState_t *ps, const usercmd_t *cmd ) {
+	pm->ps = ps;
+	pm->cmd = *cmd;
+	if ( ps->pm_type == PM_DEAD ) {
+		pm->tracemask = MASK_PLAYERSOLID & ~CONTENTS_BODY;
+	}
+	else if ( ent->r.svFlags & SVF_BOT ) {
+		pm->tracemask = MASK_PLAYERSOLID | CONTENTS_BOTCLIP;
+	}
+	else {
+		pm->tracemask = MASK_PLAYERSOLID;
+	}
+	pm->trace = trap_Trace;
+	pm->pointcontents = trap_PointContents;
+	pm->debugLevel = g_debugMove.integer;
+	pm->noFootsteps = ( g_dmflags.integer & DF_NO_FOOTSTEPS ) > 0;
+
+	pm->pmove_fixed = pmove_fixed.integer | ent->client->pers.pmoveFixed;
+	pm->pmove_msec = pmove_msec.integer;
+}
+
+#ifndef Q3_VM
+/*
+===============================================================================
+
+THREADED MOVES
+
+Bots and synchronous clients all move in G_RunFrame.  Before the first
+one thinks, a native game runs their moves ahead on the engine job
+threads, each on a copy of its playerState, against the world as it is
+then.  Every link and unlink after that is remembered, and when a
+client gets to its move in turn the result is only used if the
+playerState and inputs match what the move was run with and none of
+those changes touched the space its traces and point contents looked
+at.  Anything else runs Pmove again in turn, so the frame ends the same
+as if every move had been made one after the other.
+
+===============================================================================
+*/
+
+#define	MAX_MOVE_CHANGES	256
+
+typedef struct {
+	qboolean		valid;
+	playerState_t	start;			// the playerState the move was run from
+	playerState_t	result;
+	pmove_t			setup;			// the inputs before Pmove changed them
+	pmove_t			pm;
+	vec3_t			reachMins, reachMaxs;	// everything the traces could touch
+} aheadMove_t;
+
+static struct {
+	qboolean		active;
+	int				numChanges;
+	qboolean		overflowed;
+	vec3_t			changeMins[MAX_MOVE_CHANGES];
+	vec3_t			changeMaxs[MAX_MOVE_CHANGES];
+	int				numJobs;
+	int				jobClients[MAX_CLIENTS];
+	aheadMove_t		moves[MAX_CLIENTS];
+} moveBatch;
+
+static Q_THREADLOCAL aheadMove_t	*threadMove;
+
+/*
+==============
+G_AddMoveReach
+
+Grows the reach of the move on this thread by the bounds the engine
+gathers entities in for a trace
+==============
+*/
+static void G_AddMoveReach( const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end ) {
+	int		i;
+	float	lo, hi;
+
+	for ( i = 0 ; i < 3 ; i++ ) {
+		lo = ( start[i] < end[i] ? start[i] : end[i] ) + ( mins ? mins[i] : 0 ) - 1;
+		hi = ( start[i] > end[i] ? start[i] : end[i] ) + ( maxs ? maxs[i] : 0 ) + 1;
+		if ( lo < threadMove->reachMins[i] ) {
+			threadMove->reachMins[i] = lo;
+		}
+		if ( hi > threadMove->reachMaxs[i] ) {
+			threadMove->reachMaxs[i] = hi;
+		}
+	}
+}
+
+static void G_AheadTrace( trace_t *results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask ) {
+	G_AddMoveReach( start, mins, maxs, end );
+	trap_Trace( results, start, mins, maxs, end, passEntityNum, contentmask );
+}
+
+static int G_AheadPointContents( const vec3_t point, int passEntityNum ) {
+	G_AddMoveReach( point, NULL, NULL, point );
+	return trap_PointContents( point, passEntityNum );
+}
+
+/*
+==============
+G_RunMoveAhead
+
+A job, runs on any thread
+==============
+*/
+static void G_RunMoveAhead( int index ) {
+	aheadMove_t	*ahead;
+
+	ahead = &moveBatch.moves[ moveBatch.jobClients[index] ];
+	threadMove = ahead;
+	Pmove( &ahead->pm );
+	threadMove = NULL;
+}
+
+/*
+==============
+G_SetupMoveAhead
+
+Sets up the move G_RunClient will make for the client, if it will
+make one
+==============
+*/
+static qboolean G_SetupMoveAhead( gentity_t *ent ) {
 	gclient_t	*client;
+	aheadMove_t	*ahead;
+	usercmd_t	cmd;
+
+	client = ent->client;
+	if ( !ent->inuse || !client || client->pers.connected != CON_CONNECTED ) {
+		return qfalse;
+	}
+	if ( !( ent->r.svFlags & SVF_BOT ) && !g_synchronousClients.integer ) {
+		return qfalse;
+	}
+	if ( client->sess.sessionTeam == TEAM_SPECTATOR || level.time - client->ps.commandTime < 1 ) {
+		return qfalse;
+	}
+
+	cmd = client->pers.cmd;
+	cmd.serverTime = level.time;
+	if ( pmove_fixed.integer || client->pers.pmoveFixed ) {
+		cmd.serverTime = ((cmd.serverTime + pmove_msec.integer-1) / pmove_msec.integer) * pmove_msec.integer;
+	}
+	if ( ent->flags & FL_FORCE_GESTURE ) {
+		cmd.buttons |= BUTTON_GESTURE;
+	}
+
+	ahead = &moveBatch.moves[ ent->s.number ];
+	ahead->start = client->ps;
+	ClientMoveState( client, &ahead->start );
+	ahead->result = ahead->start;
+
+	memset( &ahead->pm, 0, sizeof( ahead->pm ) );
+	ClientMoveSetup( ent, &ahead->pm, &ahead->result, &cmd );
+	ahead->pm.trace = G_AheadTrace;
+	ahead->pm.pointcontents = G_AheadPointContents;
+	ahead->setup = ahead->pm;
+
+	VectorSet( ahead->reachMins, 999999, 999999, 999999 );
+	VectorSet( ahead->reachMaxs, -999999, -999999, -999999 );
+	ahead->valid = qtrue;
+	return qtrue;
+}
+
+/*
+==============
+G_RunMovesAhead
+
+Called before any client thinks in G_RunFrame
+==============
+*/
+void G_RunMovesAhead( void ) {
+	int		i;
+
+	moveBatch.active = qfalse;
+	moveBatch.numJobs = 0;
+	for ( i = 0 ; i < level.maxclients ; i++ ) {
+		moveBatch.moves[i].valid = qfalse;
+	}
+
+	// debug prints and intermission thinks don't mix with other threads
+	if ( g_moveThreads.integer == 1 || g_debugMove.integer || level.intermissiontime ) {
+		return;
+	}
+
+	for ( i = 0 ; i < level.maxclients ; i++ ) {
+		if ( G_SetupMoveAhead( &g_entities[i] ) ) {
+			moveBatch.jobClients[moveBatch.numJobs++] = i;
+		}
+	}
+	if ( moveBatch.numJobs < 2 ) {
+		for ( i = 0 ; i < moveBatch.numJobs ; i++ ) {
+			moveBatch.moves[ moveBatch.jobClients[i] ].valid = qfalse;
+		}
+		return;
+	}
+
+	trap_RunJobs( G_RunMoveAhead, moveBatch.numJobs, g_moveThreads.integer );
+
+	moveBatch.numChanges = 0;
+	moveBatch.overflowed = qfalse;
+	moveBatch.active = qtrue;
+}
+
+/*
+==============
+G_EndMovesAhead
+==============
+*/
+void G_EndMovesAhead( void ) {
+	moveBatch.active = qfalse;
+}
+
+/*
+==============
+G_MovesAheadLinked
+
+Called around every link and unlink, remembers where the world changed
+==============
+*/
+void G_MovesAheadLinked( gentity_t *ent ) {
+	if ( !moveBatch.active || !ent->r.linked ) {
+		return;
+	}
+	if ( moveBatch.numChanges == MAX_MOVE_CHANGES ) {
+		moveBatch.overflowed = qtrue;
+		return;
+	}
+	VectorCopy( ent->r.absmin, moveBatch.changeMins[moveBatch.numChanges] );
+	VectorCopy( ent->r.absmax, moveBatch.changeMaxs[moveBatch.numChanges] );
+	moveBatch.numChanges++;
+}
+
+/*
+==============
+G_UseMoveAhead
+
+Replaces Pmove with the move run ahead when it is sure to give the
+same result.  Returns qfalse if the move has to be made now.
+==============
+*/
+static qboolean G_UseMoveAhead( gentity_t *ent, pmove_t *pm ) {
+	aheadMove_t	*ahead;
+	pmove_t		own;
+	int			i, j;
+
+	if ( !moveBatch.active ) {
+		return qfalse;
+	}
+	ahead = &moveBatch.moves[ ent->s.number ];
+	if ( !ahead->valid ) {
+		return qfalse;
+	}
+	ahead->valid = qfalse;
+
+	if ( moveBatch.overflowed ) {
+		return qfalse;
+	}
+	if ( memcmp( &ahead->start, pm->ps, sizeof( ahead->start ) )
+		|| memcmp( &ahead->setup.cmd, &pm->cmd, sizeof( pm->cmd ) )
+		|| ahead->setup.tracemask != pm->tracemask
+		|| ahead->setup.debugLevel != pm->debugLevel
+		|| ahead->setup.noFootsteps != pm->noFootsteps
+		|| ahead->setup.gauntletHit != pm->gauntletHit
+		|| ahead->setup.pmove_fixed != pm->pmove_fixed
+		|| ahead->setup.pmove_msec != pm->pmove_msec ) {
+		return qfalse;
+	}
+	for ( i = 0 ; i < moveBatch.numChanges ; i++ ) {
+		for ( j = 0 ; j < 3 ; j++ ) {
+			if ( moveBatch.changeMins[i][j] > ahead->reachMaxs[j]
+				|| moveBatch.changeMaxs[i][j] < ahead->reachMins[j] ) {
+				break;
+			}
+		}
+		if ( j == 3 ) {
+			return qfalse;
+		}
+	}
+
+	// the outputs and the inputs Pmove changed, keep the rest
+	own = *pm;
+	*pm = ahead->pm;
+	pm->ps = own.ps;
+	pm->trace = own.trace;
+	pm->pointcontents = own.pointcontents;
+	pm->worldStamp = own.worldStamp;
+	*pm->ps = ahead->result;
+	return qtrue;
+}
+#endif
+
+// a client think split around its Pmove
+typedef struct {
 	pmove_t		pm;
 	int			oldEventSequence;
 	int			msec;
+	int			linkCount;			// when the move was set up
+} clientMove_t;
+
+/*
+==============
+ClientMoveBegin
+
+Everything in a client think that comes before Pmove.  Returns qfalse
+if the command didn't lead to a move.
+==============
+*/
+static qboolean ClientMoveBegin( gentity_t *ent, clientMove_t *move ) {
+	gclient_t	*client;
 	usercmd_t	*ucmd;
 
 	client = ent->client;
 
 	// don't think if the client is not yet connected (and thus not yet spawned in)
 	if (client->pers.connected != CON_CONNECTED) {
-		return;
+		return qfalse;
 	}
 	// mark the time, so the connection sprite can be removed
 	ucmd = &ent->client->pers.cmd;
@@ -779,14 +1115,14 @@ void ClientThink_real( gentity_t *ent ) {
 //		G_Printf("serverTime >>>>>\n" );
 	} 
 
-	msec = ucmd->serverTime - client->ps.commandTime;
+	move->msec = ucmd->serverTime - client->ps.commandTime;
 	// following others may result in bad times, but we still want
 	// to check for follow toggles
-	if ( msec < 1 && client->sess.spectatorState != SPECTATOR_FOLLOW ) {
-		return;
+	if ( move->msec < 1 && client->sess.spectatorState != SPECTATOR_FOLLOW ) {
+		return qfalse;
 	}
-	if ( msec > 200 ) {
-		msec = 200;
+	if ( move->msec > 200 ) {
+		move->msec = 200;
 	}
 
 	if ( pmove_msec.integer < 8 ) {
@@ -807,50 +1143,24 @@ void ClientThink_real( gentity_t *ent ) {
 	//
 	if ( level.intermissiontime ) {
 		ClientIntermissionThink( client );
-		return;
+		return qfalse;
 	}
 
 	// spectators don't do much
 	if ( client->sess.sessionTeam == TEAM_SPECTATOR ) {
 		if ( client->sess.spectatorState == SPECTATOR_SCOREBOARD ) {
-			return;
+			return qfalse;
 		}
 		SpectatorThink( ent, ucmd );
-		return;
+		return qfalse;
 	}
 
 	// check for inactivity timer, but never drop the local client of a non-dedicated server
 	if ( !ClientInactivityTimer( client ) ) {
-		return;
-	}
-
-	// clear the rewards if time
-	if ( level.time > client->rewardTime ) {
-		client->ps.eFlags &= ~(EF_AWARD_IMPRESSIVE | EF_AWARD_EXCELLENT | EF_AWARD_GAUNTLET | EF_AWARD_ASSIST | EF_AWARD_DEFEND | EF_AWARD_CAP );
+		return qfalse;
 	}
 
-	if ( client->noclip ) {
-		client->ps.pm_type = PM_NOCLIP;
-	} else if ( client->ps.stats[STAT_HEALTH] <= 0 ) {
-		client->ps.pm_type = PM_DEAD;
-	} else {
-		client->ps.pm_type = PM_NORMAL;
-	}
-
-	client->ps.gravity = g_gravity.value;
-
-	// set speed
-	client->ps.speed = g_speed.value;
-
-#ifdef MISSIONPACK
-	if( bg_itemlist[client->ps.stats[STAT_PERSISTANT_POWERUP]].giTag == PW_SCOUT ) {
-		client->ps.speed *= 1.5;
-	}
-	else
-#endif
-	if ( client->ps.powerups[PW_HASTE] ) {
-		client->ps.speed *= 1.3;
-	}
+	ClientMoveState( client, &client->ps );
 
 	// Let go of the hook if we aren't firing
 	if ( client->ps.weapon == WP_GRAPPLING_HOOK &&
@@ -859,15 +1169,15 @@ void ClientThink_real( gentity_t *ent ) {
 	}
 
 	// set up for pmove
-	oldEventSequence = client->ps.eventSequence;
+	move->oldEventSequence = client->ps.eventSequence;
 
-	memset (&pm, 0, sizeof(pm));
+	memset (&move->pm, 0, sizeof(move->pm));
 
 	// check for the hit-scan gauntlet, don't let the action
 	// go through as an attack unless it actually hits something
 	if ( client->ps.weapon == WP_GAUNTLET && !( ucmd->buttons & BUTTON_TALK ) &&
 		( ucmd->buttons & BUTTON_ATTACK ) && client->ps.weaponTime <= 0 ) {
-		pm.gauntletHit = CheckGauntletAttack( ent );
+		move->pm.gauntletHit = CheckGauntletAttack( ent );
 	}
 
 	if ( ent->flags & FL_FORCE_GESTURE ) {
@@ -902,47 +1212,73 @@ void ClientThink_real( gentity_t *ent ) {
 	}
 #endif
 
-	pm.ps = &client->ps;
-	pm.cmd = *ucmd;
-	if ( pm.ps->pm_type == PM_DEAD ) {
-		pm.tracemask = MASK_PLAYERSOLID & ~CONTENTS_BODY;
-	}
-	else if ( ent->r.svFlags & SVF_BOT ) {
-		pm.tracemask = MASK_PLAYERSOLID | CONTENTS_BOTCLIP;
-	}
-	else {
-		pm.tracemask = MASK_PLAYERSOLID;
-	}
-	pm.trace = trap_Trace;
-	pm.pointcontents = trap_PointContents;
-	pm.debugLevel = g_debugMove.integer;
-	pm.noFootsteps = ( g_dmflags.integer & DF_NO_FOOTSTEPS ) > 0;
+	ClientMoveSetup( ent, &move->pm, &client->ps, ucmd );
 
-	pm.pmove_fixed = pmove_fixed.integer | client->pers.pmoveFixed;
-	pm.pmove_msec = pmove_msec.integer;
+	// the world only changed for this client if something else was linked
+	// since it linked itself, its own box and missiles are never traced
+	move->linkCount = trap_LinkCount();
+	if ( move->linkCount != client->ownLinkCount ) {
+		client->worldStamp = move->linkCount;
+	}
+	move->pm.worldStamp = client->worldStamp;
 
 	VectorCopy( client->ps.origin, client->oldOrigin );
 
 #ifdef MISSIONPACK
 		if (level.intermissionQueued != 0 && g_singlePlayer.integer) {
 			if ( level.time - level.intermissionQueued >= 1000  ) {
-				pm.cmd.buttons = 0;
-				pm.cmd.forwardmove = 0;
-				pm.cmd.rightmove = 0;
-				pm.cmd.upmove = 0;
+				move->pm.cmd.buttons = 0;
+				move->pm.cmd.forwardmove = 0;
+				move->pm.cmd.rightmove = 0;
+				move->pm.cmd.upmove = 0;
 				if ( level.time - level.intermissionQueued >= 2000 && level.time - level.intermissionQueued <= 2500 ) {
 					trap_SendConsoleCommand( EXEC_APPEND, "centerview\n");
 				}
 				ent->client->ps.pm_type = PM_SPINTERMISSION;
 			}
 		}
-		Pmove (&pm);
-#else
-		Pmove (&pm);
 #endif
 
+	return qtrue;
+}
+
+/*
+==============
+ClientMovePmove
+
+The move itself.  It only changes the client's own playerState and
+reads the world through traces.
+==============
+*/
+static void ClientMovePmove( gentity_t *ent, clientMove_t *move ) {
+	G_RecordMove( ent, &move->pm );
+#ifndef Q3_VM
+	if ( G_UseMoveAhead( ent, &move->pm ) ) {
+		return;
+	}
+#endif
+	Pmove (&move->pm);
+}
+
+/*
+==============
+ClientMoveEnd
+
+Applies the results of the move: events, linking, trigger touches
+and impacts.  Everything the move changes outside the client's own
+playerState happens here.
+==============
+*/
+static void ClientMoveEnd( gentity_t *ent, clientMove_t *move ) {
+	gclient_t	*client;
+	usercmd_t	*ucmd;
+	int			linkCount;
+
+	client = ent->client;
+	ucmd = &ent->client->pers.cmd;
+
 	// save results of pmove
-	if ( ent->client->ps.eventSequence != oldEventSequence ) {
+	if ( ent->client->ps.eventSequence != move->oldEventSequence ) {
 		ent->eventTime = level.time;
 	}
 	if (g_smoothClients.integer) {
@@ -960,17 +1296,19 @@ void ClientThink_real( gentity_t *ent ) {
 	// use the snapped origin for linking so it matches client predicted versions
 	VectorCopy( ent->s.pos.trBase, ent->r.currentOrigin );
 
-	VectorCopy (pm.mins, ent->r.mins);
-	VectorCopy (pm.maxs, ent->r.maxs);
+	VectorCopy (move->pm.mins, ent->r.mins);
+	VectorCopy (move->pm.maxs, ent->r.maxs);
 
-	ent->waterlevel = pm.waterlevel;
-	ent->watertype = pm.watertype;
+	ent->waterlevel = move->pm.waterlevel;
+	ent->watertype = move->pm.watertype;
 
 	// execute client events
-	ClientEvents( ent, oldEventSequence );
+	ClientEvents( ent, move->oldEventSequence );
 
 	// link entity now, after any personal teleporters have been used
+	linkCount = trap_LinkCount();
 	trap_LinkEntity (ent);
+	client->ownLinkCount = ( linkCount == move->linkCount ) ? trap_LinkCount() : -1;
 	if ( !ent->client->noclip ) {
 		G_TouchTriggers( ent );
 	}
@@ -982,10 +1320,10 @@ void ClientThink_real( gentity_t *ent ) {
 	BotTestAAS(ent->r.currentOrigin);
 
 	// touch other objects
-	ClientImpacts( ent, &pm );
+	ClientImpacts( ent, &move->pm );
 
 	// save results of triggers and client events
-	if (ent->client->ps.eventSequence != oldEventSequence) {
+	if (ent->client->ps.eventSequence != move->oldEventSequence) {
 		ent->eventTime = level.time;
 	}
 
@@ -1014,7 +1352,28 @@ void ClientThink_real( gentity_t *ent ) {
 	}
 
 	// perform once-a-second actions
-	ClientTimerActions( ent, msec );
+	ClientTimerActions( ent, move->msec );
+}
+
+/*
+==============
+ClientThink
+
+This will be called once for each client frame, which will
+usually be a couple times for each server frame on fast clients.
+
+If "g_synchronousClients 1" is set, this will be called exactly
+once for each server frame, which makes for smooth demo recording.
+==============
+*/
+void ClientThink_real( gentity_t *ent ) {
+	clientMove_t	move;
+
+	if ( !ClientMoveBegin( ent, &move ) ) {
+		return;
+	}
+	ClientMovePmove( ent, &move );
+	ClientMoveEnd( ent, &move );
 }
 
 /*
@@ -1039,7 +1398,44 @@ void ClientThink( int clientNum ) {
 	}
 }
 
+/*
+==================
+ClientThinkUsercmds
+
+All the usercmds that arrived since the last server tick, in one call
+instead of a ClientThink for each of them
+==================
+*/
+void ClientThinkUsercmds( int clientNum ) {
+	gentity_t	*ent;
+	usercmd_t	cmds[MAX_PENDING_USERCMDS];
+	int			i, count;
 
+	ent = g_entities + clientNum;
+	count = trap_GetUsercmds( clientNum, cmds, MAX_PENDING_USERCMDS );
+
+	for ( i = 0 ; i < count ; i++ ) {
+		if ( ent->client->pers.connected != CON_CONNECTED ) {
+			break;		// may have been kicked during the last usercmd
+		}
+		ent->client->pers.cmd = cmds[i];
+		ent->client->lastCmdTime = level.time;
+
+		if ( !(ent->r.svFlags & SVF_BOT) && !g_synchronousClients.integer ) {
+			ClientThink_real( ent );
+		}
+	}
+}
+
+
+/*
+==================
+G_RunClient
+
+Bots and synchronous clients think once a server frame, each one is
+linked before the next one moves so they block each other
+==================
+*/
 void G_RunClient( gentity_t *ent ) {
 	if ( !(ent->r.svFlags & SVF_BOT) && !g_synchronousClients.integer ) {
 		return;
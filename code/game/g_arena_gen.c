@@ -11,6 +11,7 @@ Initial implementation - Basic room generation and connectivity
 
 // Global state
 static roguelikeRun_t *currentRun = NULL;
+static arena_t *compiledArena = NULL;      // arena the compiled brushes belong to
 static unsigned int arenaRandSeed = 0;
 
 // Seeded random number generator for deterministic generation
@@ -72,15 +73,17 @@ const char* G_GetRoomTypeName(roomType_t type) {
 
 void G_InitArenaGenerator(void) {
     G_Printf("Procedural Arena Generator initialized\n");
+    // regions were reset by G_InitMemory
     currentRun = NULL;
+    compiledArena = NULL;
 }
 
 //=================
 // Room Creation
 //=================
 
-arenaRoom_t* G_CreateRoom(roomType_t type, vec3_t origin, int width, int height, int depth) {
-    arenaRoom_t *room = (arenaRoom_t *)G_Alloc(sizeof(arenaRoom_t));
+arenaRoom_t* G_CreateRoom(arena_t *arena, roomType_t type, vec3_t origin, int width, int height, int depth) {
+    arenaRoom_t *room = (arenaRoom_t *)G_RegionAlloc(arena->region, sizeof(arenaRoom_t));
 
     room->type = type;
     VectorCopy(origin, room->origin);
@@ -113,92 +116,111 @@ arenaRoom_t* G_CreateRoom(roomType_t type, vec3_t origin, int width, int height,
 // Arena Generation
 //=================
 
-arena_t* G_GenerateArena(int seed, int depth, arenaTheme_t theme) {
+/*
+=================
+G_BeginArenaGeneration
+
+Generation runs as a sequence of small steps so it can be spread over
+server frames. Every generator carries its own random state and swaps it
+in around each step, so interleaving generators or other random users
+never changes the layout a seed produces.
+=================
+*/
+void G_BeginArenaGeneration(arenaGen_t *gen, int seed, int depth, arenaTheme_t theme) {
     arena_t *arena;
-    int i;
-    int startTime = trap_Milliseconds();
 
     G_Printf("Generating arena: seed=%d, depth=%d, theme=%s\n",
              seed, depth, G_GetThemeName(theme));
 
-    arena = (arena_t *)G_Alloc(sizeof(arena_t));
-    memset(arena, 0, sizeof(arena_t));
+    memset(gen, 0, sizeof(*gen));
+
+    // everything belonging to the arena comes from its own region
+    memRegion_t *region = G_AllocRegion(va("arena %d/%d", seed, depth));
+    arena = (arena_t *)G_RegionAlloc(region, sizeof(arena_t));
+    arena->region = region;
 
     arena->seed = seed;
     arena->depth = depth;
     arena->theme = theme;
 
-    ArenaSetSeed(seed + depth); // Vary seed by depth
+    gen->arena = arena;
+    gen->stage = ARENAGEN_ROOMS;
+    gen->randSeed = seed + depth; // Vary seed by depth
+
+    ArenaSetSeed(gen->randSeed);
 
     // Determine number of rooms based on depth
-    int numRooms = 3 + depth + ArenaRandRange(0, depth);
-    if (numRooms > MAX_ARENA_ROOMS) numRooms = MAX_ARENA_ROOMS;
+    gen->numRooms = 3 + depth + ArenaRandRange(0, depth);
+    if (gen->numRooms > MAX_ARENA_ROOMS) gen->numRooms = MAX_ARENA_ROOMS;
 
-    // Generate rooms in a grid pattern (simple algorithm)
-    vec3_t currentPos = {0, 0, 0};
-    arenaRoom_t *prevRoom = NULL;
+    gen->randSeed = arenaRandSeed;
+}
 
-    for (i = 0; i < numRooms; i++) {
-        roomType_t type = ROOM_TYPE_ARENA;
+static void ArenaGenerateRoom(arenaGen_t *gen) {
+    arena_t *arena = gen->arena;
+    int i = gen->roomIndex;
+    int depth = arena->depth;
+    roomType_t type = ROOM_TYPE_ARENA;
 
-        // First room is always start
-        if (i == 0) {
-            type = ROOM_TYPE_START;
-        }
-        // Last room is exit
-        else if (i == numRooms - 1) {
-            type = ROOM_TYPE_EXIT;
-        }
-        // Boss room every 5th depth
-        else if (depth % 5 == 0 && i == numRooms - 2) {
-            type = ROOM_TYPE_BOSS;
-        }
-        // Random type otherwise
-        else {
-            int r = ArenaRandRange(0, 100);
-            if (r < 40) type = ROOM_TYPE_ARENA;
-            else if (r < 60) type = ROOM_TYPE_CORRIDOR;
-            else if (r < 75) type = ROOM_TYPE_JUNCTION;
-            else if (r < 90) type = ROOM_TYPE_MULTILEVEL;
-            else type = ROOM_TYPE_HAZARD;
-        }
+    // First room is always start
+    if (i == 0) {
+        type = ROOM_TYPE_START;
+    }
+    // Last room is exit
+    else if (i == gen->numRooms - 1) {
+        type = ROOM_TYPE_EXIT;
+    }
+    // Boss room every 5th depth
+    else if (depth % 5 == 0 && i == gen->numRooms - 2) {
+        type = ROOM_TYPE_BOSS;
+    }
+    // Random type otherwise
+    else {
+        int r = ArenaRandRange(0, 100);
+        if (r < 40) type = ROOM_TYPE_ARENA;
+        else if (r < 60) type = ROOM_TYPE_CORRIDOR;
+        else if (r < 75) type = ROOM_TYPE_JUNCTION;
+        else if (r < 90) type = ROOM_TYPE_MULTILEVEL;
+        else type = ROOM_TYPE_HAZARD;
+    }
 
-        // Size varies by type and depth
-        int width = 256 + ArenaRandRange(0, 128) + (depth * 16);
-        int height = 256 + ArenaRandRange(0, 64);
-        int roomDepth = 256 + ArenaRandRange(0, 128) + (depth * 16);
+    // Size varies by type and depth
+    int width = 256 + ArenaRandRange(0, 128) + (depth * 16);
+    int height = 256 + ArenaRandRange(0, 64);
+    int roomDepth = 256 + ArenaRandRange(0, 128) + (depth * 16);
 
-        if (type == ROOM_TYPE_CORRIDOR) {
-            width = 512 + ArenaRandRange(0, 256);
-            roomDepth = 128;
-        }
-        else if (type == ROOM_TYPE_BOSS) {
-            width = 512 + (depth * 32);
-            roomDepth = 512 + (depth * 32);
-            height = 384;
-        }
+    if (type == ROOM_TYPE_CORRIDOR) {
+        width = 512 + ArenaRandRange(0, 256);
+        roomDepth = 128;
+    }
+    else if (type == ROOM_TYPE_BOSS) {
+        width = 512 + (depth * 32);
+        roomDepth = 512 + (depth * 32);
+        height = 384;
+    }
 
-        arenaRoom_t *room = G_CreateRoom(type, currentPos, width, height, roomDepth);
-        room->theme = theme;
+    arenaRoom_t *room = G_CreateRoom(arena, type, gen->currentPos, width, height, roomDepth);
+    room->theme = arena->theme;
 
-        // Link rooms
-        if (prevRoom) {
-            room->next = prevRoom;
-        }
-        prevRoom = room;
+    // Link rooms, the list head is always the newest room
+    room->next = arena->rooms;
+    arena->rooms = room;
 
-        arena->numRooms++;
+    arena->numRooms++;
 
-        // Move position for next room (simple linear layout for now)
-        currentPos[0] += width + 128; // 128 unit gap between rooms
+    // Move position for next room (simple linear layout for now)
+    gen->currentPos[0] += width + 128; // 128 unit gap between rooms
 
-        // Occasional branching
-        if (ArenaRand() % 3 == 0 && i > 0) {
-            currentPos[1] += ArenaRandRange(-256, 256);
-        }
+    // Occasional branching
+    if (ArenaRand() % 3 == 0 && i > 0) {
+        gen->currentPos[1] += ArenaRandRange(-256, 256);
     }
 
-    arena->rooms = prevRoom; // Head of linked list
+    gen->roomIndex++;
+}
+
+static void ArenaGenerateCorridors(arenaGen_t *gen) {
+    arena_t *arena = gen->arena;
 
     // Connect adjacent rooms with corridors
     G_Printf("Connecting rooms...\n");
@@ -210,43 +232,452 @@ arena_t* G_GenerateArena(int seed, int depth, arenaTheme_t theme) {
         VectorCopy(room->origin, arena->corridors[arena->numCorridors].start);
         VectorCopy(room->next->origin, arena->corridors[arena->numCorridors].end);
         arena->corridors[arena->numCorridors].width = 128;
-        arena->corridors[arena->numCorridors].theme = theme;
+        arena->corridors[arena->numCorridors].theme = arena->theme;
         arena->numCorridors++;
 
         room = room->next;
         roomIndex++;
     }
+}
+
+static void ArenaGenerateEntities(arenaGen_t *gen) {
+    arena_t *arena = gen->arena;
 
     // Place entities
     G_PlacePlayerSpawns(arena, 8); // Support up to 8 players
-    G_PlaceEnemySpawns(arena, depth);
-    G_PlaceItems(arena, depth);
+    G_PlaceEnemySpawns(arena, arena->depth);
+    G_PlaceItems(arena, arena->depth);
     G_PlaceExitPortal(arena);
 
-    // Calculate world bounds
+    // Calculate world bounds, the compile narrows them down
     VectorSet(arena->worldMins, -2048, -2048, -512);
     VectorSet(arena->worldMaxs, 2048, 2048, 512);
+}
+
+/*
+=================
+G_ArenaGenerationStep
+
+Runs the next step of a generator, returns qtrue once the arena is done
+=================
+*/
+qboolean G_ArenaGenerationStep(arenaGen_t *gen) {
+    int startTime;
+
+    if (gen->stage == ARENAGEN_IDLE || gen->stage == ARENAGEN_DONE) {
+        return gen->stage == ARENAGEN_DONE;
+    }
 
-    arena->generationTime = (trap_Milliseconds() - startTime) / 1000.0f;
+    startTime = trap_Milliseconds();
+    ArenaSetSeed(gen->randSeed);
+
+    switch (gen->stage) {
+    case ARENAGEN_ROOMS:
+        ArenaGenerateRoom(gen);
+        if (gen->roomIndex >= gen->numRooms) {
+            gen->stage = ARENAGEN_CORRIDORS;
+        }
+        break;
+    case ARENAGEN_CORRIDORS:
+        ArenaGenerateCorridors(gen);
+        gen->stage = ARENAGEN_ENTITIES;
+        break;
+    case ARENAGEN_ENTITIES:
+        ArenaGenerateEntities(gen);
+        gen->stage = ARENAGEN_COMPILE;
+        break;
+    case ARENAGEN_COMPILE:
+        // collision data is part of the result, a failed compile is
+        // simply redone by G_LoadArena
+        G_CompileArena(gen->arena);
+        gen->stage = ARENAGEN_DONE;
+        break;
+    default:
+        break;
+    }
 
-    G_Printf("Arena generated: %d rooms, %d corridors in %.2fs\n",
-             arena->numRooms, arena->numCorridors, arena->generationTime);
+    gen->randSeed = arenaRandSeed;
+    gen->msec += trap_Milliseconds() - startTime;
+
+    if (gen->stage == ARENAGEN_DONE) {
+        arena_t *arena = gen->arena;
+
+        arena->generationTime = gen->msec / 1000.0f;
+        G_Printf("Arena generated: %d rooms, %d corridors in %.2fs\n",
+                 arena->numRooms, arena->numCorridors, arena->generationTime);
+        return qtrue;
+    }
+    return qfalse;
+}
+
+/*
+=================
+G_FinishArenaGeneration
+
+Runs all remaining steps and hands the arena over to the caller
+=================
+*/
+arena_t* G_FinishArenaGeneration(arenaGen_t *gen) {
+    arena_t *arena;
+
+    if (gen->stage == ARENAGEN_IDLE) {
+        return NULL;
+    }
+    while (!G_ArenaGenerationStep(gen)) {
+    }
 
+    arena = gen->arena;
+    memset(gen, 0, sizeof(*gen));
     return arena;
 }
 
+/*
+=================
+G_CancelArenaGeneration
+=================
+*/
+void G_CancelArenaGeneration(arenaGen_t *gen) {
+    if (gen->arena) {
+        G_FreeArena(gen->arena);
+    }
+    memset(gen, 0, sizeof(*gen));
+}
+
+arena_t* G_GenerateArena(int seed, int depth, arenaTheme_t theme) {
+    arenaGen_t gen;
+
+    G_BeginArenaGeneration(&gen, seed, depth, theme);
+    return G_FinishArenaGeneration(&gen);
+}
+
 void G_FreeArena(arena_t *arena) {
     if (!arena) return;
 
-    // Free room linked list
-    arenaRoom_t *room = arena->rooms;
-    while (room) {
-        arenaRoom_t *next = room->next;
-        G_Free(room);
-        room = next;
+    if (arena == compiledArena) {
+        compiledArena = NULL;
+    }
+
+    // The arena and its rooms all go with the region
+    G_FreeRegion(arena->region);
+}
+
+//=================
+// Runtime Compile
+//=================
+
+#define ARENA_WALL_THICKNESS    16
+#define ARENA_DOOR_HEIGHT       128
+#define ARENA_PLATFORM_HEIGHT   40      // low enough to jump onto
+#define ARENA_LAVA_DEPTH        16
+
+// The compiled world lives in one static buffer, the engine copies it
+// into its own clip model on load so only the last compile is kept.
+static boxBrush_t arenaBrushes[MAX_ARENA_BRUSHES];
+static boxBrush_t arenaScratch[MAX_ARENA_BRUSHES];
+static int numArenaBrushes;
+
+static const char *arenaItemNames[] = {
+    "25 Health", "Armor Shard", "Shotgun", "Shells",
+    "50 Health", "Armor", "Rocket Launcher", "Rockets",
+    "Plasma Gun", "Cells", "Mega Health", "Heavy Armor"
+};
+
+static qboolean ArenaBoxesOverlap(const vec3_t minsA, const vec3_t maxsA,
+                                  const vec3_t minsB, const vec3_t maxsB) {
+    int i;
+
+    for (i = 0; i < 3; i++) {
+        if (minsA[i] >= maxsB[i] || maxsA[i] <= minsB[i]) {
+            return qfalse;
+        }
+    }
+    return qtrue;
+}
+
+static qboolean ArenaAddBrush(boxBrush_t *list, int *count, const vec3_t mins,
+                              const vec3_t maxs, int contents) {
+    if (*count >= MAX_ARENA_BRUSHES) {
+        return qfalse;
+    }
+    VectorCopy(mins, list[*count].mins);
+    VectorCopy(maxs, list[*count].maxs);
+    list[*count].contents = contents;
+    list[*count].surfaceFlags = 0;
+    (*count)++;
+    return qtrue;
+}
+
+/*
+=================
+ArenaCarve
+
+Removes an empty volume from the solid brushes. Every brush touching the
+volume is split into up to six boxes around it, one pair per axis, so the
+remaining solid stays axial and never overlaps itself.
+=================
+*/
+static qboolean ArenaCarve(const vec3_t mins, const vec3_t maxs) {
+    int i, axis, count = 0;
+
+    for (i = 0; i < numArenaBrushes; i++) {
+        boxBrush_t *b = &arenaBrushes[i];
+        vec3_t restMins, restMaxs, pieceMins, pieceMaxs;
+
+        if (!ArenaBoxesOverlap(b->mins, b->maxs, mins, maxs)) {
+            if (!ArenaAddBrush(arenaScratch, &count, b->mins, b->maxs, b->contents)) {
+                return qfalse;
+            }
+            continue;
+        }
+
+        VectorCopy(b->mins, restMins);
+        VectorCopy(b->maxs, restMaxs);
+        for (axis = 0; axis < 3; axis++) {
+            if (restMins[axis] < mins[axis]) {
+                VectorCopy(restMins, pieceMins);
+                VectorCopy(restMaxs, pieceMaxs);
+                pieceMaxs[axis] = mins[axis];
+                if (!ArenaAddBrush(arenaScratch, &count, pieceMins, pieceMaxs, b->contents)) {
+                    return qfalse;
+                }
+                restMins[axis] = mins[axis];
+            }
+            if (restMaxs[axis] > maxs[axis]) {
+                VectorCopy(restMins, pieceMins);
+                VectorCopy(restMaxs, pieceMaxs);
+                pieceMins[axis] = maxs[axis];
+                if (!ArenaAddBrush(arenaScratch, &count, pieceMins, pieceMaxs, b->contents)) {
+                    return qfalse;
+                }
+                restMaxs[axis] = maxs[axis];
+            }
+        }
+        // what is left is inside the volume and goes away
+    }
+
+    memcpy(arenaBrushes, arenaScratch, count * sizeof(arenaBrushes[0]));
+    numArenaBrushes = count;
+    return qtrue;
+}
+
+/*
+=================
+G_CompileArena
+
+Turns the rooms and corridors into axial collision brushes. The arena
+bounds start out as one solid block and every room and corridor is carved
+out of it, so the result is sealed without any wall bookkeeping. Room
+features are added as extra brushes afterwards.
+=================
+*/
+qboolean G_CompileArena(arena_t *arena) {
+    arenaRoom_t *room;
+    vec3_t mins, maxs;
+    int i, startTime;
+
+    if (!arena || !arena->rooms) return qfalse;
+
+    startTime = trap_Milliseconds();
+    compiledArena = NULL;
+    numArenaBrushes = 0;
+
+    // the solid block surrounding everything
+    ClearBounds(mins, maxs);
+    for (room = arena->rooms; room; room = room->next) {
+        AddPointToBounds(room->mins, mins, maxs);
+        AddPointToBounds(room->maxs, mins, maxs);
+    }
+    for (i = 0; i < 3; i++) {
+        mins[i] -= ARENA_WALL_THICKNESS;
+        maxs[i] += ARENA_WALL_THICKNESS;
+    }
+    VectorCopy(mins, arena->worldMins);
+    VectorCopy(maxs, arena->worldMaxs);
+    ArenaAddBrush(arenaBrushes, &numArenaBrushes, mins, maxs, CONTENTS_SOLID);
+
+    // rooms
+    for (room = arena->rooms; room; room = room->next) {
+        if (!ArenaCarve(room->mins, room->maxs)) {
+            G_Printf("G_CompileArena: MAX_ARENA_BRUSHES exceeded\n");
+            return qfalse;
+        }
+    }
+
+    // corridors fill the gap between a room and the next one in the list,
+    // wide enough on y to open onto both room centers
+    for (room = arena->rooms; room && room->next; room = room->next) {
+        arenaRoom_t *other = room->next;
+        float lowY = room->origin[1] < other->origin[1] ? room->origin[1] : other->origin[1];
+        float highY = room->origin[1] > other->origin[1] ? room->origin[1] : other->origin[1];
+
+        mins[0] = other->maxs[0] < room->maxs[0] ? other->maxs[0] : room->maxs[0];
+        maxs[0] = other->mins[0] > room->mins[0] ? other->mins[0] : room->mins[0];
+        if (maxs[0] <= mins[0]) {
+            continue;   // rooms touch, nothing to carve
+        }
+        mins[1] = lowY - 64;
+        maxs[1] = highY + 64;
+        mins[2] = room->mins[2];
+        maxs[2] = room->mins[2] + ARENA_DOOR_HEIGHT;
+
+        if (!ArenaCarve(mins, maxs)) {
+            G_Printf("G_CompileArena: MAX_ARENA_BRUSHES exceeded\n");
+            return qfalse;
+        }
+    }
+
+    // room features
+    for (room = arena->rooms; room; room = room->next) {
+        if (room->type == ROOM_TYPE_MULTILEVEL) {
+            // a raised platform along one side
+            VectorCopy(room->mins, mins);
+            VectorCopy(room->maxs, maxs);
+            mins[0] = room->origin[0] - room->width / 6;
+            maxs[0] = room->origin[0] + room->width / 6;
+            maxs[1] = room->mins[1] + room->depth / 3;
+            maxs[2] = room->mins[2] + ARENA_PLATFORM_HEIGHT;
+            ArenaAddBrush(arenaBrushes, &numArenaBrushes, mins, maxs, CONTENTS_SOLID);
+        }
+        else if (room->type == ROOM_TYPE_HAZARD) {
+            // a lava pool in the middle of the floor
+            mins[0] = room->origin[0] - room->width / 6;
+            maxs[0] = room->origin[0] + room->width / 6;
+            mins[1] = room->origin[1] - room->depth / 6;
+            maxs[1] = room->origin[1] + room->depth / 6;
+            mins[2] = room->mins[2];
+            maxs[2] = room->mins[2] + ARENA_LAVA_DEPTH;
+            ArenaAddBrush(arenaBrushes, &numArenaBrushes, mins, maxs, CONTENTS_LAVA);
+        }
+    }
+
+    arena->totalBrushes = numArenaBrushes;
+    arena->compileTime = (trap_Milliseconds() - startTime) / 1000.0f;
+    compiledArena = arena;
+
+    return qtrue;
+}
+
+/*
+=================
+G_ArenaAllowed
+
+The arena clip model only exists in this process: a local client shares
+it with the server, but a remote client keeps predicting against the
+original bsp. Until the cgame can build the same arena, only bots and
+the local client may be connected while one is loaded, the server turns
+remote clients away once it is.
+=================
+*/
+qboolean G_ArenaAllowed(void) {
+    gclient_t *client;
+    int i;
+
+    for (i = 0; i < level.maxclients; i++) {
+        client = &level.clients[i];
+        if (client->pers.connected == CON_DISCONNECTED) {
+            continue;
+        }
+        if (g_entities[i].r.svFlags & SVF_BOT) {
+            continue;
+        }
+        if (!client->pers.localClient) {
+            return qfalse;
+        }
+    }
+    return qtrue;
+}
+
+/*
+=================
+G_LoadArena
+
+Replaces the running world with a compiled arena. Map entities are freed,
+spawn points and items are created from the arena and all players are
+respawned inside it. The clip model is registered under the current map
+name, so a local client sharing the server's collision picks it up as well.
+=================
+*/
+qboolean G_LoadArena(arena_t *arena) {
+    gentity_t *ent;
+    char mapname[MAX_QPATH];
+    int i, j, startTime;
+
+    if (!arena) return qfalse;
+
+    if (!G_ArenaAllowed()) {
+        G_Printf("G_LoadArena: arenas can't be loaded with remote clients connected\n");
+        return qfalse;
+    }
+
+    startTime = trap_Milliseconds();
+
+    if (compiledArena != arena && !G_CompileArena(arena)) {
+        return qfalse;
+    }
+
+    // everything spawned from the old map goes, inline models included
+    for (i = MAX_CLIENTS; i < level.num_entities; i++) {
+        ent = &g_entities[i];
+        if (!ent->inuse) {
+            continue;
+        }
+        for (j = 0; j < BODY_QUEUE_SIZE; j++) {
+            if (level.bodyQue[j] == ent) {
+                break;
+            }
+        }
+        if (j < BODY_QUEUE_SIZE) {
+            trap_UnlinkEntity(ent);
+            continue;
+        }
+        G_FreeEntity(ent);
+    }
+
+    trap_Cvar_VariableStringBuffer("mapname", mapname, sizeof(mapname));
+    trap_LoadMapFromMemory(mapname, numArenaBrushes, arenaBrushes);
+
+    // spawn points
+    for (i = 0; i < arena->numPlayerSpawns; i++) {
+        ent = G_Spawn();
+        ent->classname = "info_player_deathmatch";
+        VectorCopy(arena->playerSpawns[i], ent->s.origin);
+        G_SetOrigin(ent, arena->playerSpawns[i]);
+    }
+
+    // items, cycling through the table deeper as the depth goes up
+    level.numSpawnVars = 0;
+    for (i = 0; i < arena->numItemSpawns; i++) {
+        gitem_t *item;
+        int index = (i + arena->depth) % (sizeof(arenaItemNames) / sizeof(arenaItemNames[0]));
+
+        item = BG_FindItem(arenaItemNames[index]);
+        if (!item) {
+            continue;
+        }
+        ent = G_Spawn();
+        ent->classname = item->classname;
+        VectorCopy(arena->itemSpawns[i], ent->s.origin);
+        G_SetOrigin(ent, arena->itemSpawns[i]);
+        G_SpawnItem(ent, item);
     }
+    SaveRegisteredItems();
 
-    G_Free(arena);
+    // put everybody into the new world
+    for (i = 0; i < level.maxclients; i++) {
+        ent = &g_entities[i];
+        if (!ent->inuse || ent->client->pers.connected != CON_CONNECTED) {
+            continue;
+        }
+        if (ent->client->sess.sessionTeam == TEAM_SPECTATOR) {
+            continue;
+        }
+        ClientSpawn(ent);
+    }
+
+    G_Printf("Arena loaded: %d brushes in %d msec\n",
+             numArenaBrushes, trap_Milliseconds() - startTime);
+
+    return qtrue;
 }
 
 //=================
@@ -360,14 +791,29 @@ void G_PlaceExitPortal(arena_t *arena) {
 // Roguelike Mode
 //=================
 
+// Vary theme every few levels
+static arenaTheme_t ArenaThemeForDepth(int depth) {
+    if (depth >= 10) return THEME_HELL;
+    if (depth >= 6) return THEME_SPACE;
+    if (depth >= 3) return THEME_GOTHIC;
+    return THEME_TECH;
+}
+
 roguelikeRun_t* G_StartRoguelikeRun(int seed, qboolean permadeath) {
+    if (!G_ArenaAllowed()) {
+        G_Printf("G_StartRoguelikeRun: arenas can't be loaded with remote clients connected\n");
+        return NULL;
+    }
+
     if (currentRun) {
+        G_CancelArenaGeneration(&currentRun->nextArena);
         G_FreeArena(currentRun->currentArena);
-        G_Free(currentRun);
+        G_FreeRegion(currentRun->region);
     }
 
-    currentRun = (roguelikeRun_t *)G_Alloc(sizeof(roguelikeRun_t));
-    memset(currentRun, 0, sizeof(roguelikeRun_t));
+    memRegion_t *region = G_AllocRegion("roguelike run");
+    currentRun = (roguelikeRun_t *)G_RegionAlloc(region, sizeof(roguelikeRun_t));
+    currentRun->region = region;
 
     currentRun->seed = seed;
     currentRun->currentDepth = 1;
@@ -378,8 +824,12 @@ roguelikeRun_t* G_StartRoguelikeRun(int seed, qboolean permadeath) {
     currentRun->lives = permadeath ? 1 : 3;
     currentRun->timeElapsed = 0;
 
-    // Generate first arena
-    currentRun->currentArena = G_GenerateArena(seed, 1, THEME_TECH);
+    // Generate and load the first arena
+    currentRun->currentArena = G_GenerateArena(seed, 1, ArenaThemeForDepth(1));
+    G_LoadArena(currentRun->currentArena);
+
+    // The second one builds up in the background while this one is played
+    G_BeginArenaGeneration(&currentRun->nextArena, seed, 2, ArenaThemeForDepth(2));
 
     G_Printf("Started roguelike run: seed=%d, permadeath=%d\n", seed, permadeath);
 
@@ -387,12 +837,9 @@ roguelikeRun_t* G_StartRoguelikeRun(int seed, qboolean permadeath) {
 }
 
 qboolean G_AdvanceToNextArena(roguelikeRun_t *run) {
-    if (!run) return qfalse;
+    arena_t *next;
 
-    // Free current arena
-    if (run->currentArena) {
-        G_FreeArena(run->currentArena);
-    }
+    if (!run) return qfalse;
 
     // Advance depth
     run->currentDepth++;
@@ -400,20 +847,49 @@ qboolean G_AdvanceToNextArena(roguelikeRun_t *run) {
         run->maxDepth = run->currentDepth;
     }
 
-    // Vary theme every few levels
-    arenaTheme_t theme = THEME_TECH;
-    if (run->currentDepth >= 10) theme = THEME_HELL;
-    else if (run->currentDepth >= 6) theme = THEME_SPACE;
-    else if (run->currentDepth >= 3) theme = THEME_GOTHIC;
+    // Take over the pre-generated arena, finishing whatever steps the
+    // background generation has not gotten to yet. A generator for some
+    // other depth only happens if the run was changed underneath it.
+    if (run->nextArena.arena && run->nextArena.arena->depth != run->currentDepth) {
+        G_CancelArenaGeneration(&run->nextArena);
+    }
+    if (run->nextArena.stage == ARENAGEN_IDLE) {
+        G_BeginArenaGeneration(&run->nextArena, run->seed, run->currentDepth,
+                               ArenaThemeForDepth(run->currentDepth));
+    }
+    next = G_FinishArenaGeneration(&run->nextArena);
 
-    // Generate next arena
-    run->currentArena = G_GenerateArena(run->seed, run->currentDepth, theme);
+    // Free current arena
+    if (run->currentArena) {
+        G_FreeArena(run->currentArena);
+    }
+    run->currentArena = next;
+
+    if (!G_LoadArena(run->currentArena)) {
+        return qfalse;
+    }
+
+    G_BeginArenaGeneration(&run->nextArena, run->seed, run->currentDepth + 1,
+                           ArenaThemeForDepth(run->currentDepth + 1));
 
     G_Printf("Advanced to arena depth %d\n", run->currentDepth);
 
     return qtrue;
 }
 
+/*
+=================
+G_RunArenaPregeneration
+
+Called every server frame, moves the next arena of the run one step along
+=================
+*/
+void G_RunArenaPregeneration(void) {
+    if (!currentRun) return;
+
+    G_ArenaGenerationStep(&currentRun->nextArena);
+}
+
 void G_EndRoguelikeRun(roguelikeRun_t *run, qboolean victory) {
     if (!run) return;
 
@@ -422,6 +898,7 @@ void G_EndRoguelikeRun(roguelikeRun_t *run, qboolean victory) {
 
     // TODO: Save to leaderboard
 
+    G_CancelArenaGeneration(&run->nextArena);
     if (run->currentArena) {
         G_FreeArena(run->currentArena);
     }
@@ -430,7 +907,7 @@ void G_EndRoguelikeRun(roguelikeRun_t *run, qboolean victory) {
         currentRun = NULL;
     }
 
-    G_Free(run);
+    G_FreeRegion(run->region);
 }
 
 roguelikeRun_t* G_GetCurrentRun(void) {
@@ -450,6 +927,7 @@ void G_PrintArenaInfo(arena_t *arena) {
     G_Printf("Player Spawns: %d, Enemy Spawns: %d, Items: %d\n",
              arena->numPlayerSpawns, arena->numEnemySpawns, arena->numItemSpawns);
     G_Printf("Generation Time: %.2fs\n", arena->generationTime);
+    G_Printf("Brushes: %d, Compile Time: %.3fs\n", arena->totalBrushes, arena->compileTime);
 
     arenaRoom_t *room = arena->rooms;
     int idx = 0;
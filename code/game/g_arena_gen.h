@@ -76,6 +76,7 @@ typedef struct {
 
 // Complete arena definition
 typedef struct {
+    struct memRegion_s *region; // Holds the arena and its rooms
     int seed;                   // Generation seed
     int depth;                  // Difficulty level (1+)
     arenaTheme_t theme;
@@ -104,8 +105,29 @@ typedef struct {
     int totalArea;
     int totalBrushes;
     float generationTime;
+    float compileTime;
 } arena_t;
 
+// Stepwise generation, so an arena can be built across server frames
+typedef enum {
+    ARENAGEN_IDLE,
+    ARENAGEN_ROOMS,         // One room per step
+    ARENAGEN_CORRIDORS,
+    ARENAGEN_ENTITIES,      // Spawns, items and exit
+    ARENAGEN_COMPILE,       // Collision brushes
+    ARENAGEN_DONE
+} arenaGenStage_t;
+
+typedef struct {
+    arenaGenStage_t stage;
+    arena_t *arena;             // Arena being built
+    unsigned int randSeed;      // Private random state, keeps seeds reproducible
+    int numRooms;
+    int roomIndex;
+    vec3_t currentPos;          // Where the next room goes
+    int msec;                   // Time spent in steps so far
+} arenaGen_t;
+
 // Roguelike run state
 typedef struct {
     int seed;                   // Master seed for run
@@ -117,6 +139,8 @@ typedef struct {
     int lives;                  // Extra lives
     float timeElapsed;          // Total time in run
     arena_t *currentArena;      // Currently loaded arena
+    arenaGen_t nextArena;       // Next depth, generated in the background
+    struct memRegion_s *region; // Holds the run state
 } roguelikeRun_t;
 
 //=================
@@ -129,6 +153,18 @@ void        G_InitArenaGenerator(void);
 // Generate a new arena
 arena_t*    G_GenerateArena(int seed, int depth, arenaTheme_t theme);
 
+// Stepwise generation of a new arena
+void        G_BeginArenaGeneration(arenaGen_t *gen, int seed, int depth, arenaTheme_t theme);
+
+// Run one generation step, returns qtrue when the arena is complete
+qboolean    G_ArenaGenerationStep(arenaGen_t *gen);
+
+// Run the remaining steps and take the arena out of the generator
+arena_t*    G_FinishArenaGeneration(arenaGen_t *gen);
+
+// Drop an unfinished or unclaimed arena
+void        G_CancelArenaGeneration(arenaGen_t *gen);
+
 // Free arena memory
 void        G_FreeArena(arena_t *arena);
 
@@ -138,12 +174,15 @@ qboolean    G_CompileArena(arena_t *arena);
 // Load generated arena into game
 qboolean    G_LoadArena(arena_t *arena);
 
+// Arenas are local only, remote clients would predict against the original map
+qboolean    G_ArenaAllowed(void);
+
 //=================
 // Room Generation
 //=================
 
-// Create a room of specified type
-arenaRoom_t* G_CreateRoom(roomType_t type, vec3_t origin, int width, int height, int depth);
+// Create a room of specified type, allocated from the arena's region
+arenaRoom_t* G_CreateRoom(arena_t *arena, roomType_t type, vec3_t origin, int width, int height, int depth);
 
 // Connect two rooms with a corridor
 qboolean    G_ConnectRooms(arena_t *arena, int roomA, int roomB);
@@ -183,6 +222,9 @@ void        G_EndRoguelikeRun(roguelikeRun_t *run, qboolean victory);
 // Get current run state (for HUD display)
 roguelikeRun_t* G_GetCurrentRun(void);
 
+// Advance the background generation of the next arena (once per frame)
+void        G_RunArenaPregeneration(void);
+
 //=================
 // Utility
 //=================
@@ -1164,6 +1164,7 @@ void ClientSpawn(gentity_t *ent) {
 	ent->takedamage = qtrue;
 	ent->inuse = qtrue;
 	ent->classname = "player";
+	G_IndexEntity( ent );
 	ent->r.contents = CONTENTS_BODY;
 	ent->clipmask = MASK_PLAYERSOLID;
 	ent->die = player_die;
@@ -1328,6 +1329,7 @@ void ClientDisconnect( int clientNum ) {
 	ent->s.modelindex = 0;
 	ent->inuse = qfalse;
 	ent->classname = "disconnected";
+	G_UnindexEntity( ent );
 	ent->client->pers.connected = CON_DISCONNECTED;
 	ent->client->ps.persistant[PERS_TEAM] = TEAM_FREE;
 	ent->client->sess.sessionTeam = TEAM_FREE;
@@ -1125,6 +1125,107 @@ qboolean CanDamage (gentity_t *targ, vec3_t origin) {
 }
 
 
+/*
+============
+G_CanDamageList
+
+Same as calling CanDamage for each entity in the list, with the line of
+sight traces batched: the midpoints of all the entities are traced first
+and only the entities that failed get the four offset traces.  The list
+is compacted to the entities that can be damaged, keeping their order,
+and the new count is returned.
+============
+*/
+#define	CANDAMAGE_BATCH		256		// multiple of the four offset traces
+
+static traceRequest_t	canDamageRequests[CANDAMAGE_BATCH];
+static trace_t			canDamageResults[CANDAMAGE_BATCH];
+static qboolean			canDamage[MAX_GENTITIES];
+
+static const float canDamageOffsets[4][2] = {
+	{ 15.0, 15.0 }, { 15.0, -15.0 }, { -15.0, 15.0 }, { -15.0, -15.0 }
+};
+
+int G_CanDamageList( vec3_t origin, int *entityList, int count ) {
+	gentity_t		*targ;
+	traceRequest_t	*req;
+	int				i, j, k, first, num, numRequests;
+	int				pending[CANDAMAGE_BATCH / 4];
+
+	if ( count > MAX_GENTITIES ) {
+		count = MAX_GENTITIES;
+	}
+
+	// trace to the midpoint of the bounds of every entity
+	for ( first = 0 ; first < count ; first += CANDAMAGE_BATCH ) {
+		num = count - first;
+		if ( num > CANDAMAGE_BATCH ) {
+			num = CANDAMAGE_BATCH;
+		}
+		for ( i = 0 ; i < num ; i++ ) {
+			targ = &g_entities[entityList[first + i]];
+			req = &canDamageRequests[i];
+			VectorCopy( origin, req->start );
+			// use the midpoint of the bounds instead of the origin, because
+			// bmodels may have their origin is 0,0,0
+			VectorAdd( targ->r.absmin, targ->r.absmax, req->end );
+			VectorScale( req->end, 0.5, req->end );
+			VectorClear( req->mins );
+			VectorClear( req->maxs );
+			req->passEntityNum = ENTITYNUM_NONE;
+			req->contentmask = MASK_SOLID;
+		}
+		trap_TraceBatch( canDamageRequests, canDamageResults, num );
+		for ( i = 0 ; i < num ; i++ ) {
+			canDamage[first + i] = ( canDamageResults[i].fraction == 1.0
+				|| canDamageResults[i].entityNum == entityList[first + i] );
+		}
+	}
+
+	// the four offset traces for the entities that are still hidden
+	i = 0;
+	while ( i < count ) {
+		numRequests = 0;
+		for ( ; i < count && numRequests < CANDAMAGE_BATCH ; i++ ) {
+			if ( canDamage[i] ) {
+				continue;
+			}
+			targ = &g_entities[entityList[i]];
+			for ( j = 0 ; j < 4 ; j++ ) {
+				req = &canDamageRequests[numRequests + j];
+				VectorCopy( origin, req->start );
+				VectorAdd( targ->r.absmin, targ->r.absmax, req->end );
+				VectorScale( req->end, 0.5, req->end );
+				req->end[0] += canDamageOffsets[j][0];
+				req->end[1] += canDamageOffsets[j][1];
+				VectorClear( req->mins );
+				VectorClear( req->maxs );
+				req->passEntityNum = ENTITYNUM_NONE;
+				req->contentmask = MASK_SOLID;
+			}
+			pending[numRequests / 4] = i;
+			numRequests += 4;
+		}
+		if ( !numRequests ) {
+			break;
+		}
+		trap_TraceBatch( canDamageRequests, canDamageResults, numRequests );
+		for ( j = 0 ; j < numRequests ; j++ ) {
+			if ( canDamageResults[j].fraction == 1.0 ) {
+				canDamage[pending[j / 4]] = qtrue;
+			}
+		}
+	}
+
+	for ( i = 0, k = 0 ; i < count ; i++ ) {
+		if ( canDamage[i] ) {
+			entityList[k++] = entityList[i];
+		}
+	}
+	return k;
+}
+
+
 /*
 ============
 G_RadiusDamage
@@ -1136,7 +1237,6 @@ qboolean G_RadiusDamage ( vec3_t origin, gentity_t *attacker, float damage, floa
 	gentity_t	*ent;
 	int			entityList[MAX_GENTITIES];
 	int			numListedEntities;
-	vec3_t		mins, maxs;
 	vec3_t		v;
 	vec3_t		dir;
 	int			i, e;
@@ -1146,18 +1246,28 @@ qboolean G_RadiusDamage ( vec3_t origin, gentity_t *attacker, float damage, floa
 		radius = 1;
 	}
 
-	for ( i = 0 ; i < 3 ; i++ ) {
-		mins[i] = origin[i] - radius;
-		maxs[i] = origin[i] + radius;
+	// nearest first
+	numListedEntities = trap_EntitiesInRadius( origin, radius, 0, entityList, MAX_GENTITIES );
+
+	// drop what can't be damaged before any line of sight tests
+	for ( e = 0, i = 0 ; e < numListedEntities ; e++ ) {
+		ent = &g_entities[entityList[ e ]];
+
+		if (ent == ignore)
+			continue;
+		if (!ent->takedamage)
+			continue;
+		entityList[i++] = entityList[e];
 	}
 
-	numListedEntities = trap_EntitiesInBox( mins, maxs, entityList, MAX_GENTITIES );
+	// the visibility of everything is checked before any damage is dealt,
+	// damage doesn't move or add solid entities so the result is the same
+	numListedEntities = G_CanDamageList( origin, entityList, i );
 
 	for ( e = 0 ; e < numListedEntities ; e++ ) {
 		ent = &g_entities[entityList[ e ]];
 
-		if (ent == ignore)
-			continue;
+		// killed or removed by an earlier target
 		if (!ent->takedamage)
 			continue;
 
@@ -1179,16 +1289,14 @@ qboolean G_RadiusDamage ( vec3_t origin, gentity_t *attacker, float damage, floa
 
 		points = damage * ( 1.0 - dist / radius );
 
-		if( CanDamage (ent, origin) ) {
-			if( LogAccuracyHit( ent, attacker ) ) {
-				hitClient = qtrue;
-			}
-			VectorSubtract (ent->r.currentOrigin, origin, dir);
-			// push the center of mass higher than the origin so players
-			// get knocked into the air more
-			dir[2] += 24;
-			G_Damage (ent, NULL, attacker, dir, origin, (int)points, DAMAGE_RADIUS, mod);
+		if( LogAccuracyHit( ent, attacker ) ) {
+			hitClient = qtrue;
 		}
+		VectorSubtract (ent->r.currentOrigin, origin, dir);
+		// push the center of mass higher than the origin so players
+		// get knocked into the air more
+		dir[2] += 24;
+		G_Damage (ent, NULL, attacker, dir, origin, (int)points, DAMAGE_RADIUS, mod);
 	}
 
 	return hitClient;
@@ -967,6 +967,11 @@ void G_RunItem( gentity_t *ent ) {
 		return;
 	}
 
+	// moving corpses can block missiles
+	if ( ent->r.contents & ~CONTENTS_TRIGGER ) {
+		G_InvalidateMissileTraces();
+	}
+
 	// get current position
 	BG_EvaluateTrajectory( &ent->s.pos, level.time, origin );
 
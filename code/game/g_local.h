@@ -278,6 +278,10 @@ struct gclient_s {
 
 	vec3_t		oldOrigin;
 
+	int			worldStamp;			// pmove_t worldStamp of the last move
+	int			ownLinkCount;		// link count right after the client linked itself,
+									// -1 if anything else was linked during the move
+
 	// sum up damage over an entire frame, so
 	// shotgun blasts give a single big kick
 	int			damage_armor;		// damage absorbed by armor
@@ -466,6 +470,13 @@ int G_ModelIndex( char *name );
 int		G_SoundIndex( char *name );
 void	G_TeamCommand( team_t team, char *cmd );
 void	G_KillBox (gentity_t *ent);
+void	G_InitEntityIndex( void );
+void	G_InitEntityAllocator( void );
+void	G_EntityFrameStats( void );
+void	G_IndexEntity( gentity_t *ent );
+void	G_UnindexEntity( gentity_t *ent );
+void	G_UpdateEntityIndex( qboolean clearDirty );
+void	Svcmd_EntityIndexStress_f( void );
 gentity_t *G_Find (gentity_t *from, int fieldofs, const char *match);
 gentity_t *G_PickTarget (char *targetname);
 void	G_UseTargets (gentity_t *ent, gentity_t *activator);
@@ -496,6 +507,7 @@ const char *BuildShaderStateConfig();
 // g_combat.c
 //
 qboolean CanDamage (gentity_t *targ, vec3_t origin);
+int G_CanDamageList( vec3_t origin, int *entityList, int count );
 void G_Damage (gentity_t *targ, gentity_t *inflictor, gentity_t *attacker, vec3_t dir, vec3_t point, int damage, int dflags, int mod);
 qboolean G_RadiusDamage (vec3_t origin, gentity_t *attacker, float damage, float radius, gentity_t *ignore, int mod);
 int G_InvulnerabilityEffect( gentity_t *targ, vec3_t dir, vec3_t point, vec3_t impactpoint, vec3_t bouncedir );
@@ -518,6 +530,8 @@ void TossClientCubes( gentity_t *self );
 //
 // g_missile.c
 //
+void G_BeginMissileTraces( void );
+void G_InvalidateMissileTraces( void );
 void G_RunMissile( gentity_t *ent );
 
 gentity_t *fire_blaster (gentity_t *self, vec3_t start, vec3_t aimdir);
@@ -641,8 +655,21 @@ void ClientCommand( int clientNum );
 // g_active.c
 //
 void ClientThink( int clientNum );
+void ClientThinkUsercmds( int clientNum );
 void ClientEndFrame( gentity_t *ent );
 void G_RunClient( gentity_t *ent );
+#ifndef Q3_VM
+void G_RunMovesAhead( void );
+void G_EndMovesAhead( void );
+void G_MovesAheadLinked( gentity_t *ent );
+#endif
+
+//
+// g_pmove_bench.c
+//
+void G_RecordMove( gentity_t *ent, const pmove_t *pm );
+void Svcmd_PmoveRecord_f( void );
+void Svcmd_PmoveBench_f( void );
 
 //
 // g_team.c
@@ -654,7 +681,13 @@ qboolean CheckObeliskAttack( gentity_t *obelisk, gentity_t *attacker );
 //
 // g_mem.c
 //
+typedef struct memRegion_s memRegion_t;
+
 void *G_Alloc( int size );
+memRegion_t *G_AllocRegion( const char *name );
+void *G_RegionAlloc( memRegion_t *region, int size );
+void G_FreeRegion( memRegion_t *region );
+int G_RegionBlocksInUse( void );
 void G_InitMemory( void );
 void Svcmd_GameMem_f( void );
 
@@ -736,6 +769,7 @@ extern	vmCvar_t	g_forcerespawn;
 extern	vmCvar_t	g_inactivity;
 extern	vmCvar_t	g_debugMove;
 extern	vmCvar_t	g_debugAlloc;
+extern	vmCvar_t	g_entityStats;
 extern	vmCvar_t	g_debugDamage;
 extern	vmCvar_t	g_weaponRespawn;
 extern	vmCvar_t	g_weaponTeamRespawn;
@@ -757,6 +791,7 @@ extern	vmCvar_t	g_cubeTimeout;
 extern	vmCvar_t	g_redteam;
 extern	vmCvar_t	g_blueteam;
 extern	vmCvar_t	g_smoothClients;
+extern	vmCvar_t	g_moveThreads;
 extern	vmCvar_t	pmove_fixed;
 extern	vmCvar_t	pmove_msec;
 extern	vmCvar_t	g_rankings;
@@ -806,6 +841,11 @@ qboolean trap_EntityContact( const vec3_t mins, const vec3_t maxs, const gentity
 int		trap_BotAllocateClient( void );
 void	trap_BotFreeClient( int clientNum );
 void	trap_GetUsercmd( int clientNum, usercmd_t *cmd );
+int		trap_GetUsercmds( int clientNum, usercmd_t *cmds, int maxcount );
+int		trap_LinkCount( void );
+#ifndef Q3_VM
+void	trap_RunJobs( void (*job)( int index ), int numJobs, int numThreads );
+#endif
 qboolean	trap_GetEntityToken( char *buffer, int bufferSize );
 
 int		trap_DebugPolygonCreate(int color, int numPoints, vec3_t *points);
@@ -834,6 +874,7 @@ void	trap_AAS_PresenceTypeBoundingBox(int presencetype, vec3_t mins, vec3_t maxs
 float	trap_AAS_Time(void);
 
 int		trap_AAS_PointAreaNum(vec3_t point);
+int		trap_AAS_PointAreaNums(vec3_t *points, int *areanums, int numpoints);
 int		trap_AAS_PointReachabilityAreaIndex(vec3_t point);
 int		trap_AAS_TraceAreas(vec3_t start, vec3_t end, int *areas, vec3_t *points, int maxareas);
 
@@ -847,6 +888,7 @@ int		trap_AAS_IntForBSPEpairKey(int ent, char *key, int *value);
 int		trap_AAS_AreaReachability(int areanum);
 
 int		trap_AAS_AreaTravelTimeToGoalArea(int areanum, vec3_t origin, int goalareanum, int travelflags);
+int		trap_AAS_AreaTravelTimesToGoalAreas(int *areanums, vec3_t *origins, int *goalareanums, int travelflags, int *traveltimes, int numqueries);
 int		trap_AAS_EnableRoutingArea( int areanum, int enable );
 int		trap_AAS_PredictRoute(void /*struct aas_predictroute_s*/ *route, int areanum, vec3_t origin,
 							int goalareanum, int travelflags, int maxareas, int maxtime,
@@ -968,4 +1010,7 @@ void	trap_BotResetWeaponState(int weaponstate);
 int		trap_GeneticParentsAndChildSelection(int numranks, float *ranks, int *parent1, int *parent2, int *child);
 
 void	trap_SnapVector( float *v );
+void	trap_LoadMapFromMemory( const char *name, int numBoxes, const boxBrush_t *boxes );
+void	trap_TraceBatch( const traceRequest_t *requests, trace_t *results, int count );
+int		trap_EntitiesInRadius( const vec3_t origin, float radius, int contentmask, int *list, int maxcount );
 
@@ -60,6 +60,7 @@ vmCvar_t	g_inactivity;
 vmCvar_t	g_debugMove;
 vmCvar_t	g_debugDamage;
 vmCvar_t	g_debugAlloc;
+vmCvar_t	g_entityStats;
 vmCvar_t	g_weaponRespawn;
 vmCvar_t	g_weaponTeamRespawn;
 vmCvar_t	g_motd;
@@ -78,6 +79,7 @@ vmCvar_t	g_teamForceBalance;
 vmCvar_t	g_banIPs;
 vmCvar_t	g_filterBan;
 vmCvar_t	g_smoothClients;
+vmCvar_t	g_moveThreads;
 vmCvar_t	pmove_fixed;
 vmCvar_t	pmove_msec;
 vmCvar_t	g_rankings;
@@ -151,6 +153,7 @@ static cvarTable_t		gameCvarTable[] = {
 	{ &g_debugMove, "g_debugMove", "0", 0, 0, qfalse },
 	{ &g_debugDamage, "g_debugDamage", "0", 0, 0, qfalse },
 	{ &g_debugAlloc, "g_debugAlloc", "0", 0, 0, qfalse },
+	{ &g_entityStats, "g_entityStats", "0", 0, 0, qfalse },
 	{ &g_motd, "g_motd", "", 0, 0, qfalse },
 	{ &g_blood, "com_blood", "1", 0, 0, qfalse },
 
@@ -176,6 +179,8 @@ static cvarTable_t		gameCvarTable[] = {
 	{ &g_proxMineTimeout, "g_proxMineTimeout", "20000", 0, 0, qfalse },
 #endif
 	{ &g_smoothClients, "g_smoothClients", "1", 0, 0, qfalse},
+	// native game only, 0 is a thread per processor, 1 runs every move in turn
+	{ &g_moveThreads, "g_moveThreads", "0", CVAR_ARCHIVE, 0, qfalse},
 	{ &pmove_fixed, "pmove_fixed", "0", CVAR_SYSTEMINFO, 0, qfalse},
 	{ &pmove_msec, "pmove_msec", "8", CVAR_SYSTEMINFO, 0, qfalse},
 
@@ -214,6 +219,9 @@ int vmMain( int command, int arg0, int arg1, int arg2, int arg3, int arg4, int a
 	case GAME_CLIENT_THINK:
 		ClientThink( arg0 );
 		return 0;
+	case GAME_CLIENT_THINK_USERCMDS:
+		ClientThinkUsercmds( arg0 );
+		return 0;
 	case GAME_CLIENT_USERINFO_CHANGED:
 		ClientUserinfoChanged( arg0 );
 		return 0;
@@ -309,6 +317,8 @@ void G_FindTeams( void ) {
 				if ( e2->targetname ) {
 					e->targetname = e2->targetname;
 					e2->targetname = NULL;
+					G_IndexEntity( e );
+					G_IndexEntity( e2 );
 				}
 			}
 		}
@@ -452,8 +462,23 @@ void G_InitGame( int levelTime, int randomSeed, int restart ) {
 
 	// initialize all entities for this game
 	memset( g_entities, 0, MAX_GENTITIES * sizeof(g_entities[0]) );
+	G_InitEntityIndex();
+	G_InitEntityAllocator();
 	level.gentities = g_entities;
 
+	// the engine numbers clients and entities with its own MAX_CLIENTS,
+	// one without sv_clientLimit is a stock 64 player build
+	i = trap_Cvar_VariableIntegerValue( "sv_clientLimit" );
+	if ( !i ) {
+		i = 64;
+	}
+	if ( i != MAX_CLIENTS ) {
+		G_Error( "The server is built for %i clients, the game module for %i", i, MAX_CLIENTS );
+	}
+	if ( g_maxclients.integer > MAX_CLIENTS ) {
+		G_Error( "sv_maxclients %i is over the game module's limit of %i", g_maxclients.integer, MAX_CLIENTS );
+	}
+
 	// initialize all clients for this game
 	level.maxclients = g_maxclients.integer;
 	memset( g_clients, 0, MAX_CLIENTS * sizeof(g_clients[0]) );
@@ -1704,6 +1729,8 @@ void G_RunThink (gentity_t *ent) {
 	if (!ent->think) {
 		G_Error ( "NULL ent->think");
 	}
+	// a think can move or remove anything
+	G_InvalidateMissileTraces();
 	ent->think (ent);
 }
 
@@ -1728,6 +1755,9 @@ int start, end;
 	level.framenum++;
 	level.previousTime = level.time;
 	level.time = levelTime;
+
+	// entities spawned last frame have their names by now
+	G_UpdateEntityIndex( qtrue );
 	msec = level.time - level.previousTime;
 
 	// get any cvar changes
@@ -1737,6 +1767,10 @@ int start, end;
 	// go through all allocated objects
 	//
 	start = trap_Milliseconds();
+	G_BeginMissileTraces();
+#ifndef Q3_VM
+	G_RunMovesAhead();
+#endif
 	ent = &g_entities[0];
 	for (i=0 ; i<level.num_entities ; i++, ent++) {
 		if ( !ent->inuse ) {
@@ -1796,6 +1830,9 @@ int start, end;
 
 		G_RunThink( ent );
 	}
+#ifndef Q3_VM
+	G_EndMovesAhead();
+#endif
 end = trap_Milliseconds();
 
 start = trap_Milliseconds();
@@ -1827,6 +1864,11 @@ end = trap_Milliseconds();
 	// for tracking changes
 	CheckCvars();
 
+	// build the next roguelike arena a step at a time
+	G_RunArenaPregeneration();
+
+	G_EntityFrameStats();
+
 	if (g_listEntity.integer) {
 		for (i = 0; i < MAX_GENTITIES; i++) {
 			G_Printf("%4i: %s\n", i, g_entities[i].classname);
@@ -52,10 +52,212 @@ void *G_Alloc( int size ) {
 	return p;
 }
 
+/*
+===============================================================================
+
+REGIONS
+
+Memory that lives for a bounded time, like a roguelike run or a single
+generated arena, comes from regions instead of the pool above.  A region
+is a chain of fixed size blocks taken from a shared block pool; freeing
+a region hands its whole chain back in one step, whatever it holds.
+
+===============================================================================
+*/
+
+#define	REGION_POOLSIZE		(1024 * 1024)
+#define	REGION_BLOCKSIZE	(32 * 1024)
+#define	REGION_BLOCKS		(REGION_POOLSIZE / REGION_BLOCKSIZE)
+#define	MAX_REGIONS			32
+
+typedef struct regionBlock_s {
+	struct regionBlock_s	*next;
+	int						used;		// bytes handed out after the header
+} regionBlock_t;
+
+// the data follows the header, 32 byte aligned like the pool
+#define	REGION_HEADERSIZE	( ( (int)sizeof( regionBlock_t ) + 31 ) & ~31 )
+#define	REGION_BLOCKDATA	( REGION_BLOCKSIZE - REGION_HEADERSIZE )
+
+struct memRegion_s {
+	qboolean		inuse;
+	char			name[32];
+	regionBlock_t	*first, *last;		// allocations come from the last block
+	int				numBlocks;
+	int				bytes;				// requested, before alignment
+};
+
+static char				regionPool[REGION_POOLSIZE];
+static regionBlock_t	*freeRegionBlocks;
+static memRegion_t		regions[MAX_REGIONS];
+static int				regionBlocksUsed;
+static int				regionBlocksPeak;
+
+/*
+=================
+G_InitRegions
+=================
+*/
+static void G_InitRegions( void ) {
+	regionBlock_t	*block;
+	int				i;
+
+	memset( regions, 0, sizeof( regions ) );
+	freeRegionBlocks = NULL;
+	for ( i = REGION_BLOCKS - 1 ; i >= 0 ; i-- ) {
+		block = (regionBlock_t *)&regionPool[i * REGION_BLOCKSIZE];
+		block->next = freeRegionBlocks;
+		block->used = 0;
+		freeRegionBlocks = block;
+	}
+	regionBlocksUsed = 0;
+	regionBlocksPeak = 0;
+}
+
+/*
+=================
+G_AllocRegion
+
+Blocks are only taken on the first allocation
+=================
+*/
+memRegion_t *G_AllocRegion( const char *name ) {
+	memRegion_t	*region;
+	int			i;
+
+	for ( i = 0, region = regions ; i < MAX_REGIONS ; i++, region++ ) {
+		if ( !region->inuse ) {
+			break;
+		}
+	}
+	if ( i == MAX_REGIONS ) {
+		G_Error( "G_AllocRegion: no free regions for %s\n", name );
+		return NULL;
+	}
+
+	memset( region, 0, sizeof( *region ) );
+	region->inuse = qtrue;
+	Q_strncpyz( region->name, name, sizeof( region->name ) );
+
+	return region;
+}
+
+/*
+=================
+G_RegionAlloc
+
+Returns zero filled memory that stays valid until the region is freed
+=================
+*/
+void *G_RegionAlloc( memRegion_t *region, int size ) {
+	regionBlock_t	*block;
+	char			*p;
+	int				aligned;
+
+	if ( !region || !region->inuse ) {
+		G_Error( "G_RegionAlloc: bad region\n" );
+		return NULL;
+	}
+
+	aligned = ( size + 31 ) & ~31;
+	if ( aligned > REGION_BLOCKDATA ) {
+		G_Error( "G_RegionAlloc: %i bytes is more than a block in %s\n", size, region->name );
+		return NULL;
+	}
+
+	if ( g_debugAlloc.integer ) {
+		G_Printf( "G_RegionAlloc of %i bytes in %s\n", size, region->name );
+	}
+
+	block = region->last;
+	if ( !block || block->used + aligned > REGION_BLOCKDATA ) {
+		block = freeRegionBlocks;
+		if ( !block ) {
+			G_Error( "G_RegionAlloc: out of blocks on allocation of %i bytes in %s\n", size, region->name );
+			return NULL;
+		}
+		freeRegionBlocks = block->next;
+		block->next = NULL;
+		block->used = 0;
+
+		if ( region->last ) {
+			region->last->next = block;
+		} else {
+			region->first = block;
+		}
+		region->last = block;
+		region->numBlocks++;
+
+		regionBlocksUsed++;
+		if ( regionBlocksUsed > regionBlocksPeak ) {
+			regionBlocksPeak = regionBlocksUsed;
+		}
+	}
+
+	p = (char *)block + REGION_HEADERSIZE + block->used;
+	block->used += aligned;
+	region->bytes += size;
+
+	memset( p, 0, size );
+	return p;
+}
+
+/*
+=================
+G_FreeRegion
+
+Everything allocated from the region goes at once, the block chain is
+spliced back onto the free list without walking it
+=================
+*/
+void G_FreeRegion( memRegion_t *region ) {
+	if ( !region || !region->inuse ) {
+		return;
+	}
+
+	if ( region->first ) {
+		region->last->next = freeRegionBlocks;
+		freeRegionBlocks = region->first;
+		regionBlocksUsed -= region->numBlocks;
+	}
+
+	region->inuse = qfalse;
+	region->first = region->last = NULL;
+	region->numBlocks = 0;
+	region->bytes = 0;
+}
+
+/*
+=================
+G_RegionBlocksInUse
+=================
+*/
+int G_RegionBlocksInUse( void ) {
+	return regionBlocksUsed;
+}
+
+//===============================================================================
+
 void G_InitMemory( void ) {
 	allocPoint = 0;
+	G_InitRegions();
 }
 
 void Svcmd_GameMem_f( void ) {
+	memRegion_t	*region;
+	int			i, count;
+
 	G_Printf( "Game memory status: %i out of %i bytes allocated\n", allocPoint, POOLSIZE );
+	G_Printf( "Region blocks: %i out of %i in use, %i peak, %i bytes each\n",
+		regionBlocksUsed, REGION_BLOCKS, regionBlocksPeak, REGION_BLOCKSIZE );
+
+	count = 0;
+	for ( i = 0, region = regions ; i < MAX_REGIONS ; i++, region++ ) {
+		if ( !region->inuse ) {
+			continue;
+		}
+		G_Printf( "  %-24s %2i blocks %7i bytes\n", region->name, region->numBlocks, region->bytes );
+		count++;
+	}
+	G_Printf( "%i regions in use\n", count );
 }
@@ -275,6 +275,8 @@ void G_MissileImpact( gentity_t *ent, trace_t *trace ) {
 #endif
 	other = &g_entities[trace->entityNum];
 
+	G_InvalidateMissileTraces();
+
 	// check for bounce
 	if ( !other->takedamage &&
 		( ent->s.eFlags & ( EF_BOUNCE | EF_BOUNCE_HALF ) ) ) {
@@ -439,6 +441,150 @@ void G_MissileImpact( gentity_t *ent, trace_t *trace ) {
 	trap_LinkEntity( ent );
 }
 
+/*
+================
+G_MissilePassEntity
+================
+*/
+static int G_MissilePassEntity( gentity_t *ent ) {
+	// if this missile bounced off an invulnerability sphere
+	if ( ent->target_ent ) {
+		return ent->target_ent->s.number;
+	}
+#ifdef MISSIONPACK
+	// prox mines that left the owner bbox will attach to anything, even the owner
+	if (ent->s.weapon == WP_PROX_LAUNCHER && ent->count) {
+		return ENTITYNUM_NONE;
+	}
+#endif
+	// ignore interactions with the missile owner
+	return ent->r.ownerNum;
+}
+
+/*
+=============================================================================
+
+BATCHED MISSILE TRACES
+
+The first missile run in a frame traces the moves of all the missiles
+after it with a single trap_TraceBatch.  The results stay valid until
+something that can block a missile moves, gets freed or thinks, after
+which the remaining missiles are traced again, up to MAX_MISSILE_BATCHES
+times a frame before falling back to one trap_Trace per missile.
+
+=============================================================================
+*/
+
+#define	MAX_MISSILE_BATCHES		4
+
+typedef struct {
+	qboolean		valid;			// nothing has moved since the batch was traced
+	int				numBatches;		// batches traced this frame
+	int				numTraces;
+	int				traceNum[MAX_GENTITIES];	// trace index + 1, 0 if not traced
+	traceRequest_t	requests[MAX_GENTITIES];
+	trace_t			results[MAX_GENTITIES];
+} missileTraces_t;
+
+static missileTraces_t	missileTraces;
+
+/*
+================
+G_BeginMissileTraces
+
+Called before the entities are run each frame
+================
+*/
+void G_BeginMissileTraces( void ) {
+	missileTraces.valid = qfalse;
+	missileTraces.numBatches = 0;
+}
+
+/*
+================
+G_InvalidateMissileTraces
+
+Called whenever something that missiles clip against may have changed
+================
+*/
+void G_InvalidateMissileTraces( void ) {
+	missileTraces.valid = qfalse;
+}
+
+/*
+================
+G_TraceMissiles
+
+Traces the moves of all missiles from first on that will be run this frame
+================
+*/
+static void G_TraceMissiles( gentity_t *first ) {
+	gentity_t		*ent;
+	traceRequest_t	*req;
+	int				i;
+
+	memset( missileTraces.traceNum, 0, sizeof( missileTraces.traceNum ) );
+	missileTraces.numTraces = 0;
+
+	for ( i = first - g_entities, ent = first ; i < level.num_entities ; i++, ent++ ) {
+		// same tests as the G_RunFrame entity loop
+		if ( !ent->inuse || ent->s.eType != ET_MISSILE ) {
+			continue;
+		}
+		if ( ent->freeAfterEvent ) {
+			continue;
+		}
+		if ( !ent->r.linked && ent->neverFree ) {
+			continue;
+		}
+
+		req = &missileTraces.requests[missileTraces.numTraces];
+		VectorCopy( ent->r.currentOrigin, req->start );
+		BG_EvaluateTrajectory( &ent->s.pos, level.time, req->end );
+		VectorCopy( ent->r.mins, req->mins );
+		VectorCopy( ent->r.maxs, req->maxs );
+		req->passEntityNum = G_MissilePassEntity( ent );
+		req->contentmask = ent->clipmask;
+
+		missileTraces.traceNum[i] = ++missileTraces.numTraces;
+	}
+
+	trap_TraceBatch( missileTraces.requests, missileTraces.results, missileTraces.numTraces );
+
+	missileTraces.valid = qtrue;
+	missileTraces.numBatches++;
+}
+
+/*
+================
+G_MissileTrace
+
+Same as trap_Trace for the move of the missile, using the batched
+result when it was traced with the same parameters
+================
+*/
+static void G_MissileTrace( gentity_t *ent, const vec3_t origin, int passent, trace_t *tr ) {
+	traceRequest_t	*req;
+	int				num;
+
+	if ( !missileTraces.valid && missileTraces.numBatches < MAX_MISSILE_BATCHES ) {
+		G_TraceMissiles( ent );
+	}
+
+	num = missileTraces.valid ? missileTraces.traceNum[ent->s.number] : 0;
+	if ( num ) {
+		req = &missileTraces.requests[num - 1];
+		if ( req->passEntityNum == passent && req->contentmask == ent->clipmask
+			&& VectorCompare( req->start, ent->r.currentOrigin ) && VectorCompare( req->end, origin )
+			&& VectorCompare( req->mins, ent->r.mins ) && VectorCompare( req->maxs, ent->r.maxs ) ) {
+			*tr = missileTraces.results[num - 1];
+			return;
+		}
+	}
+
+	trap_Trace( tr, ent->r.currentOrigin, ent->r.mins, ent->r.maxs, origin, passent, ent->clipmask );
+}
+
 /*
 ================
 G_RunMissile
@@ -452,22 +598,10 @@ void G_RunMissile( gentity_t *ent ) {
 	// get current position
 	BG_EvaluateTrajectory( &ent->s.pos, level.time, origin );
 
-	// if this missile bounced off an invulnerability sphere
-	if ( ent->target_ent ) {
-		passent = ent->target_ent->s.number;
-	}
-#ifdef MISSIONPACK
-	// prox mines that left the owner bbox will attach to anything, even the owner
-	else if (ent->s.weapon == WP_PROX_LAUNCHER && ent->count) {
-		passent = ENTITYNUM_NONE;
-	}
-#endif
-	else {
-		// ignore interactions with the missile owner
-		passent = ent->r.ownerNum;
-	}
+	passent = G_MissilePassEntity( ent );
+
 	// trace a line from the previous position to the current position
-	trap_Trace( &tr, ent->r.currentOrigin, ent->r.mins, ent->r.maxs, origin, passent, ent->clipmask );
+	G_MissileTrace( ent, origin, passent, &tr );
 
 	if ( tr.startsolid || tr.allsolid ) {
 		// make sure the tr.entityNum is set to the entity we're stuck in
@@ -480,6 +614,11 @@ void G_RunMissile( gentity_t *ent ) {
 
 	trap_LinkEntity( ent );
 
+	// solid missiles block the ones traced after them
+	if ( ent->r.contents ) {
+		G_InvalidateMissileTraces();
+	}
+
 	if ( tr.fraction != 1 ) {
 		// never explode or bounce on sky
 		if ( tr.surfaceFlags & SURF_NOIMPACT ) {
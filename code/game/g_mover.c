@@ -486,6 +486,7 @@ void G_RunMover( gentity_t *ent ) {
 
 	// if stationary at one of the positions, don't move anything
 	if ( ent->s.pos.trType != TR_STATIONARY || ent->s.apos.trType != TR_STATIONARY ) {
+		G_InvalidateMissileTraces();
 		G_MoverTeam( ent );
 	}
 
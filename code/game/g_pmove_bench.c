@@ -0,0 +1,370 @@
+/*
+===========================================================================
+Copyright (C) 1999-2005 Id Software, Inc.
+
+This file is part of Quake III Arena source code.
+
+Quake III Arena source code is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the License,
+or (at your option) any later version.
+
+Quake III Arena source code is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Foobar; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+===========================================================================
+*/
+//
+// g_pmove_bench.c -- recording and deterministic replay of player moves
+
+/*
+The usercmds of one client are captured right before they go through Pmove,
+together with the playerState the recording started from.  A replay runs
+the commands back to back through Pmove on the loaded map, so it only
+depends on the collision world and the movement code itself.  The final
+playerState of a replay is stored with the recording and every later replay
+has to reproduce it bit for bit, which makes it safe to measure
+optimizations of bg_pmove.c and bg_movement.c against the same file.
+
+pmove_record <clientnum> <name>		start recording a client
+pmove_record stop					stop and write pmove/<name>.pmv
+pmove_bench <name> [runs]			replay and time a recording
+*/
+
+#include "g_local.h"
+
+#define	PMOVE_RECORDING_IDENT	(('V'<<24)+('M'<<16)+('P'<<8)+'Q')
+#define	PMOVE_RECORDING_VERSION	1
+
+#define	MAX_RECORDED_MOVES		16384
+
+typedef struct {
+	int				ident;
+	int				version;
+	char			mapname[MAX_QPATH];
+	int				tracemask;
+	int				noFootsteps;
+	int				pmove_fixed;
+	int				pmove_msec;
+	int				numMoves;
+	playerState_t	start;			// state before the first move
+	playerState_t	result;			// state after replaying all the moves
+} moveRecordingHeader_t;
+
+typedef struct {
+	moveRecordingHeader_t	header;
+	usercmd_t				cmds[MAX_RECORDED_MOVES];
+} moveRecording_t;
+
+static moveRecording_t	recording;
+static int				recordClient = -1;
+static char				recordName[MAX_QPATH];
+
+static int				replayTraces;
+static int				replayPointContents;
+
+/*
+================
+G_ReplayTrace
+
+Players and bodies are somewhere else on every replay, so moves
+only collide with the map and the movers
+================
+*/
+static void G_ReplayTrace( trace_t *results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int passEntityNum, int contentMask ) {
+	replayTraces++;
+	trap_Trace( results, start, mins, maxs, end, passEntityNum, contentMask & ~CONTENTS_BODY );
+}
+
+/*
+================
+G_ReplayPointContents
+================
+*/
+static int G_ReplayPointContents( const vec3_t point, int passEntityNum ) {
+	replayPointContents++;
+	return trap_PointContents( point, passEntityNum );
+}
+
+/*
+================
+G_ReplayMoves
+
+Runs all the recorded moves from the recorded start state
+================
+*/
+static void G_ReplayMoves( playerState_t *ps ) {
+	pmove_t		pm;
+	int			worldStamp;
+	int			i;
+
+	*ps = recording.header.start;
+	worldStamp = trap_LinkCount();		// nothing moves during a replay
+
+	for ( i = 0 ; i < recording.header.numMoves ; i++ ) {
+		memset( &pm, 0, sizeof( pm ) );
+		pm.ps = ps;
+		pm.cmd = recording.cmds[i];
+		pm.tracemask = recording.header.tracemask;
+		pm.trace = G_ReplayTrace;
+		pm.pointcontents = G_ReplayPointContents;
+		pm.noFootsteps = recording.header.noFootsteps;
+		pm.pmove_fixed = recording.header.pmove_fixed;
+		pm.pmove_msec = recording.header.pmove_msec;
+		pm.worldStamp = worldStamp;
+
+		Pmove( &pm );
+	}
+}
+
+/*
+================
+G_PlayerStateDifference
+
+Returns the byte offset of the first difference, or -1 if identical
+================
+*/
+static int G_PlayerStateDifference( const playerState_t *a, const playerState_t *b ) {
+	const byte	*pa, *pb;
+	int			i;
+
+	pa = (const byte *)a;
+	pb = (const byte *)b;
+	for ( i = 0 ; i < sizeof( playerState_t ) ; i++ ) {
+		if ( pa[i] != pb[i] ) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+/*
+================
+G_StopMoveRecording
+
+Replays the captured moves to get the reference result and writes the file
+================
+*/
+static void G_StopMoveRecording( void ) {
+	fileHandle_t	f;
+	char			filename[MAX_QPATH];
+
+	if ( recordClient < 0 ) {
+		return;
+	}
+	recordClient = -1;
+
+	if ( !recording.header.numMoves ) {
+		G_Printf( "pmove_record: no moves recorded\n" );
+		return;
+	}
+
+	G_ReplayMoves( &recording.header.result );
+
+	Com_sprintf( filename, sizeof( filename ), "pmove/%s.pmv", recordName );
+	trap_FS_FOpenFile( filename, &f, FS_WRITE );
+	if ( !f ) {
+		G_Printf( "pmove_record: couldn't write %s\n", filename );
+		return;
+	}
+	trap_FS_Write( &recording.header, sizeof( recording.header ), f );
+	trap_FS_Write( recording.cmds, recording.header.numMoves * sizeof( usercmd_t ), f );
+	trap_FS_FCloseFile( f );
+
+	G_Printf( "pmove_record: wrote %i moves to %s\n", recording.header.numMoves, filename );
+}
+
+/*
+================
+G_RecordMove
+
+Called from ClientThink_real right before Pmove
+================
+*/
+void G_RecordMove( gentity_t *ent, const pmove_t *pm ) {
+	moveRecordingHeader_t	*header;
+
+	if ( ent->s.number != recordClient ) {
+		return;
+	}
+
+	header = &recording.header;
+	if ( !header->numMoves ) {
+		header->start = *pm->ps;
+		header->tracemask = pm->tracemask;
+		header->noFootsteps = pm->noFootsteps;
+		header->pmove_fixed = pm->pmove_fixed;
+		header->pmove_msec = pm->pmove_msec;
+	}
+
+	recording.cmds[header->numMoves++] = pm->cmd;
+
+	if ( header->numMoves == MAX_RECORDED_MOVES ) {
+		G_Printf( "pmove_record: recording full\n" );
+		G_StopMoveRecording();
+	}
+}
+
+/*
+=================
+Svcmd_PmoveRecord_f
+
+Usage: pmove_record <clientnum> <name>
+       pmove_record stop
+=================
+*/
+void Svcmd_PmoveRecord_f( void ) {
+	char		arg[MAX_TOKEN_CHARS];
+	int			clientNum;
+	gentity_t	*ent;
+
+	if ( trap_Argc() < 2 ) {
+		G_Printf( "Usage: pmove_record <clientnum> <name> | stop\n" );
+		return;
+	}
+
+	trap_Argv( 1, arg, sizeof( arg ) );
+	if ( !Q_stricmp( arg, "stop" ) ) {
+		if ( recordClient < 0 ) {
+			G_Printf( "pmove_record: not recording\n" );
+			return;
+		}
+		G_StopMoveRecording();
+		return;
+	}
+
+	if ( recordClient >= 0 ) {
+		G_Printf( "pmove_record: already recording client %i\n", recordClient );
+		return;
+	}
+
+	if ( trap_Argc() < 3 ) {
+		G_Printf( "Usage: pmove_record <clientnum> <name> | stop\n" );
+		return;
+	}
+
+	clientNum = atoi( arg );
+	if ( clientNum < 0 || clientNum >= level.maxclients ) {
+		G_Printf( "pmove_record: bad client number %i\n", clientNum );
+		return;
+	}
+	ent = &g_entities[clientNum];
+	if ( !ent->inuse || ent->client->pers.connected != CON_CONNECTED ) {
+		G_Printf( "pmove_record: client %i is not connected\n", clientNum );
+		return;
+	}
+
+	trap_Argv( 2, recordName, sizeof( recordName ) );
+
+	memset( &recording.header, 0, sizeof( recording.header ) );
+	recording.header.ident = PMOVE_RECORDING_IDENT;
+	recording.header.version = PMOVE_RECORDING_VERSION;
+	trap_Cvar_VariableStringBuffer( "mapname", recording.header.mapname, sizeof( recording.header.mapname ) );
+
+	recordClient = clientNum;
+	G_Printf( "pmove_record: recording client %i\n", clientNum );
+}
+
+/*
+=================
+Svcmd_PmoveBench_f
+
+Replays a recording runs times, reporting the cost per move and
+checking every replay ends in the recorded playerState
+Usage: pmove_bench <name> [runs]
+=================
+*/
+void Svcmd_PmoveBench_f( void ) {
+	char			arg[MAX_TOKEN_CHARS];
+	char			filename[MAX_QPATH];
+	char			mapname[MAX_QPATH];
+	fileHandle_t	f;
+	playerState_t	ps;
+	int				len, runs, i, msec, diff, firstDiff, mismatches;
+	float			moves;
+
+	if ( trap_Argc() < 2 ) {
+		G_Printf( "Usage: pmove_bench <name> [runs]\n" );
+		return;
+	}
+
+	if ( recordClient >= 0 ) {
+		G_Printf( "pmove_bench: stop the recording first\n" );
+		return;
+	}
+
+	trap_Argv( 1, arg, sizeof( arg ) );
+	Com_sprintf( filename, sizeof( filename ), "pmove/%s.pmv", arg );
+
+	runs = 10;
+	if ( trap_Argc() > 2 ) {
+		trap_Argv( 2, arg, sizeof( arg ) );
+		runs = atoi( arg );
+		if ( runs < 1 ) {
+			runs = 1;
+		}
+	}
+
+	len = trap_FS_FOpenFile( filename, &f, FS_READ );
+	if ( !f ) {
+		G_Printf( "pmove_bench: couldn't open %s\n", filename );
+		return;
+	}
+	if ( len < sizeof( recording.header ) ) {
+		G_Printf( "pmove_bench: %s is too short\n", filename );
+		trap_FS_FCloseFile( f );
+		return;
+	}
+	trap_FS_Read( &recording.header, sizeof( recording.header ), f );
+	if ( recording.header.ident != PMOVE_RECORDING_IDENT
+		|| recording.header.version != PMOVE_RECORDING_VERSION
+		|| recording.header.numMoves <= 0 || recording.header.numMoves > MAX_RECORDED_MOVES
+		|| len != sizeof( recording.header ) + recording.header.numMoves * sizeof( usercmd_t ) ) {
+		G_Printf( "pmove_bench: %s is not a valid recording\n", filename );
+		trap_FS_FCloseFile( f );
+		return;
+	}
+	trap_FS_Read( recording.cmds, recording.header.numMoves * sizeof( usercmd_t ), f );
+	trap_FS_FCloseFile( f );
+
+	trap_Cvar_VariableStringBuffer( "mapname", mapname, sizeof( mapname ) );
+	if ( Q_stricmp( mapname, recording.header.mapname ) ) {
+		G_Printf( "pmove_bench: %s was recorded on %s\n", filename, recording.header.mapname );
+		return;
+	}
+
+	replayTraces = 0;
+	replayPointContents = 0;
+	mismatches = 0;
+	firstDiff = -1;
+
+	msec = trap_Milliseconds();
+	for ( i = 0 ; i < runs ; i++ ) {
+		G_ReplayMoves( &ps );
+		diff = G_PlayerStateDifference( &ps, &recording.header.result );
+		if ( diff >= 0 ) {
+			if ( !mismatches ) {
+				firstDiff = diff;
+			}
+			mismatches++;
+		}
+	}
+	msec = trap_Milliseconds() - msec;
+
+	moves = (float)recording.header.numMoves * runs;
+	G_Printf( "%i moves x %i runs: %i msec, %.0f ns per move, %.2f traces and %.2f point contents per move\n",
+		recording.header.numMoves, runs, msec, msec * 1000000.0f / moves,
+		replayTraces / moves, replayPointContents / moves );
+
+	if ( !mismatches ) {
+		G_Printf( "final playerState matches the recording\n" );
+	} else {
+		G_Printf( "^1final playerState differs from the recording in %i of %i runs, first difference at byte %i\n",
+			mismatches, runs, firstDiff );
+	}
+}
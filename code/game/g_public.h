@@ -48,6 +48,9 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #define SVF_NOTSINGLECLIENT		0x00000800	// send entity to everyone but one client
 											// (entityShared_t->singleClient)
 
+// with sv_tickCommands the usercmds of a client wait for the next tick,
+// GAME_CLIENT_THINK_USERCMDS never runs more than this at once
+#define	MAX_PENDING_USERCMDS	32
 
 
 //===============================================================
@@ -96,6 +99,16 @@ typedef struct {
 	entityShared_t	r;				// shared by both the server system and game
 } sharedEntity_t;
 
+// one trace of a G_TRACE_BATCH call, the fields match the trap_Trace arguments
+typedef struct {
+	vec3_t		start;
+	vec3_t		end;
+	vec3_t		mins;
+	vec3_t		maxs;
+	int			passEntityNum;
+	int			contentmask;
+} traceRequest_t;
+
 
 
 //===============================================================
@@ -229,6 +242,28 @@ typedef enum {
 	// 1.32
 	G_FS_SEEK,
 
+	G_LOAD_MAP_FROM_MEMORY,	// ( const char *name, int numBoxes, const boxBrush_t *boxes );
+	// replaces the collision world with a runtime generated one, entities
+	// using inline models of the previous map must be freed before
+
+	G_TRACE_BATCH,	// ( const traceRequest_t *requests, trace_t *results, int count );
+	// same as count G_TRACE calls, the world sectors are only walked once
+
+	G_ENTITIES_IN_RADIUS,	// ( const vec3_t origin, float radius, int contentmask, int *list, int maxcount );
+	// entities whose bounding box is closer than radius to origin, nearest
+	// first, a contentmask of 0 accepts any contents
+
+	G_GET_USERCMDS,	// ( int clientNum, usercmd_t *cmds, int maxcount );
+	// the usercmds of a GAME_CLIENT_THINK_USERCMDS call, oldest first
+
+	G_LINK_COUNT,	// ( void );
+	// changes whenever an entity is linked or unlinked, so anything
+	// derived from traces is still valid while it stays the same
+
+	G_RUN_JOBS,		// ( void (*job)( int index ), int numJobs, int numThreads );
+	// native game only, see Sys_RunJobs.  A job can call traces and
+	// point contents, nothing else in the engine is safe from other threads.
+
 	BOTLIB_SETUP = 200,				// ( void );
 	BOTLIB_SHUTDOWN,				// ( void );
 	BOTLIB_LIBVAR_SET,
@@ -386,7 +421,10 @@ typedef enum {
 	BOTLIB_PC_LOAD_SOURCE,
 	BOTLIB_PC_FREE_SOURCE,
 	BOTLIB_PC_READ_TOKEN,
-	BOTLIB_PC_SOURCE_FILE_AND_LINE
+	BOTLIB_PC_SOURCE_FILE_AND_LINE,
+
+	BOTLIB_AAS_POINT_AREA_NUMS,
+	BOTLIB_AAS_AREA_TRAVEL_TIMES_TO_GOAL_AREAS
 
 } gameImport_t;
 
@@ -424,6 +462,10 @@ typedef enum {
 	// The game can issue trap_argc() / trap_argv() commands to get the command
 	// and parameters.  Return qfalse if the game doesn't recognize it as a command.
 
-	BOTAI_START_FRAME				// ( int time );
+	BOTAI_START_FRAME,				// ( int time );
+
+	GAME_CLIENT_THINK_USERCMDS		// ( int clientNum );
+	// runs all the usercmds queued for the client since the last tick,
+	// a game without it returns -1 and gets a GAME_CLIENT_THINK for each
 } gameExport_t;
 
@@ -474,7 +474,11 @@ void G_SpawnGEntityFromSpawnVars( void ) {
 	// if we didn't get a classname, don't bother spawning anything
 	if ( !G_CallSpawn( ent ) ) {
 		G_FreeEntity( ent );
+		return;
 	}
+
+	// spawn functions may have changed the names
+	G_IndexEntity( ent );
 }
 
 
@@ -443,7 +443,7 @@ char	*ConcatArgs( int start );
 Svcmd_GenerateArena_f
 
 Test command to generate a procedural arena
-Usage: generate_arena <seed> <depth> [theme]
+Usage: generate_arena <seed> <depth> [theme] [load]
 =================
 */
 void Svcmd_GenerateArena_f( void ) {
@@ -453,7 +453,7 @@ void Svcmd_GenerateArena_f( void ) {
 	arena_t *arena;
 
 	if ( trap_Argc() < 3 ) {
-		G_Printf( "Usage: generate_arena <seed> <depth> [theme]\n" );
+		G_Printf( "Usage: generate_arena <seed> <depth> [theme] [load]\n" );
 		G_Printf( "Themes: 0=Tech, 1=Gothic, 2=Space, 3=Hell, 4=Random\n" );
 		return;
 	}
@@ -485,14 +485,144 @@ void Svcmd_GenerateArena_f( void ) {
 		G_Printf( "  Item spawns: %d\n", arena->numItemSpawns );
 		G_Printf( "  Theme: %s\n", G_GetThemeName(arena->theme) );
 
-		// TODO: Compile BSP or generate runtime meshes
-		// For now, just report the generation
+		if ( G_CompileArena( arena ) ) {
+			G_Printf( "  Brushes: %d (compiled in %.3fs)\n", arena->totalBrushes, arena->compileTime );
+			if ( trap_Argc() >= 5 ) {
+				trap_Argv( 4, arg, sizeof( arg ) );
+				if ( atoi( arg ) ) {
+					G_LoadArena( arena );
+				}
+			}
+		}
 		G_FreeArena( arena );
 	} else {
 		G_Printf( "Failed to generate arena\n" );
 	}
 }
 
+/*
+=================
+Svcmd_ArenaBench_f
+
+Times generation and compilation of the arena for every depth of a run
+Usage: arena_bench <seed> <maxdepth>
+=================
+*/
+#define	ARENA_BENCH_COMPILES	20
+
+void Svcmd_ArenaBench_f( void ) {
+	char arg[MAX_TOKEN_CHARS];
+	int seed, maxDepth, depth, i;
+	int start, genTime, compileTime;
+	int totalGen, totalCompile;
+	arena_t *arena;
+
+	if ( trap_Argc() < 3 ) {
+		G_Printf( "Usage: arena_bench <seed> <maxdepth>\n" );
+		return;
+	}
+
+	trap_Argv( 1, arg, sizeof( arg ) );
+	seed = atoi( arg );
+
+	trap_Argv( 2, arg, sizeof( arg ) );
+	maxDepth = atoi( arg );
+
+	totalGen = totalCompile = 0;
+	for ( depth = 1 ; depth <= maxDepth ; depth++ ) {
+		start = trap_Milliseconds();
+		arena = G_GenerateArena( seed, depth, THEME_TECH );
+		genTime = trap_Milliseconds() - start;
+		if ( !arena ) {
+			G_Printf( "depth %i: generation failed\n", depth );
+			break;
+		}
+
+		// compiling is cheap, repeat it to get below timer resolution
+		start = trap_Milliseconds();
+		for ( i = 0 ; i < ARENA_BENCH_COMPILES ; i++ ) {
+			if ( !G_CompileArena( arena ) ) {
+				break;
+			}
+		}
+		compileTime = trap_Milliseconds() - start;
+
+		G_Printf( "depth %2i: %2i rooms %4i brushes, generate %3i msec, compile %6.2f msec\n",
+			depth, arena->numRooms, arena->totalBrushes, genTime,
+			(float)compileTime / ARENA_BENCH_COMPILES );
+
+		totalGen += genTime;
+		totalCompile += compileTime;
+		G_FreeArena( arena );
+	}
+
+	G_Printf( "total: generate %i msec, compile %.2f msec\n",
+		totalGen, (float)totalCompile / ARENA_BENCH_COMPILES );
+}
+
+/*
+=================
+Svcmd_ArenaSoak_f
+
+Plays through many depths of a run back to back and checks that the
+region blocks all come back once the run is over
+Usage: arena_soak <seed> <depths>
+=================
+*/
+void Svcmd_ArenaSoak_f( void ) {
+	char arg[MAX_TOKEN_CHARS];
+	int seed, depths, i;
+	int baseline, peak, start;
+	roguelikeRun_t *run;
+
+	if ( trap_Argc() < 3 ) {
+		G_Printf( "Usage: arena_soak <seed> <depths>\n" );
+		return;
+	}
+
+	trap_Argv( 1, arg, sizeof( arg ) );
+	seed = atoi( arg );
+
+	trap_Argv( 2, arg, sizeof( arg ) );
+	depths = atoi( arg );
+
+	if ( G_GetCurrentRun() ) {
+		G_EndRoguelikeRun( G_GetCurrentRun(), qfalse );
+	}
+
+	start = trap_Milliseconds();
+	baseline = G_RegionBlocksInUse();
+	peak = baseline;
+
+	run = G_StartRoguelikeRun( seed, qfalse );
+	if ( !run ) {
+		G_Printf( "arena_soak: couldn't start a run\n" );
+		return;
+	}
+	for ( i = 1 ; i < depths ; i++ ) {
+		if ( !G_AdvanceToNextArena( run ) ) {
+			G_Printf( "arena_soak: failed at depth %i\n", run->currentDepth );
+			break;
+		}
+		if ( G_RegionBlocksInUse() > peak ) {
+			peak = G_RegionBlocksInUse();
+		}
+		if ( i % 10 == 0 ) {
+			G_Printf( "arena_soak: depth %i, %i region blocks in use\n",
+				run->currentDepth, G_RegionBlocksInUse() );
+		}
+	}
+	G_EndRoguelikeRun( run, qfalse );
+
+	G_Printf( "arena_soak: %i depths in %i msec, peak %i region blocks\n",
+		depths, trap_Milliseconds() - start, peak );
+	if ( G_RegionBlocksInUse() != baseline ) {
+		G_Printf( S_COLOR_RED "arena_soak: %i region blocks leaked\n", G_RegionBlocksInUse() - baseline );
+	} else {
+		G_Printf( "arena_soak: no region blocks leaked\n" );
+	}
+}
+
 /*
 =================
 Svcmd_StartRoguelike_f
@@ -595,6 +725,21 @@ qboolean	ConsoleCommand( void ) {
 		return qtrue;
 	}
 
+	if (Q_stricmp (cmd, "entindex_stress") == 0) {
+		Svcmd_EntityIndexStress_f();
+		return qtrue;
+	}
+
+	if (Q_stricmp (cmd, "pmove_record") == 0) {
+		Svcmd_PmoveRecord_f();
+		return qtrue;
+	}
+
+	if (Q_stricmp (cmd, "pmove_bench") == 0) {
+		Svcmd_PmoveBench_f();
+		return qtrue;
+	}
+
 	if (Q_stricmp (cmd, "addbot") == 0) {
 		Svcmd_AddBot_f();
 		return qtrue;
@@ -631,6 +776,16 @@ qboolean	ConsoleCommand( void ) {
 		return qtrue;
 	}
 
+	if (Q_stricmp (cmd, "arena_bench") == 0) {
+		Svcmd_ArenaBench_f();
+		return qtrue;
+	}
+
+	if (Q_stricmp (cmd, "arena_soak") == 0) {
+		Svcmd_ArenaSoak_f();
+		return qtrue;
+	}
+
 	if (Q_stricmp (cmd, "start_roguelike") == 0) {
 		Svcmd_StartRoguelike_f();
 		return qtrue;
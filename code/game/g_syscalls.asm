@@ -46,6 +46,11 @@ equ trap_SnapVector			-43
 equ trap_TraceCapsule		-44
 equ trap_EntityContactCapsule	-45
 equ trap_FS_Seek -46
+equ trap_LoadMapFromMemory	-47
+equ trap_TraceBatch	-48
+equ trap_EntitiesInRadius	-49
+equ trap_GetUsercmds	-50
+equ trap_LinkCount	-51
 
 equ	memset					-101
 equ	memcpy					-102
@@ -222,4 +227,7 @@ equ trap_BotLibLoadSource				-579
 equ trap_BotLibFreeSource				-580
 equ trap_BotLibReadToken				-581
 equ trap_BotLibSourceFileAndLine		-582
+
+equ trap_AAS_PointAreaNums				-583
+equ trap_AAS_AreaTravelTimesToGoalAreas	-584
  
@@ -176,10 +176,13 @@ qboolean trap_AreasConnected( int area1, int area2 ) {
 }
 
 void trap_LinkEntity( gentity_t *ent ) {
+	G_MovesAheadLinked( ent );
 	syscall( G_LINKENTITY, ent );
+	G_MovesAheadLinked( ent );
 }
 
 void trap_UnlinkEntity( gentity_t *ent ) {
+	G_MovesAheadLinked( ent );
 	syscall( G_UNLINKENTITY, ent );
 }
 
@@ -207,6 +210,18 @@ void trap_GetUsercmd( int clientNum, usercmd_t *cmd ) {
 	syscall( G_GET_USERCMD, clientNum, cmd );
 }
 
+int trap_GetUsercmds( int clientNum, usercmd_t *cmds, int maxcount ) {
+	return syscall( G_GET_USERCMDS, clientNum, cmds, maxcount );
+}
+
+int trap_LinkCount( void ) {
+	return syscall( G_LINK_COUNT );
+}
+
+void trap_RunJobs( void (*job)( int index ), int numJobs, int numThreads ) {
+	syscall( G_RUN_JOBS, job, numJobs, numThreads );
+}
+
 qboolean trap_GetEntityToken( char *buffer, int bufferSize ) {
 	return syscall( G_GET_ENTITY_TOKEN, buffer, bufferSize );
 }
@@ -228,6 +243,18 @@ void trap_SnapVector( float *v ) {
 	return;
 }
 
+void trap_LoadMapFromMemory( const char *name, int numBoxes, const boxBrush_t *boxes ) {
+	syscall( G_LOAD_MAP_FROM_MEMORY, name, numBoxes, boxes );
+}
+
+void trap_TraceBatch( const traceRequest_t *requests, trace_t *results, int count ) {
+	syscall( G_TRACE_BATCH, requests, results, count );
+}
+
+int trap_EntitiesInRadius( const vec3_t origin, float radius, int contentmask, int *list, int maxcount ) {
+	return syscall( G_ENTITIES_IN_RADIUS, origin, PASSFLOAT( radius ), contentmask, list, maxcount );
+}
+
 // BotLib traps start here
 int trap_BotLibSetup( void ) {
 	return syscall( BOTLIB_SETUP );
@@ -299,6 +326,10 @@ int trap_AAS_PointAreaNum(vec3_t point) {
 	return syscall( BOTLIB_AAS_POINT_AREA_NUM, point );
 }
 
+int trap_AAS_PointAreaNums(vec3_t *points, int *areanums, int numpoints) {
+	return syscall( BOTLIB_AAS_POINT_AREA_NUMS, points, areanums, numpoints );
+}
+
 int trap_AAS_PointReachabilityAreaIndex(vec3_t point) {
 	return syscall( BOTLIB_AAS_POINT_REACHABILITY_AREA_INDEX, point );
 }
@@ -347,6 +378,10 @@ int trap_AAS_AreaTravelTimeToGoalArea(int areanum, vec3_t origin, int goalareanu
 	return syscall( BOTLIB_AAS_AREA_TRAVEL_TIME_TO_GOAL_AREA, areanum, origin, goalareanum, travelflags );
 }
 
+int trap_AAS_AreaTravelTimesToGoalAreas(int *areanums, vec3_t *origins, int *goalareanums, int travelflags, int *traveltimes, int numqueries) {
+	return syscall( BOTLIB_AAS_AREA_TRAVEL_TIMES_TO_GOAL_AREAS, areanums, origins, goalareanums, travelflags, traveltimes, numqueries );
+}
+
 int trap_AAS_EnableRoutingArea( int areanum, int enable ) {
 	return syscall( BOTLIB_AAS_ENABLE_ROUTING_AREA, areanum, enable );
 }
@@ -145,19 +145,264 @@ void G_TeamCommand( team_t team, char *cmd ) {
 
 
 /*
-=============
-G_Find
+=============================================================================
 
-Searches all active entities for the next one that holds
-the matching string at fieldofs (use the FOFS() macro) in the structure.
+ENTITY INDEX
 
-Searches beginning at the entity after from, or the beginning if NULL
-NULL will be returned if the end of the list is reached.
+G_Find lookups by classname and targetname go through hash chains instead
+of scanning every entity.  Each chain is kept sorted by entity number, so
+walking the matches of a name visits them in the same order as a scan.
 
-=============
+The fields are plain pointers that get assigned all over the code, so the
+index never trusts itself: a lookup always checks the current string of a
+candidate.  Entities are indexed when they are spawned from the map, and
+everything that went through G_InitGentity this frame is re-indexed before
+each lookup, which covers the usual spawn-then-set-classname pattern.
+
+=============================================================================
 */
-gentity_t *G_Find (gentity_t *from, int fieldofs, const char *match)
-{
+
+#define	ENTINDEX_CLASSNAME		0
+#define	ENTINDEX_TARGETNAME		1
+#define	ENTINDEX_FIELDS			2
+#define	ENTINDEX_HASHSIZE		2048	// must be a power of two
+
+typedef struct {
+	const char	*name;			// string the entity was indexed with
+	int			hash;
+	int			prev, next;		// entity numbers, -1 ends the chain
+	qboolean	linked;
+} entityIndexLink_t;
+
+typedef struct {
+	int			head, tail;
+} entityIndexBucket_t;
+
+static entityIndexLink_t	indexLinks[ENTINDEX_FIELDS][MAX_GENTITIES];
+static entityIndexBucket_t	indexBuckets[ENTINDEX_FIELDS][ENTINDEX_HASHSIZE];
+
+// entities that went through G_InitGentity this frame
+static int			dirtyEntities[MAX_GENTITIES];
+static qboolean		entityDirty[MAX_GENTITIES];
+static int			numDirtyEntities;
+
+static int			indexLookups, indexSteps;
+
+/*
+================
+G_EntityIndexHash
+
+Case insensitive like the Q_stricmp in G_Find
+================
+*/
+static int G_EntityIndexHash( const char *name ) {
+	int		hash, c;
+
+	hash = 0;
+	while ( *name ) {
+		c = *name++;
+		if ( c >= 'A' && c <= 'Z' ) {
+			c += 'a' - 'A';
+		}
+		hash = hash * 31 + c;
+	}
+	return hash & 0x7fffffff;
+}
+
+/*
+================
+G_EntityIndexField
+================
+*/
+static const char *G_EntityIndexField( gentity_t *ent, int field ) {
+	if ( field == ENTINDEX_CLASSNAME ) {
+		return ent->classname;
+	}
+	return ent->targetname;
+}
+
+/*
+================
+G_UnlinkEntityIndex
+================
+*/
+static void G_UnlinkEntityIndex( int field, int num ) {
+	entityIndexLink_t	*link, *links;
+	entityIndexBucket_t	*bucket;
+
+	links = indexLinks[field];
+	link = &links[num];
+	if ( !link->linked ) {
+		return;
+	}
+	bucket = &indexBuckets[field][link->hash & ( ENTINDEX_HASHSIZE - 1 )];
+
+	if ( link->prev >= 0 ) {
+		links[link->prev].next = link->next;
+	} else {
+		bucket->head = link->next;
+	}
+	if ( link->next >= 0 ) {
+		links[link->next].prev = link->prev;
+	} else {
+		bucket->tail = link->prev;
+	}
+
+	link->linked = qfalse;
+	link->name = NULL;
+}
+
+/*
+================
+G_LinkEntityIndex
+
+New entities tend to have the highest numbers, so the sorted
+position is searched from the tail of the chain
+================
+*/
+static void G_LinkEntityIndex( int field, int num, const char *name ) {
+	entityIndexLink_t	*link, *links;
+	entityIndexBucket_t	*bucket;
+	int					after;
+
+	links = indexLinks[field];
+	link = &links[num];
+	if ( link->linked ) {
+		if ( link->name == name ) {
+			return;		// nothing changed
+		}
+		G_UnlinkEntityIndex( field, num );
+	}
+	if ( !name ) {
+		return;
+	}
+
+	link->name = name;
+	link->hash = G_EntityIndexHash( name );
+	bucket = &indexBuckets[field][link->hash & ( ENTINDEX_HASHSIZE - 1 )];
+
+	after = bucket->tail;
+	while ( after >= 0 && after > num ) {
+		after = links[after].prev;
+	}
+
+	link->prev = after;
+	if ( after >= 0 ) {
+		link->next = links[after].next;
+		links[after].next = num;
+	} else {
+		link->next = bucket->head;
+		bucket->head = num;
+	}
+	if ( link->next >= 0 ) {
+		links[link->next].prev = num;
+	} else {
+		bucket->tail = num;
+	}
+	link->linked = qtrue;
+}
+
+/*
+================
+G_InitEntityIndex
+================
+*/
+void G_InitEntityIndex( void ) {
+	int		i, j;
+
+	memset( indexLinks, 0, sizeof( indexLinks ) );
+	for ( i = 0 ; i < ENTINDEX_FIELDS ; i++ ) {
+		for ( j = 0 ; j < ENTINDEX_HASHSIZE ; j++ ) {
+			indexBuckets[i][j].head = -1;
+			indexBuckets[i][j].tail = -1;
+		}
+	}
+	memset( entityDirty, 0, sizeof( entityDirty ) );
+	numDirtyEntities = 0;
+	indexLookups = indexSteps = 0;
+}
+
+/*
+================
+G_IndexEntity
+
+Call after changing the classname or targetname of an entity
+outside of spawning
+================
+*/
+void G_IndexEntity( gentity_t *ent ) {
+	int		num;
+
+	num = ent - g_entities;
+	if ( !ent->inuse ) {
+		G_UnindexEntity( ent );
+		return;
+	}
+	G_LinkEntityIndex( ENTINDEX_CLASSNAME, num, ent->classname );
+	G_LinkEntityIndex( ENTINDEX_TARGETNAME, num, ent->targetname );
+}
+
+/*
+================
+G_UnindexEntity
+================
+*/
+void G_UnindexEntity( gentity_t *ent ) {
+	int		num;
+
+	num = ent - g_entities;
+	G_UnlinkEntityIndex( ENTINDEX_CLASSNAME, num );
+	G_UnlinkEntityIndex( ENTINDEX_TARGETNAME, num );
+}
+
+/*
+================
+G_MarkEntityIndexDirty
+================
+*/
+static void G_MarkEntityIndexDirty( gentity_t *ent ) {
+	int		num;
+
+	num = ent - g_entities;
+	if ( entityDirty[num] ) {
+		return;
+	}
+	entityDirty[num] = qtrue;
+	dirtyEntities[numDirtyEntities++] = num;
+}
+
+/*
+================
+G_UpdateEntityIndex
+
+Re-indexes everything initialized this frame.  With clearDirty
+the entities are considered settled, which G_RunFrame does once
+at the start of every frame.
+================
+*/
+void G_UpdateEntityIndex( qboolean clearDirty ) {
+	int		i, num;
+
+	for ( i = 0 ; i < numDirtyEntities ; i++ ) {
+		num = dirtyEntities[i];
+		G_IndexEntity( &g_entities[num] );
+		if ( clearDirty ) {
+			entityDirty[num] = qfalse;
+		}
+	}
+	if ( clearDirty ) {
+		numDirtyEntities = 0;
+	}
+}
+
+/*
+================
+G_FindLinear
+
+The original scan, used for fields that aren't indexed
+================
+*/
+static gentity_t *G_FindLinear( gentity_t *from, int fieldofs, const char *match ) {
 	char	*s;
 
 	if (!from)
@@ -179,6 +424,178 @@ gentity_t *G_Find (gentity_t *from, int fieldofs, const char *match)
 	return NULL;
 }
 
+/*
+=============
+G_Find
+
+Searches all active entities for the next one that holds
+the matching string at fieldofs (use the FOFS() macro) in the structure.
+
+Searches beginning at the entity after from, or the beginning if NULL
+NULL will be returned if the end of the list is reached.
+
+Classname and targetname searches go through the entity index.
+=============
+*/
+gentity_t *G_Find (gentity_t *from, int fieldofs, const char *match)
+{
+	entityIndexLink_t	*links;
+	gentity_t			*ent;
+	const char			*s;
+	int					field, hash, fromnum, num;
+
+	if ( fieldofs == FOFS(classname) ) {
+		field = ENTINDEX_CLASSNAME;
+	} else if ( fieldofs == FOFS(targetname) ) {
+		field = ENTINDEX_TARGETNAME;
+	} else {
+		return G_FindLinear( from, fieldofs, match );
+	}
+
+	G_UpdateEntityIndex( qfalse );
+	indexLookups++;
+
+	links = indexLinks[field];
+	hash = G_EntityIndexHash( match );
+	fromnum = from ? from - g_entities : -1;
+
+	// continuing a walk over the same name is the common case
+	if ( from && links[fromnum].linked && links[fromnum].hash == hash ) {
+		num = links[fromnum].next;
+	} else {
+		num = indexBuckets[field][hash & ( ENTINDEX_HASHSIZE - 1 )].head;
+		while ( num >= 0 && num <= fromnum ) {
+			num = links[num].next;
+		}
+	}
+
+	for ( ; num >= 0 ; num = links[num].next ) {
+		indexSteps++;
+		if ( links[num].hash != hash || num >= level.num_entities ) {
+			continue;
+		}
+		ent = &g_entities[num];
+		if ( !ent->inuse ) {
+			continue;
+		}
+		s = G_EntityIndexField( ent, field );
+		if ( !s ) {
+			continue;
+		}
+		if ( !Q_stricmp( s, match ) ) {
+			return ent;
+		}
+	}
+
+	return NULL;
+}
+
+/*
+=============
+Svcmd_EntityIndexStress_f
+
+Fills the free entity slots with chains of targets and checks that
+indexed lookups return exactly what a full scan returns
+Usage: entindex_stress [lookups]
+=============
+*/
+#define	STRESS_NAMES	64
+
+void Svcmd_EntityIndexStress_f( void ) {
+	static char	names[STRESS_NAMES][16];
+	gentity_t	*spawned[MAX_GENTITIES];
+	gentity_t	*a, *b;
+	char		arg[MAX_TOKEN_CHARS];
+	int			numSpawned, free, lookups, mismatches;
+	int			i, start, linearTime, indexTime, found;
+	const char	*name;
+
+	lookups = 10000;
+	if ( trap_Argc() >= 2 ) {
+		trap_Argv( 1, arg, sizeof( arg ) );
+		lookups = atoi( arg );
+	}
+
+	for ( i = 0 ; i < STRESS_NAMES ; i++ ) {
+		Com_sprintf( names[i], sizeof( names[i] ), "stress%i", i );
+	}
+
+	// take the free slots, leaving a few for the game itself
+	free = ENTITYNUM_MAX_NORMAL - level.num_entities;
+	for ( i = MAX_CLIENTS ; i < level.num_entities ; i++ ) {
+		if ( !g_entities[i].inuse ) {
+			free++;
+		}
+	}
+
+	for ( numSpawned = 0 ; numSpawned < free - 16 ; ) {
+		a = G_Spawn();
+		a->classname = "target_stress";
+		a->targetname = names[numSpawned % STRESS_NAMES];
+		a->target = names[( numSpawned + 1 ) % STRESS_NAMES];
+		spawned[numSpawned++] = a;
+	}
+	G_UpdateEntityIndex( qtrue );
+
+	// every name walked completely with both searches
+	mismatches = 0;
+	found = 0;
+	start = trap_Milliseconds();
+	for ( i = 0 ; i < lookups ; i++ ) {
+		name = names[i % STRESS_NAMES];
+		a = NULL;
+		while ( ( a = G_FindLinear( a, FOFS(targetname), name ) ) != NULL ) {
+			found++;
+		}
+	}
+	linearTime = trap_Milliseconds() - start;
+
+	start = trap_Milliseconds();
+	for ( i = 0 ; i < lookups ; i++ ) {
+		name = names[i % STRESS_NAMES];
+		a = NULL;
+		while ( ( a = G_Find( a, FOFS(targetname), name ) ) != NULL ) {
+			found--;
+		}
+	}
+	indexTime = trap_Milliseconds() - start;
+
+	for ( i = 0 ; i < STRESS_NAMES ; i++ ) {
+		a = b = NULL;
+		do {
+			a = G_FindLinear( a, FOFS(targetname), names[i] );
+			b = G_Find( b, FOFS(targetname), names[i] );
+			if ( a != b ) {
+				mismatches++;
+				break;
+			}
+		} while ( a );
+	}
+	a = b = NULL;
+	do {
+		a = G_FindLinear( a, FOFS(classname), "target_stress" );
+		b = G_Find( b, FOFS(classname), "TARGET_STRESS" );
+		if ( a != b ) {
+			mismatches++;
+			break;
+		}
+	} while ( a );
+
+	for ( i = 0 ; i < numSpawned ; i++ ) {
+		G_FreeEntity( spawned[i] );
+	}
+
+	G_Printf( "%i entities, %i names, %i walks: scan %i msec, index %i msec\n",
+		numSpawned, STRESS_NAMES, lookups, linearTime, indexTime );
+	G_Printf( "%i lookups averaged %.2f chain steps\n",
+		indexLookups, indexLookups ? (float)indexSteps / indexLookups : 0 );
+	if ( mismatches || found ) {
+		G_Printf( S_COLOR_RED "entity index disagrees with the scan\n" );
+	} else {
+		G_Printf( "entity index matches the scan\n" );
+	}
+}
+
 
 /*
 =============
@@ -364,11 +781,123 @@ float vectoyaw( const vec3_t vec ) {
 }
 
 
+/*
+=============================================================================
+
+ENTITY ALLOCATION
+
+Freed slots go into a queue in the order they were freed, which is also
+the order in which they become reusable, so G_Spawn only ever has to look
+at the head.
+
+=============================================================================
+*/
+
+#define	FREEQUEUE_SIZE		(MAX_GENTITIES * 2)	// power of two, room for stale entries
+
+typedef struct {
+	int			num;
+	int			freetime;		// stale if the entity was reused or freed again since
+} freeEntity_t;
+
+static freeEntity_t	freeQueue[FREEQUEUE_SIZE];
+static int			freeHead, freeTail;		// tail - head entries are queued
+
+typedef struct {
+	int			spawns, frees;			// this frame
+	int			peakSpawns, peakFrees;	// worst frame of the reporting period
+	int			totalSpawns, totalFrees;
+	int			newSlots, forced;
+	int			nextReport;
+} entityStats_t;
+
+static entityStats_t	entityStats;
+
+/*
+=================
+G_InitEntityAllocator
+=================
+*/
+void G_InitEntityAllocator( void ) {
+	freeHead = freeTail = 0;
+	memset( &entityStats, 0, sizeof( entityStats ) );
+}
+
+/*
+=================
+G_FreeQueueEntryValid
+=================
+*/
+static qboolean G_FreeQueueEntryValid( freeEntity_t *f ) {
+	gentity_t	*e;
+
+	e = &g_entities[f->num];
+	return !e->inuse && e->freetime == f->freetime;
+}
+
+/*
+=================
+G_QueueFreeEntity
+=================
+*/
+static void G_QueueFreeEntity( gentity_t *e ) {
+	freeEntity_t	*f;
+	int				i, count;
+
+	if ( freeTail - freeHead == FREEQUEUE_SIZE ) {
+		// full of entries for slots freed more than once, squeeze them out
+		count = freeTail - freeHead;
+		freeTail = freeHead;
+		for ( i = 0 ; i < count ; i++ ) {
+			f = &freeQueue[( freeHead + i ) & ( FREEQUEUE_SIZE - 1 )];
+			if ( G_FreeQueueEntryValid( f ) ) {
+				freeQueue[freeTail++ & ( FREEQUEUE_SIZE - 1 )] = *f;
+			}
+		}
+	}
+
+	f = &freeQueue[freeTail++ & ( FREEQUEUE_SIZE - 1 )];
+	f->num = e - g_entities;
+	f->freetime = e->freetime;
+}
+
+/*
+=================
+G_ReusableEntity
+
+Takes the oldest free slot off the queue if it may be reused
+=================
+*/
+static gentity_t *G_ReusableEntity( qboolean force ) {
+	freeEntity_t	*f;
+
+	while ( freeHead != freeTail ) {
+		f = &freeQueue[freeHead & ( FREEQUEUE_SIZE - 1 )];
+		if ( !G_FreeQueueEntryValid( f ) ) {
+			freeHead++;
+			continue;
+		}
+
+		// the first couple seconds of server time can involve a lot of
+		// freeing and allocating, so relax the replacement policy
+		if ( !force && f->freetime > level.startTime + 2000 && level.time - f->freetime < 1000 ) {
+			return NULL;	// everything behind it was freed even later
+		}
+
+		freeHead++;
+		return &g_entities[f->num];
+	}
+	return NULL;
+}
+
 void G_InitGentity( gentity_t *e ) {
 	e->inuse = qtrue;
 	e->classname = "noclass";
 	e->s.number = e - g_entities;
 	e->r.ownerNum = ENTITYNUM_NONE;
+
+	// the names are usually set right after this
+	G_MarkEntityIndexDirty( e );
 }
 
 /*
@@ -387,35 +916,27 @@ angles and bad trails.
 =================
 */
 gentity_t *G_Spawn( void ) {
-	int			i, force;
+	int			i;
 	gentity_t	*e;
 
-	e = NULL;	// shut up warning
-	i = 0;		// shut up warning
-	for ( force = 0 ; force < 2 ; force++ ) {
-		// if we go through all entities and can't find one to free,
-		// override the normal minimum times before use
-		e = &g_entities[MAX_CLIENTS];
-		for ( i = MAX_CLIENTS ; i<level.num_entities ; i++, e++) {
-			if ( e->inuse ) {
-				continue;
-			}
+	entityStats.spawns++;
 
-			// the first couple seconds of server time can involve a lot of
-			// freeing and allocating, so relax the replacement policy
-			if ( !force && e->freetime > level.startTime + 2000 && level.time - e->freetime < 1000 ) {
-				continue;
-			}
+	e = G_ReusableEntity( qfalse );
+	if ( e ) {
+		G_InitGentity( e );
+		return e;
+	}
 
-			// reuse this slot
+	if ( level.num_entities == ENTITYNUM_MAX_NORMAL ) {
+		// if no slot has been free long enough, override the
+		// normal minimum times before use
+		e = G_ReusableEntity( qtrue );
+		if ( e ) {
+			entityStats.forced++;
 			G_InitGentity( e );
 			return e;
 		}
-		if ( i != MAX_GENTITIES ) {
-			break;
-		}
-	}
-	if ( i == ENTITYNUM_MAX_NORMAL ) {
+
 		for (i = 0; i < MAX_GENTITIES; i++) {
 			G_Printf("%4i: %s\n", i, g_entities[i].classname);
 		}
@@ -423,7 +944,9 @@ gentity_t *G_Spawn( void ) {
 	}
 	
 	// open up a new slot
+	e = &g_entities[level.num_entities];
 	level.num_entities++;
+	entityStats.newSlots++;
 
 	// let the server system know that there are more entities
 	trap_LocateGameData( level.gentities, level.num_entities, sizeof( gentity_t ), 
@@ -433,22 +956,63 @@ gentity_t *G_Spawn( void ) {
 	return e;
 }
 
+/*
+=================
+G_EntityFrameStats
+
+Called at the end of every frame, g_entityStats prints
+a summary once a second
+=================
+*/
+void G_EntityFrameStats( void ) {
+	entityStats_t	*st;
+	int				i, inuse;
+
+	st = &entityStats;
+	st->totalSpawns += st->spawns;
+	st->totalFrees += st->frees;
+	if ( st->spawns > st->peakSpawns ) {
+		st->peakSpawns = st->spawns;
+	}
+	if ( st->frees > st->peakFrees ) {
+		st->peakFrees = st->frees;
+	}
+	st->spawns = st->frees = 0;
+
+	if ( !g_entityStats.integer || level.time < st->nextReport ) {
+		return;
+	}
+	st->nextReport = level.time + 1000;
+
+	inuse = 0;
+	for ( i = 0 ; i < level.num_entities ; i++ ) {
+		if ( g_entities[i].inuse ) {
+			inuse++;
+		}
+	}
+
+	G_Printf( "entities: %i spawned, %i freed, peak %i/%i per frame, %i new slots, %i forced, "
+		"%i queued, %i of %i slots in use\n",
+		st->totalSpawns, st->totalFrees, st->peakSpawns, st->peakFrees, st->newSlots, st->forced,
+		freeTail - freeHead, inuse, level.num_entities );
+
+	st->totalSpawns = st->totalFrees = 0;
+	st->peakSpawns = st->peakFrees = 0;
+	st->newSlots = st->forced = 0;
+}
+
 /*
 =================
 G_EntitiesFree
 =================
 */
 qboolean G_EntitiesFree( void ) {
-	int			i;
-	gentity_t	*e;
-
-	e = &g_entities[MAX_CLIENTS];
-	for ( i = MAX_CLIENTS; i < level.num_entities; i++, e++) {
-		if ( e->inuse ) {
-			continue;
+	// drop the stale entries in front, a valid head means a free slot
+	while ( freeHead != freeTail ) {
+		if ( G_FreeQueueEntryValid( &freeQueue[freeHead & ( FREEQUEUE_SIZE - 1 )] ) ) {
+			return qtrue;
 		}
-		// slot available
-		return qtrue;
+		freeHead++;
 	}
 	return qfalse;
 }
@@ -462,16 +1026,24 @@ Marks the entity as free
 =================
 */
 void G_FreeEntity( gentity_t *ed ) {
+	if ( ed->r.linked && ed->r.contents ) {
+		G_InvalidateMissileTraces();
+	}
 	trap_UnlinkEntity (ed);		// unlink from world
 
 	if ( ed->neverFree ) {
 		return;
 	}
 
+	G_UnindexEntity( ed );
+
 	memset (ed, 0, sizeof(*ed));
 	ed->classname = "freed";
 	ed->freetime = level.time;
 	ed->inuse = qfalse;
+
+	entityStats.frees++;
+	G_QueueFreeEntity( ed );
 }
 
 /*
@@ -5,6 +5,8 @@ set INCLUDE=
 mkdir vm
 cd vm
 set cc=lcc -DQ3_VM -S -Wf-target=bytecode -Wf-g -I..\..\cgame -I..\..\game -I..\..\ui %1
+rem set MAX_CLIENTS to 128 or 256 for a raised player limit, the engine has to match
+if not "%MAX_CLIENTS%"=="" set cc=%cc% -DMAX_CLIENTS=%MAX_CLIENTS%
 
 %cc%  ../g_main.c
 @if errorlevel 1 goto quit
@@ -60,6 +62,8 @@ set cc=lcc -DQ3_VM -S -Wf-target=bytecode -Wf-g -I..\..\cgame -I..\..\game -I..\
 @if errorlevel 1 goto quit
 %cc%  ../g_mover.c
 @if errorlevel 1 goto quit
+%cc%  ../g_pmove_bench.c
+@if errorlevel 1 goto quit
 %cc%  ../g_session.c
 @if errorlevel 1 goto quit
 %cc%  ../g_spawn.c
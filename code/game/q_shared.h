@@ -120,6 +120,15 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 #define	QDECL
 
+// a separate copy of the variable for every thread, see Sys_RunJobs
+#if defined( Q3_VM )
+#define	Q_THREADLOCAL
+#elif defined( _MSC_VER )
+#define	Q_THREADLOCAL	__declspec( thread )
+#else
+#define	Q_THREADLOCAL	__thread
+#endif
+
 short   ShortSwap (short l);
 int		LongSwap (int l);
 float	FloatSwap (const float *f);
@@ -1031,6 +1040,14 @@ typedef struct {
 // trace->entityNum can also be 0 to (MAX_GENTITIES-1)
 // or ENTITYNUM_NONE, ENTITYNUM_WORLD
 
+// an axial box handed to CM_LoadMapFromMemory, used to build the
+// clip model for runtime generated worlds without a bsp file
+typedef struct {
+	vec3_t		mins, maxs;
+	int			contents;
+	int			surfaceFlags;
+} boxBrush_t;
+
 
 // markfragments are returned by CM_MarkFragments()
 typedef struct {
@@ -1089,7 +1106,15 @@ typedef enum {
 //
 // per-level limits
 //
-#define	MAX_CLIENTS			64		// absolute limit
+#ifndef MAX_CLIENTS
+#define	MAX_CLIENTS			64		// absolute limit, can be raised at build time
+#endif
+#if MAX_CLIENTS > 256
+#error MAX_CLIENTS > 256: client numbers are sent over the net as 8 bits
+#endif
+#if MAX_CLIENTS != 64 && MAX_CLIENTS != 128 && MAX_CLIENTS != 256
+#error MAX_CLIENTS has to be 64, 128 or 256, each has its own protocol version
+#endif
 #define MAX_LOCATIONS		64
 
 #define	GENTITYNUM_BITS		10		// don't need to send any more
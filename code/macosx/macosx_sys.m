@@ -495,6 +495,30 @@ void Sys_StreamSeek( fileHandle_t f, int offset, int origin ) {
 	FS_Seek( f, offset, origin );
 }
 
+qboolean Sys_BeginStreamedWrite( fileHandle_t f, int bufferSize ) {
+	return qfalse;
+}
+
+qboolean Sys_StreamedWrite( const void *buffer, int len, fileHandle_t f ) {
+	return FS_Write( buffer, len, f ) == len;
+}
+
+qboolean Sys_EndStreamedWrite( fileHandle_t f ) {
+	return qtrue;
+}
+
+void Sys_RunJobs( void (*job)( int index ), int numJobs, int numThreads ) {
+	int		i;
+
+	for ( i = 0 ; i < numJobs ; i++ ) {
+		job( i );
+	}
+}
+
+int Sys_ThreadNum( void ) {
+	return 0;
+}
+
 
 void OutputDebugString(char * s)
 {
@@ -6,6 +6,8 @@ mkdir vm
 cd vm
 
 set cc=lcc -DQ3_VM -S -Wf-target=bytecode -Wf-g -I..\..\cgame -I..\..\game -I..\..\q3_ui %1
+rem set MAX_CLIENTS to 128 or 256 for a raised player limit, the engine has to match
+if not "%MAX_CLIENTS%"=="" set cc=%cc% -DMAX_CLIENTS=%MAX_CLIENTS%
 
 lcc -DQ3_VM -S -Wf-target=bytecode -Wf-g -I..\..\cgame -I..\..\game -I..\..\q3_ui ../ui_main.c
 @if errorlevel 1 goto quit
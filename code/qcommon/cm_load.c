@@ -42,11 +42,12 @@ void SetPlaneSignbits (cplane_t *out) {
 #endif //BSPC
 
 // to allow boxes to be treated as brush models, we allocate
-// some extra indexes along with those needed by the map
-#define	BOX_BRUSHES		1
-#define	BOX_SIDES		6
+// some extra indexes along with those needed by the map,
+// one box for every thread that can trace
+#define	BOX_BRUSHES		CM_MAX_THREADS
+#define	BOX_SIDES		(6*CM_MAX_THREADS)
 #define	BOX_LEAFS		2
-#define	BOX_PLANES		12
+#define	BOX_PLANES		(12*CM_MAX_THREADS)
 
 #define	LL(x) x=LittleLong(x)
 
@@ -62,11 +63,12 @@ byte		*cmod_base;
 cvar_t		*cm_noAreas;
 cvar_t		*cm_noCurves;
 cvar_t		*cm_playerCurveClip;
+cvar_t		*cm_debugSurfaceUpdate;		// registered here, traces can run on other threads
 #endif
 
-cmodel_t	box_model;
-cplane_t	*box_planes;
-cbrush_t	*box_brush;
+cmodel_t	box_models[CM_MAX_THREADS];
+cplane_t	*box_planes[CM_MAX_THREADS];
+cbrush_t	*box_brushes[CM_MAX_THREADS];
 
 
 
@@ -559,6 +561,414 @@ unsigned CM_Checksum(dheader_t *header) {
 	return LittleLong(Com_BlockChecksum(checksums, 11 * 4));
 }
 
+#ifndef BSPC
+/*
+===============================================================================
+
+					MAP GENERATION FROM MEMORY
+
+Runtime generated worlds hand the collision model over as a list of axial
+boxes.  There is no bsp compile, so the boxes are sorted into a simple kd
+tree of axial nodes instead, and every leaf shares cluster and area 0,
+which leaves pvs and area portals effectively disabled.
+
+===============================================================================
+*/
+
+#define	MEMORY_LEAF_BRUSHES		4		// stop splitting once a leaf holds this few boxes
+#define	MEMORY_MAX_DEPTH		32
+#define	MEMORY_ALIGN(x)			(((x) + 15) & ~15)
+
+typedef struct {
+	int			axis;
+	float		dist;
+	int			children[2];
+} memoryNode_t;
+
+typedef struct {
+	const boxBrush_t	*boxes;
+
+	int			numNodes, maxNodes;
+	memoryNode_t	*nodes;
+
+	int			numLeafs, maxLeafs;
+	cLeaf_t		*leafs;
+
+	int			numLeafBrushes, maxLeafBrushes;
+	int			*leafbrushes;
+} memoryTree_t;
+
+static byte	*cm_memoryMap;		// single block holding all the arrays of a memory map
+
+/*
+=================
+CM_FreeMemoryMap
+=================
+*/
+static void CM_FreeMemoryMap( void ) {
+	if ( cm_memoryMap ) {
+		Z_Free( cm_memoryMap );
+		cm_memoryMap = NULL;
+	}
+}
+
+/*
+=================
+CM_GrowMemoryArray
+
+Makes room for at least one more element in a temporary build array
+=================
+*/
+static void *CM_GrowMemoryArray( void *array, int count, int *max, int size ) {
+	void	*grown;
+
+	if ( count < *max ) {
+		return array;
+	}
+	*max = *max ? *max * 2 : 64;
+	grown = Z_Malloc( *max * size );
+	if ( array ) {
+		Com_Memcpy( grown, array, count * size );
+		Z_Free( array );
+	}
+	return grown;
+}
+
+/*
+=================
+CM_CompareFloats
+=================
+*/
+static int CM_CompareFloats( const void *a, const void *b ) {
+	float	fa, fb;
+
+	fa = *(const float *)a;
+	fb = *(const float *)b;
+	if ( fa < fb ) {
+		return -1;
+	}
+	if ( fa > fb ) {
+		return 1;
+	}
+	return 0;
+}
+
+/*
+=================
+CM_EmitMemoryLeaf
+=================
+*/
+static int CM_EmitMemoryLeaf( memoryTree_t *t, const int *list, int count ) {
+	cLeaf_t		*leaf;
+	int			i;
+
+	t->leafs = CM_GrowMemoryArray( t->leafs, t->numLeafs, &t->maxLeafs, sizeof( *t->leafs ) );
+	leaf = &t->leafs[t->numLeafs];
+	Com_Memset( leaf, 0, sizeof( *leaf ) );
+	leaf->firstLeafBrush = t->numLeafBrushes;
+	leaf->numLeafBrushes = count;
+
+	for ( i = 0 ; i < count ; i++ ) {
+		t->leafbrushes = CM_GrowMemoryArray( t->leafbrushes, t->numLeafBrushes,
+			&t->maxLeafBrushes, sizeof( *t->leafbrushes ) );
+		t->leafbrushes[t->numLeafBrushes++] = list[i];
+	}
+
+	return -1 - t->numLeafs++;
+}
+
+/*
+=================
+CM_BuildMemoryTree_r
+
+Splits the boxes at the median of their centers along the longest axis
+of the node.  Boxes crossing the split plane are referenced from both
+sides, the trace checkcount keeps them from being tested twice.
+Returns a node number, or -1 - leafnum.
+=================
+*/
+static int CM_BuildMemoryTree_r( memoryTree_t *t, const int *list, int count,
+								vec3_t mins, vec3_t maxs, int depth ) {
+	const boxBrush_t	*box;
+	float		*centers;
+	float		dist;
+	int			*front, *back;
+	int			numFront, numBack;
+	int			axis, nodenum, child, i;
+	vec3_t		childMins, childMaxs;
+
+	if ( count <= MEMORY_LEAF_BRUSHES || depth >= MEMORY_MAX_DEPTH ) {
+		return CM_EmitMemoryLeaf( t, list, count );
+	}
+
+	axis = 0;
+	for ( i = 1 ; i < 3 ; i++ ) {
+		if ( maxs[i] - mins[i] > maxs[axis] - mins[axis] ) {
+			axis = i;
+		}
+	}
+
+	centers = Z_Malloc( count * sizeof( *centers ) );
+	for ( i = 0 ; i < count ; i++ ) {
+		box = &t->boxes[list[i]];
+		centers[i] = ( box->mins[axis] + box->maxs[axis] ) * 0.5f;
+	}
+	qsort( centers, count, sizeof( *centers ), CM_CompareFloats );
+	dist = centers[count / 2];
+	Z_Free( centers );
+
+	if ( dist <= mins[axis] || dist >= maxs[axis] ) {
+		dist = ( mins[axis] + maxs[axis] ) * 0.5f;
+	}
+
+	// a point exactly on the plane is classified to the front
+	front = Z_Malloc( count * sizeof( *front ) );
+	back = Z_Malloc( count * sizeof( *back ) );
+	numFront = numBack = 0;
+	for ( i = 0 ; i < count ; i++ ) {
+		box = &t->boxes[list[i]];
+		if ( box->maxs[axis] >= dist ) {
+			front[numFront++] = list[i];
+		}
+		if ( box->mins[axis] < dist ) {
+			back[numBack++] = list[i];
+		}
+	}
+
+	if ( numFront == count && numBack == count ) {
+		// every box crosses the plane, splitting won't help
+		Z_Free( back );
+		Z_Free( front );
+		return CM_EmitMemoryLeaf( t, list, count );
+	}
+
+	t->nodes = CM_GrowMemoryArray( t->nodes, t->numNodes, &t->maxNodes, sizeof( *t->nodes ) );
+	nodenum = t->numNodes++;
+	t->nodes[nodenum].axis = axis;
+	t->nodes[nodenum].dist = dist;
+
+	// the node array may move while the children are built
+	VectorCopy( mins, childMins );
+	VectorCopy( maxs, childMaxs );
+	childMins[axis] = dist;
+	child = CM_BuildMemoryTree_r( t, front, numFront, childMins, maxs, depth + 1 );
+	t->nodes[nodenum].children[0] = child;
+	childMaxs[axis] = dist;
+	child = CM_BuildMemoryTree_r( t, back, numBack, mins, childMaxs, depth + 1 );
+	t->nodes[nodenum].children[1] = child;
+
+	Z_Free( back );
+	Z_Free( front );
+
+	return nodenum;
+}
+
+/*
+==================
+CM_LoadMapFromMemory
+
+Builds the clip model of a runtime generated world.  The world has a
+single inline model, no patches and no entity string, so anything that
+referenced inline models of the previous map must be gone before this
+is called.
+==================
+*/
+void CM_LoadMapFromMemory( const char *name, int numBoxes, const boxBrush_t *boxes ) {
+	memoryTree_t	tree;
+	int				*list;
+	int				i, j, root;
+	int				numPlanes, numSides, numNodes;
+	int				size, ofs;
+	vec3_t			mins, maxs;
+	cplane_t		*plane;
+	cbrushside_t	*side;
+	cbrush_t		*brush;
+	cNode_t			*node;
+	int				start;
+
+	if ( !name || !name[0] ) {
+		Com_Error( ERR_DROP, "CM_LoadMapFromMemory: NULL name" );
+	}
+	if ( numBoxes < 0 || ( numBoxes && !boxes ) ) {
+		Com_Error( ERR_DROP, "CM_LoadMapFromMemory: bad box list" );
+	}
+
+	cm_noAreas = Cvar_Get ("cm_noAreas", "0", CVAR_CHEAT);
+	cm_noCurves = Cvar_Get ("cm_noCurves", "0", CVAR_CHEAT);
+	cm_playerCurveClip = Cvar_Get ("cm_playerCurveClip", "1", CVAR_ARCHIVE|CVAR_CHEAT );
+	cm_debugSurfaceUpdate = Cvar_Get( "r_debugSurfaceUpdate", "1", 0 );
+	Com_DPrintf( "CM_LoadMapFromMemory( %s, %i )\n", name, numBoxes );
+
+	start = Sys_Milliseconds();
+
+	// world bounds
+	ClearBounds( mins, maxs );
+	for ( i = 0 ; i < numBoxes ; i++ ) {
+		AddPointToBounds( boxes[i].mins, mins, maxs );
+		AddPointToBounds( boxes[i].maxs, mins, maxs );
+	}
+	if ( !numBoxes ) {
+		VectorClear( mins );
+		VectorClear( maxs );
+	}
+
+	// sort the boxes into the tree
+	Com_Memset( &tree, 0, sizeof( tree ) );
+	tree.boxes = boxes;
+	list = Z_Malloc( ( numBoxes + 1 ) * sizeof( *list ) );
+	for ( i = 0 ; i < numBoxes ; i++ ) {
+		list[i] = i;
+	}
+	root = CM_BuildMemoryTree_r( &tree, list, numBoxes, mins, maxs, 0 );
+	Z_Free( list );
+
+	// the tree walks need at least one node
+	numNodes = tree.numNodes;
+	if ( root < 0 ) {
+		numNodes = 1;
+	}
+	numPlanes = numBoxes * 6 + numNodes;
+	numSides = numBoxes * 6;
+
+	// free old stuff
+	CM_FreeMemoryMap();
+	Com_Memset( &cm, 0, sizeof( cm ) );
+	CM_ClearLevelPatches();
+
+	size = MEMORY_ALIGN( sizeof( *cm.shaders ) )
+		+ MEMORY_ALIGN( ( numPlanes + BOX_PLANES ) * sizeof( *cm.planes ) )
+		+ MEMORY_ALIGN( ( numSides + BOX_SIDES ) * sizeof( *cm.brushsides ) )
+		+ MEMORY_ALIGN( ( numBoxes + BOX_BRUSHES ) * sizeof( *cm.brushes ) )
+		+ MEMORY_ALIGN( ( tree.numLeafs + BOX_LEAFS ) * sizeof( *cm.leafs ) )
+		+ MEMORY_ALIGN( ( tree.numLeafBrushes + BOX_BRUSHES ) * sizeof( *cm.leafbrushes ) )
+		+ MEMORY_ALIGN( numNodes * sizeof( *cm.nodes ) )
+		+ MEMORY_ALIGN( sizeof( *cm.cmodels ) )
+		+ MEMORY_ALIGN( sizeof( *cm.areas ) )
+		+ MEMORY_ALIGN( sizeof( *cm.areaPortals ) )
+		+ MEMORY_ALIGN( 32 )	// visibility
+		+ MEMORY_ALIGN( 1 );	// entity string
+
+	cm_memoryMap = Z_Malloc( size );
+	ofs = 0;
+#define	MEMORY_CARVE(p, count)	( p = (void *)( cm_memoryMap + ofs ), ofs += MEMORY_ALIGN( (count) * sizeof( *p ) ) )
+
+	MEMORY_CARVE( cm.shaders, 1 );
+	MEMORY_CARVE( cm.planes, numPlanes + BOX_PLANES );
+	MEMORY_CARVE( cm.brushsides, numSides + BOX_SIDES );
+	MEMORY_CARVE( cm.brushes, numBoxes + BOX_BRUSHES );
+	MEMORY_CARVE( cm.leafs, tree.numLeafs + BOX_LEAFS );
+	MEMORY_CARVE( cm.leafbrushes, tree.numLeafBrushes + BOX_BRUSHES );
+	MEMORY_CARVE( cm.nodes, numNodes );
+	MEMORY_CARVE( cm.cmodels, 1 );
+	MEMORY_CARVE( cm.areas, 1 );
+	MEMORY_CARVE( cm.areaPortals, 1 );
+	MEMORY_CARVE( cm.visibility, 32 );
+	MEMORY_CARVE( cm.entityString, 1 );
+#undef MEMORY_CARVE
+
+	Q_strncpyz( cm.shaders[0].shader, "noshader", sizeof( cm.shaders[0].shader ) );
+	cm.shaders[0].contentFlags = CONTENTS_SOLID;
+	cm.numShaders = 1;
+
+	// brushes, with the side order CM_BoundBrush expects
+	for ( i = 0 ; i < numBoxes ; i++ ) {
+		brush = &cm.brushes[i];
+		brush->shaderNum = 0;
+		brush->contents = boxes[i].contents;
+		brush->numsides = 6;
+		brush->sides = &cm.brushsides[i * 6];
+
+		for ( j = 0 ; j < 6 ; j++ ) {
+			plane = &cm.planes[i * 6 + j];
+			VectorClear( plane->normal );
+			if ( j & 1 ) {
+				plane->normal[j >> 1] = 1;
+				plane->dist = boxes[i].maxs[j >> 1];
+			} else {
+				plane->normal[j >> 1] = -1;
+				plane->dist = -boxes[i].mins[j >> 1];
+			}
+			plane->type = PlaneTypeForNormal( plane->normal );
+			SetPlaneSignbits( plane );
+
+			side = &brush->sides[j];
+			side->plane = plane;
+			side->shaderNum = 0;
+			side->surfaceFlags = boxes[i].surfaceFlags;
+		}
+
+		CM_BoundBrush( brush );
+	}
+	cm.numBrushes = numBoxes;
+	cm.numBrushSides = numSides;
+
+	// nodes, each with its own axial plane after the brush planes
+	for ( i = 0 ; i < tree.numNodes ; i++ ) {
+		plane = &cm.planes[numBoxes * 6 + i];
+		VectorClear( plane->normal );
+		plane->normal[tree.nodes[i].axis] = 1;
+		plane->dist = tree.nodes[i].dist;
+		plane->type = tree.nodes[i].axis;
+		plane->signbits = 0;
+
+		node = &cm.nodes[i];
+		node->plane = plane;
+		node->children[0] = tree.nodes[i].children[0];
+		node->children[1] = tree.nodes[i].children[1];
+	}
+	if ( root < 0 ) {
+		// a lone leaf, hang it from both sides of a dummy node
+		plane = &cm.planes[numBoxes * 6];
+		plane->normal[0] = 1;
+		plane->type = PLANE_X;
+		cm.nodes[0].plane = plane;
+		cm.nodes[0].children[0] = root;
+		cm.nodes[0].children[1] = root;
+	}
+	cm.numNodes = numNodes;
+	cm.numPlanes = numPlanes;
+
+	Com_Memcpy( cm.leafs, tree.leafs, tree.numLeafs * sizeof( *cm.leafs ) );
+	cm.numLeafs = tree.numLeafs;
+	Com_Memcpy( cm.leafbrushes, tree.leafbrushes, tree.numLeafBrushes * sizeof( *cm.leafbrushes ) );
+	cm.numLeafBrushes = tree.numLeafBrushes;
+
+	if ( tree.nodes ) {
+		Z_Free( tree.nodes );
+	}
+	if ( tree.leafs ) {
+		Z_Free( tree.leafs );
+	}
+	if ( tree.leafbrushes ) {
+		Z_Free( tree.leafbrushes );
+	}
+
+	// spread the world bounds by a pixel like CMod_LoadSubmodels
+	for ( i = 0 ; i < 3 ; i++ ) {
+		cm.cmodels[0].mins[i] = mins[i] - 1;
+		cm.cmodels[0].maxs[i] = maxs[i] + 1;
+	}
+	cm.numSubModels = 1;
+
+	// no vis, a single cluster and area
+	cm.numClusters = 1;
+	cm.clusterBytes = 32;
+	Com_Memset( cm.visibility, 255, cm.clusterBytes );
+	cm.numAreas = 1;
+	cm.entityString[0] = 0;
+	cm.numEntityChars = 1;
+
+	CM_InitBoxHull ();
+
+	CM_FloodAreaConnections ();
+
+	Q_strncpyz( cm.name, name, sizeof( cm.name ) );
+
+	Com_DPrintf( "%i boxes, %i nodes, %i leafs, %i leafbrushes in %i msec\n",
+		numBoxes, cm.numNodes, cm.numLeafs, cm.numLeafBrushes, Sys_Milliseconds() - start );
+}
+#endif
+
 /*
 ==================
 CM_LoadMap
@@ -581,6 +991,7 @@ void CM_LoadMap( const char *name, qboolean clientload, int *checksum ) {
 	cm_noAreas = Cvar_Get ("cm_noAreas", "0", CVAR_CHEAT);
 	cm_noCurves = Cvar_Get ("cm_noCurves", "0", CVAR_CHEAT);
 	cm_playerCurveClip = Cvar_Get ("cm_playerCurveClip", "1", CVAR_ARCHIVE|CVAR_CHEAT );
+	cm_debugSurfaceUpdate = Cvar_Get( "r_debugSurfaceUpdate", "1", 0 );
 #endif
 	Com_DPrintf( "CM_LoadMap( %s, %i )\n", name, clientload );
 
@@ -590,6 +1001,9 @@ void CM_LoadMap( const char *name, qboolean clientload, int *checksum ) {
 	}
 
 	// free old stuff
+#ifndef BSPC
+	CM_FreeMemoryMap();
+#endif
 	Com_Memset( &cm, 0, sizeof( cm ) );
 	CM_ClearLevelPatches();
 
@@ -663,6 +1077,9 @@ CM_ClearMap
 ==================
 */
 void CM_ClearMap( void ) {
+#ifndef BSPC
+	CM_FreeMemoryMap();
+#endif
 	Com_Memset( &cm, 0, sizeof( cm ) );
 	CM_ClearLevelPatches();
 }
@@ -680,7 +1097,7 @@ cmodel_t	*CM_ClipHandleToModel( clipHandle_t handle ) {
 		return &cm.cmodels[handle];
 	}
 	if ( handle == BOX_MODEL_HANDLE ) {
-		return &box_model;
+		return &box_models[CM_ThreadNum()];
 	}
 	if ( handle < MAX_SUBMODELS ) {
 		Com_Error( ERR_DROP, "CM_ClipHandleToModel: bad handle %i < %i < %i", 
@@ -739,51 +1156,57 @@ CM_InitBoxHull
 
 Set up the planes and nodes so that the six floats of a bounding box
 can just be stored out and get a proper clipping hull structure.
+Every thread that can trace gets a box of its own.
 ===================
 */
 void CM_InitBoxHull (void)
 {
-	int			i;
+	int			i, t;
 	int			side;
 	cplane_t	*p;
 	cbrushside_t	*s;
+	cplane_t	*planes;
+	cbrush_t	*brush;
 
-	box_planes = &cm.planes[cm.numPlanes];
-
-	box_brush = &cm.brushes[cm.numBrushes];
-	box_brush->numsides = 6;
-	box_brush->sides = cm.brushsides + cm.numBrushSides;
-	box_brush->contents = CONTENTS_BODY;
-
-	box_model.leaf.numLeafBrushes = 1;
-//	box_model.leaf.firstLeafBrush = cm.numBrushes;
-	box_model.leaf.firstLeafBrush = cm.numLeafBrushes;
-	cm.leafbrushes[cm.numLeafBrushes] = cm.numBrushes;
-
-	for (i=0 ; i<6 ; i++)
-	{
-		side = i&1;
+	for ( t = 0 ; t < CM_MAX_THREADS ; t++ ) {
+		planes = &cm.planes[cm.numPlanes + t*12];
+		box_planes[t] = planes;
 
-		// brush sides
-		s = &cm.brushsides[cm.numBrushSides+i];
-		s->plane = 	cm.planes + (cm.numPlanes+i*2+side);
-		s->surfaceFlags = 0;
+		brush = &cm.brushes[cm.numBrushes + t];
+		brush->numsides = 6;
+		brush->sides = cm.brushsides + cm.numBrushSides + t*6;
+		brush->contents = CONTENTS_BODY;
+		box_brushes[t] = brush;
 
-		// planes
-		p = &box_planes[i*2];
-		p->type = i>>1;
-		p->signbits = 0;
-		VectorClear (p->normal);
-		p->normal[i>>1] = 1;
+		box_models[t].leaf.numLeafBrushes = 1;
+		box_models[t].leaf.firstLeafBrush = cm.numLeafBrushes + t;
+		cm.leafbrushes[cm.numLeafBrushes + t] = cm.numBrushes + t;
 
-		p = &box_planes[i*2+1];
-		p->type = 3 + (i>>1);
-		p->signbits = 0;
-		VectorClear (p->normal);
-		p->normal[i>>1] = -1;
-
-		SetPlaneSignbits( p );
-	}	
+		for (i=0 ; i<6 ; i++)
+		{
+			side = i&1;
+
+			// brush sides
+			s = &brush->sides[i];
+			s->plane = planes + (i*2+side);
+			s->surfaceFlags = 0;
+
+			// planes
+			p = &planes[i*2];
+			p->type = i>>1;
+			p->signbits = 0;
+			VectorClear (p->normal);
+			p->normal[i>>1] = 1;
+
+			p = &planes[i*2+1];
+			p->type = 3 + (i>>1);
+			p->signbits = 0;
+			VectorClear (p->normal);
+			p->normal[i>>1] = -1;
+
+			SetPlaneSignbits( p );
+		}
+	}
 }
 
 /*
@@ -796,33 +1219,56 @@ Capsules are handled differently though.
 ===================
 */
 clipHandle_t CM_TempBoxModel( const vec3_t mins, const vec3_t maxs, int capsule ) {
+	cmodel_t	*model;
+	cplane_t	*planes;
+	cbrush_t	*brush;
 
-	VectorCopy( mins, box_model.mins );
-	VectorCopy( maxs, box_model.maxs );
+	model = &box_models[CM_ThreadNum()];
+	VectorCopy( mins, model->mins );
+	VectorCopy( maxs, model->maxs );
 
 	if ( capsule ) {
 		return CAPSULE_MODEL_HANDLE;
 	}
 
-	box_planes[0].dist = maxs[0];
-	box_planes[1].dist = -maxs[0];
-	box_planes[2].dist = mins[0];
-	box_planes[3].dist = -mins[0];
-	box_planes[4].dist = maxs[1];
-	box_planes[5].dist = -maxs[1];
-	box_planes[6].dist = mins[1];
-	box_planes[7].dist = -mins[1];
-	box_planes[8].dist = maxs[2];
-	box_planes[9].dist = -maxs[2];
-	box_planes[10].dist = mins[2];
-	box_planes[11].dist = -mins[2];
-
-	VectorCopy( mins, box_brush->bounds[0] );
-	VectorCopy( maxs, box_brush->bounds[1] );
+	planes = box_planes[CM_ThreadNum()];
+	planes[0].dist = maxs[0];
+	planes[1].dist = -maxs[0];
+	planes[2].dist = mins[0];
+	planes[3].dist = -mins[0];
+	planes[4].dist = maxs[1];
+	planes[5].dist = -maxs[1];
+	planes[6].dist = mins[1];
+	planes[7].dist = -mins[1];
+	planes[8].dist = maxs[2];
+	planes[9].dist = -maxs[2];
+	planes[10].dist = mins[2];
+	planes[11].dist = -mins[2];
+
+	brush = box_brushes[CM_ThreadNum()];
+	VectorCopy( mins, brush->bounds[0] );
+	VectorCopy( maxs, brush->bounds[1] );
 
 	return BOX_MODEL_HANDLE;
 }
 
+/*
+==================
+CM_NextCheckcount
+
+Brushes and patches remember the last trace or listing that tested them.
+The counts of different threads never collide, so when another thread
+tested a brush in between, a trace at worst tests it twice but never
+skips it.
+==================
+*/
+int CM_NextCheckcount( void ) {
+	static Q_THREADLOCAL unsigned	count;
+
+	count++;
+	return (int)( count * CM_MAX_THREADS + CM_ThreadNum() );
+}
+
 /*
 ===================
 CM_ModelBounds
@@ -125,9 +125,17 @@ typedef struct {
 	cPatch_t	**surfaces;			// non-patches will be NULL
 
 	int			floodvalid;
-	int			checkcount;					// incremented on each trace
 } clipMap_t;
 
+// traces can run on the job threads of Sys_RunJobs at the same time,
+// every thread has its own temporary box model and checkcounts
+#ifdef BSPC
+#define	CM_ThreadNum()	0
+#else
+#define	CM_ThreadNum()	Sys_ThreadNum()
+#endif
+#define	CM_MAX_THREADS	MAX_JOB_THREADS
+
 
 // keep 1/8 unit away to keep the position valid before network snapping
 // and to avoid various numeric issues
@@ -139,6 +147,7 @@ extern	int			c_traces, c_brush_traces, c_patch_traces;
 extern	cvar_t		*cm_noAreas;
 extern	cvar_t		*cm_noCurves;
 extern	cvar_t		*cm_playerCurveClip;
+extern	cvar_t		*cm_debugSurfaceUpdate;
 
 // cm_test.c
 
@@ -162,6 +171,7 @@ typedef struct {
 	vec3_t		modelOrigin;// origin of the model tracing through
 	int			contents;	// ored contents of the model tracing through
 	qboolean	isPoint;	// optimized case
+	int			checkcount;	// brushes and patches already tested by this trace
 	trace_t		trace;		// returned from trace call
 	sphere_t	sphere;		// sphere for oriendted capsule collision
 } traceWork_t;
@@ -173,6 +183,7 @@ typedef struct leafList_s {
 	int		*list;
 	vec3_t	bounds[2];
 	int		lastLeaf;		// for overflows where each leaf can't be stored individually
+	int		checkcount;		// brushes already stored
 	void	(*storeLeafs)( struct leafList_s *ll, int nodenum );
 } leafList_t;
 
@@ -185,6 +196,7 @@ void CM_StoreBrushes( leafList_t *ll, int nodenum );
 void CM_BoxLeafnums_r( leafList_t *ll, int nodenum );
 
 cmodel_t	*CM_ClipHandleToModel( clipHandle_t handle );
+int			CM_NextCheckcount( void );
 
 // cm_patch.c
 
@@ -24,6 +24,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 
 void		CM_LoadMap( const char *name, qboolean clientload, int *checksum);
+void		CM_LoadMapFromMemory( const char *name, int numBoxes, const boxBrush_t *boxes );
 void		CM_ClearMap( void );
 clipHandle_t CM_InlineModel( int index );		// 0 = world, 1 + are bmodels
 clipHandle_t CM_TempBoxModel( const vec3_t mins, const vec3_t maxs, int capsule );
@@ -250,10 +250,10 @@ void CM_TestInLeaf( traceWork_t *tw, cLeaf_t *leaf ) {
 	for (k=0 ; k<leaf->numLeafBrushes ; k++) {
 		brushnum = cm.leafbrushes[leaf->firstLeafBrush+k];
 		b = &cm.brushes[brushnum];
-		if (b->checkcount == cm.checkcount) {
+		if (b->checkcount == tw->checkcount) {
 			continue;	// already checked this brush in another leaf
 		}
-		b->checkcount = cm.checkcount;
+		b->checkcount = tw->checkcount;
 
 		if ( !(b->contents & tw->contents)) {
 			continue;
@@ -276,10 +276,10 @@ void CM_TestInLeaf( traceWork_t *tw, cLeaf_t *leaf ) {
 			if ( !patch ) {
 				continue;
 			}
-			if ( patch->checkcount == cm.checkcount ) {
+			if ( patch->checkcount == tw->checkcount ) {
 				continue;	// already checked this brush in another leaf
 			}
-			patch->checkcount = cm.checkcount;
+			patch->checkcount = tw->checkcount;
 
 			if ( !(patch->contents & tw->contents)) {
 				continue;
@@ -428,14 +428,10 @@ void CM_PositionTest( traceWork_t *tw ) {
 	ll.storeLeafs = CM_StoreLeafs;
 	ll.lastLeaf = 0;
 	ll.overflowed = qfalse;
-
-	cm.checkcount++;
+	ll.checkcount = tw->checkcount;
 
 	CM_BoxLeafnums_r( &ll, 0 );
 
-
-	cm.checkcount++;
-
 	// test the contents of the leafs
 	for (i=0 ; i < ll.count ; i++) {
 		CM_TestInLeaf( tw, &cm.leafs[leafs[i]] );
@@ -674,10 +670,10 @@ void CM_TraceThroughLeaf( traceWork_t *tw, cLeaf_t *leaf ) {
 		brushnum = cm.leafbrushes[leaf->firstLeafBrush+k];
 
 		b = &cm.brushes[brushnum];
-		if ( b->checkcount == cm.checkcount ) {
+		if ( b->checkcount == tw->checkcount ) {
 			continue;	// already checked this brush in another leaf
 		}
-		b->checkcount = cm.checkcount;
+		b->checkcount = tw->checkcount;
 
 		if ( !(b->contents & tw->contents) ) {
 			continue;
@@ -700,10 +696,10 @@ void CM_TraceThroughLeaf( traceWork_t *tw, cLeaf_t *leaf ) {
 			if ( !patch ) {
 				continue;
 			}
-			if ( patch->checkcount == cm.checkcount ) {
+			if ( patch->checkcount == tw->checkcount ) {
 				continue;	// already checked this patch in another leaf
 			}
-			patch->checkcount = cm.checkcount;
+			patch->checkcount = tw->checkcount;
 
 			if ( !(patch->contents & tw->contents) ) {
 				continue;
@@ -1155,12 +1151,11 @@ void CM_Trace( trace_t *results, const vec3_t start, const vec3_t end, vec3_t mi
 
 	cmod = CM_ClipHandleToModel( model );
 
-	cm.checkcount++;		// for multi-check avoidance
-
 	c_traces++;				// for statistics, may be zeroed
 
 	// fill in a default trace
 	Com_Memset( &tw, 0, sizeof(tw) );
+	tw.checkcount = CM_NextCheckcount();	// for multi-check avoidance
 	tw.trace.fraction = 1;	// assume it goes the entire distance until shown otherwise
 	VectorCopy(origin, tw.modelOrigin);
 
@@ -34,8 +34,14 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #endif
 #endif
 
+#if MAX_CLIENTS == 64
 int demo_protocols[] =
 { 66, 67, 68, 0 };
+#else
+// the stock demos have the 64 player configstring layout
+int demo_protocols[] =
+{ PROTOCOL_VERSION, 0 };
+#endif
 
 #define MAX_NUM_ARGVS	50
 
@@ -67,6 +73,7 @@ cvar_t	*com_dedicated;
 cvar_t	*com_timescale;
 cvar_t	*com_fixedtime;
 cvar_t	*com_dropsim;		// 0.0 to 1.0, simulated packet drops
+cvar_t	*com_latencysim;	// msec, simulated delay of incoming packets
 cvar_t	*com_journal;
 cvar_t	*com_maxfps;
 cvar_t	*com_timedemo;
@@ -2055,6 +2062,64 @@ void Com_RunAndTimeServerPacket( netadr_t *evFrom, msg_t *buf ) {
 	}
 }
 
+#define	MAX_DELAYED_PACKETS		1024
+
+// packets held back by com_latencysim
+static sysEvent_t	com_delayedPackets[MAX_DELAYED_PACKETS];
+static int			com_delayedHead, com_delayedTail;
+
+/*
+=================
+Com_RunPacketEvent
+=================
+*/
+static void Com_RunPacketEvent( sysEvent_t *ev, msg_t *buf ) {
+	netadr_t	evFrom;
+
+	evFrom = *(netadr_t *)ev->evPtr;
+	buf->cursize = ev->evPtrLength - sizeof( evFrom );
+
+	// we must copy the contents of the message out, because
+	// the event buffers are only large enough to hold the
+	// exact payload, but channel messages need to be large
+	// enough to hold fragment reassembly
+	if ( (unsigned)buf->cursize > buf->maxsize ) {
+		Com_Printf("Com_EventLoop: oversize packet\n");
+		return;
+	}
+	Com_Memcpy( buf->data, (byte *)((netadr_t *)ev->evPtr + 1), buf->cursize );
+	if ( com_sv_running->integer ) {
+		Com_RunAndTimeServerPacket( &evFrom, buf );
+	} else {
+		CL_PacketEvent( evFrom, buf );
+	}
+}
+
+/*
+=================
+Com_RunDelayedPackets
+
+Runs the packets that have waited com_latencysim msec,
+or all of them once it is turned off
+=================
+*/
+static void Com_RunDelayedPackets( msg_t *buf ) {
+	sysEvent_t	*ev;
+	int			now;
+
+	now = Sys_Milliseconds();
+	while ( com_delayedTail != com_delayedHead ) {
+		ev = &com_delayedPackets[com_delayedTail & (MAX_DELAYED_PACKETS-1)];
+		if ( com_latencysim->integer > 0 && ev->evTime > now ) {
+			break;
+		}
+		com_delayedTail++;
+
+		Com_RunPacketEvent( ev, buf );
+		Z_Free( ev->evPtr );
+	}
+}
+
 /*
 =================
 Com_EventLoop
@@ -2075,6 +2140,8 @@ int Com_EventLoop( void ) {
 
 		// if no more events are available
 		if ( ev.evType == SE_NONE ) {
+			Com_RunDelayedPackets( &buf );
+
 			// manually send packet events for the loopback channel
 			while ( NET_GetLoopPacket( NS_CLIENT, &evFrom, &buf ) ) {
 				CL_PacketEvent( evFrom, &buf );
@@ -2126,23 +2193,18 @@ int Com_EventLoop( void ) {
 				}
 			}
 
-			evFrom = *(netadr_t *)ev.evPtr;
-			buf.cursize = ev.evPtrLength - sizeof( evFrom );
-
-			// we must copy the contents of the message out, because
-			// the event buffers are only large enough to hold the
-			// exact payload, but channel messages need to be large
-			// enough to hold fragment reassembly
-			if ( (unsigned)buf.cursize > buf.maxsize ) {
-				Com_Printf("Com_EventLoop: oversize packet\n");
+			// hold the packet back com_latencysim msec to simulate a long
+			// round trip, the queue owns it until Com_RunDelayedPackets runs it
+			if ( com_latencysim->integer > 0 ) {
+				if ( com_delayedHead - com_delayedTail == MAX_DELAYED_PACKETS ) {
+					break;		// drop it like a full router would
+				}
+				ev.evTime = Sys_Milliseconds() + com_latencysim->integer;
+				com_delayedPackets[com_delayedHead++ & (MAX_DELAYED_PACKETS-1)] = ev;
 				continue;
 			}
-			Com_Memcpy( buf.data, (byte *)((netadr_t *)ev.evPtr + 1), buf.cursize );
-			if ( com_sv_running->integer ) {
-				Com_RunAndTimeServerPacket( &evFrom, &buf );
-			} else {
-				CL_PacketEvent( evFrom, &buf );
-			}
+
+			Com_RunPacketEvent( &ev, &buf );
 			break;
 		}
 
@@ -2426,6 +2488,7 @@ void Com_Init( char *commandLine ) {
 	com_fixedtime = Cvar_Get ("fixedtime", "0", CVAR_CHEAT);
 	com_showtrace = Cvar_Get ("com_showtrace", "0", CVAR_CHEAT);
 	com_dropsim = Cvar_Get ("com_dropsim", "0", CVAR_CHEAT);
+	com_latencysim = Cvar_Get ("com_latencysim", "0", CVAR_CHEAT);
 	com_viewlog = Cvar_Get( "viewlog", "0", CVAR_CHEAT );
 	com_speeds = Cvar_Get ("com_speeds", "0", 0);
 	com_timedemo = Cvar_Get ("timedemo", "0", CVAR_CHEAT);
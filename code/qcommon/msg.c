@@ -181,6 +181,92 @@ void MSG_WriteBits( msg_t *msg, int value, int bits ) {
 	}
 }
 
+/*
+============
+MSG_WriteBitStream
+
+Appends bits that were already written to another bitstream, starting
+at bit start of data.  The huffman codes don't depend on where they are
+in the stream, so this reproduces the original writes exactly.
+============
+*/
+void MSG_WriteBitStream( msg_t *msg, const byte *data, int start, int bits ) {
+	int		shift, value;
+
+	if ( msg->oob ) {
+		Com_Error( ERR_DROP, "MSG_WriteBitStream: oob message" );
+	}
+
+	if ( !bits ) {
+		return;
+	}
+
+	if ( msg->maxsize - msg->cursize < ( bits >> 3 ) + 4 ) {
+		msg->overflowed = qtrue;
+		return;
+	}
+
+	oldsize += bits;
+
+	// a byte at a time, the bits past the end of the message are always clear
+	for ( ; bits >= 8 ; bits -= 8, start += 8 ) {
+		shift = start & 7;
+		value = data[start >> 3] >> shift;
+		if ( shift ) {
+			value |= data[(start >> 3) + 1] << ( 8 - shift );
+		}
+		value &= 0xff;
+
+		shift = msg->bit & 7;
+		if ( shift ) {
+			msg->data[msg->bit >> 3] |= value << shift;
+			msg->data[(msg->bit >> 3) + 1] = value >> ( 8 - shift );
+		} else {
+			msg->data[msg->bit >> 3] = value;
+		}
+		msg->bit += 8;
+	}
+
+	for ( ; bits > 0 ; bits--, start++ ) {
+		Huff_putBit( ( data[start >> 3] >> ( start & 7 ) ) & 1, msg->data, &msg->bit );
+	}
+
+	msg->cursize = (msg->bit>>3)+1;
+}
+
+/*
+============
+MSG_WriteAligned
+
+Pads the message to the next byte and reserves length bytes there,
+which don't go through the huffman coder.  Returns where the caller
+should put them, or NULL if they don't fit.
+============
+*/
+byte *MSG_WriteAligned( msg_t *msg, int length ) {
+	byte	*data;
+
+	if ( msg->oob ) {
+		Com_Error( ERR_DROP, "MSG_WriteAligned: oob message" );
+	}
+
+	if ( msg->maxsize - msg->cursize < length + 4 ) {
+		msg->overflowed = qtrue;
+		return NULL;
+	}
+
+	while ( msg->bit & 7 ) {
+		Huff_putBit( 0, msg->data, &msg->bit );
+	}
+
+	oldsize += length << 3;
+
+	data = msg->data + ( msg->bit >> 3 );
+	msg->bit += length << 3;
+	msg->cursize = (msg->bit>>3)+1;
+	return data;
+}
+
 int MSG_ReadBits( msg_t *msg, int bits ) {
 	int			value;
 	int			get;
@@ -513,6 +599,33 @@ void MSG_ReadData( msg_t *msg, void *data, int len ) {
 	}
 }
 
+/*
+============
+MSG_ReadAligned
+
+Skips to the next byte and returns the length bytes written there
+by MSG_WriteAligned, or NULL if the message is too short
+============
+*/
+byte *MSG_ReadAligned( msg_t *msg, int length ) {
+	byte	*data;
+
+	if ( msg->oob ) {
+		Com_Error( ERR_DROP, "MSG_ReadAligned: oob message" );
+	}
+
+	msg->bit = ( msg->bit + 7 ) & ~7;
+	if ( length < 0 || ( msg->bit >> 3 ) + length > msg->cursize ) {
+		msg->readcount = msg->cursize + 1;
+		return NULL;
+	}
+
+	data = msg->data + ( msg->bit >> 3 );
+	msg->bit += length << 3;
+	msg->readcount = (msg->bit>>3)+1;
+	return data;
+}
+
 
 /*
 =============================================================================
@@ -47,6 +47,8 @@ void MSG_Init (msg_t *buf, byte *data, int length);
 void MSG_InitOOB( msg_t *buf, byte *data, int length );
 void MSG_Clear (msg_t *buf);
 void MSG_WriteData (msg_t *buf, const void *data, int length);
+void MSG_WriteBitStream( msg_t *msg, const byte *data, int start, int bits );
+byte *MSG_WriteAligned( msg_t *msg, int length );
 void MSG_Bitstream( msg_t *buf );
 
 // TTimo
@@ -85,6 +87,7 @@ char	*MSG_ReadBigString (msg_t *sb);
 char	*MSG_ReadStringLine (msg_t *sb);
 float	MSG_ReadAngle16 (msg_t *sb);
 void	MSG_ReadData (msg_t *sb, void *buffer, int size);
+byte	*MSG_ReadAligned( msg_t *msg, int length );
 
 
 void MSG_WriteDeltaUsercmd( msg_t *msg, struct usercmd_s *from, struct usercmd_s *to );
@@ -171,6 +174,12 @@ void		NET_Sleep(int msec);
 
 #define MAX_DOWNLOAD_WINDOW			8		// max of eight download frames
 #define MAX_DOWNLOAD_BLKSIZE		2048	// 2048 byte block chunks
+
+// "download <file> DOWNLOAD_WINDOW_VERSION <number>" asks for svc_downloadBlock messages,
+// which are sent on their own, selectively acknowledged with "dlack"
+#define DOWNLOAD_WINDOW_VERSION		1
+#define MAX_DOWNLOAD_WINDOW_BLOCKS	128		// power of two, also the range of a dlack
+#define DOWNLOAD_WINDOW_BLKSIZE		1200	// a block and its headers fit in one unfragmented packet
  
 
 /*
@@ -219,7 +228,15 @@ PROTOCOL
 ==============================================================
 */
 
+// a raised MAX_CLIENTS moves every configstring after CS_PLAYERS, so those
+// builds get a protocol of their own and only talk to each other
+#if MAX_CLIENTS == 256
+#define	PROTOCOL_VERSION	91
+#elif MAX_CLIENTS == 128
+#define	PROTOCOL_VERSION	90
+#else
 #define	PROTOCOL_VERSION	68
+#endif
 // 1.31 - 67
 
 // maintain a list of compatible protocols for demo playing
@@ -259,7 +276,9 @@ enum svc_ops_e {
 	svc_serverCommand,			// [string] to be executed by client game module
 	svc_download,				// [short] size [size bytes]
 	svc_snapshot,
-	svc_EOF
+	svc_EOF,
+	svc_downloadBlock			// [long] download [long] block [long] file size [short] size, [size aligned bytes]
+								// after svc_EOF so it doesn't renumber it, only sent when asked for
 };
 
 
@@ -322,6 +341,8 @@ int		QDECL VM_Call( vm_t *vm, int callNum, ... );
 
 void	VM_Debug( int level );
 
+qboolean	VM_IsNative( vm_t *vm );	// native code can be called from other threads
+
 void	*VM_ArgPtr( int intValue );
 void	*VM_ExplicitArgPtr( vm_t *vm, int intValue );
 
@@ -558,6 +579,10 @@ int		FS_FileIsInPAK(const char *filename, int *pChecksum );
 
 int		FS_Write( const void *buffer, int len, fileHandle_t f );
 
+FILE	*FS_FileForHandle( fileHandle_t f );
+// the FILE of a file opened for writing, for writes that can't go through
+// FS_Write because they happen off the main thread
+
 int		FS_Read2( void *buffer, int len, fileHandle_t f );
 int		FS_Read( void *buffer, int len, fileHandle_t f );
 // properly handles partial reads and reads from other dlls
@@ -977,11 +1002,30 @@ void	Sys_EndStreamedFile( fileHandle_t f );
 int		Sys_StreamedRead( void *buffer, int size, int count, fileHandle_t f );
 void	Sys_StreamSeek( fileHandle_t f, int offset, int origin );
 
+// background writing, the handle is written by a thread until Sys_EndStreamedWrite
+qboolean	Sys_BeginStreamedWrite( fileHandle_t f, int bufferSize );
+qboolean	Sys_StreamedWrite( const void *buffer, int len, fileHandle_t f );
+qboolean	Sys_EndStreamedWrite( fileHandle_t f );
+
+// runs job( 0 ) to job( numJobs - 1 ) on up to numThreads threads, the
+// caller included, and returns when all of them are done.  numThreads
+// <= 0 uses one thread per processor.
+#define	MAX_JOB_THREADS		16
+void	Sys_RunJobs( void (*job)( int index ), int numJobs, int numThreads );
+int		Sys_ThreadNum( void );		// 0 on the main thread, 1 to MAX_JOB_THREADS - 1 on job threads
+
 void	Sys_ShowConsole( int level, qboolean quitOnClose );
 void	Sys_SetErrorText( const char *text );
 
 void	Sys_SendPacket( int length, const void *data, netadr_t to );
 
+// non-blocking TCP streams for the client's download transports
+int		Sys_TCPConnect( netadr_t to );
+int		Sys_TCPSend( int sock, const void *data, int length );
+#define	TCP_CLOSED	-2		// Sys_TCPRecv when the other end closed the stream
+int		Sys_TCPRecv( int sock, void *data, int length );
+void	Sys_TCPClose( int sock );
+
 qboolean	Sys_StringToAdr( const char *s, netadr_t *a );
 //Does NOT parse port numbers, only base addresses.
 
@@ -564,6 +564,15 @@ vm_t *VM_Create( const char *module, int (*systemCalls)(int *),
 	return vm;
 }
 
+/*
+==============
+VM_IsNative
+==============
+*/
+qboolean VM_IsNative( vm_t *vm ) {
+	return vm->dllHandle != NULL;
+}
+
 /*
 ==============
 VM_Free
@@ -33,6 +33,22 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 #define	MAX_ENT_CLUSTERS	16
 
+// the snapshot entities are a ring shared by all clients, sized for
+// PACKET_BACKUP snapshots of this many entities for every client
+#define	SNAPSHOT_ENTITIES_PER_CLIENT	64
+
+// the ring only holds indexes, the entity states themselves are pooled
+// and shared by every snapshot built in the same batch, so the pool
+// never needs to be larger than PACKET_BACKUP batches of every entity
+#define	MAX_SNAPSHOT_STATES				(PACKET_BACKUP*MAX_GENTITIES)
+
+#define	HEADER_RATE_BYTES	48		// include our header, IP header, and some overhead
+
+typedef struct {
+	entityState_t	s;
+	int				refCount;			// snapshot entity slots referencing this state
+} snapshotState_t;
+
 typedef struct svEntity_s {
 	struct worldSector_s *worldSector;
 	struct svEntity_s *nextEntityInWorldSector;
@@ -43,6 +59,8 @@ typedef struct svEntity_s {
 	int			lastCluster;		// if all the clusters don't fit in clusternums
 	int			areanum, areanum2;
 	int			snapshotCounter;	// used to prevent double adding from portal views
+	int			snapshotState;		// pooled copy of the state for this snapshot batch
+	int			snapshotStateBatch;	// snapshotState is only valid if == svs.snapshotStateBatch
 } svEntity_t;
 
 typedef enum {
@@ -51,6 +69,12 @@ typedef enum {
 	SS_GAME				// actively running
 } serverState_t;
 
+// part of a gamestate message, huffman encoded
+typedef struct {
+	byte			*data;				// NULL when it has to be encoded again
+	int				bits;
+} gamestateChunk_t;
+
 typedef struct {
 	serverState_t	state;
 	qboolean		restarting;			// if true, send configstring changes during SS_LOADING
@@ -67,17 +91,35 @@ typedef struct {
 	char			*configstrings[MAX_CONFIGSTRINGS];
 	svEntity_t		svEntities[MAX_GENTITIES];
 
+	// the configstrings and baselines are the same in every gamestate,
+	// so they are only encoded again after they change
+	gamestateChunk_t	gamestateConfigstrings[MAX_CONFIGSTRINGS];
+	gamestateChunk_t	gamestateBaselines;
+	gamestateChunk_t	gamestate;			// all of the above
+
+	// configstring changes are collected and sent at the end of the frame,
+	// or before any other server command so the order is kept
+	qboolean		configstringsModified;
+	qboolean		configstringModified[MAX_CONFIGSTRINGS];
+	int				configstringChanges[MAX_CONFIGSTRINGS];	// SV_SetConfigstring calls since the last send
+	int				configstringBytes[MAX_CONFIGSTRINGS];	// their "cs" commands would have cost this much
+
 	char			*entityParsePoint;	// used during game VM init
 
 	// the game virtual machine will update these on init and changes
 	sharedEntity_t	*gentities;
 	int				gentitySize;
 	int				num_entities;		// current number, <= MAX_GENTITIES
+	int				linkCount;			// bumped by every link and unlink, see G_LINK_COUNT
 
 	playerState_t	*gameClients;
 	int				gameClientSize;		// will be > sizeof(playerState_t) due to game private data
 
 	int				restartTime;
+
+	qboolean		worldFromMemory;	// generated by the game, see SV_LoadWorldFromMemory
+
+	int				usercmdCalls;		// trips into the game to run usercmds, for bot_soak
 } server_t;
 
 
@@ -89,9 +131,10 @@ typedef struct {
 	byte			areabits[MAX_MAP_AREA_BYTES];		// portalarea visibility bits
 	playerState_t	ps;
 	int				num_entities;
-	int				first_entity;		// into the circular sv_packet_entities[]
+	int				first_entity;		// into the circular svs.snapshotEntities[]
 										// the entities MUST be in increasing state number
 										// order, otherwise the delta compression will fail
+	qboolean		released;			// entity states were reclaimed, can't delta from it
 	int				messageSent;		// time the message was transmitted
 	int				messageAcked;		// time the message was acked
 	int				messageSize;		// used to rate drop packets
@@ -112,6 +155,34 @@ typedef struct netchan_buffer_s {
 	struct netchan_buffer_s *next;
 } netchan_buffer_t;
 
+typedef struct {
+	int				queued;				// snapshots that went through the pacing schedule
+	int				queueDelay;			// total msec between being scheduled and sent
+	int				maxQueueDelay;
+	int				sent;
+	float			linkDelay;			// total msec spent waiting for the simulated link
+	float			maxLinkDelay;
+	float			lastTransit;		// msec from the server frame to leaving the link
+	float			jitter;				// interarrival jitter estimate as in RFC 3550
+} pacingStats_t;
+
+typedef struct {
+	int				changes;			// SV_SetConfigstring calls while clients were in the game
+	int				coalesced;			// changes replaced by a later one before they went out
+	int				commands;			// reliable commands sent for configstrings
+	int				bytes;
+	int				unbatchedCommands;	// what sending every change on its own would have cost
+	int				unbatchedBytes;
+} configstringStats_t;
+
+typedef struct {
+	int				sendTime;			// Sys_Milliseconds() when last sent
+	qboolean		acked;
+	qboolean		lost;				// later blocks got through, send it again
+	qboolean		resent;				// no round trip samples from this block
+	int				sendSeq;			// order of the last send among all blocks
+} downloadBlock_t;
+
 typedef struct client_s {
 	clientState_t	state;
 	char			userinfo[MAX_INFO_STRING];		// name, etc
@@ -126,6 +197,8 @@ typedef struct client_s {
 	int				challenge;
 
 	usercmd_t		lastUsercmd;
+	usercmd_t		pendingCmds[MAX_PENDING_USERCMDS];	// received, but not run yet
+	int				numPendingCmds;
 	int				lastMessageNum;		// for delta compression
 	int				lastClientCommand;	// reliable client message sequence
 	char			lastClientCommandString[MAX_STRING_CHARS];
@@ -145,6 +218,25 @@ typedef struct client_s {
 	qboolean		downloadEOF;		// We have sent the EOF block
 	int				downloadSendTime;	// time we last got an ack from the client
 
+	// sliding window downloads, sent outside of the snapshots
+	qboolean		downloadWindowed;	// client asked for DOWNLOAD_WINDOW_VERSION
+	int				downloadNumber;		// echoed in every block, tells the client's downloads apart
+	int				downloadNumBlocks;	// the last one is shorter, possibly empty
+	int				downloadAckBlock;	// every block before this one has been received
+	int				downloadNextBlock;	// first block that was never sent
+	float			downloadWindow;		// blocks allowed in flight
+	float			downloadThreshold;	// window stops doubling every round trip here
+	int				downloadRecoverBlock;	// window isn't cut again until this one is acked
+	int				downloadRtt;		// smoothed round trip msec, 0 until measured
+	int				downloadBackoff;	// timeout doublings since the last measurement
+	int				downloadTokens;		// bytes that can be sent right now at sv_dlRate
+	int				downloadTokenTime;
+	int				downloadStartTime;
+	int				downloadResent;		// blocks sent more than once
+	int				downloadSendSeq;
+	int				downloadAckedSeq;	// latest sendSeq that was acknowledged
+	downloadBlock_t	downloadWindowBlocks[MAX_DOWNLOAD_WINDOW_BLOCKS];
+
 	int				deltaMessage;		// frame last client usercmd message
 	int				nextReliableTime;	// svs.time when another reliable command will be allowed
 	int				lastPacketTime;		// svs.time when packet was last received
@@ -156,6 +248,11 @@ typedef struct client_s {
 	int				ping;
 	int				rate;				// bytes / second
 	int				snapshotMsec;		// requests a snapshot every snapshotMsec unless rate choked
+	qboolean		multiConfigstrings;	// the client and the cgame understand "mcs"
+	int				rateTokens;			// bytes that can be sent right now when pacing
+	int				rateTokenTime;		// Sys_Milliseconds() rateTokens were last refilled
+	int				pacedTime;			// Sys_Milliseconds() the snapshot was scheduled
+	pacingStats_t	pacing;
 	int				pureAuthentic;
 	qboolean  gotCP; // TTimo - additional flag to distinguish between a bad pure checksum, and no cp command at all
 	netchan_t		netchan;
@@ -199,14 +296,25 @@ typedef struct {
 	int			snapFlagServerBit;			// ^= SNAPFLAG_SERVERCOUNT every SV_SpawnServer()
 
 	client_t	*clients;					// [sv_maxclients->integer];
-	int			numSnapshotEntities;		// sv_maxclients->integer*PACKET_BACKUP*MAX_PACKET_ENTITIES
+	int			numSnapshotEntities;		// sv_maxclients->integer*PACKET_BACKUP*SNAPSHOT_ENTITIES_PER_CLIENT
 	int			nextSnapshotEntities;		// next snapshotEntities to use
-	entityState_t	*snapshotEntities;		// [numSnapshotEntities]
+	int			*snapshotEntities;			// [numSnapshotEntities] into snapshotStates, -1 if released
+	int			numSnapshotStates;			// no more than MAX_SNAPSHOT_STATES
+	snapshotState_t	*snapshotStates;		// [numSnapshotStates]
+	int			*freeSnapshotStates;		// [numSnapshotStates] stack of unreferenced states
+	int			numFreeSnapshotStates;
+	int			snapshotStateBatch;			// bumped for every batch of snapshots sharing states
 	int			nextHeartbeatTime;
 	challenge_t	challenges[MAX_CHALLENGES];	// to prevent invalid IPs from connecting
 	netadr_t	redirectAddress;			// for rcon return messages
 
 	netadr_t	authorizeAddress;			// for rcon return messages
+
+	int			frameRealTime;				// Sys_Milliseconds() of the last SV_SendClientMessages
+	int			linkTime;					// Sys_Milliseconds() linkBacklog was last drained
+	float		linkBacklog;				// msec until the simulated link has sent its queue
+
+	configstringStats_t	configstringStats;
 } serverStatic_t;
 
 //=============================================================================
@@ -223,6 +331,7 @@ extern	cvar_t	*sv_zombietime;
 extern	cvar_t	*sv_rconPassword;
 extern	cvar_t	*sv_privatePassword;
 extern	cvar_t	*sv_allowDownload;
+extern	cvar_t	*sv_dlURL;
 extern	cvar_t	*sv_maxclients;
 
 extern	cvar_t	*sv_privateClients;
@@ -243,6 +352,12 @@ extern	cvar_t	*sv_pure;
 extern	cvar_t	*sv_floodProtect;
 extern	cvar_t	*sv_lanForceRate;
 extern	cvar_t	*sv_strictAuth;
+extern	cvar_t	*sv_pacing;
+extern	cvar_t	*sv_tickCommands;
+extern	cvar_t	*sv_maxSnaps;
+extern	cvar_t	*sv_simulatedLink;
+extern	cvar_t	*sv_dlRate;
+extern	cvar_t	*sv_autoRecordDemo;
 
 //===========================================================
 
@@ -268,6 +383,8 @@ void SV_MasterShutdown (void);
 //
 void SV_SetConfigstring( int index, const char *val );
 void SV_GetConfigstring( int index, char *buffer, int bufferSize );
+void SV_UpdateGamestate( void );
+void SV_SendModifiedConfigstrings( void );
 
 void SV_SetUserinfo( int index, const char *val );
 void SV_GetUserinfo( int index, char *buffer, int bufferSize );
@@ -294,8 +411,11 @@ void SV_DropClient( client_t *drop, const char *reason );
 
 void SV_ExecuteClientCommand( client_t *cl, const char *s, qboolean clientOK );
 void SV_ClientThink (client_t *cl, usercmd_t *cmd);
+void SV_RunPendingUsercmds( void );
+void SV_ClientUsercmd( client_t *cl, usercmd_t *cmd );
 
 void SV_WriteDownloadToClient( client_t *cl , msg_t *msg );
+void SV_SendDownloadMessages( void );
 
 //
 // sv_ccmds.c
@@ -309,8 +429,27 @@ void SV_AddServerCommand( client_t *client, const char *cmd );
 void SV_UpdateServerCommandsToClient( client_t *client, msg_t *msg );
 void SV_WriteFrameToClient (client_t *client, msg_t *msg);
 void SV_SendMessageToClient( msg_t *msg, client_t *client );
+int SV_ClientRate( client_t *client );
 void SV_SendClientMessages( void );
 void SV_SendClientSnapshot( client_t *client );
+int SV_SendPacedSnapshots( void );
+void SV_InitSnapshotStates( void );
+void SV_ReleaseClientSnapshots( client_t *client );
+int SV_SnapshotStateNum( clientSnapshot_t *frame, int index );
+entityState_t *SV_SnapshotEntity( clientSnapshot_t *frame, int index );
+
+//
+// sv_demo.c
+//
+void SV_DemoFrame( void );
+void SV_DemoServerCommand( int clientNum, const char *cmd );
+void SV_DemoConfigstringModified( int index );
+void SV_DemoAutoRecord( void );
+void SV_DemoShutdown( void );
+void SV_Record_f( void );
+void SV_StopRecord_f( void );
+void SV_DemoExtract_f( void );
+void SV_DemoBench_f( void );
 
 //
 // sv_game.c
@@ -338,6 +477,9 @@ int			SV_BotLibShutdown( void );
 int			SV_BotGetSnapshotEntity( int client, int ent );
 int			SV_BotGetConsoleMessage( int client, char *buf, int size );
 
+void		SV_BotSoak_f( void );
+void		SV_BotSoakFrame( int msec, int ticks );
+
 int BotImport_DebugPolygonCreate(int color, int numPoints, vec3_t *points);
 void BotImport_DebugPolygonDelete(int id);
 
@@ -349,6 +491,9 @@ void BotImport_DebugPolygonDelete(int id);
 void SV_ClearWorld (void);
 // called after the world model has been loaded, before linking any entities
 
+void SV_LoadWorldFromMemory( const char *name, int numBoxes, const boxBrush_t *boxes );
+// replaces the world model with a runtime generated one and relinks entities
+
 void SV_UnlinkEntity( sharedEntity_t *ent );
 // call before removing an entity, and before trying to move one,
 // so it doesn't clip against itself
@@ -375,6 +520,10 @@ int SV_AreaEntities( const vec3_t mins, const vec3_t maxs, int *entityList, int
 // returns the number of pointers filled in
 // The world entity is never returned in this list.
 
+int SV_EntitiesInRadius( const vec3_t origin, float radius, int contentmask, int *entityList, int maxcount );
+// fills in entities whose bounding box is closer than radius to origin,
+// sorted nearest first.  A contentmask of 0 accepts any contents.
+
 
 int SV_PointContents( const vec3_t p, int passEntityNum );
 // returns the CONTENTS_* value from the world and all entities at the given point.
@@ -392,6 +541,9 @@ void SV_Trace( trace_t *results, const vec3_t start, vec3_t mins, vec3_t maxs, c
 // passEntityNum is explicitly excluded from clipping checks (normally ENTITYNUM_NONE)
 
 
+void SV_TraceBatch( const traceRequest_t *requests, trace_t *results, int count );
+// runs count independent traces, sharing the entity gathering between them
+
 void SV_ClipToEntity( trace_t *trace, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int entityNum, int contentmask, int capsule );
 // clip to a specific entity
 
@@ -489,6 +489,7 @@ void SV_BotInitCvars(void) {
 	Cvar_Get("bot_forcereachability", "0", 0);			//force reachability calculations
 	Cvar_Get("bot_forcewrite", "0", 0);					//force writing aas file
 	Cvar_Get("bot_aasoptimize", "0", 0);				//no aas file optimisation
+	Cvar_Get("bot_aasflatnodes", "1", 0);				//flattened aas tree for tracing
 	Cvar_Get("bot_saveroutingcache", "0", 0);			//save routing cache
 	Cvar_Get("bot_thinktime", "100", CVAR_CHEAT);		//msec the bots thinks
 	Cvar_Get("bot_reloadcharacters", "0", 0);			//reload the bot characters each time
@@ -608,7 +609,7 @@ int EntityInPVS( int client, int entityNum ) {
 	cl = &svs.clients[client];
 	frame = &cl->frames[cl->netchan.outgoingSequence & PACKET_MASK];
 	for ( i = 0; i < frame->num_entities; i++ )	{
-		if ( svs.snapshotEntities[(frame->first_entity + i) % svs.numSnapshotEntities].number == entityNum ) {
+		if ( SV_SnapshotEntity( frame, i )->number == entityNum ) {
 			return qtrue;
 		}
 	}
@@ -630,6 +631,193 @@ int SV_BotGetSnapshotEntity( int client, int sequence ) {
 	if (sequence < 0 || sequence >= frame->num_entities) {
 		return -1;
 	}
-	return svs.snapshotEntities[(frame->first_entity + sequence) % svs.numSnapshotEntities].number;
+	return SV_SnapshotEntity( frame, sequence )->number;
 }
 
+
+/*
+==============================================================================
+
+BOT SOAK
+
+Fills the server with bots a step at a time and reports the server frame
+time at every player count, to see how the frame cost grows with the
+number of players.  The cost per game tick shows what a higher sv_fps
+would cost.  The bot usercmds go through the same path as the ones of
+real clients, so set sv_tickCommands to soak the queued usercmds, the
+game calls per tick show how many trips into the game they took.
+
+==============================================================================
+*/
+
+#define	SOAK_SETTLE_MSEC	3000		// let the new bots spawn before measuring
+#define	SOAK_CONNECT_MSEC	15000		// give up if the bots don't show up
+
+typedef struct {
+	qboolean	active;
+	int			maxPlayers;
+	int			step;
+	int			frames;
+	char		botName[MAX_QPATH];
+
+	int			targetPlayers;
+	int			stepTime;				// svs.time the bots of this step were added
+	int			numFrames;
+	int			numTicks;
+	int			totalMsec;
+	int			maxMsec;
+	int			usercmdCalls;
+	int			lastUsercmdCalls;		// sv.usercmdCalls at the previous frame
+} botSoak_t;
+
+static botSoak_t	soak;
+
+/*
+==================
+SV_SoakPlayerCount
+==================
+*/
+static int SV_SoakPlayerCount( void ) {
+	int		i, count;
+
+	count = 0;
+	for ( i = 0 ; i < sv_maxclients->integer ; i++ ) {
+		if ( svs.clients[i].state >= CS_CONNECTED ) {
+			count++;
+		}
+	}
+	return count;
+}
+
+/*
+==================
+SV_BotSoakStep
+==================
+*/
+static void SV_BotSoakStep( void ) {
+	int		players, i;
+
+	players = SV_SoakPlayerCount();
+	soak.targetPlayers = players + soak.step;
+	if ( soak.targetPlayers > soak.maxPlayers ) {
+		soak.targetPlayers = soak.maxPlayers;
+	}
+
+	for ( i = players ; i < soak.targetPlayers ; i++ ) {
+		Cbuf_AddText( va( "addbot %s\n", soak.botName ) );
+	}
+
+	soak.stepTime = svs.time;
+	soak.numFrames = 0;
+	soak.numTicks = 0;
+	soak.totalMsec = 0;
+	soak.maxMsec = 0;
+	soak.usercmdCalls = 0;
+}
+
+/*
+==================
+SV_BotSoak_f
+
+bot_soak <maxplayers> [step] [frames] [botname]
+bot_soak stop
+==================
+*/
+void SV_BotSoak_f( void ) {
+	if ( Cmd_Argc() < 2 ) {
+		Com_Printf( "Usage: bot_soak <maxplayers> [step] [frames] [botname]\n       bot_soak stop\n" );
+		return;
+	}
+
+	if ( !Q_stricmp( Cmd_Argv( 1 ), "stop" ) ) {
+		soak.active = qfalse;
+		return;
+	}
+
+	if ( !com_sv_running->integer ) {
+		Com_Printf( "Server is not running.\n" );
+		return;
+	}
+
+	soak.maxPlayers = atoi( Cmd_Argv( 1 ) );
+	if ( soak.maxPlayers > sv_maxclients->integer ) {
+		Com_Printf( "bot_soak: sv_maxclients is %i\n", sv_maxclients->integer );
+		soak.maxPlayers = sv_maxclients->integer;
+	}
+	soak.step = Cmd_Argc() > 2 ? atoi( Cmd_Argv( 2 ) ) : 8;
+	if ( soak.step < 1 ) {
+		soak.step = 1;
+	}
+	soak.frames = Cmd_Argc() > 3 ? atoi( Cmd_Argv( 3 ) ) : 200;
+	if ( soak.frames < 1 ) {
+		soak.frames = 1;
+	}
+	Q_strncpyz( soak.botName, Cmd_Argc() > 4 ? Cmd_Argv( 4 ) : "sarge", sizeof( soak.botName ) );
+
+	if ( SV_SoakPlayerCount() >= soak.maxPlayers ) {
+		Com_Printf( "bot_soak: already %i players\n", SV_SoakPlayerCount() );
+		return;
+	}
+
+	Com_Printf( "sv_fps %i, sv_tickCommands %i\n", sv_fps->integer, sv_tickCommands->integer );
+	Com_Printf( "players  avg msec  max msec  msec/tick  calls/tick\n" );
+	soak.lastUsercmdCalls = sv.usercmdCalls;
+	SV_BotSoakStep();
+	soak.active = qtrue;
+}
+
+/*
+==================
+SV_BotSoakFrame
+
+Called with the time the server spent on a frame
+and the number of game ticks it ran
+==================
+*/
+void SV_BotSoakFrame( int msec, int ticks ) {
+	int		players, calls;
+
+	if ( !soak.active ) {
+		return;
+	}
+
+	calls = sv.usercmdCalls - soak.lastUsercmdCalls;
+	soak.lastUsercmdCalls = sv.usercmdCalls;
+	if ( calls < 0 ) {
+		calls = 0;		// map change
+	}
+
+	players = SV_SoakPlayerCount();
+	if ( players < soak.targetPlayers ) {
+		if ( svs.time - soak.stepTime > SOAK_CONNECT_MSEC ) {
+			Com_Printf( "bot_soak: only %i of %i players connected, stopping\n", players, soak.targetPlayers );
+			soak.active = qfalse;
+		}
+		return;
+	}
+	if ( svs.time - soak.stepTime < SOAK_SETTLE_MSEC ) {
+		return;
+	}
+
+	soak.numFrames++;
+	soak.numTicks += ticks;
+	soak.totalMsec += msec;
+	soak.usercmdCalls += calls;
+	if ( msec > soak.maxMsec ) {
+		soak.maxMsec = msec;
+	}
+	if ( soak.numFrames < soak.frames ) {
+		return;
+	}
+
+	Com_Printf( "%7i  %8.2f  %8i  %9.3f  %10.2f\n", players, (float)soak.totalMsec / soak.numFrames, soak.maxMsec,
+		soak.numTicks ? (float)soak.totalMsec / soak.numTicks : 0,
+		soak.numTicks ? (float)soak.usercmdCalls / soak.numTicks : 0 );
+
+	if ( soak.targetPlayers >= soak.maxPlayers ) {
+		Com_Printf( "bot_soak: done\n" );
+		soak.active = qfalse;
+		return;
+	}
+	SV_BotSoakStep();
+}
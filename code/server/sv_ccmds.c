@@ -241,6 +241,17 @@ static void SV_MapRestart_f( void ) {
 		return;
 	}
 
+	// a generated world has no entity string to spawn the level from again
+	if ( sv.worldFromMemory ) {
+		char	mapname[MAX_QPATH];
+
+		Com_Printf( "generated world -- restarting.\n" );
+		Q_strncpyz( mapname, Cvar_VariableString( "mapname" ), sizeof( mapname ) );
+
+		SV_SpawnServer( mapname, qfalse );
+		return;
+	}
+
 	// check for changes in variables that can't just be restarted
 	// check for maxclients change
 	if ( sv_maxclients->modified || sv_gametype->modified ) {
@@ -269,6 +280,7 @@ static void SV_MapRestart_f( void ) {
 	sv.state = SS_LOADING;
 	sv.restarting = qtrue;
 
+	SV_DemoShutdown();
 	SV_RestartGameProgs();
 
 	// run a few frames to allow everything to settle
@@ -316,6 +328,8 @@ static void SV_MapRestart_f( void ) {
 	// run another frame to allow things to look at all the players
 	VM_Call( gvm, GAME_RUN_FRAME, svs.time );
 	svs.time += 100;
+
+	SV_DemoAutoRecord();
 }
 
 //===============================================================
@@ -588,6 +602,71 @@ static void SV_Status_f( void ) {
 	Com_Printf ("\n");
 }
 
+/*
+================
+SV_PacingStats_f
+
+Queueing delay and send jitter of every client, use
+"pacing_stats reset" before a measurement
+================
+*/
+static void SV_PacingStats_f( void ) {
+	int			i;
+	client_t	*cl;
+	float		queueAvg, linkAvg;
+
+	// make sure server is running
+	if ( !com_sv_running->integer ) {
+		Com_Printf( "Server is not running.\n" );
+		return;
+	}
+
+	if ( Cmd_Argc() > 1 && !Q_stricmp( Cmd_Argv( 1 ), "reset" ) ) {
+		for ( i = 0, cl = svs.clients ; i < sv_maxclients->integer ; i++, cl++ ) {
+			Com_Memset( &cl->pacing, 0, sizeof( cl->pacing ) );
+		}
+		return;
+	}
+
+	Com_Printf ("num  sent queue avg  max  link avg    max jitter name\n");
+	Com_Printf ("--- ----- --------- ---- -------- ------ ------ ---------------\n");
+	for ( i = 0, cl = svs.clients ; i < sv_maxclients->integer ; i++, cl++ ) {
+		if ( !cl->state || cl->netchan.remoteAddress.type == NA_BOT ) {
+			continue;
+		}
+		queueAvg = cl->pacing.queued ? (float)cl->pacing.queueDelay / cl->pacing.queued : 0;
+		linkAvg = cl->pacing.sent ? cl->pacing.linkDelay / cl->pacing.sent : 0;
+		Com_Printf ("%3i %5i %9.1f %4i %8.1f %6.1f %6.2f %s^7\n", i, cl->pacing.sent,
+			queueAvg, cl->pacing.maxQueueDelay, linkAvg, cl->pacing.maxLinkDelay,
+			cl->pacing.jitter, cl->name );
+	}
+	Com_Printf ("\n");
+}
+
+/*
+================
+SV_ConfigstringStats_f
+
+What collecting the configstring changes of a frame saved,
+"configstring_stats reset" clears the counters
+================
+*/
+static void SV_ConfigstringStats_f( void ) {
+	configstringStats_t	*stats;
+
+	stats = &svs.configstringStats;
+
+	if ( Cmd_Argc() > 1 && !Q_stricmp( Cmd_Argv( 1 ), "reset" ) ) {
+		Com_Memset( stats, 0, sizeof( *stats ) );
+		return;
+	}
+
+	Com_Printf( "%i configstring changes, %i replaced before they were sent\n", stats->changes, stats->coalesced );
+	Com_Printf( "%i reliable commands, %i without batching\n", stats->commands, stats->unbatchedCommands );
+	Com_Printf( "%i command bytes, %i without batching, %i saved\n", stats->bytes, stats->unbatchedBytes,
+		stats->unbatchedBytes - stats->bytes );
+}
+
 /*
 ==================
 SV_ConSay_f
@@ -733,6 +812,13 @@ void SV_AddOperatorCommands( void ) {
 	Cmd_AddCommand ("spdevmap", SV_Map_f);
 #endif
 	Cmd_AddCommand ("killserver", SV_KillServer_f);
+	Cmd_AddCommand ("bot_soak", SV_BotSoak_f);
+	Cmd_AddCommand ("pacing_stats", SV_PacingStats_f);
+	Cmd_AddCommand ("configstring_stats", SV_ConfigstringStats_f);
+	Cmd_AddCommand ("svrecord", SV_Record_f);
+	Cmd_AddCommand ("svstoprecord", SV_StopRecord_f);
+	Cmd_AddCommand ("svdemo_extract", SV_DemoExtract_f);
+	Cmd_AddCommand ("svdemo_bench", SV_DemoBench_f);
 	if( com_dedicated->integer ) {
 		Cmd_AddCommand ("say", SV_ConSay_f);
 	}
@@ -317,6 +317,14 @@ void SV_DirectConnect( netadr_t from ) {
 		Info_SetValueForKey( userinfo, "ip", "localhost" );
 	}
 
+	// a generated world only exists in this process, remote clients
+	// would predict against the map they loaded
+	if ( sv.worldFromMemory && from.type != NA_LOOPBACK ) {
+		NET_OutOfBandPrint( NS_SERVER, from, "print\nServer is running a local only arena.\n" );
+		Com_DPrintf( "Client rejected, the world is generated\n" );
+		return;
+	}
+
 	newcl = &temp;
 	Com_Memset (newcl, 0, sizeof(client_t));
 
@@ -403,6 +411,8 @@ gotnewcl:
 	// build a new connection
 	// accept the new client
 	// this is the only place a client_t is ever initialized
+	// a reconnecting client still holds the states of its snapshots
+	SV_ReleaseClientSnapshots( newcl );
 	*newcl = temp;
 	clientNum = newcl - svs.clients;
 	ent = SV_GentityNum( clientNum );
@@ -493,6 +503,9 @@ void SV_DropClient( client_t *drop, const char *reason ) {
 	// Kill any download
 	SV_CloseDownload( drop );
 
+	// let go of the pooled entity states
+	SV_ReleaseClientSnapshots( drop );
+
 	// tell everyone why they got dropped
 	SV_SendServerCommand( NULL, "print \"%s" S_COLOR_WHITE " %s\n\"", drop->name, reason );
 
@@ -544,8 +557,6 @@ the wrong gamestate.
 ================
 */
 void SV_SendClientGameState( client_t *client ) {
-	int			start;
-	entityState_t	*base, nullstate;
 	msg_t		msg;
 	byte		msgBuffer[MAX_MSGLEN];
 
@@ -576,25 +587,9 @@ void SV_SendClientGameState( client_t *client ) {
 	MSG_WriteByte( &msg, svc_gamestate );
 	MSG_WriteLong( &msg, client->reliableSequence );
 
-	// write the configstrings
-	for ( start = 0 ; start < MAX_CONFIGSTRINGS ; start++ ) {
-		if (sv.configstrings[start][0]) {
-			MSG_WriteByte( &msg, svc_configstring );
-			MSG_WriteShort( &msg, start );
-			MSG_WriteBigString( &msg, sv.configstrings[start] );
-		}
-	}
-
-	// write the baselines
-	Com_Memset( &nullstate, 0, sizeof( nullstate ) );
-	for ( start = 0 ; start < MAX_GENTITIES; start++ ) {
-		base = &sv.svEntities[start].baseline;
-		if ( !base->number ) {
-			continue;
-		}
-		MSG_WriteByte( &msg, svc_baseline );
-		MSG_WriteDeltaEntity( &msg, &nullstate, base, qtrue );
-	}
+	// write the configstrings and baselines
+	SV_UpdateGamestate();
+	MSG_WriteBitStream( &msg, sv.gamestate.data, 0, sv.gamestate.bits );
 
 	MSG_WriteByte( &msg, svc_EOF );
 
@@ -629,6 +624,7 @@ void SV_ClientEnterWorld( client_t *client, usercmd_t *cmd ) {
 	client->deltaMessage = -1;
 	client->nextSnapshotTime = svs.time;	// generate a snapshot immediately
 	client->lastUsercmd = *cmd;
+	client->numPendingCmds = 0;
 
 	// call the game begin function
 	VM_Call( gvm, GAME_CLIENT_BEGIN, client - svs.clients );
@@ -741,6 +737,144 @@ void SV_BeginDownload_f( client_t *cl ) {
 	// cl->downloadName is non-zero now, SV_WriteDownloadToClient will see this and open
 	// the file itself
 	Q_strncpyz( cl->downloadName, Cmd_Argv(1), sizeof(cl->downloadName) );
+
+	// newer clients ask for the sliding window
+	cl->downloadWindowed = ( atoi( Cmd_Argv(2) ) == DOWNLOAD_WINDOW_VERSION );
+	cl->downloadNumber = atoi( Cmd_Argv(3) );
+}
+
+/*
+==================
+SV_AckDownloadBlock
+
+Returns qtrue if the block wasn't acknowledged before
+==================
+*/
+static qboolean SV_AckDownloadBlock( client_t *cl, int block, int now ) {
+	downloadBlock_t	*b;
+
+	b = &cl->downloadWindowBlocks[block & (MAX_DOWNLOAD_WINDOW_BLOCKS-1)];
+	if ( b->acked ) {
+		return qfalse;
+	}
+	b->acked = qtrue;
+
+	// a resent block can't tell which send got through
+	if ( !b->resent ) {
+		if ( cl->downloadRtt ) {
+			cl->downloadRtt = ( cl->downloadRtt * 7 + now - b->sendTime ) / 8;
+		} else {
+			cl->downloadRtt = now - b->sendTime;
+		}
+		cl->downloadBackoff = 0;
+	}
+	if ( b->sendSeq > cl->downloadAckedSeq ) {
+		cl->downloadAckedSeq = b->sendSeq;
+	}
+	return qtrue;
+}
+
+/*
+==================
+SV_DownloadLoss
+
+Halves the window, once per round trip
+==================
+*/
+static void SV_DownloadLoss( client_t *cl ) {
+	if ( cl->downloadAckBlock < cl->downloadRecoverBlock ) {
+		return;
+	}
+	cl->downloadThreshold = cl->downloadWindow / 2;
+	if ( cl->downloadThreshold < 2 ) {
+		cl->downloadThreshold = 2;
+	}
+	cl->downloadWindow = cl->downloadThreshold;
+	cl->downloadRecoverBlock = cl->downloadNextBlock;
+}
+
+/*
+==================
+SV_DownloadAck_f
+
+dlack <block> <hex>
+
+Every block before the first one is there, the hex digits flag the
+blocks after it that are there too, four blocks to a digit
+==================
+*/
+void SV_DownloadAck_f( client_t *cl ) {
+	downloadBlock_t	*b;
+	const char		*s;
+	int				ack, block, i, j, bits, now, acked;
+	qboolean		lost;
+
+	if ( !cl->downloadWindowed || !cl->download ) {
+		return;
+	}
+
+	ack = atoi( Cmd_Argv(1) );
+	if ( ack < cl->downloadAckBlock || ack > cl->downloadNextBlock ) {
+		return;		// from an earlier download
+	}
+
+	now = Sys_Milliseconds();
+	acked = 0;
+	for ( block = cl->downloadAckBlock ; block < ack ; block++ ) {
+		acked += SV_AckDownloadBlock( cl, block, now );
+	}
+	cl->downloadAckBlock = ack;
+
+	s = Cmd_Argv(2);
+	for ( i = 0 ; s[i] && i < MAX_DOWNLOAD_WINDOW_BLOCKS / 4 ; i++ ) {
+		if ( s[i] >= '0' && s[i] <= '9' ) {
+			bits = s[i] - '0';
+		} else if ( s[i] >= 'a' && s[i] <= 'f' ) {
+			bits = s[i] - 'a' + 10;
+		} else {
+			break;
+		}
+		for ( j = 0 ; j < 4 ; j++ ) {
+			block = ack + 1 + i * 4 + j;
+			if ( ( bits & ( 1 << j ) ) && block < cl->downloadNextBlock ) {
+				acked += SV_AckDownloadBlock( cl, block, now );
+			}
+		}
+	}
+
+	if ( cl->downloadAckBlock == cl->downloadNumBlocks ) {
+		now -= cl->downloadStartTime;
+		Com_Printf( "clientDownload: %d : file \"%s\" completed, %i bytes in %i msec, %i of %i blocks resent\n",
+			cl - svs.clients, cl->downloadName, cl->downloadSize, now, cl->downloadResent, cl->downloadNumBlocks );
+		SV_CloseDownload( cl );
+		return;
+	}
+
+	// open the window a block per block in the slow start,
+	// then about a block per round trip
+	if ( acked ) {
+		if ( cl->downloadWindow < cl->downloadThreshold ) {
+			cl->downloadWindow += acked;
+		} else {
+			cl->downloadWindow += (float)acked / cl->downloadWindow;
+		}
+		if ( cl->downloadWindow > MAX_DOWNLOAD_WINDOW_BLOCKS ) {
+			cl->downloadWindow = MAX_DOWNLOAD_WINDOW_BLOCKS;
+		}
+	}
+
+	// a block is lost once three that were sent after it got through
+	lost = qfalse;
+	for ( block = cl->downloadAckBlock ; block < cl->downloadNextBlock ; block++ ) {
+		b = &cl->downloadWindowBlocks[block & (MAX_DOWNLOAD_WINDOW_BLOCKS-1)];
+		if ( !b->acked && !b->lost && b->sendSeq + 3 <= cl->downloadAckedSeq ) {
+			b->lost = qtrue;
+			lost = qtrue;
+		}
+	}
+	if ( lost ) {
+		SV_DownloadLoss( cl );
+	}
 }
 
 /*
@@ -813,6 +947,24 @@ void SV_WriteDownloadToClient( client_t *cl , msg_t *msg )
 		cl->downloadCurrentBlock = cl->downloadClientBlock = cl->downloadXmitBlock = 0;
 		cl->downloadCount = 0;
 		cl->downloadEOF = qfalse;
+
+		if ( cl->downloadWindowed ) {
+			cl->downloadNumBlocks = cl->downloadSize / DOWNLOAD_WINDOW_BLKSIZE + 1;
+			cl->downloadAckBlock = cl->downloadNextBlock = cl->downloadRecoverBlock = 0;
+			cl->downloadWindow = 4;
+			cl->downloadThreshold = MAX_DOWNLOAD_WINDOW_BLOCKS;
+			cl->downloadRtt = 0;
+			cl->downloadBackoff = 0;
+			cl->downloadTokens = 0;
+			cl->downloadTokenTime = cl->downloadStartTime = Sys_Milliseconds();
+			cl->downloadResent = 0;
+			cl->downloadSendSeq = cl->downloadAckedSeq = 0;
+		}
+	}
+
+	// SV_SendDownloadMessages sends the blocks on their own
+	if ( cl->downloadWindowed ) {
+		return;
 	}
 
 	// Perform any reads that we need to
@@ -920,6 +1072,186 @@ void SV_WriteDownloadToClient( client_t *cl , msg_t *msg )
 	}
 }
 
+/*
+==================
+SV_NextDownloadBlock
+
+Lost blocks go first, then new ones while the window has room.
+Returns -1 if nothing should be sent now.
+==================
+*/
+static int SV_NextDownloadBlock( client_t *cl, int now ) {
+	downloadBlock_t	*b;
+	int				block, timeout;
+
+	// acks only come as often as the client sends packets
+	if ( cl->downloadRtt ) {
+		timeout = cl->downloadRtt * 2 + 100;
+	} else {
+		timeout = 1000;
+	}
+	timeout <<= cl->downloadBackoff;
+
+	for ( block = cl->downloadAckBlock ; block < cl->downloadNextBlock ; block++ ) {
+		b = &cl->downloadWindowBlocks[block & (MAX_DOWNLOAD_WINDOW_BLOCKS-1)];
+		if ( b->acked ) {
+			continue;
+		}
+		if ( b->lost ) {
+			return block;
+		}
+		if ( now - b->sendTime > timeout ) {
+			// back off until a block that was only sent once gets
+			// through, or a long round trip would never be measured
+			if ( cl->downloadBackoff < 4 ) {
+				cl->downloadBackoff++;
+			}
+			SV_DownloadLoss( cl );
+			return block;
+		}
+	}
+
+	if ( cl->downloadNextBlock < cl->downloadNumBlocks
+		&& cl->downloadNextBlock - cl->downloadAckBlock < (int)cl->downloadWindow ) {
+		return cl->downloadNextBlock;
+	}
+	return -1;
+}
+
+/*
+==================
+SV_SendDownloadBlock
+
+Sends a message with just the one block, read from the file straight
+into the message buffer.  Returns the size of the message.
+==================
+*/
+static int SV_SendDownloadBlock( client_t *cl, int block, int now ) {
+	byte			msg_buf[MAX_MSGLEN];
+	msg_t			msg;
+	downloadBlock_t	*b;
+	byte			*data;
+	int				offset, length;
+
+	offset = block * DOWNLOAD_WINDOW_BLKSIZE;
+	length = cl->downloadSize - offset;
+	if ( length > DOWNLOAD_WINDOW_BLKSIZE ) {
+		length = DOWNLOAD_WINDOW_BLKSIZE;
+	}
+
+	MSG_Init( &msg, msg_buf, sizeof( msg_buf ) );
+	MSG_WriteLong( &msg, cl->lastClientCommand );
+
+	MSG_WriteByte( &msg, svc_downloadBlock );
+	MSG_WriteLong( &msg, cl->downloadNumber );
+	MSG_WriteLong( &msg, block );
+	MSG_WriteLong( &msg, cl->downloadSize );
+	MSG_WriteShort( &msg, length );
+	data = MSG_WriteAligned( &msg, length );
+
+	if ( length ) {
+		FS_Seek( cl->download, offset, FS_SEEK_SET );
+		if ( FS_Read( data, length, cl->download ) != length ) {
+			Com_Printf( "clientDownload: %d : couldn't read \"%s\"\n", cl - svs.clients, cl->downloadName );
+
+			// fail the download the same way as a missing file
+			MSG_Init( &msg, msg_buf, sizeof( msg_buf ) );
+			MSG_WriteLong( &msg, cl->lastClientCommand );
+			MSG_WriteByte( &msg, svc_download );
+			MSG_WriteShort( &msg, 0 );
+			MSG_WriteLong( &msg, -1 );
+			MSG_WriteString( &msg, va( "Server couldn't read \"%s\" for downloading.\n", cl->downloadName ) );
+			SV_CloseDownload( cl );
+		}
+	}
+
+	if ( cl->download ) {
+		b = &cl->downloadWindowBlocks[block & (MAX_DOWNLOAD_WINDOW_BLOCKS-1)];
+		if ( block == cl->downloadNextBlock ) {
+			Com_Memset( b, 0, sizeof( *b ) );
+			cl->downloadNextBlock++;
+		} else {
+			b->resent = qtrue;
+			b->lost = qfalse;
+			cl->downloadResent++;
+		}
+		b->sendTime = now;
+		b->sendSeq = ++cl->downloadSendSeq;
+	}
+
+	// there is no snapshot in this message for the client to delta from
+	cl->frames[cl->netchan.outgoingSequence & PACKET_MASK].messageSize = msg.cursize;
+	cl->frames[cl->netchan.outgoingSequence & PACKET_MASK].messageSent = svs.time;
+	cl->frames[cl->netchan.outgoingSequence & PACKET_MASK].messageAcked = -1;
+
+	SV_Netchan_Transmit( cl, &msg );
+
+	return msg.cursize;
+}
+
+/*
+==================
+SV_SendDownloadMessages
+
+Sliding window downloads don't wait for the snapshots, every client
+gets as many blocks as its window and sv_dlRate allow, but never more
+than its own rate limited by sv_maxRate.  Called every
+frame and whenever a dedicated server wakes up for a packet, so the
+acknowledgements clock out new blocks.
+==================
+*/
+void SV_SendDownloadMessages( void ) {
+	client_t	*cl;
+	int			i, now, dlRate, rate, maxTokens, elapsed, block;
+
+	now = Sys_Milliseconds();
+
+	dlRate = sv_dlRate->integer * 1024;
+	if ( dlRate < 1024 ) {
+		dlRate = 1024;
+	}
+
+	for ( i = 0, cl = svs.clients ; i < sv_maxclients->integer ; i++, cl++ ) {
+		if ( !cl->state || !cl->downloadWindowed || !cl->download ) {
+			continue;
+		}
+		if ( cl->netchan.remoteAddress.type == NA_BOT ) {
+			continue;
+		}
+
+		// don't queue up behind a fragmented gamestate or snapshot
+		if ( cl->netchan.unsentFragments ) {
+			continue;
+		}
+
+		rate = SV_ClientRate( cl );
+		if ( rate <= 0 || rate > dlRate ) {
+			rate = dlRate;
+		}
+		maxTokens = rate / 10;
+		if ( maxTokens < DOWNLOAD_WINDOW_BLKSIZE * 2 ) {
+			maxTokens = DOWNLOAD_WINDOW_BLKSIZE * 2;
+		}
+
+		elapsed = now - cl->downloadTokenTime;
+		cl->downloadTokenTime = now;
+		if ( elapsed > 0 ) {
+			cl->downloadTokens += (float)rate * elapsed / 1000;
+			if ( cl->downloadTokens > maxTokens ) {
+				cl->downloadTokens = maxTokens;
+			}
+		}
+
+		while ( cl->downloadTokens > 0 && cl->download ) {
+			block = SV_NextDownloadBlock( cl, now );
+			if ( block < 0 ) {
+				break;
+			}
+			cl->downloadTokens -= SV_SendDownloadBlock( cl, block, now ) + HEADER_RATE_BYTES;
+		}
+	}
+}
+
 /*
 =================
 SV_Disconnect_f
@@ -1151,16 +1483,23 @@ void SV_UserinfoChanged( client_t *cl ) {
 	val = Info_ValueForKey (cl->userinfo, "snaps");
 	if (strlen(val)) {
 		i = atoi(val);
+		if ( i > sv_maxSnaps->integer ) {
+			i = sv_maxSnaps->integer;
+		}
 		if ( i < 1 ) {
 			i = 1;
-		} else if ( i > 30 ) {
-			i = 30;
 		}
 		cl->snapshotMsec = 1000/i;
 	} else {
 		cl->snapshotMsec = 50;
 	}
 	
+	// both the client and the cgame can take several configstrings in one
+	// command, an older client would hand "mcs" to the cgame without
+	// updating its gamestate
+	cl->multiConfigstrings = atoi( Info_ValueForKey( cl->userinfo, "cl_multiConfigstrings" ) ) != 0
+		&& atoi( Info_ValueForKey( cl->userinfo, "cg_multiConfigstrings" ) ) != 0;
+
 	// TTimo
 	// maintain the IP information
 	// this is set in SV_DirectConnect (directly on the server, not transmitted), may be lost when client updates it's userinfo
@@ -1205,6 +1544,7 @@ static ucmd_t ucmds[] = {
 	{"nextdl", SV_NextDownload_f},
 	{"stopdl", SV_StopDownload_f},
 	{"donedl", SV_DoneDownload_f},
+	{"dlack", SV_DownloadAck_f},
 
 	{NULL, NULL}
 };
@@ -1314,9 +1654,92 @@ void SV_ClientThink (client_t *cl, usercmd_t *cmd) {
 		return;		// may have been kicked during the last usercmd
 	}
 
+	sv.usercmdCalls++;
 	VM_Call( gvm, GAME_CLIENT_THINK, cl - svs.clients );
 }
 
+/*
+==================
+SV_RunClientUsercmds
+
+One trip into the game for all the queued usercmds of the client
+==================
+*/
+static void SV_RunClientUsercmds( client_t *cl ) {
+	int		i, count;
+
+	count = cl->numPendingCmds;
+	cl->lastUsercmd = cl->pendingCmds[count - 1];
+
+	if ( cl->state == CS_ACTIVE ) {
+		sv.usercmdCalls++;
+		if ( VM_Call( gvm, GAME_CLIENT_THINK_USERCMDS, cl - svs.clients ) == -1 ) {
+			// a game that can only take them one at a time
+			for ( i = 0 ; i < count ; i++ ) {
+				SV_ClientThink( cl, &cl->pendingCmds[i] );
+			}
+		}
+	}
+
+	cl->numPendingCmds = 0;
+}
+
+/*
+==================
+SV_RunPendingUsercmds
+
+Called by SV_Frame before every game frame.  With sv_tickCommands the
+usercmds aren't run as the packets come in, but in one pass per tick
+right before the game frame, with one trip into the game per client
+instead of one for every usercmd between the frames of a high sv_fps
+server.
+==================
+*/
+void SV_RunPendingUsercmds( void ) {
+	int			i;
+	client_t	*cl;
+
+	for ( i = 0, cl = svs.clients ; i < sv_maxclients->integer ; i++, cl++ ) {
+		if ( cl->numPendingCmds ) {
+			SV_RunClientUsercmds( cl );
+		}
+	}
+}
+
+/*
+==================
+SV_QueueUsercmd
+==================
+*/
+static void SV_QueueUsercmd( client_t *cl, usercmd_t *cmd ) {
+	// a client sending faster than the server ticks runs the older ones now
+	if ( cl->numPendingCmds == MAX_PENDING_USERCMDS ) {
+		SV_RunClientUsercmds( cl );
+	}
+	cl->pendingCmds[cl->numPendingCmds++] = *cmd;
+}
+
+/*
+==================
+SV_ClientUsercmd
+
+A new usercmd from a client or a bot, run now or queued for the next
+tick with sv_tickCommands
+==================
+*/
+void SV_ClientUsercmd( client_t *cl, usercmd_t *cmd ) {
+	if ( sv_tickCommands->integer ) {
+		SV_QueueUsercmd( cl, cmd );
+		return;
+	}
+
+	// queued before sv_tickCommands was turned off, they go first
+	if ( cl->numPendingCmds ) {
+		SV_RunClientUsercmds( cl );
+	}
+	SV_ClientThink( cl, cmd );
+}
+
 /*
 ==================
 SV_UserMove
@@ -1332,6 +1755,7 @@ each of the backup packets.
 static void SV_UserMove( client_t *cl, msg_t *msg, qboolean delta ) {
 	int			i, key;
 	int			cmdCount;
+	int			lastTime;
 	usercmd_t	nullcmd;
 	usercmd_t	cmds[MAX_PACKET_USERCMDS];
 	usercmd_t	*cmd, *oldcmd;
@@ -1408,6 +1832,12 @@ static void SV_UserMove( client_t *cl, msg_t *msg, qboolean delta ) {
 	// of ones we have previously received, but the servertimes
 	// in the commands will cause them to be immediately discarded
 	for ( i =  0 ; i < cmdCount ; i++ ) {
+		if ( cl->numPendingCmds ) {
+			lastTime = cl->pendingCmds[cl->numPendingCmds - 1].serverTime;
+		} else {
+			lastTime = cl->lastUsercmd.serverTime;
+		}
+
 		// if this is a cmd from before a map_restart ignore it
 		if ( cmds[i].serverTime > cmds[cmdCount-1].serverTime ) {
 			continue;
@@ -1418,10 +1848,10 @@ static void SV_UserMove( client_t *cl, msg_t *msg, qboolean delta ) {
 		//}
 		// don't execute if this is an old cmd which is already executed
 		// these old cmds are included when cl_packetdup > 0
-		if ( cmds[i].serverTime <= cl->lastUsercmd.serverTime ) {
+		if ( cmds[i].serverTime <= lastTime ) {
 			continue;
 		}
-		SV_ClientThink (cl, &cmds[ i ]);
+		SV_ClientUsercmd( cl, &cmds[ i ] );
 	}
 }
 
@@ -0,0 +1,1412 @@
+/*
+===========================================================================
+Copyright (C) 1999-2005 Id Software, Inc.
+
+This file is part of Quake III Arena source code.
+
+Quake III Arena source code is free software; you can redistribute it
+and/or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation; either version 2 of the License,
+or (at your option) any later version.
+
+Quake III Arena source code is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Foobar; if not, write to the Free Software
+Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+===========================================================================
+*/
+// sv_demo.c -- server side demos of the whole world
+
+#include "server.h"
+
+/*
+=============================================================================
+
+A server demo records what every client could be sent instead of what one
+client saw: all the entities that aren't SVF_NOCLIENT and the playerState
+of every active client, delta compressed against the previous game frame.
+The frame is encoded right after the game has run, and the file writes
+happen on a thread of their own through Sys_StreamedWrite, so the server
+frame only pays for the encoding.
+
+svdemo_extract turns a server demo into a normal client demo from the point
+of view of any client, which the demo command plays back.  The client gets
+a new gamestate whenever it comes back into the game, like a reconnect.
+
+The file is a series of messages, each one prefixed with its length:
+
+1	demo_gamestate		(first message only)
+4	SVDEMO_VERSION
+4	sv_maxclients
+<svc_configstring and svc_baseline as in a gamestate, up to svc_EOF>
+
+1	demo_configstring
+2	index
+<big string>
+
+1	demo_serverCommand
+2	client number, -1 for a broadcast
+<big string>
+
+1	demo_frame
+4	serverTime
+1	keyframe, nothing is delta compressed
+<client number, delta playerState> ... MAX_GENTITIES-1
+<delta entities> ... MAX_GENTITIES-1
+<entity number, svFlags, singleClient> ... MAX_GENTITIES-1
+	for the entities only some clients are sent
+
+1	demo_EOF
+
+svrecord [name]					start recording demos/<name>.svdm_<protocol>
+svstoprecord					stop recording
+svdemo_extract <name> <client>	write demos/<name>-<client>.dm_<protocol>
+svdemo_bench [frames] [runs]	time the encoding of the next frames
+
+=============================================================================
+*/
+
+#define	SVDEMO_VERSION			2
+#define	SVDEMO_MSGLEN			0x40000		// a keyframe of every entity and client
+#define	SVDEMO_WRITE_BUFFER		0x100000	// several seconds of a stalled disk
+
+// the cgame never gets more entities than MAX_ENTITIES_IN_SNAPSHOT
+#define	MAX_EXTRACTED_ENTITIES	256
+#define	MAX_EXTRACTED_COMMANDS	128
+
+#define	SVDEMO_VISIBILITY_FLAGS	( SVF_SINGLECLIENT | SVF_NOTSINGLECLIENT | SVF_CLIENTMASK )
+
+typedef enum {
+	demo_EOF,
+	demo_gamestate,
+	demo_configstring,
+	demo_serverCommand,
+	demo_frame
+} demoOps_t;
+
+typedef struct {
+	int				numEntities;
+	entityState_t	entities[MAX_GENTITIES];		// sorted by number
+	int				visFlags[MAX_GENTITIES];		// SVDEMO_VISIBILITY_FLAGS, by entity number
+	int				visClient[MAX_GENTITIES];		// singleClient, by entity number
+	qboolean		playerValid[MAX_CLIENTS];
+	playerState_t	players[MAX_CLIENTS];
+} demoFrame_t;
+
+typedef struct {
+	entityState_t	baselines[MAX_GENTITIES];
+	demoFrame_t		frames[2];
+	int				current;		// frames[current] is the last complete frame
+} demoWorld_t;
+
+typedef struct {
+	qboolean		recording;
+	fileHandle_t	file;
+	char			name[MAX_QPATH];
+
+	qboolean		keyframe;				// nothing has been written to delta from
+	qboolean		resyncConfigstrings;	// a message was lost, send them all again
+	qboolean		configstringsModified;
+	qboolean		configstringModified[MAX_CONFIGSTRINGS];
+
+	// the message being built, server commands are added as they come
+	msg_t			msg;
+	byte			block[4 + SVDEMO_MSGLEN];
+
+	int				startTime;
+	int				frames;
+	int				bytes;
+	int				droppedMessages;
+} demoRecorder_t;
+
+typedef struct {
+	demoWorld_t		world;
+	int				framesLeft;
+	int				runs;
+	int				frames;
+	int				entities;
+	int				players;
+	int				deltaMsec;
+	int				deltaBytes;
+	int				keyframeMsec;
+	int				keyframeBytes;
+	byte			msgBuffer[SVDEMO_MSGLEN];
+} demoBench_t;
+
+typedef struct {
+	demoWorld_t		world;
+	char			*configstrings[MAX_CONFIGSTRINGS];
+
+	// what the extracted client was sent last, deltaValid
+	// is only set while the client is in the game
+	qboolean		deltaValid;
+	playerState_t	ps;
+	int				numEntities;
+	entityState_t	entities[MAX_EXTRACTED_ENTITIES];
+
+	// the snapshot being written
+	entityState_t	*candidates[MAX_GENTITIES];
+	entityState_t	snapEntities[MAX_EXTRACTED_ENTITIES];
+
+	// server commands waiting for the next snapshot
+	qboolean		configstringsModified;
+	qboolean		configstringModified[MAX_CONFIGSTRINGS];
+	char			commands[MAX_EXTRACTED_COMMANDS][MAX_STRING_CHARS];
+	int				commandHead;
+	int				commandTail;
+	int				commandSequence;
+	int				droppedCommands;
+
+	fileHandle_t	out;
+	int				messageSequence;
+	int				snapshots;
+
+	byte			readBuffer[SVDEMO_MSGLEN];
+	byte			writeBuffer[MAX_MSGLEN];
+} demoExtract_t;
+
+static demoRecorder_t	svDemo;
+static demoWorld_t		svDemoWorld;
+static demoBench_t		*svDemoBench;
+
+/*
+=============================================================================
+
+DELTA ENCODING
+
+=============================================================================
+*/
+
+/*
+==================
+SV_DemoWriteEntities
+
+Same as SV_EmitPacketEntities, on sorted arrays of entities
+==================
+*/
+static void SV_DemoWriteEntities( msg_t *msg, entityState_t *from, int numFrom,
+								 entityState_t *to, int numTo, entityState_t *baselines ) {
+	int		oldindex, newindex;
+	int		oldnum, newnum;
+
+	oldindex = 0;
+	newindex = 0;
+	while ( newindex < numTo || oldindex < numFrom ) {
+		newnum = newindex < numTo ? to[newindex].number : 9999;
+		oldnum = oldindex < numFrom ? from[oldindex].number : 9999;
+
+		if ( newnum == oldnum ) {
+			// nothing is written if the entity hasn't changed
+			MSG_WriteDeltaEntity( msg, &from[oldindex], &to[newindex], qfalse );
+			oldindex++;
+			newindex++;
+		} else if ( newnum < oldnum ) {
+			// a new entity, sent from the baseline
+			MSG_WriteDeltaEntity( msg, &baselines[newnum], &to[newindex], qtrue );
+			newindex++;
+		} else {
+			// the old entity is gone
+			MSG_WriteDeltaEntity( msg, &from[oldindex], NULL, qtrue );
+			oldindex++;
+		}
+	}
+
+	MSG_WriteBits( msg, (MAX_GENTITIES-1), GENTITYNUM_BITS );
+}
+
+/*
+==================
+SV_DemoReadEntities
+
+Same as CL_ParsePacketEntities, to holds room for MAX_GENTITIES
+==================
+*/
+static qboolean SV_DemoReadEntities( msg_t *msg, entityState_t *from, int numFrom,
+								entityState_t *to, int *numTo, entityState_t *baselines ) {
+	int		oldindex;
+	int		newnum;
+	int		count;
+
+	oldindex = 0;
+	count = 0;
+	while ( 1 ) {
+		newnum = MSG_ReadBits( msg, GENTITYNUM_BITS );
+		if ( newnum == (MAX_GENTITIES-1) ) {
+			break;
+		}
+		if ( msg->readcount > msg->cursize ) {
+			return qfalse;
+		}
+
+		// entities in between didn't change
+		while ( oldindex < numFrom && from[oldindex].number < newnum ) {
+			to[count++] = from[oldindex++];
+		}
+
+		if ( oldindex < numFrom && from[oldindex].number == newnum ) {
+			MSG_ReadDeltaEntity( msg, &from[oldindex], &to[count], newnum );
+			oldindex++;
+		} else {
+			MSG_ReadDeltaEntity( msg, &baselines[newnum], &to[count], newnum );
+		}
+
+		// removed entities come back numbered MAX_GENTITIES-1
+		if ( to[count].number != (MAX_GENTITIES-1) ) {
+			count++;
+		}
+	}
+
+	while ( oldindex < numFrom ) {
+		to[count++] = from[oldindex++];
+	}
+
+	*numTo = count;
+	return qtrue;
+}
+
+/*
+==================
+SV_DemoCaptureFrame
+
+Copies everything a client could be sent out of the game
+==================
+*/
+static void SV_DemoCaptureFrame( demoFrame_t *frame ) {
+	int				e, i;
+	sharedEntity_t	*ent;
+	entityState_t	*state;
+	client_t		*cl;
+
+	frame->numEntities = 0;
+	for ( e = 0 ; e < sv.num_entities ; e++ ) {
+		ent = SV_GentityNum( e );
+		if ( !ent->r.linked || ( ent->r.svFlags & SVF_NOCLIENT ) ) {
+			continue;
+		}
+
+		state = &frame->entities[ frame->numEntities++ ];
+		*state = ent->s;
+		state->number = e;
+
+		frame->visFlags[e] = ent->r.svFlags & SVDEMO_VISIBILITY_FLAGS;
+		frame->visClient[e] = ent->r.singleClient;
+	}
+
+	for ( i = 0, cl = svs.clients ; i < sv_maxclients->integer ; i++, cl++ ) {
+		frame->playerValid[i] = ( cl->state == CS_ACTIVE );
+		if ( frame->playerValid[i] ) {
+			frame->players[i] = *SV_GameClientNum( i );
+		}
+	}
+}
+
+/*
+==================
+SV_DemoCopyBaselines
+
+The baselines as the gamestate has them, it leaves out the ones numbered 0
+==================
+*/
+static void SV_DemoCopyBaselines( demoWorld_t *world ) {
+	int		i;
+
+	for ( i = 0 ; i < MAX_GENTITIES ; i++ ) {
+		if ( sv.svEntities[i].baseline.number ) {
+			world->baselines[i] = sv.svEntities[i].baseline;
+		} else {
+			Com_Memset( &world->baselines[i], 0, sizeof( world->baselines[i] ) );
+		}
+	}
+}
+
+/*
+==================
+SV_DemoEncodeFrame
+
+Captures the current world and writes it as a delta from the last frame of
+world, which only moves on to the new frame once the caller sets current
+==================
+*/
+static void SV_DemoEncodeFrame( demoWorld_t *world, msg_t *msg, qboolean keyframe ) {
+	demoFrame_t		*last, *frame;
+	int				i, num;
+
+	last = &world->frames[ world->current ];
+	frame = &world->frames[ world->current ^ 1 ];
+
+	SV_DemoCaptureFrame( frame );
+
+	MSG_WriteByte( msg, demo_frame );
+	MSG_WriteLong( msg, svs.time );
+	MSG_WriteByte( msg, keyframe );
+
+	for ( i = 0 ; i < sv_maxclients->integer ; i++ ) {
+		if ( !frame->playerValid[i] ) {
+			continue;
+		}
+		MSG_WriteBits( msg, i, GENTITYNUM_BITS );
+		if ( !keyframe && last->playerValid[i] ) {
+			MSG_WriteDeltaPlayerstate( msg, &last->players[i], &frame->players[i] );
+		} else {
+			MSG_WriteDeltaPlayerstate( msg, NULL, &frame->players[i] );
+		}
+	}
+	MSG_WriteBits( msg, (MAX_GENTITIES-1), GENTITYNUM_BITS );
+
+	if ( keyframe ) {
+		SV_DemoWriteEntities( msg, NULL, 0, frame->entities, frame->numEntities, world->baselines );
+	} else {
+		SV_DemoWriteEntities( msg, last->entities, last->numEntities,
+			frame->entities, frame->numEntities, world->baselines );
+	}
+
+	for ( i = 0 ; i < frame->numEntities ; i++ ) {
+		num = frame->entities[i].number;
+		if ( !frame->visFlags[num] ) {
+			continue;
+		}
+		MSG_WriteBits( msg, num, GENTITYNUM_BITS );
+		MSG_WriteLong( msg, frame->visFlags[num] );
+		MSG_WriteLong( msg, frame->visClient[num] );
+	}
+	MSG_WriteBits( msg, (MAX_GENTITIES-1), GENTITYNUM_BITS );
+}
+
+/*
+==================
+SV_DemoReadFrame
+
+The reading side of SV_DemoEncodeFrame, qfalse if the frame is corrupt
+==================
+*/
+static qboolean SV_DemoReadFrame( demoWorld_t *world, msg_t *msg, int *serverTime ) {
+	demoFrame_t		*last, *frame;
+	qboolean		keyframe;
+	qboolean		valid;
+	int				i, num;
+
+	last = &world->frames[ world->current ];
+	frame = &world->frames[ world->current ^ 1 ];
+
+	*serverTime = MSG_ReadLong( msg );
+	keyframe = MSG_ReadByte( msg );
+
+	Com_Memset( frame->playerValid, 0, sizeof( frame->playerValid ) );
+	while ( 1 ) {
+		i = MSG_ReadBits( msg, GENTITYNUM_BITS );
+		if ( i == (MAX_GENTITIES-1) ) {
+			break;
+		}
+		if ( i < 0 || i >= MAX_CLIENTS ) {
+			return qfalse;
+		}
+		if ( !keyframe && last->playerValid[i] ) {
+			MSG_ReadDeltaPlayerstate( msg, &last->players[i], &frame->players[i] );
+		} else {
+			MSG_ReadDeltaPlayerstate( msg, NULL, &frame->players[i] );
+		}
+		frame->playerValid[i] = qtrue;
+	}
+
+	if ( keyframe ) {
+		valid = SV_DemoReadEntities( msg, NULL, 0, frame->entities, &frame->numEntities, world->baselines );
+	} else {
+		valid = SV_DemoReadEntities( msg, last->entities, last->numEntities,
+			frame->entities, &frame->numEntities, world->baselines );
+	}
+	if ( !valid ) {
+		return qfalse;
+	}
+
+	for ( i = 0 ; i < frame->numEntities ; i++ ) {
+		frame->visFlags[ frame->entities[i].number ] = 0;
+	}
+	while ( 1 ) {
+		num = MSG_ReadBits( msg, GENTITYNUM_BITS );
+		if ( num == (MAX_GENTITIES-1) ) {
+			break;
+		}
+		if ( msg->readcount > msg->cursize ) {
+			return qfalse;
+		}
+		frame->visFlags[num] = MSG_ReadLong( msg );
+		frame->visClient[num] = MSG_ReadLong( msg );
+	}
+
+	if ( msg->readcount > msg->cursize ) {
+		return qfalse;
+	}
+
+	world->current ^= 1;
+	return qtrue;
+}
+
+/*
+=============================================================================
+
+RECORDING
+
+=============================================================================
+*/
+
+/*
+==================
+SV_DemoFlush
+
+Hands the message to the writer thread and starts a new one.  If the
+thread is too far behind the message is dropped; a frame in it is simply
+never used to delta from, the configstrings are sent again in full, and
+any server commands in it are lost for good.
+==================
+*/
+static qboolean SV_DemoFlush( void ) {
+	int			len;
+	qboolean	written;
+
+	MSG_WriteByte( &svDemo.msg, demo_EOF );
+
+	if ( svDemo.msg.overflowed ) {
+		Com_Printf( "SV_DemoFlush: overflowed\n" );
+		written = qfalse;
+	} else {
+		len = LittleLong( svDemo.msg.cursize );
+		Com_Memcpy( svDemo.block, &len, 4 );
+		written = Sys_StreamedWrite( svDemo.block, 4 + svDemo.msg.cursize, svDemo.file );
+	}
+
+	if ( written ) {
+		svDemo.bytes += 4 + svDemo.msg.cursize;
+	} else {
+		svDemo.droppedMessages++;
+		svDemo.resyncConfigstrings = qtrue;
+	}
+
+	MSG_Init( &svDemo.msg, svDemo.block + 4, SVDEMO_MSGLEN );
+	return written;
+}
+
+/*
+==================
+SV_DemoWriteConfigstrings
+==================
+*/
+static void SV_DemoWriteConfigstrings( void ) {
+	int		i;
+
+	if ( !svDemo.configstringsModified && !svDemo.resyncConfigstrings ) {
+		return;
+	}
+
+	for ( i = 0 ; i < MAX_CONFIGSTRINGS ; i++ ) {
+		if ( !svDemo.configstringModified[i] && !svDemo.resyncConfigstrings ) {
+			continue;
+		}
+		svDemo.configstringModified[i] = qfalse;
+
+		MSG_WriteByte( &svDemo.msg, demo_configstring );
+		MSG_WriteShort( &svDemo.msg, i );
+		MSG_WriteBigString( &svDemo.msg, sv.configstrings[i] );
+	}
+
+	svDemo.configstringsModified = qfalse;
+	svDemo.resyncConfigstrings = qfalse;
+}
+
+/*
+==================
+SV_DemoStartRecord
+==================
+*/
+static void SV_DemoStartRecord( const char *name ) {
+	char	filename[MAX_QPATH];
+
+	if ( svDemo.recording ) {
+		Com_Printf( "Already recording %s.\n", svDemo.name );
+		return;
+	}
+
+	if ( sv.state != SS_GAME ) {
+		Com_Printf( "Server is not running.\n" );
+		return;
+	}
+
+	Com_sprintf( filename, sizeof( filename ), "demos/%s.svdm_%d", name, PROTOCOL_VERSION );
+	svDemo.file = FS_FOpenFileWrite( filename );
+	if ( !svDemo.file ) {
+		Com_Printf( "ERROR: couldn't open %s.\n", filename );
+		return;
+	}
+	Com_Printf( "recording server demo to %s.\n", filename );
+
+	if ( !Sys_BeginStreamedWrite( svDemo.file, SVDEMO_WRITE_BUFFER ) ) {
+		Com_Printf( "WARNING: no writer thread, the server frame will wait on the disk\n" );
+	}
+
+	Q_strncpyz( svDemo.name, name, sizeof( svDemo.name ) );
+	svDemo.recording = qtrue;
+	svDemo.keyframe = qtrue;
+	svDemo.resyncConfigstrings = qfalse;
+	svDemo.configstringsModified = qfalse;
+	Com_Memset( svDemo.configstringModified, 0, sizeof( svDemo.configstringModified ) );
+	svDemo.startTime = svs.time;
+	svDemo.frames = 0;
+	svDemo.bytes = 0;
+	svDemo.droppedMessages = 0;
+
+	SV_DemoCopyBaselines( &svDemoWorld );
+	svDemoWorld.current = 0;
+	svDemoWorld.frames[0].numEntities = 0;
+	Com_Memset( svDemoWorld.frames[0].playerValid, 0, sizeof( svDemoWorld.frames[0].playerValid ) );
+
+	// the gamestate is the same one the clients get
+	MSG_Init( &svDemo.msg, svDemo.block + 4, SVDEMO_MSGLEN );
+	MSG_WriteByte( &svDemo.msg, demo_gamestate );
+	MSG_WriteLong( &svDemo.msg, SVDEMO_VERSION );
+	MSG_WriteLong( &svDemo.msg, sv_maxclients->integer );
+	SV_UpdateGamestate();
+	MSG_WriteBitStream( &svDemo.msg, sv.gamestate.data, 0, sv.gamestate.bits );
+	MSG_WriteByte( &svDemo.msg, svc_EOF );
+	SV_DemoFlush();
+
+	// configstrings are all in the gamestate
+	svDemo.resyncConfigstrings = qfalse;
+}
+
+/*
+==================
+SV_DemoStopRecord
+==================
+*/
+static void SV_DemoStopRecord( void ) {
+	qboolean	written;
+	int			frames;
+
+	if ( !svDemo.recording ) {
+		return;
+	}
+
+	// server commands since the last frame
+	if ( svDemo.msg.cursize ) {
+		SV_DemoFlush();
+	}
+
+	written = Sys_EndStreamedWrite( svDemo.file );
+	FS_FCloseFile( svDemo.file );
+	svDemo.file = 0;
+	svDemo.recording = qfalse;
+
+	frames = svDemo.frames ? svDemo.frames : 1;
+	Com_Printf( "stopped server demo %s: %i frames in %i seconds, %i KB, %i bytes per frame\n",
+		svDemo.name, svDemo.frames, ( svs.time - svDemo.startTime ) / 1000,
+		svDemo.bytes / 1024, svDemo.bytes / frames );
+	if ( svDemo.droppedMessages ) {
+		Com_Printf( "^3%i messages were dropped with their server commands, the disk couldn't keep up\n", svDemo.droppedMessages );
+	}
+	if ( !written ) {
+		Com_Printf( "^1writing %s failed, the demo is incomplete\n", svDemo.name );
+	}
+}
+
+/*
+==================
+SV_DemoDefaultName
+==================
+*/
+static void SV_DemoDefaultName( char *name, int size ) {
+	qtime_t	t;
+
+	Com_RealTime( &t );
+	Com_sprintf( name, size, "%04i%02i%02i-%02i%02i%02i-%s",
+		1900 + t.tm_year, t.tm_mon + 1, t.tm_mday, t.tm_hour, t.tm_min, t.tm_sec,
+		Cvar_VariableString( "mapname" ) );
+}
+
+/*
+==================
+SV_DemoAutoRecord
+
+Called when a map has been loaded or restarted, so every match ends up
+in a demo of its own when sv_autoRecordDemo is set
+==================
+*/
+void SV_DemoAutoRecord( void ) {
+	char	name[MAX_QPATH];
+
+	if ( !sv_autoRecordDemo->integer ) {
+		return;
+	}
+
+	SV_DemoDefaultName( name, sizeof( name ) );
+	SV_DemoStartRecord( name );
+}
+
+/*
+==================
+SV_DemoShutdown
+
+Called before the game is shut down or restarted, the baselines
+and the world a demo deltas against don't survive it
+==================
+*/
+void SV_DemoShutdown( void ) {
+	SV_DemoStopRecord();
+
+	if ( svDemoBench ) {
+		Z_Free( svDemoBench );
+		svDemoBench = NULL;
+	}
+}
+
+/*
+==================
+SV_DemoConfigstringModified
+==================
+*/
+void SV_DemoConfigstringModified( int index ) {
+	if ( !svDemo.recording ) {
+		return;
+	}
+
+	svDemo.configstringsModified = qtrue;
+	svDemo.configstringModified[index] = qtrue;
+}
+
+/*
+==================
+SV_DemoServerCommand
+
+Broadcasts are recorded once with client -1.  The configstrings changed
+so far go first, a command can depend on them
+==================
+*/
+void SV_DemoServerCommand( int clientNum, const char *cmd ) {
+	if ( !svDemo.recording ) {
+		return;
+	}
+
+	SV_DemoWriteConfigstrings();
+
+	if ( svDemo.msg.cursize > SVDEMO_MSGLEN / 2 ) {
+		SV_DemoFlush();
+	}
+
+	MSG_WriteByte( &svDemo.msg, demo_serverCommand );
+	MSG_WriteShort( &svDemo.msg, clientNum );
+	MSG_WriteBigString( &svDemo.msg, cmd );
+}
+
+/*
+==================
+SV_DemoBenchFrame
+
+Encodes the frame runs times as a delta and runs times as a keyframe
+==================
+*/
+static void SV_DemoBenchFrame( void ) {
+	demoBench_t		*bench;
+	demoFrame_t		*frame;
+	msg_t			msg;
+	int				i, msec;
+	float			encodes;
+
+	bench = svDemoBench;
+
+	msec = Sys_Milliseconds();
+	for ( i = 0 ; i < bench->runs ; i++ ) {
+		MSG_Init( &msg, bench->msgBuffer, sizeof( bench->msgBuffer ) );
+		SV_DemoEncodeFrame( &bench->world, &msg, qfalse );
+	}
+	bench->deltaMsec += Sys_Milliseconds() - msec;
+	bench->deltaBytes += msg.cursize;
+
+	msec = Sys_Milliseconds();
+	for ( i = 0 ; i < bench->runs ; i++ ) {
+		MSG_Init( &msg, bench->msgBuffer, sizeof( bench->msgBuffer ) );
+		SV_DemoEncodeFrame( &bench->world, &msg, qtrue );
+	}
+	bench->keyframeMsec += Sys_Milliseconds() - msec;
+	bench->keyframeBytes += msg.cursize;
+
+	bench->world.current ^= 1;
+	frame = &bench->world.frames[ bench->world.current ];
+	bench->entities += frame->numEntities;
+	for ( i = 0 ; i < MAX_CLIENTS ; i++ ) {
+		if ( frame->playerValid[i] ) {
+			bench->players++;
+		}
+	}
+	bench->frames++;
+
+	if ( --bench->framesLeft ) {
+		return;
+	}
+
+	encodes = (float)bench->frames * bench->runs;
+	Com_Printf( "%i frames x %i runs, %.1f entities and %.1f players per frame\n",
+		bench->frames, bench->runs, (float)bench->entities / bench->frames,
+		(float)bench->players / bench->frames );
+	Com_Printf( "delta frame: %.1f usec, %i bytes\n",
+		bench->deltaMsec * 1000.0f / encodes, bench->deltaBytes / bench->frames );
+	Com_Printf( "keyframe:    %.1f usec, %i bytes\n",
+		bench->keyframeMsec * 1000.0f / encodes, bench->keyframeBytes / bench->frames );
+
+	Z_Free( svDemoBench );
+	svDemoBench = NULL;
+}
+
+/*
+==================
+SV_DemoFrame
+
+Called after every game frame
+==================
+*/
+void SV_DemoFrame( void ) {
+	if ( svDemoBench ) {
+		SV_DemoBenchFrame();
+	}
+
+	if ( !svDemo.recording ) {
+		return;
+	}
+
+	SV_DemoWriteConfigstrings();
+	SV_DemoEncodeFrame( &svDemoWorld, &svDemo.msg, svDemo.keyframe );
+	if ( SV_DemoFlush() ) {
+		svDemoWorld.current ^= 1;
+		svDemo.keyframe = qfalse;
+		svDemo.frames++;
+	}
+}
+
+/*
+==================
+SV_Record_f
+
+svrecord [name]
+==================
+*/
+void SV_Record_f( void ) {
+	char	name[MAX_QPATH];
+
+	if ( Cmd_Argc() > 2 ) {
+		Com_Printf( "svrecord [name]\n" );
+		return;
+	}
+
+	if ( Cmd_Argc() == 2 ) {
+		Q_strncpyz( name, Cmd_Argv( 1 ), sizeof( name ) );
+	} else {
+		SV_DemoDefaultName( name, sizeof( name ) );
+	}
+
+	SV_DemoStartRecord( name );
+}
+
+/*
+==================
+SV_StopRecord_f
+==================
+*/
+void SV_StopRecord_f( void ) {
+	if ( !svDemo.recording ) {
+		Com_Printf( "Not recording a server demo.\n" );
+		return;
+	}
+
+	SV_DemoStopRecord();
+}
+
+/*
+==================
+SV_DemoBench_f
+
+Times the encoding of the coming frames, without writing anything
+svdemo_bench [frames] [runs]
+==================
+*/
+void SV_DemoBench_f( void ) {
+	demoBench_t	*bench;
+
+	if ( sv.state != SS_GAME ) {
+		Com_Printf( "Server is not running.\n" );
+		return;
+	}
+
+	if ( svDemoBench ) {
+		Com_Printf( "svdemo_bench: %i frames left\n", svDemoBench->framesLeft );
+		return;
+	}
+
+	bench = Z_Malloc( sizeof( *bench ) );
+
+	bench->framesLeft = Cmd_Argc() > 1 ? atoi( Cmd_Argv( 1 ) ) : 100;
+	if ( bench->framesLeft < 1 ) {
+		bench->framesLeft = 1;
+	}
+	bench->runs = Cmd_Argc() > 2 ? atoi( Cmd_Argv( 2 ) ) : 100;
+	if ( bench->runs < 1 ) {
+		bench->runs = 1;
+	}
+
+	SV_DemoCopyBaselines( &bench->world );
+
+	// the first frame to delta from
+	SV_DemoCaptureFrame( &bench->world.frames[0] );
+
+	svDemoBench = bench;
+}
+
+/*
+=============================================================================
+
+EXTRACTING A CLIENT DEMO
+
+=============================================================================
+*/
+
+static vec3_t	extractOrigin;
+
+/*
+==================
+SV_DemoCompareDistance
+==================
+*/
+static int QDECL SV_DemoCompareDistance( const void *a, const void *b ) {
+	const entityState_t	*ea, *eb;
+	float				da, db;
+
+	ea = *(const entityState_t **)a;
+	eb = *(const entityState_t **)b;
+	da = DistanceSquared( ea->pos.trBase, extractOrigin );
+	db = DistanceSquared( eb->pos.trBase, extractOrigin );
+
+	if ( da < db ) {
+		return -1;
+	}
+	return da > db;
+}
+
+/*
+==================
+SV_DemoCompareNumber
+==================
+*/
+static int QDECL SV_DemoCompareNumber( const void *a, const void *b ) {
+	return (*(const entityState_t **)a)->number - (*(const entityState_t **)b)->number;
+}
+
+/*
+==================
+SV_DemoEntityVisible
+
+The SVF_ flags tested by SV_AddEntitiesVisibleFromPoint.  There is no
+PVS in a server demo, so everything else is visible.
+==================
+*/
+static qboolean SV_DemoEntityVisible( demoFrame_t *frame, int num, int clientNum ) {
+	int		flags;
+	int		singleClient;
+
+	flags = frame->visFlags[num];
+	singleClient = frame->visClient[num];
+
+	if ( ( flags & SVF_SINGLECLIENT ) && singleClient != clientNum ) {
+		return qfalse;
+	}
+	if ( ( flags & SVF_NOTSINGLECLIENT ) && singleClient == clientNum ) {
+		return qfalse;
+	}
+	if ( ( flags & SVF_CLIENTMASK ) && ( clientNum >= 32 || !( singleClient & ( 1 << clientNum ) ) ) ) {
+		return qfalse;
+	}
+	return qtrue;
+}
+
+/*
+==================
+SV_DemoQueueCommand
+==================
+*/
+static void SV_DemoQueueCommand( demoExtract_t *ex, const char *cmd ) {
+	if ( ex->commandHead - ex->commandTail >= MAX_EXTRACTED_COMMANDS ) {
+		ex->droppedCommands++;
+		return;
+	}
+	Q_strncpyz( ex->commands[ ex->commandHead % MAX_EXTRACTED_COMMANDS ], cmd, MAX_STRING_CHARS );
+	ex->commandHead++;
+}
+
+/*
+==================
+SV_DemoWriteClientCommand
+==================
+*/
+static void SV_DemoWriteClientCommand( demoExtract_t *ex, msg_t *msg, const char *cmd ) {
+	MSG_WriteByte( msg, svc_serverCommand );
+	MSG_WriteLong( msg, ++ex->commandSequence );
+	MSG_WriteString( msg, cmd );
+}
+
+/*
+==================
+SV_DemoWriteClientConfigstring
+
+Split up the same way as SV_SendConfigstring, returns the number of commands
+==================
+*/
+static int SV_DemoWriteClientConfigstring( demoExtract_t *ex, msg_t *msg, int index ) {
+	int		len;
+	int		maxChunkSize = MAX_STRING_CHARS - 24;
+	int		sent, remaining, count;
+	char	*val, *cmd;
+	char	buf[MAX_STRING_CHARS];
+
+	val = ex->configstrings[index];
+	len = strlen( val );
+	if ( len < maxChunkSize ) {
+		SV_DemoWriteClientCommand( ex, msg, va( "cs %i \"%s\"\n", index, val ) );
+		return 1;
+	}
+
+	sent = 0;
+	remaining = len;
+	count = 0;
+	while ( remaining > 0 ) {
+		if ( sent == 0 ) {
+			cmd = "bcs0";
+		} else if ( remaining < maxChunkSize ) {
+			cmd = "bcs2";
+		} else {
+			cmd = "bcs1";
+		}
+		Q_strncpyz( buf, &val[sent], maxChunkSize );
+		SV_DemoWriteClientCommand( ex, msg, va( "%s %i \"%s\"\n", cmd, index, buf ) );
+		count++;
+
+		sent += maxChunkSize - 1;
+		remaining -= maxChunkSize - 1;
+	}
+	return count;
+}
+
+/*
+==================
+SV_DemoWriteClientMessage
+
+The same layout CL_WriteDemoMessage uses
+==================
+*/
+static void SV_DemoWriteClientMessage( demoExtract_t *ex, msg_t *msg ) {
+	int		len;
+
+	len = LittleLong( ex->messageSequence );
+	FS_Write( &len, 4, ex->out );
+	len = LittleLong( msg->cursize );
+	FS_Write( &len, 4, ex->out );
+	FS_Write( msg->data, msg->cursize, ex->out );
+
+	ex->messageSequence++;
+}
+
+/*
+==================
+SV_DemoWriteClientGamestate
+==================
+*/
+static qboolean SV_DemoWriteClientGamestate( demoExtract_t *ex, int clientNum ) {
+	msg_t			msg;
+	entityState_t	nullstate;
+	int				i;
+
+	MSG_Init( &msg, ex->writeBuffer, sizeof( ex->writeBuffer ) );
+	MSG_Bitstream( &msg );
+
+	MSG_WriteLong( &msg, 0 );
+
+	MSG_WriteByte( &msg, svc_gamestate );
+	MSG_WriteLong( &msg, ex->commandSequence );
+
+	// the gamestate holds every configstring, a new connection
+	// never gets the commands of the old one
+	ex->configstringsModified = qfalse;
+	Com_Memset( ex->configstringModified, 0, sizeof( ex->configstringModified ) );
+	ex->commandTail = ex->commandHead;
+
+	for ( i = 0 ; i < MAX_CONFIGSTRINGS ; i++ ) {
+		if ( !ex->configstrings[i][0] ) {
+			continue;
+		}
+		MSG_WriteByte( &msg, svc_configstring );
+		MSG_WriteShort( &msg, i );
+		MSG_WriteBigString( &msg, ex->configstrings[i] );
+	}
+
+	Com_Memset( &nullstate, 0, sizeof( nullstate ) );
+	for ( i = 0 ; i < MAX_GENTITIES ; i++ ) {
+		if ( !ex->world.baselines[i].number ) {
+			continue;
+		}
+		MSG_WriteByte( &msg, svc_baseline );
+		MSG_WriteDeltaEntity( &msg, &nullstate, &ex->world.baselines[i], qtrue );
+	}
+
+	MSG_WriteByte( &msg, svc_EOF );
+
+	MSG_WriteLong( &msg, clientNum );
+	MSG_WriteLong( &msg, 0 );		// checksum feed
+
+	MSG_WriteByte( &msg, svc_EOF );
+
+	if ( msg.overflowed ) {
+		Com_Printf( "svdemo_extract: gamestate overflowed\n" );
+		return qfalse;
+	}
+
+	SV_DemoWriteClientMessage( ex, &msg );
+
+	return qtrue;
+}
+
+/*
+==================
+SV_DemoWriteClientSnapshot
+
+Writes the last frame of the world as seen by clientNum, along with
+the server commands it got since the last snapshot
+==================
+*/
+static qboolean SV_DemoWriteClientSnapshot( demoExtract_t *ex, int clientNum, int serverTime ) {
+	demoFrame_t		*frame;
+	playerState_t	*ps;
+	msg_t			msg;
+	int				i, count, sent;
+
+	frame = &ex->world.frames[ ex->world.current ];
+	ps = &frame->players[clientNum];
+
+	// the same entities a client would get, nearest first if there are too many
+	count = 0;
+	for ( i = 0 ; i < frame->numEntities ; i++ ) {
+		if ( SV_DemoEntityVisible( frame, frame->entities[i].number, ps->clientNum ) ) {
+			ex->candidates[count++] = &frame->entities[i];
+		}
+	}
+	if ( count > MAX_EXTRACTED_ENTITIES ) {
+		VectorCopy( ps->origin, extractOrigin );
+		qsort( ex->candidates, count, sizeof( ex->candidates[0] ), SV_DemoCompareDistance );
+		count = MAX_EXTRACTED_ENTITIES;
+		qsort( ex->candidates, count, sizeof( ex->candidates[0] ), SV_DemoCompareNumber );
+	}
+	for ( i = 0 ; i < count ; i++ ) {
+		ex->snapEntities[i] = *ex->candidates[i];
+	}
+
+	MSG_Init( &msg, ex->writeBuffer, sizeof( ex->writeBuffer ) );
+	MSG_Bitstream( &msg );
+
+	MSG_WriteLong( &msg, 0 );
+
+	// the cgame only executes commands when it gets a snapshot, so keep them
+	// well inside the client's reliable command buffer and leave the rest
+	// for the next snapshot
+	sent = 0;
+	if ( ex->configstringsModified ) {
+		ex->configstringsModified = qfalse;
+		for ( i = 0 ; i < MAX_CONFIGSTRINGS ; i++ ) {
+			if ( !ex->configstringModified[i] ) {
+				continue;
+			}
+			if ( sent && ( sent >= MAX_RELIABLE_COMMANDS / 4
+				|| msg.cursize + strlen( ex->configstrings[i] ) > MAX_MSGLEN / 2 ) ) {
+				ex->configstringsModified = qtrue;
+				break;
+			}
+			sent += SV_DemoWriteClientConfigstring( ex, &msg, i );
+			ex->configstringModified[i] = qfalse;
+		}
+	}
+	while ( sent < MAX_RELIABLE_COMMANDS / 2 && ex->commandTail < ex->commandHead
+		&& msg.cursize < MAX_MSGLEN / 2 ) {
+		SV_DemoWriteClientCommand( ex, &msg, ex->commands[ ex->commandTail % MAX_EXTRACTED_COMMANDS ] );
+		ex->commandTail++;
+		sent++;
+	}
+
+	MSG_WriteByte( &msg, svc_snapshot );
+	MSG_WriteLong( &msg, serverTime );
+	MSG_WriteByte( &msg, ex->deltaValid );		// delta from the previous message
+	MSG_WriteByte( &msg, 0 );					// snapFlags
+	MSG_WriteByte( &msg, 0 );					// no areabits, every area is visible
+
+	if ( ex->deltaValid ) {
+		MSG_WriteDeltaPlayerstate( &msg, &ex->ps, ps );
+		SV_DemoWriteEntities( &msg, ex->entities, ex->numEntities, ex->snapEntities, count, ex->world.baselines );
+	} else {
+		MSG_WriteDeltaPlayerstate( &msg, NULL, ps );
+		SV_DemoWriteEntities( &msg, NULL, 0, ex->snapEntities, count, ex->world.baselines );
+	}
+
+	MSG_WriteByte( &msg, svc_EOF );
+
+	if ( msg.overflowed ) {
+		Com_Printf( "svdemo_extract: snapshot at %i overflowed\n", serverTime );
+		return qfalse;
+	}
+
+	SV_DemoWriteClientMessage( ex, &msg );
+
+	ex->deltaValid = qtrue;
+	ex->ps = *ps;
+	ex->numEntities = count;
+	Com_Memcpy( ex->entities, ex->snapEntities, count * sizeof( ex->entities[0] ) );
+	ex->snapshots++;
+
+	return qtrue;
+}
+
+/*
+==================
+SV_DemoReadMessage
+
+Reads the next length prefixed message, qfalse at the end of the file
+==================
+*/
+static qboolean SV_DemoReadMessage( demoExtract_t *ex, fileHandle_t f, msg_t *msg ) {
+	int		len;
+
+	if ( FS_Read( &len, 4, f ) != 4 ) {
+		return qfalse;
+	}
+	len = LittleLong( len );
+	if ( len <= 0 || len > sizeof( ex->readBuffer ) ) {
+		Com_Printf( "svdemo_extract: bad message length %i\n", len );
+		return qfalse;
+	}
+
+	MSG_Init( msg, ex->readBuffer, sizeof( ex->readBuffer ) );
+	if ( FS_Read( msg->data, len, f ) != len ) {
+		Com_Printf( "svdemo_extract: demo file is truncated\n" );
+		return qfalse;
+	}
+	msg->cursize = len;
+	MSG_BeginReading( msg );
+
+	return qtrue;
+}
+
+/*
+==================
+SV_DemoReadGamestate
+==================
+*/
+static qboolean SV_DemoReadGamestate( demoExtract_t *ex, msg_t *msg, int *maxclients ) {
+	entityState_t	nullstate;
+	int				cmd, i;
+
+	if ( MSG_ReadByte( msg ) != demo_gamestate ) {
+		Com_Printf( "svdemo_extract: not a server demo\n" );
+		return qfalse;
+	}
+	i = MSG_ReadLong( msg );
+	if ( i != SVDEMO_VERSION ) {
+		Com_Printf( "svdemo_extract: demo version %i, expected %i\n", i, SVDEMO_VERSION );
+		return qfalse;
+	}
+	*maxclients = MSG_ReadLong( msg );
+
+	Com_Memset( &nullstate, 0, sizeof( nullstate ) );
+	while ( 1 ) {
+		cmd = MSG_ReadByte( msg );
+		if ( cmd == svc_EOF ) {
+			break;
+		}
+
+		if ( cmd == svc_configstring ) {
+			i = MSG_ReadShort( msg );
+			if ( i < 0 || i >= MAX_CONFIGSTRINGS ) {
+				Com_Printf( "svdemo_extract: bad configstring index %i\n", i );
+				return qfalse;
+			}
+			Z_Free( ex->configstrings[i] );
+			ex->configstrings[i] = CopyString( MSG_ReadBigString( msg ) );
+		} else if ( cmd == svc_baseline ) {
+			i = MSG_ReadBits( msg, GENTITYNUM_BITS );
+			if ( i < 0 || i >= MAX_GENTITIES ) {
+				Com_Printf( "svdemo_extract: bad baseline number %i\n", i );
+				return qfalse;
+			}
+			MSG_ReadDeltaEntity( msg, &nullstate, &ex->world.baselines[i], i );
+		} else {
+			Com_Printf( "svdemo_extract: bad gamestate command %i\n", cmd );
+			return qfalse;
+		}
+	}
+
+	return MSG_ReadByte( msg ) == demo_EOF;
+}
+
+/*
+==================
+SV_DemoExtract
+
+The client demo only starts once clientNum is in the game, its
+gamestate already holds every configstring changed before that
+==================
+*/
+static void SV_DemoExtract( demoExtract_t *ex, fileHandle_t f, int clientNum ) {
+	msg_t		msg;
+	int			maxclients;
+	int			cmd, i, serverTime;
+	qboolean	started;
+	char		*s;
+
+	if ( !SV_DemoReadMessage( ex, f, &msg ) || !SV_DemoReadGamestate( ex, &msg, &maxclients ) ) {
+		return;
+	}
+	if ( clientNum >= maxclients ) {
+		Com_Printf( "svdemo_extract: the demo only has %i clients\n", maxclients );
+		return;
+	}
+
+	started = qfalse;
+	while ( SV_DemoReadMessage( ex, f, &msg ) ) {
+		while ( 1 ) {
+			cmd = MSG_ReadByte( &msg );
+			if ( msg.readcount > msg.cursize ) {
+				Com_Printf( "svdemo_extract: read past the end of a message\n" );
+				return;
+			}
+			if ( cmd == demo_EOF ) {
+				break;
+			}
+
+			switch ( cmd ) {
+			case demo_configstring:
+				i = MSG_ReadShort( &msg );
+				if ( i < 0 || i >= MAX_CONFIGSTRINGS ) {
+					Com_Printf( "svdemo_extract: bad configstring index %i\n", i );
+					return;
+				}
+				s = MSG_ReadBigString( &msg );
+				// all of them are written again after a dropped message
+				if ( !strcmp( s, ex->configstrings[i] ) ) {
+					break;
+				}
+				Z_Free( ex->configstrings[i] );
+				ex->configstrings[i] = CopyString( s );
+				if ( ex->deltaValid ) {
+					ex->configstringsModified = qtrue;
+					ex->configstringModified[i] = qtrue;
+				}
+				break;
+
+			case demo_serverCommand:
+				i = MSG_ReadShort( &msg );
+				s = MSG_ReadBigString( &msg );
+				// only while the client is in the game
+				if ( ex->deltaValid && ( i == -1 || i == clientNum ) ) {
+					SV_DemoQueueCommand( ex, s );
+				}
+				break;
+
+			case demo_frame:
+				if ( !SV_DemoReadFrame( &ex->world, &msg, &serverTime ) ) {
+					Com_Printf( "svdemo_extract: bad frame\n" );
+					return;
+				}
+				if ( !ex->world.frames[ ex->world.current ].playerValid[clientNum] ) {
+					// not in the game, the next snapshot can't be a delta
+					ex->deltaValid = qfalse;
+					break;
+				}
+				if ( !ex->deltaValid ) {
+					// entered the game, or came back as a new connection
+					if ( !SV_DemoWriteClientGamestate( ex, clientNum ) ) {
+						return;
+					}
+					started = qtrue;
+				}
+				if ( !SV_DemoWriteClientSnapshot( ex, clientNum, serverTime ) ) {
+					return;
+				}
+				break;
+
+			default:
+				Com_Printf( "svdemo_extract: bad demo command %i\n", cmd );
+				return;
+			}
+		}
+	}
+
+	if ( !started ) {
+		Com_Printf( "svdemo_extract: client %i never entered the game\n", clientNum );
+	}
+}
+
+/*
+==================
+SV_DemoExtract_f
+
+svdemo_extract <name> <clientnum>
+==================
+*/
+void SV_DemoExtract_f( void ) {
+	char			filename[MAX_QPATH];
+	char			outname[MAX_QPATH];
+	demoExtract_t	*ex;
+	fileHandle_t	f;
+	int				clientNum, i, len;
+
+	if ( Cmd_Argc() != 3 ) {
+		Com_Printf( "svdemo_extract <name> <clientnum>\n" );
+		return;
+	}
+
+	clientNum = atoi( Cmd_Argv( 2 ) );
+	if ( clientNum < 0 || clientNum >= MAX_CLIENTS ) {
+		Com_Printf( "Bad client number %i.\n", clientNum );
+		return;
+	}
+
+	Com_sprintf( filename, sizeof( filename ), "demos/%s.svdm_%d", Cmd_Argv( 1 ), PROTOCOL_VERSION );
+	FS_FOpenFileRead( filename, &f, qtrue );
+	if ( !f ) {
+		Com_Printf( "Couldn't open %s.\n", filename );
+		return;
+	}
+
+	Com_sprintf( outname, sizeof( outname ), "demos/%s-%i.dm_%d", Cmd_Argv( 1 ), clientNum, PROTOCOL_VERSION );
+
+	ex = Z_Malloc( sizeof( *ex ) );
+	for ( i = 0 ; i < MAX_CONFIGSTRINGS ; i++ ) {
+		ex->configstrings[i] = CopyString( "" );
+	}
+	ex->out = FS_FOpenFileWrite( outname );
+	if ( !ex->out ) {
+		Com_Printf( "ERROR: couldn't open %s.\n", outname );
+	} else {
+		SV_DemoExtract( ex, f, clientNum );
+
+		// the same end marker CL_StopRecord_f writes
+		len = -1;
+		FS_Write( &len, 4, ex->out );
+		FS_Write( &len, 4, ex->out );
+		FS_FCloseFile( ex->out );
+
+		Com_Printf( "wrote %i snapshots to %s\n", ex->snapshots, outname );
+		if ( ex->droppedCommands ) {
+			Com_Printf( "^3%i server commands didn't fit in between snapshots\n", ex->droppedCommands );
+		}
+	}
+
+	FS_FCloseFile( f );
+	for ( i = 0 ; i < MAX_CONFIGSTRINGS ; i++ ) {
+		Z_Free( ex->configstrings[i] );
+	}
+	Z_Free( ex );
+}
@@ -285,6 +285,30 @@ void SV_GetUsercmd( int clientNum, usercmd_t *cmd ) {
 	*cmd = svs.clients[clientNum].lastUsercmd;
 }
 
+/*
+===============
+SV_GetUsercmds
+
+The queued usercmds a GAME_CLIENT_THINK_USERCMDS call runs
+===============
+*/
+static int SV_GetUsercmds( int clientNum, usercmd_t *cmds, int maxcount ) {
+	client_t	*cl;
+	int			count;
+
+	if ( clientNum < 0 || clientNum >= sv_maxclients->integer ) {
+		Com_Error( ERR_DROP, "SV_GetUsercmds: bad clientNum:%i", clientNum );
+	}
+	cl = &svs.clients[clientNum];
+
+	count = cl->numPendingCmds;
+	if ( count > maxcount ) {
+		count = maxcount;
+	}
+	Com_Memcpy( cmds, cl->pendingCmds, count * sizeof( *cmds ) );
+	return count;
+}
+
 //==============================================
 
 static int	FloatAsInt( float f ) {
@@ -453,6 +477,25 @@ int SV_GameSystemCalls( int *args ) {
 	case G_SNAPVECTOR:
 		Sys_SnapVector( VMA(1) );
 		return 0;
+	case G_LOAD_MAP_FROM_MEMORY:
+		SV_LoadWorldFromMemory( VMA(1), args[2], VMA(3) );
+		return 0;
+	case G_TRACE_BATCH:
+		SV_TraceBatch( VMA(1), VMA(2), args[3] );
+		return 0;
+	case G_ENTITIES_IN_RADIUS:
+		return SV_EntitiesInRadius( VMA(1), VMF(2), args[3], VMA(4), args[5] );
+	case G_GET_USERCMDS:
+		return SV_GetUsercmds( args[1], VMA(2), args[3] );
+	case G_LINK_COUNT:
+		return sv.linkCount;
+	case G_RUN_JOBS:
+		// a qvm can't be entered from other threads
+		if ( !VM_IsNative( gvm ) ) {
+			Com_Error( ERR_DROP, "G_RUN_JOBS from a qvm" );
+		}
+		Sys_RunJobs( (void (*)( int ))VMA(1), args[2], args[3] );
+		return 0;
 
 		//====================================
 
@@ -490,7 +533,7 @@ int SV_GameSystemCalls( int *args ) {
 	case BOTLIB_GET_CONSOLE_MESSAGE:
 		return SV_BotGetConsoleMessage( args[1], VMA(2), args[3] );
 	case BOTLIB_USER_COMMAND:
-		SV_ClientThink( &svs.clients[args[1]], VMA(2) );
+		SV_ClientUsercmd( &svs.clients[args[1]], VMA(2) );
 		return 0;
 
 	case BOTLIB_AAS_BBOX_AREAS:
@@ -513,6 +556,8 @@ int SV_GameSystemCalls( int *args ) {
 
 	case BOTLIB_AAS_POINT_AREA_NUM:
 		return botlib_export->aas.AAS_PointAreaNum( VMA(1) );
+	case BOTLIB_AAS_POINT_AREA_NUMS:
+		return botlib_export->aas.AAS_PointAreaNums( VMA(1), VMA(2), args[3] );
 	case BOTLIB_AAS_POINT_REACHABILITY_AREA_INDEX:
 		return botlib_export->aas.AAS_PointReachabilityAreaIndex( VMA(1) );
 	case BOTLIB_AAS_TRACE_AREAS:
@@ -536,6 +581,8 @@ int SV_GameSystemCalls( int *args ) {
 
 	case BOTLIB_AAS_AREA_TRAVEL_TIME_TO_GOAL_AREA:
 		return botlib_export->aas.AAS_AreaTravelTimeToGoalArea( args[1], VMA(2), args[3], args[4] );
+	case BOTLIB_AAS_AREA_TRAVEL_TIMES_TO_GOAL_AREAS:
+		return botlib_export->aas.AAS_AreaTravelTimesToGoalAreas( VMA(1), VMA(2), VMA(3), args[4], VMA(5), args[6] );
 	case BOTLIB_AAS_ENABLE_ROUTING_AREA:
 		return botlib_export->aas.AAS_EnableRoutingArea( args[1], args[2] );
 	case BOTLIB_AAS_PREDICT_ROUTE:
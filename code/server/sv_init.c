@@ -22,17 +22,94 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "server.h"
 
+/*
+===============
+SV_FreeGamestateChunk
+===============
+*/
+static void SV_FreeGamestateChunk( gamestateChunk_t *chunk ) {
+	if ( chunk->data ) {
+		Z_Free( chunk->data );
+		chunk->data = NULL;
+	}
+	chunk->bits = 0;
+}
+
+/*
+===============
+SV_SaveGamestateChunk
+
+Keeps a copy of everything written to msg
+===============
+*/
+static void SV_SaveGamestateChunk( gamestateChunk_t *chunk, msg_t *msg ) {
+	chunk->data = Z_Malloc( msg->cursize );
+	Com_Memcpy( chunk->data, msg->data, msg->cursize );
+	chunk->bits = msg->bit;
+}
+
+/*
+===============
+SV_UpdateGamestate
+
+Encodes the configstrings and baselines of the gamestate message into
+sv.gamestate.  After a configstring change only that string is encoded
+again, the huffman codes don't depend on where they are in the stream.
+===============
+*/
+void SV_UpdateGamestate( void ) {
+	int				i;
+	entityState_t	*base, nullstate;
+	msg_t			msg;
+	byte			msgBuffer[MAX_MSGLEN];
+
+	if ( sv.gamestate.data ) {
+		return;
+	}
+
+	for ( i = 0 ; i < MAX_CONFIGSTRINGS ; i++ ) {
+		if ( !sv.configstrings[i][0] || sv.gamestateConfigstrings[i].data ) {
+			continue;
+		}
+		MSG_Init( &msg, msgBuffer, sizeof( msgBuffer ) );
+		MSG_WriteByte( &msg, svc_configstring );
+		MSG_WriteShort( &msg, i );
+		MSG_WriteBigString( &msg, sv.configstrings[i] );
+		SV_SaveGamestateChunk( &sv.gamestateConfigstrings[i], &msg );
+	}
+
+	if ( !sv.gamestateBaselines.data ) {
+		MSG_Init( &msg, msgBuffer, sizeof( msgBuffer ) );
+		Com_Memset( &nullstate, 0, sizeof( nullstate ) );
+		for ( i = 0 ; i < MAX_GENTITIES ; i++ ) {
+			base = &sv.svEntities[i].baseline;
+			if ( !base->number ) {
+				continue;
+			}
+			MSG_WriteByte( &msg, svc_baseline );
+			MSG_WriteDeltaEntity( &msg, &nullstate, base, qtrue );
+		}
+		SV_SaveGamestateChunk( &sv.gamestateBaselines, &msg );
+	}
+
+	MSG_Init( &msg, msgBuffer, sizeof( msgBuffer ) );
+	for ( i = 0 ; i < MAX_CONFIGSTRINGS ; i++ ) {
+		if ( sv.configstrings[i][0] ) {
+			MSG_WriteBitStream( &msg, sv.gamestateConfigstrings[i].data, 0, sv.gamestateConfigstrings[i].bits );
+		}
+	}
+	MSG_WriteBitStream( &msg, sv.gamestateBaselines.data, 0, sv.gamestateBaselines.bits );
+	SV_SaveGamestateChunk( &sv.gamestate, &msg );
+}
+
 /*
 ===============
 SV_SetConfigstring
 
+The clients get the change from SV_SendModifiedConfigstrings
 ===============
 */
 void SV_SetConfigstring (int index, const char *val) {
-	int		len, i;
-	int		maxChunkSize = MAX_STRING_CHARS - 24;
-	client_t	*client;
-
 	if ( index < 0 || index >= MAX_CONFIGSTRINGS ) {
 		Com_Error (ERR_DROP, "SV_SetConfigstring: bad index %i\n", index);
 	}
@@ -49,53 +126,163 @@ void SV_SetConfigstring (int index, const char *val) {
 	// change the string in sv
 	Z_Free( sv.configstrings[index] );
 	sv.configstrings[index] = CopyString( val );
+	SV_FreeGamestateChunk( &sv.gamestateConfigstrings[index] );
+	SV_FreeGamestateChunk( &sv.gamestate );
+	SV_DemoConfigstringModified( index );
 
 	// send it to all the clients if we aren't
 	// spawning a new server
 	if ( sv.state == SS_GAME || sv.restarting ) {
+		if ( sv.configstringModified[index] ) {
+			svs.configstringStats.coalesced++;
+		}
+		svs.configstringStats.changes++;
 
-		// send the data to all relevent clients
-		for (i = 0, client = svs.clients; i < sv_maxclients->integer ; i++, client++) {
-			if ( client->state < CS_PRIMED ) {
-				continue;
+		sv.configstringsModified = qtrue;
+		sv.configstringModified[index] = qtrue;
+		sv.configstringChanges[index]++;
+		sv.configstringBytes[index] += strlen( va( "cs %i \"%s\"\n", index, val ) );
+	}
+}
+
+/*
+===============
+SV_AddConfigstringCommand
+===============
+*/
+static void SV_AddConfigstringCommand( client_t *client, const char *cmd ) {
+	svs.configstringStats.commands++;
+	svs.configstringStats.bytes += strlen( cmd );
+	SV_AddServerCommand( client, cmd );
+}
+
+/*
+===============
+SV_SendConfigstring
+
+Sends a single configstring, split into bcs0 / bcs1 / bcs2
+commands if it doesn't fit in one
+===============
+*/
+static void SV_SendConfigstring( client_t *client, int index ) {
+	int		len;
+	int		maxChunkSize = MAX_STRING_CHARS - 24;
+	char	*val;
+
+	val = sv.configstrings[index];
+	len = strlen( val );
+	if( len >= maxChunkSize ) {
+		int		sent = 0;
+		int		remaining = len;
+		char	*cmd;
+		char	buf[MAX_STRING_CHARS];
+
+		while (remaining > 0 ) {
+			if ( sent == 0 ) {
+				cmd = "bcs0";
 			}
-			// do not always send server info to all clients
-			if ( index == CS_SERVERINFO && client->gentity && (client->gentity->r.svFlags & SVF_NOSERVERINFO) ) {
-				continue;
+			else if( remaining < maxChunkSize ) {
+				cmd = "bcs2";
 			}
-
-			len = strlen( val );
-			if( len >= maxChunkSize ) {
-				int		sent = 0;
-				int		remaining = len;
-				char	*cmd;
-				char	buf[MAX_STRING_CHARS];
-
-				while (remaining > 0 ) {
-					if ( sent == 0 ) {
-						cmd = "bcs0";
-					}
-					else if( remaining < maxChunkSize ) {
-						cmd = "bcs2";
-					}
-					else {
-						cmd = "bcs1";
-					}
-					Q_strncpyz( buf, &val[sent], maxChunkSize );
-
-					SV_SendServerCommand( client, "%s %i \"%s\"\n", cmd, index, buf );
-
-					sent += (maxChunkSize - 1);
-					remaining -= (maxChunkSize - 1);
-				}
-			} else {
-				// standard cs, just send it
-				SV_SendServerCommand( client, "cs %i \"%s\"\n", index, val );
+			else {
+				cmd = "bcs1";
 			}
+			Q_strncpyz( buf, &val[sent], maxChunkSize );
+
+			SV_AddConfigstringCommand( client, va( "%s %i \"%s\"\n", cmd, index, buf ) );
+
+			sent += (maxChunkSize - 1);
+			remaining -= (maxChunkSize - 1);
 		}
+	} else {
+		// standard cs, just send it
+		SV_AddConfigstringCommand( client, va( "cs %i \"%s\"\n", index, val ) );
 	}
 }
 
+/*
+===============
+SV_SendConfigstringsToClient
+
+Packs as many modified configstrings as fit into each "mcs" command
+if the client's cgame understands it
+===============
+*/
+static void SV_SendConfigstringsToClient( client_t *client ) {
+	char	cmd[MAX_STRING_CHARS];
+	char	entry[MAX_STRING_CHARS];
+	int		index, cmdLen, entryLen;
+
+	cmdLen = 0;
+	for ( index = 0 ; index < MAX_CONFIGSTRINGS ; index++ ) {
+		if ( !sv.configstringModified[index] ) {
+			continue;
+		}
+		// do not always send server info to all clients
+		if ( index == CS_SERVERINFO && client->gentity && (client->gentity->r.svFlags & SVF_NOSERVERINFO) ) {
+			continue;
+		}
+
+		svs.configstringStats.unbatchedCommands += sv.configstringChanges[index];
+		svs.configstringStats.unbatchedBytes += sv.configstringBytes[index];
+
+		if ( !client->multiConfigstrings || strlen( sv.configstrings[index] ) >= MAX_STRING_CHARS - 24 ) {
+			SV_SendConfigstring( client, index );
+			continue;
+		}
+
+		Com_sprintf( entry, sizeof( entry ), " %i \"%s\"", index, sv.configstrings[index] );
+		entryLen = strlen( entry );
+
+		// the client reads at most MAX_STRING_CHARS - 1 characters of a command
+		if ( cmdLen && cmdLen + entryLen >= MAX_STRING_CHARS ) {
+			SV_AddConfigstringCommand( client, cmd );
+			cmdLen = 0;
+		}
+		if ( !cmdLen ) {
+			strcpy( cmd, "mcs" );
+			cmdLen = 3;
+		}
+		Com_Memcpy( cmd + cmdLen, entry, entryLen + 1 );
+		cmdLen += entryLen;
+	}
+
+	if ( cmdLen ) {
+		SV_AddConfigstringCommand( client, cmd );
+	}
+}
+
+/*
+===============
+SV_SendModifiedConfigstrings
+
+Sends the final value of every configstring that changed since the last
+call.  Called at the end of the frame and from SV_AddServerCommand, so
+the clients still get every change before the commands that follow it.
+===============
+*/
+void SV_SendModifiedConfigstrings( void ) {
+	int			i;
+	client_t	*client;
+
+	if ( !sv.configstringsModified ) {
+		return;
+	}
+	// SV_AddServerCommand comes back here
+	sv.configstringsModified = qfalse;
+
+	for (i = 0, client = svs.clients; i < sv_maxclients->integer ; i++, client++) {
+		if ( client->state < CS_PRIMED ) {
+			continue;
+		}
+		SV_SendConfigstringsToClient( client );
+	}
+
+	Com_Memset( sv.configstringModified, 0, sizeof( sv.configstringModified ) );
+	Com_Memset( sv.configstringChanges, 0, sizeof( sv.configstringChanges ) );
+	Com_Memset( sv.configstringBytes, 0, sizeof( sv.configstringBytes ) );
+}
+
 
 
 /*
@@ -183,6 +370,9 @@ void SV_CreateBaseline( void ) {
 		//
 		sv.svEntities[entnum].baseline = svent->s;
 	}
+
+	SV_FreeGamestateChunk( &sv.gamestateBaselines );
+	SV_FreeGamestateChunk( &sv.gamestate );
 }
 
 
@@ -206,6 +396,38 @@ void SV_BoundMaxClients( int minimum ) {
 }
 
 
+/*
+===============
+SV_SetNumSnapshotEntities
+
+Sizes the snapshot entity ring and the state pool for sv_maxclients,
+the memory itself is allocated in SV_SpawnServer
+===============
+*/
+static void SV_SetNumSnapshotEntities( void ) {
+	int		backup;
+
+	if ( com_dedicated->integer ) {
+		backup = PACKET_BACKUP;
+	} else {
+		// we don't need nearly as many when playing locally
+		backup = 4;
+	}
+	svs.numSnapshotEntities = sv_maxclients->integer * backup * SNAPSHOT_ENTITIES_PER_CLIENT;
+
+	// every slot could reference a different state on small servers,
+	// large ones share the states between clients
+	svs.numSnapshotStates = svs.numSnapshotEntities;
+	if ( svs.numSnapshotStates > MAX_SNAPSHOT_STATES ) {
+		svs.numSnapshotStates = MAX_SNAPSHOT_STATES;
+	}
+
+	Com_DPrintf( "%i snapshot entities, %i snapshot states, %i KB\n", svs.numSnapshotEntities,
+		svs.numSnapshotStates, (int)( ( svs.numSnapshotEntities * sizeof( int )
+		+ svs.numSnapshotStates * ( sizeof( snapshotState_t ) + sizeof( int ) ) ) / 1024 ) );
+}
+
+
 /*
 ===============
 SV_Startup
@@ -223,12 +445,7 @@ void SV_Startup( void ) {
 	SV_BoundMaxClients( 1 );
 
 	svs.clients = Z_Malloc (sizeof(client_t) * sv_maxclients->integer );
-	if ( com_dedicated->integer ) {
-		svs.numSnapshotEntities = sv_maxclients->integer * PACKET_BACKUP * 64;
-	} else {
-		// we don't need nearly as many when playing locally
-		svs.numSnapshotEntities = sv_maxclients->integer * 4 * 64;
-	}
+	SV_SetNumSnapshotEntities();
 	svs.initialized = qtrue;
 
 	Cvar_Set( "sv_running", "1" );
@@ -293,12 +510,7 @@ void SV_ChangeMaxClients( void ) {
 	Hunk_FreeTempMemory( oldClients );
 	
 	// allocate new snapshot entities
-	if ( com_dedicated->integer ) {
-		svs.numSnapshotEntities = sv_maxclients->integer * PACKET_BACKUP * 64;
-	} else {
-		// we don't need nearly as many when playing locally
-		svs.numSnapshotEntities = sv_maxclients->integer * 4 * 64;
-	}
+	SV_SetNumSnapshotEntities();
 }
 
 /*
@@ -313,7 +525,10 @@ void SV_ClearServer(void) {
 		if ( sv.configstrings[i] ) {
 			Z_Free( sv.configstrings[i] );
 		}
+		SV_FreeGamestateChunk( &sv.gamestateConfigstrings[i] );
 	}
+	SV_FreeGamestateChunk( &sv.gamestateBaselines );
+	SV_FreeGamestateChunk( &sv.gamestate );
 	Com_Memset (&sv, 0, sizeof(sv));
 }
 
@@ -352,6 +567,7 @@ void SV_SpawnServer( char *server, qboolean killBots ) {
 	const char	*p;
 
 	// shut down the existing game if it is running
+	SV_DemoShutdown();
 	SV_ShutdownGameProgs();
 
 	Com_Printf ("------ Server Initialization ------\n");
@@ -384,8 +600,10 @@ void SV_SpawnServer( char *server, qboolean killBots ) {
 	FS_ClearPakReferences(0);
 
 	// allocate the snapshot entities on the hunk
-	svs.snapshotEntities = Hunk_Alloc( sizeof(entityState_t)*svs.numSnapshotEntities, h_high );
-	svs.nextSnapshotEntities = 0;
+	svs.snapshotEntities = Hunk_Alloc( sizeof(int)*svs.numSnapshotEntities, h_high );
+	svs.snapshotStates = Hunk_Alloc( sizeof(snapshotState_t)*svs.numSnapshotStates, h_high );
+	svs.freeSnapshotStates = Hunk_Alloc( sizeof(int)*svs.numSnapshotStates, h_high );
+	SV_InitSnapshotStates();
 
 	// toggle the server bit so clients can detect that a
 	// server has changed
@@ -540,6 +758,8 @@ void SV_SpawnServer( char *server, qboolean killBots ) {
 	// to all clients
 	sv.state = SS_GAME;
 
+	SV_DemoAutoRecord();
+
 	// send a heartbeat now so the master will get up to date info
 	SV_Heartbeat_f();
 
@@ -567,6 +787,8 @@ void SV_Init (void) {
 	sv_gametype = Cvar_Get ("g_gametype", "0", CVAR_SERVERINFO | CVAR_LATCH );
 	Cvar_Get ("sv_keywords", "", CVAR_SERVERINFO);
 	Cvar_Get ("protocol", va("%i", PROTOCOL_VERSION), CVAR_SERVERINFO | CVAR_ROM);
+	// the game and cgame modules check that they were built for the same MAX_CLIENTS
+	Cvar_Get ("sv_clientLimit", va("%i", MAX_CLIENTS), CVAR_SERVERINFO | CVAR_ROM);
 	sv_mapname = Cvar_Get ("mapname", "nomap", CVAR_SERVERINFO | CVAR_ROM);
 	sv_privateClients = Cvar_Get ("sv_privateClients", "0", CVAR_SERVERINFO);
 	sv_hostname = Cvar_Get ("sv_hostname", "noname", CVAR_SERVERINFO | CVAR_ARCHIVE );
@@ -599,6 +821,7 @@ void SV_Init (void) {
 	Cvar_Get ("nextmap", "", CVAR_TEMP );
 
 	sv_allowDownload = Cvar_Get ("sv_allowDownload", "0", CVAR_SERVERINFO);
+	sv_dlURL = Cvar_Get ("sv_dlURL", "", CVAR_SERVERINFO | CVAR_ARCHIVE);
 	sv_master[0] = Cvar_Get ("sv_master1", MASTER_SERVER_NAME, 0 );
 	sv_master[1] = Cvar_Get ("sv_master2", "", CVAR_ARCHIVE );
 	sv_master[2] = Cvar_Get ("sv_master3", "", CVAR_ARCHIVE );
@@ -611,6 +834,12 @@ void SV_Init (void) {
 	sv_mapChecksum = Cvar_Get ("sv_mapChecksum", "", CVAR_ROM);
 	sv_lanForceRate = Cvar_Get ("sv_lanForceRate", "1", CVAR_ARCHIVE );
 	sv_strictAuth = Cvar_Get ("sv_strictAuth", "1", CVAR_ARCHIVE );
+	sv_pacing = Cvar_Get ("sv_pacing", "0", CVAR_ARCHIVE );
+	sv_simulatedLink = Cvar_Get ("sv_simulatedLink", "0", CVAR_TEMP );
+	sv_tickCommands = Cvar_Get ("sv_tickCommands", "0", CVAR_ARCHIVE );
+	sv_maxSnaps = Cvar_Get ("sv_maxSnaps", "30", CVAR_ARCHIVE );
+	sv_dlRate = Cvar_Get ("sv_dlRate", "100", CVAR_ARCHIVE );
+	sv_autoRecordDemo = Cvar_Get ("sv_autoRecordDemo", "0", CVAR_ARCHIVE );
 
 	// initialize bot cvars so they are listed and can be set before loading the botlib
 	SV_BotInitCvars();
@@ -673,6 +902,7 @@ void SV_Shutdown( char *finalmsg ) {
 
 	SV_RemoveOperatorCommands();
 	SV_MasterShutdown();
+	SV_DemoShutdown();
 	SV_ShutdownGameProgs();
 
 	// free current level
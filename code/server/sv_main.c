@@ -32,6 +32,7 @@ cvar_t	*sv_zombietime;			// seconds to sink messages after disconnect
 cvar_t	*sv_rconPassword;		// password for remote server commands
 cvar_t	*sv_privatePassword;	// password for the privateClient slots
 cvar_t	*sv_allowDownload;
+cvar_t	*sv_dlURL;				// web server clients can fetch missing files from
 cvar_t	*sv_maxclients;
 
 cvar_t	*sv_privateClients;		// number of clients reserved for password
@@ -52,6 +53,12 @@ cvar_t	*sv_pure;
 cvar_t	*sv_floodProtect;
 cvar_t	*sv_lanForceRate; // dedicated 1 (LAN) server forces local client rates to 99999 (bug #491)
 cvar_t	*sv_strictAuth;
+cvar_t	*sv_pacing;			// msec a dedicated server spreads the snapshots of a frame over
+cvar_t	*sv_simulatedLink;	// bytes / second of a simulated uplink for pacing_stats
+cvar_t	*sv_tickCommands;	// run the usercmds of all clients at the start of every tick
+cvar_t	*sv_maxSnaps;		// highest snapshot rate a client can ask for with snaps
+cvar_t	*sv_dlRate;			// KB / second cap of every sliding window download, below the client rate
+cvar_t	*sv_autoRecordDemo;		// record a server demo of every map and map_restart
 
 /*
 =============================================================================
@@ -128,6 +135,9 @@ not have future snapshot_t executed before it is executed
 void SV_AddServerCommand( client_t *client, const char *cmd ) {
 	int		index, i;
 
+	// configstring changes made before this command have to get there first
+	SV_SendModifiedConfigstrings();
+
 	// this is very ugly but it's also a waste to for instance send multiple config string updates
 	// for the same config string index in one snapshot
 //	if ( SV_ReplacePendingServerCommands( client, cmd ) ) {
@@ -172,6 +182,8 @@ void QDECL SV_SendServerCommand(client_t *cl, const char *fmt, ...) {
 	Q_vsnprintf ((char *)message, sizeof(message), fmt,argptr);
 	va_end (argptr);
 
+	SV_DemoServerCommand( cl != NULL ? cl - svs.clients : -1, (char *)message );
+
 	if ( cl != NULL ) {
 		SV_AddServerCommand( cl, (char *)message );
 		return;
@@ -751,6 +763,9 @@ happen before SV_Frame is called
 void SV_Frame( int msec ) {
 	int		frameMsec;
 	int		startTime;
+	int		frameStartTime;
+	int		sendMsec;
+	int		ticks;
 
 	// the menu kills the server with this cvar
 	if ( sv_killserver->integer ) {
@@ -779,9 +794,19 @@ void SV_Frame( int msec ) {
 	if (!com_dedicated->integer) SV_BotFrame( svs.time + sv.timeResidual );
 
 	if ( com_dedicated->integer && sv.timeResidual < frameMsec ) {
+		// send the snapshots that were spread out over the frame
+		sendMsec = SV_SendPacedSnapshots();
+
+		// download acknowledgements that just came in make room for more blocks
+		SV_SendDownloadMessages();
+
 		// NET_Sleep will give the OS time slices until either get a packet
 		// or time enough for a server frame has gone by
-		NET_Sleep(frameMsec - sv.timeResidual);
+		if ( sendMsec >= 0 && sendMsec < frameMsec - sv.timeResidual ) {
+			NET_Sleep( sendMsec );
+		} else {
+			NET_Sleep(frameMsec - sv.timeResidual);
+		}
 		return;
 	}
 
@@ -817,6 +842,8 @@ void SV_Frame( int msec ) {
 		cvar_modifiedFlags &= ~CVAR_SYSTEMINFO;
 	}
 
+	frameStartTime = Sys_Milliseconds ();
+
 	if ( com_speeds->integer ) {
 		startTime = Sys_Milliseconds ();
 	} else {
@@ -829,12 +856,20 @@ void SV_Frame( int msec ) {
 	if (com_dedicated->integer) SV_BotFrame( svs.time );
 
 	// run the game simulation in chunks
+	ticks = 0;
 	while ( sv.timeResidual >= frameMsec ) {
+		// usercmds that arrived since the last tick
+		SV_RunPendingUsercmds();
+
 		sv.timeResidual -= frameMsec;
 		svs.time += frameMsec;
+		ticks++;
 
 		// let everything in the world think and move
 		VM_Call( gvm, GAME_RUN_FRAME, svs.time );
+
+		// record the world as it is after the game frame
+		SV_DemoFrame();
 	}
 
 	if ( com_speeds->integer ) {
@@ -845,7 +880,11 @@ void SV_Frame( int msec ) {
 	SV_CheckTimeouts();
 
 	// send messages back to the clients
+	SV_SendModifiedConfigstrings();
 	SV_SendClientMessages();
+	SV_SendDownloadMessages();
+
+	SV_BotSoakFrame( Sys_Milliseconds () - frameStartTime, ticks );
 
 	// send a heartbeat to the master if needed
 	SV_MasterHeartbeat();
@@ -45,6 +45,104 @@ A normal server packet will look like:
 =============================================================================
 */
 
+/*
+=============================================================================
+
+Delta cache
+
+Clients that acknowledged the same snapshot delta the same pooled entity
+states against each other, so the bits written for one client can be
+spliced into the message of the next.  The cache is only valid for one
+batch of snapshots, the pool indexes get reused after that.
+
+=============================================================================
+*/
+
+#define	DELTA_CACHE_HASH		4096
+#define	MAX_DELTA_CACHE_ENTRIES	8192
+#define	DELTA_CACHE_BYTES		0x40000
+
+typedef struct deltaCacheEntry_s {
+	int							from;		// snapshot state, or -1 - entity number for the baseline
+	int							to;			// snapshot state
+	int							start;		// first bit in deltaCache.data
+	int							bits;
+	struct deltaCacheEntry_s	*hashNext;
+} deltaCacheEntry_t;
+
+typedef struct {
+	int					batch;				// svs.snapshotStateBatch the entries were written in
+	msg_t				msg;				// the cached bits, every entry starts on a byte
+	int					numEntries;
+	deltaCacheEntry_t	entries[MAX_DELTA_CACHE_ENTRIES];
+	deltaCacheEntry_t	*hash[DELTA_CACHE_HASH];
+	byte				data[DELTA_CACHE_BYTES];
+} deltaCache_t;
+
+static deltaCache_t	deltaCache;
+
+/*
+=============
+SV_WriteDeltaSnapshotState
+
+Same as MSG_WriteDeltaEntity for two pooled states, or from the
+baseline if from is negative.  Forced if from the baseline.
+=============
+*/
+static void SV_WriteDeltaSnapshotState( msg_t *msg, int from, int to ) {
+	deltaCacheEntry_t	*entry;
+	entityState_t		*oldent, *newent;
+	int					hash, start;
+
+	if ( deltaCache.batch != svs.snapshotStateBatch ) {
+		if ( !deltaCache.msg.data ) {
+			MSG_Init( &deltaCache.msg, deltaCache.data, sizeof( deltaCache.data ) );
+		}
+		MSG_Clear( &deltaCache.msg );
+		Com_Memset( deltaCache.hash, 0, sizeof( deltaCache.hash ) );
+		deltaCache.numEntries = 0;
+		deltaCache.batch = svs.snapshotStateBatch;
+	}
+
+	hash = ( from * 31 + to ) & ( DELTA_CACHE_HASH - 1 );
+	for ( entry = deltaCache.hash[hash] ; entry ; entry = entry->hashNext ) {
+		if ( entry->from == from && entry->to == to ) {
+			MSG_WriteBitStream( msg, deltaCache.data, entry->start, entry->bits );
+			return;
+		}
+	}
+
+	newent = &svs.snapshotStates[to].s;
+	start = msg->bit;
+	if ( from < 0 ) {
+		oldent = &sv.svEntities[newent->number].baseline;
+		MSG_WriteDeltaEntity( msg, oldent, newent, qtrue );
+	} else {
+		oldent = &svs.snapshotStates[from].s;
+		MSG_WriteDeltaEntity( msg, oldent, newent, qfalse );
+	}
+
+	if ( msg->overflowed || deltaCache.numEntries == MAX_DELTA_CACHE_ENTRIES ) {
+		return;
+	}
+
+	// keep a copy for the next client that needs the same delta
+	deltaCache.msg.bit = ( deltaCache.msg.bit + 7 ) & ~7;
+	entry = &deltaCache.entries[deltaCache.numEntries];
+	entry->start = deltaCache.msg.bit;
+	entry->bits = msg->bit - start;
+	MSG_WriteBitStream( &deltaCache.msg, msg->data, start, entry->bits );
+	if ( deltaCache.msg.overflowed ) {
+		return;
+	}
+
+	entry->from = from;
+	entry->to = to;
+	entry->hashNext = deltaCache.hash[hash];
+	deltaCache.hash[hash] = entry;
+	deltaCache.numEntries++;
+}
+
 /*
 =============
 SV_EmitPacketEntities
@@ -56,6 +154,7 @@ static void SV_EmitPacketEntities( clientSnapshot_t *from, clientSnapshot_t *to,
 	entityState_t	*oldent, *newent;
 	int		oldindex, newindex;
 	int		oldnum, newnum;
+	int		oldstate, newstate;
 	int		from_num_entities;
 
 	// generate the delta update
@@ -67,20 +166,24 @@ static void SV_EmitPacketEntities( clientSnapshot_t *from, clientSnapshot_t *to,
 
 	newent = NULL;
 	oldent = NULL;
+	newstate = 0;
+	oldstate = 0;
 	newindex = 0;
 	oldindex = 0;
 	while ( newindex < to->num_entities || oldindex < from_num_entities ) {
 		if ( newindex >= to->num_entities ) {
 			newnum = 9999;
 		} else {
-			newent = &svs.snapshotEntities[(to->first_entity+newindex) % svs.numSnapshotEntities];
+			newstate = SV_SnapshotStateNum( to, newindex );
+			newent = &svs.snapshotStates[newstate].s;
 			newnum = newent->number;
 		}
 
 		if ( oldindex >= from_num_entities ) {
 			oldnum = 9999;
 		} else {
-			oldent = &svs.snapshotEntities[(from->first_entity+oldindex) % svs.numSnapshotEntities];
+			oldstate = SV_SnapshotStateNum( from, oldindex );
+			oldent = &svs.snapshotStates[oldstate].s;
 			oldnum = oldent->number;
 		}
 
@@ -88,7 +191,7 @@ static void SV_EmitPacketEntities( clientSnapshot_t *from, clientSnapshot_t *to,
 			// delta update from old position
 			// because the force parm is qfalse, this will not result
 			// in any bytes being emited if the entity has not changed at all
-			MSG_WriteDeltaEntity (msg, oldent, newent, qfalse );
+			SV_WriteDeltaSnapshotState( msg, oldstate, newstate );
 			oldindex++;
 			newindex++;
 			continue;
@@ -96,7 +199,7 @@ static void SV_EmitPacketEntities( clientSnapshot_t *from, clientSnapshot_t *to,
 
 		if ( newnum < oldnum ) {
 			// this is a new entity, send it from the baseline
-			MSG_WriteDeltaEntity (msg, &sv.svEntities[newnum].baseline, newent, qtrue );
+			SV_WriteDeltaSnapshotState( msg, -1 - newnum, newstate );
 			newindex++;
 			continue;
 		}
@@ -145,7 +248,8 @@ static void SV_WriteSnapshotToClient( client_t *client, msg_t *msg ) {
 		lastframe = client->netchan.outgoingSequence - client->deltaMessage;
 
 		// the snapshot's entities may still have rolled off the buffer, though
-		if ( oldframe->first_entity <= svs.nextSnapshotEntities - svs.numSnapshotEntities ) {
+		if ( oldframe->released
+			|| oldframe->first_entity <= svs.nextSnapshotEntities - svs.numSnapshotEntities ) {
 			Com_DPrintf ("%s: Delta request from out of date entities.\n", client->name);
 			oldframe = NULL;
 			lastframe = 0;
@@ -220,6 +324,179 @@ void SV_UpdateServerCommandsToClient( client_t *client, msg_t *msg ) {
 /*
 =============================================================================
 
+Pooled snapshot entity states
+
+Every slot of the svs.snapshotEntities ring holds one reference to a
+pooled entityState_t.  All the snapshots built in the same batch share a
+single copy of each entity, so the pool grows with the number of entities
+instead of with the number of clients times their entities.
+
+=============================================================================
+*/
+
+/*
+===============
+SV_InitSnapshotStates
+
+Called by SV_SpawnServer after the ring and the pool are allocated
+===============
+*/
+void SV_InitSnapshotStates( void ) {
+	int		i, j;
+
+	for ( i = 0 ; i < svs.numSnapshotEntities ; i++ ) {
+		svs.snapshotEntities[i] = -1;
+	}
+	svs.nextSnapshotEntities = 0;
+
+	for ( i = 0 ; i < svs.numSnapshotStates ; i++ ) {
+		svs.snapshotStates[i].refCount = 0;
+		svs.freeSnapshotStates[i] = svs.numSnapshotStates - 1 - i;
+	}
+	svs.numFreeSnapshotStates = svs.numSnapshotStates;
+
+	// the svEntities are cleared for every map, so they never match
+	svs.snapshotStateBatch++;
+
+	// snapshots from the previous map point into the old ring
+	for ( i = 0 ; i < sv_maxclients->integer ; i++ ) {
+		for ( j = 0 ; j < PACKET_BACKUP ; j++ ) {
+			svs.clients[i].frames[j].num_entities = 0;
+			svs.clients[i].frames[j].released = qtrue;
+		}
+	}
+}
+
+/*
+===============
+SV_ReleaseSnapshotState
+===============
+*/
+static void SV_ReleaseSnapshotState( int index ) {
+	snapshotState_t	*state;
+
+	state = &svs.snapshotStates[index];
+	if ( --state->refCount == 0 ) {
+		svs.freeSnapshotStates[svs.numFreeSnapshotStates++] = index;
+	}
+}
+
+/*
+===============
+SV_ReleaseSnapshotFrame
+
+Drops the references of all the entity slots of a snapshot
+that are still in the ring, it can't be delta'd from after this
+===============
+*/
+static void SV_ReleaseSnapshotFrame( clientSnapshot_t *frame ) {
+	int		i, slot;
+
+	for ( i = 0 ; i < frame->num_entities ; i++ ) {
+		slot = frame->first_entity + i;
+		// slots that rolled off were released when they got reused
+		if ( slot < svs.nextSnapshotEntities - svs.numSnapshotEntities ) {
+			continue;
+		}
+		slot %= svs.numSnapshotEntities;
+		if ( svs.snapshotEntities[slot] >= 0 ) {
+			SV_ReleaseSnapshotState( svs.snapshotEntities[slot] );
+			svs.snapshotEntities[slot] = -1;
+		}
+	}
+	frame->released = qtrue;
+}
+
+/*
+===============
+SV_ReleaseClientSnapshots
+
+Called by SV_DropClient
+===============
+*/
+void SV_ReleaseClientSnapshots( client_t *client ) {
+	int		i;
+
+	for ( i = 0 ; i < PACKET_BACKUP ; i++ ) {
+		SV_ReleaseSnapshotFrame( &client->frames[i] );
+	}
+
+	// the freed states can be reused before the batch is over
+	svs.snapshotStateBatch++;
+}
+
+/*
+===============
+SV_ReclaimSnapshotStates
+
+The pool ran dry, release every snapshot that isn't being built
+or delta'd from right now.  Those clients will just get a full
+snapshot the next time they ask for a delta from a released one.
+===============
+*/
+static void SV_ReclaimSnapshotStates( void ) {
+	client_t	*cl;
+	int			i, j;
+
+	Com_DPrintf( "snapshot states exhausted, releasing old snapshots\n" );
+
+	for ( i = 0, cl = svs.clients ; i < sv_maxclients->integer ; i++, cl++ ) {
+		for ( j = 0 ; j < PACKET_BACKUP ; j++ ) {
+			if ( j == ( cl->netchan.outgoingSequence & PACKET_MASK ) ) {
+				continue;
+			}
+			if ( cl->deltaMessage > 0 && j == ( cl->deltaMessage & PACKET_MASK ) ) {
+				continue;
+			}
+			SV_ReleaseSnapshotFrame( &cl->frames[j] );
+		}
+	}
+
+	// copies made for this batch may have been freed
+	svs.snapshotStateBatch++;
+}
+
+/*
+===============
+SV_AllocSnapshotState
+
+Returns -1 if the pool is exhausted even after reclaiming
+===============
+*/
+static int SV_AllocSnapshotState( void ) {
+	if ( !svs.numFreeSnapshotStates ) {
+		SV_ReclaimSnapshotStates();
+		if ( !svs.numFreeSnapshotStates ) {
+			return -1;
+		}
+	}
+	return svs.freeSnapshotStates[--svs.numFreeSnapshotStates];
+}
+
+/*
+===============
+SV_SnapshotStateNum
+
+Returns the pooled state of the index'th entity of a snapshot
+that hasn't been released or rolled off the ring
+===============
+*/
+int SV_SnapshotStateNum( clientSnapshot_t *frame, int index ) {
+	return svs.snapshotEntities[ ( frame->first_entity + index ) % svs.numSnapshotEntities ];
+}
+
+/*
+===============
+SV_SnapshotEntity
+===============
+*/
+entityState_t *SV_SnapshotEntity( clientSnapshot_t *frame, int index ) {
+	return &svs.snapshotStates[ SV_SnapshotStateNum( frame, index ) ].s;
+}
+
+/*
+=============================================================================
+
 Build a client snapshot structure
 
 =============================================================================
@@ -310,6 +587,8 @@ static void SV_AddEntitiesVisibleFromPoint( vec3_t origin, clientSnapshot_t *fra
 
 	c_fullsend = 0;
 
+	// every client walks every entity, and players are entities themselves,
+	// so building all the snapshots grows with the square of the player count
 	for ( e = 0 ; e < sv.num_entities ; e++ ) {
 		ent = SV_GentityNum(e);
 
@@ -439,7 +718,7 @@ static void SV_BuildClientSnapshot( client_t *client ) {
 	snapshotEntityNumbers_t		entityNumbers;
 	int							i;
 	sharedEntity_t				*ent;
-	entityState_t				*state;
+	int							*slot;
 	svEntity_t					*svEnt;
 	sharedEntity_t				*clent;
 	int							clientNum;
@@ -451,6 +730,10 @@ static void SV_BuildClientSnapshot( client_t *client ) {
 	// this is the frame we are creating
 	frame = &client->frames[ client->netchan.outgoingSequence & PACKET_MASK ];
 
+	// drop the entity states of the snapshot this one replaces
+	SV_ReleaseSnapshotFrame( frame );
+	frame->released = qfalse;
+
 	// clear everything in this snapshot
 	entityNumbers.numSnapshotEntities = 0;
 	Com_Memset( frame->areabits, 0, sizeof( frame->areabits ) );
@@ -498,13 +781,31 @@ static void SV_BuildClientSnapshot( client_t *client ) {
 		((int *)frame->areabits)[i] = ((int *)frame->areabits)[i] ^ -1;
 	}
 
-	// copy the entity states out
+	// reference the entity states, only the first snapshot
+	// of the batch that sees an entity copies its state
 	frame->num_entities = 0;
 	frame->first_entity = svs.nextSnapshotEntities;
 	for ( i = 0 ; i < entityNumbers.numSnapshotEntities ; i++ ) {
-		ent = SV_GentityNum(entityNumbers.snapshotEntities[i]);
-		state = &svs.snapshotEntities[svs.nextSnapshotEntities % svs.numSnapshotEntities];
-		*state = ent->s;
+		svEnt = &sv.svEntities[ entityNumbers.snapshotEntities[i] ];
+		if ( svEnt->snapshotStateBatch != svs.snapshotStateBatch ) {
+			svEnt->snapshotState = SV_AllocSnapshotState();
+			if ( svEnt->snapshotState < 0 ) {
+				Com_Printf( "WARNING: out of snapshot entity states for %s\n", client->name );
+				break;
+			}
+			ent = SV_GentityNum( entityNumbers.snapshotEntities[i] );
+			svs.snapshotStates[ svEnt->snapshotState ].s = ent->s;
+			svEnt->snapshotStateBatch = svs.snapshotStateBatch;
+		}
+
+		// reference the new state before the slot lets go of
+		// whatever it held when it was used last time around
+		svs.snapshotStates[ svEnt->snapshotState ].refCount++;
+		slot = &svs.snapshotEntities[svs.nextSnapshotEntities % svs.numSnapshotEntities];
+		if ( *slot >= 0 ) {
+			SV_ReleaseSnapshotState( *slot );
+		}
+		*slot = svEnt->snapshotState;
 		svs.nextSnapshotEntities++;
 		// this should never hit, map should always be restarted first in SV_Frame
 		if ( svs.nextSnapshotEntities >= 0x7FFFFFFE ) {
@@ -514,6 +815,27 @@ static void SV_BuildClientSnapshot( client_t *client ) {
 	}
 }
 
+/*
+====================
+SV_ClientRate
+
+The rate of the client in bytes / second, limited by sv_maxRate
+====================
+*/
+int SV_ClientRate( client_t *client ) {
+	int		rate;
+
+	rate = client->rate;
+	if ( sv_maxRate->integer ) {
+		if ( sv_maxRate->integer < 1000 ) {
+			Cvar_Set( "sv_MaxRate", "1000" );
+		}
+		if ( sv_maxRate->integer < rate ) {
+			rate = sv_maxRate->integer;
+		}
+	}
+	return rate;
+}
 
 /*
 ====================
@@ -523,27 +845,254 @@ Return the number of msec a given size message is supposed
 to take to clear, based on the current rate
 ====================
 */
-#define	HEADER_RATE_BYTES	48		// include our header, IP header, and some overhead
 static int SV_RateMsec( client_t *client, int messageSize ) {
-	int		rate;
 	int		rateMsec;
 
 	// individual messages will never be larger than fragment size
 	if ( messageSize > 1500 ) {
 		messageSize = 1500;
 	}
-	rate = client->rate;
-	if ( sv_maxRate->integer ) {
-		if ( sv_maxRate->integer < 1000 ) {
-			Cvar_Set( "sv_MaxRate", "1000" );
+	rateMsec = ( messageSize + HEADER_RATE_BYTES ) * 1000 / SV_ClientRate( client );
+
+	return rateMsec;
+}
+
+/*
+=============================================================================
+
+Snapshot pacing
+
+A dedicated server doesn't send all the snapshots of a frame in one burst.
+The messages are all written at the end of the frame, so every client sees
+the same world, but every client that is due gets a slot in the first
+sv_pacing msec after the frame to transmit it, the ones that have waited
+longest first, and SV_Frame sends them while it is waiting for the next
+frame.  Instead of holding a client off
+for as long as its last message takes at its rate, every client has a
+bucket of rate tokens that refills at its rate.
+
+=============================================================================
+*/
+
+static int		pacedClients[MAX_CLIENTS];
+static int		pacedSendTimes[MAX_CLIENTS];
+static int		numPacedClients;
+static int		nextPacedClient;
+
+// by client number
+static byte		pacedBuffers[MAX_CLIENTS][MAX_MSGLEN];
+static msg_t	pacedMessages[MAX_CLIENTS];
+static int		pacedSequences[MAX_CLIENTS];	// netchan.outgoingSequence it was written for
+
+/*
+====================
+SV_PacingEnabled
+
+Listen servers already send every time they are called
+====================
+*/
+static qboolean SV_PacingEnabled( void ) {
+	return sv_pacing->integer > 0 && com_dedicated->integer;
+}
+
+/*
+====================
+SV_RefillRateTokens
+
+The bucket holds up to a tenth of a second worth of the rate,
+but always at least a full packet
+====================
+*/
+static void SV_RefillRateTokens( client_t *client, int now ) {
+	int		rate, maxTokens, elapsed;
+
+	elapsed = now - client->rateTokenTime;
+	client->rateTokenTime = now;
+	if ( elapsed <= 0 ) {
+		return;
+	}
+	if ( elapsed > 1000 ) {
+		elapsed = 1000;
+	}
+
+	rate = SV_ClientRate( client );
+	maxTokens = rate / 10;
+	if ( maxTokens < 1500 + HEADER_RATE_BYTES ) {
+		maxTokens = 1500 + HEADER_RATE_BYTES;
+	}
+
+	client->rateTokens += rate * elapsed / 1000;
+	if ( client->rateTokens > maxTokens ) {
+		client->rateTokens = maxTokens;
+	}
+}
+
+/*
+====================
+SV_RecordTransmit
+
+Keeps the pacing_stats of a client.  With sv_simulatedLink all the
+messages queue on one uplink of that many bytes / second, which shows
+how long the bursts would wait in the network card.
+====================
+*/
+static void SV_RecordTransmit( client_t *client, int messageSize ) {
+	pacingStats_t	*stats;
+	float			transit;
+	int				now;
+
+	stats = &client->pacing;
+	now = Sys_Milliseconds();
+
+	transit = now - svs.frameRealTime;
+	if ( sv_simulatedLink->integer > 0 ) {
+		svs.linkBacklog -= now - svs.linkTime;
+		if ( svs.linkBacklog < 0 ) {
+			svs.linkBacklog = 0;
 		}
-		if ( sv_maxRate->integer < rate ) {
-			rate = sv_maxRate->integer;
+		svs.linkTime = now;
+		svs.linkBacklog += ( messageSize + HEADER_RATE_BYTES ) * 1000.0f / sv_simulatedLink->integer;
+
+		stats->linkDelay += svs.linkBacklog;
+		if ( svs.linkBacklog > stats->maxLinkDelay ) {
+			stats->maxLinkDelay = svs.linkBacklog;
 		}
+		transit += svs.linkBacklog;
 	}
-	rateMsec = ( messageSize + HEADER_RATE_BYTES ) * 1000 / rate;
 
-	return rateMsec;
+	// every snapshot should leave the same time after its frame
+	if ( stats->sent ) {
+		stats->jitter += ( fabs( transit - stats->lastTransit ) - stats->jitter ) / 16;
+	}
+	stats->lastTransit = transit;
+	stats->sent++;
+}
+
+/*
+=======================
+SV_QsortPacedClients
+
+Clients that are playing go before the ones still connecting,
+then the ones that have been due the longest
+=======================
+*/
+static int QDECL SV_QsortPacedClients( const void *a, const void *b ) {
+	client_t	*ca, *cb;
+
+	ca = &svs.clients[ *(int *)a ];
+	cb = &svs.clients[ *(int *)b ];
+
+	if ( ( ca->state == CS_ACTIVE ) != ( cb->state == CS_ACTIVE ) ) {
+		return ca->state == CS_ACTIVE ? -1 : 1;
+	}
+	if ( ca->nextSnapshotTime < cb->nextSnapshotTime ) {
+		return -1;
+	}
+	if ( ca->nextSnapshotTime > cb->nextSnapshotTime ) {
+		return 1;
+	}
+	return *(int *)a - *(int *)b;
+}
+
+/*
+=======================
+SV_SchedulePacedSnapshots
+
+Spreads the send times evenly over sv_pacing msec, but never
+into the next frame
+=======================
+*/
+static void SV_SchedulePacedSnapshots( void ) {
+	int		i, window;
+
+	window = sv_pacing->integer;
+	if ( window > 1000 / sv_fps->integer - 1 ) {
+		window = 1000 / sv_fps->integer - 1;
+	}
+	if ( window < 0 ) {
+		window = 0;
+	}
+
+	qsort( pacedClients, numPacedClients, sizeof( pacedClients[0] ), SV_QsortPacedClients );
+
+	for ( i = 0 ; i < numPacedClients ; i++ ) {
+		pacedSendTimes[i] = svs.frameRealTime + i * window / numPacedClients;
+	}
+	nextPacedClient = 0;
+}
+
+/*
+=======================
+SV_SendPacedSnapshot
+=======================
+*/
+static void SV_SendPacedSnapshot( int clientNum, int now ) {
+	client_t	*cl;
+	int			delay;
+
+	// the client may have left or the server restarted since
+	if ( clientNum >= sv_maxclients->integer ) {
+		return;
+	}
+	cl = &svs.clients[clientNum];
+	if ( !cl->state ) {
+		return;
+	}
+
+	// a gamestate went out in between, the snapshot was written for a
+	// frame slot that now belongs to it
+	if ( cl->netchan.outgoingSequence != pacedSequences[clientNum] ) {
+		return;
+	}
+
+	delay = now - cl->pacedTime;
+	cl->pacing.queued++;
+	cl->pacing.queueDelay += delay;
+	if ( delay > cl->pacing.maxQueueDelay ) {
+		cl->pacing.maxQueueDelay = delay;
+	}
+
+	SV_SendMessageToClient( &pacedMessages[clientNum], cl );
+}
+
+/*
+=======================
+SV_SendPacedSnapshots
+
+Called by SV_Frame while waiting for the next frame, returns
+the msec until the next scheduled snapshot or -1 if none
+=======================
+*/
+int SV_SendPacedSnapshots( void ) {
+	int		now;
+
+	now = Sys_Milliseconds();
+	while ( nextPacedClient < numPacedClients && pacedSendTimes[nextPacedClient] <= now ) {
+		SV_SendPacedSnapshot( pacedClients[nextPacedClient++], now );
+	}
+
+	if ( nextPacedClient == numPacedClients ) {
+		return -1;
+	}
+	return pacedSendTimes[nextPacedClient] - now;
+}
+
+/*
+=======================
+SV_FlushPacedSnapshots
+
+Sends whatever didn't make it out before the next frame
+=======================
+*/
+static void SV_FlushPacedSnapshots( void ) {
+	int		now;
+
+	now = Sys_Milliseconds();
+	while ( nextPacedClient < numPacedClients ) {
+		SV_SendPacedSnapshot( pacedClients[nextPacedClient++], now );
+	}
+	numPacedClients = 0;
+	nextPacedClient = 0;
 }
 
 /*
@@ -563,6 +1112,7 @@ void SV_SendMessageToClient( msg_t *msg, client_t *client ) {
 
 	// send the datagram
 	SV_Netchan_Transmit( client, msg );	//msg->cursize, msg->data );
+	SV_RecordTransmit( client, msg->cursize );
 
 	// set nextSnapshotTime based on rate and requested number of updates
 
@@ -574,18 +1124,27 @@ void SV_SendMessageToClient( msg_t *msg, client_t *client ) {
 		return;
 	}
 	
-	// normal rate / snapshotMsec calculation
-	rateMsec = SV_RateMsec( client, msg->cursize );
-
-	if ( rateMsec < client->snapshotMsec ) {
-		// never send more packets than this, no matter what the rate is at
-		rateMsec = client->snapshotMsec;
+	if ( SV_PacingEnabled() ) {
+		// take the message out of the bucket, SV_SendClientMessages
+		// holds the client back until it has refilled
+		SV_RefillRateTokens( client, Sys_Milliseconds() );
+		client->rateTokens -= ( msg->cursize > 1500 ? 1500 : msg->cursize ) + HEADER_RATE_BYTES;
 		client->rateDelayed = qfalse;
+		client->nextSnapshotTime = svs.time + client->snapshotMsec;
 	} else {
-		client->rateDelayed = qtrue;
-	}
+		// normal rate / snapshotMsec calculation
+		rateMsec = SV_RateMsec( client, msg->cursize );
 
-	client->nextSnapshotTime = svs.time + rateMsec;
+		if ( rateMsec < client->snapshotMsec ) {
+			// never send more packets than this, no matter what the rate is at
+			rateMsec = client->snapshotMsec;
+			client->rateDelayed = qfalse;
+		} else {
+			client->rateDelayed = qtrue;
+		}
+
+		client->nextSnapshotTime = svs.time + rateMsec;
+	}
 
 	// don't pile up empty snapshots while connecting
 	if ( client->state != CS_ACTIVE ) {
@@ -601,49 +1160,63 @@ void SV_SendMessageToClient( msg_t *msg, client_t *client ) {
 
 /*
 =======================
-SV_SendClientSnapshot
-
-Also called by SV_FinalMessage
+SV_WriteClientMessage
 
+Builds the snapshot and writes the message that carries it, returns
+qfalse if there is nothing to send
 =======================
 */
-void SV_SendClientSnapshot( client_t *client ) {
-	byte		msg_buf[MAX_MSGLEN];
-	msg_t		msg;
-
+static qboolean SV_WriteClientMessage( client_t *client, msg_t *msg, byte *data, int length ) {
 	// build the snapshot
 	SV_BuildClientSnapshot( client );
 
 	// bots need to have their snapshots build, but
 	// the query them directly without needing to be sent
 	if ( client->gentity && client->gentity->r.svFlags & SVF_BOT ) {
-		return;
+		return qfalse;
 	}
 
-	MSG_Init (&msg, msg_buf, sizeof(msg_buf));
-	msg.allowoverflow = qtrue;
+	MSG_Init (msg, data, length);
+	msg->allowoverflow = qtrue;
 
 	// NOTE, MRE: all server->client messages now acknowledge
 	// let the client know which reliable clientCommands we have received
-	MSG_WriteLong( &msg, client->lastClientCommand );
+	MSG_WriteLong( msg, client->lastClientCommand );
 
 	// (re)send any reliable server commands
-	SV_UpdateServerCommandsToClient( client, &msg );
+	SV_UpdateServerCommandsToClient( client, msg );
 
 	// send over all the relevant entityState_t
 	// and the playerState_t
-	SV_WriteSnapshotToClient( client, &msg );
+	SV_WriteSnapshotToClient( client, msg );
 
 	// Add any download data if the client is downloading
-	SV_WriteDownloadToClient( client, &msg );
+	SV_WriteDownloadToClient( client, msg );
 
 	// check for overflow
-	if ( msg.overflowed ) {
+	if ( msg->overflowed ) {
 		Com_Printf ("WARNING: msg overflowed for %s\n", client->name);
-		MSG_Clear (&msg);
+		MSG_Clear (msg);
 	}
 
-	SV_SendMessageToClient( &msg, client );
+	return qtrue;
+}
+
+/*
+=======================
+SV_SendClientSnapshot
+
+Also called by SV_FinalMessage
+
+=======================
+*/
+void SV_SendClientSnapshot( client_t *client ) {
+	byte		msg_buf[MAX_MSGLEN];
+	msg_t		msg;
+
+	if ( SV_WriteClientMessage( client, &msg, msg_buf, sizeof( msg_buf ) ) ) {
+		SV_SendMessageToClient( &msg, client );
+	}
 }
 
 
@@ -655,6 +1228,16 @@ SV_SendClientMessages
 void SV_SendClientMessages( void ) {
 	int			i;
 	client_t	*c;
+	qboolean	paced;
+
+	// the snapshots below share one copy of every entity state
+	svs.snapshotStateBatch++;
+	svs.frameRealTime = Sys_Milliseconds();
+
+	paced = SV_PacingEnabled();
+	if ( paced ) {
+		SV_FlushPacedSnapshots();
+	}
 
 	// send a message to each connected client
 	for (i=0, c = svs.clients ; i < sv_maxclients->integer ; i++, c++) {
@@ -675,8 +1258,30 @@ void SV_SendClientMessages( void ) {
 			continue;
 		}
 
+		// bots and the local client don't go over the network
+		if ( paced && c->netchan.remoteAddress.type != NA_BOT
+			&& c->netchan.remoteAddress.type != NA_LOOPBACK ) {
+			SV_RefillRateTokens( c, svs.frameRealTime );
+			if ( c->rateTokens < 0 ) {
+				c->rateDelayed = qtrue;
+				continue;		// still sending the last one at its rate
+			}
+			// write it now, only the transmit waits for its slot
+			if ( SV_WriteClientMessage( c, &pacedMessages[i], pacedBuffers[i], sizeof( pacedBuffers[i] ) ) ) {
+				pacedSequences[i] = c->netchan.outgoingSequence;
+				c->pacedTime = svs.frameRealTime;
+				pacedClients[numPacedClients++] = i;
+			}
+			continue;
+		}
+
 		// generate and send a new message
 		SV_SendClientSnapshot( c );
 	}
+
+	if ( numPacedClients ) {
+		SV_SchedulePacedSnapshots();
+		SV_SendPacedSnapshots();
+	}
 }
 
@@ -157,6 +157,42 @@ void SV_ClearWorld( void ) {
 	SV_CreateworldSector( 0, mins, maxs );
 }
 
+/*
+===============
+SV_LoadWorldFromMemory
+
+Swaps the collision world for one generated at runtime while the level
+keeps running.  The sectors are rebuilt for the new bounds and every
+linked entity is linked again, except brush models, whose inline models
+went away with the old map.
+===============
+*/
+void SV_LoadWorldFromMemory( const char *name, int numBoxes, const boxBrush_t *boxes ) {
+	sharedEntity_t	*gEnt;
+	byte			relink[MAX_GENTITIES];
+	int				i;
+
+	Com_Memset( relink, 0, sizeof( relink ) );
+	for ( i = 0 ; i < sv.num_entities ; i++ ) {
+		gEnt = SV_GentityNum( i );
+		if ( !gEnt->r.linked ) {
+			continue;
+		}
+		SV_UnlinkEntity( gEnt );
+		relink[i] = !gEnt->r.bmodel;
+	}
+
+	CM_LoadMapFromMemory( name, numBoxes, boxes );
+	SV_ClearWorld();
+	sv.worldFromMemory = qtrue;
+
+	for ( i = 0 ; i < sv.num_entities ; i++ ) {
+		if ( relink[i] ) {
+			SV_LinkEntity( SV_GentityNum( i ) );
+		}
+	}
+}
+
 
 /*
 ===============
@@ -172,6 +208,7 @@ void SV_UnlinkEntity( sharedEntity_t *gEnt ) {
 	ent = SV_SvEntityForGentity( gEnt );
 
 	gEnt->r.linked = qfalse;
+	sv.linkCount++;
 
 	ws = ent->worldSector;
 	if ( !ws ) {
@@ -218,6 +255,7 @@ void SV_LinkEntity( sharedEntity_t *gEnt ) {
 	if ( ent->worldSector ) {
 		SV_UnlinkEntity( gEnt );	// unlink from old position
 	}
+	sv.linkCount++;
 
 	// encode the size into the entityState_t for client prediction
 	if ( gEnt->r.bmodel ) {
@@ -442,6 +480,89 @@ int SV_AreaEntities( const vec3_t mins, const vec3_t maxs, int *entityList, int
 }
 
 
+typedef struct {
+	float		dist;
+	int			entityNum;
+} radiusEntity_t;
+
+static int SV_CompareRadiusEntities( const void *a, const void *b ) {
+	const radiusEntity_t	*ea = a, *eb = b;
+
+	if ( ea->dist < eb->dist ) {
+		return -1;
+	}
+	if ( ea->dist > eb->dist ) {
+		return 1;
+	}
+	return ea->entityNum - eb->entityNum;
+}
+
+/*
+================
+SV_EntitiesInRadius
+
+Returns the entities whose bounding box comes closer than radius to origin,
+nearest first.  If contentmask is not 0 only entities with matching
+contents are returned.
+================
+*/
+int SV_EntitiesInRadius( const vec3_t origin, float radius, int contentmask, int *entityList, int maxcount ) {
+	int				touch[MAX_GENTITIES];
+	radiusEntity_t	sorted[MAX_GENTITIES];
+	sharedEntity_t	*gcheck;
+	vec3_t			mins, maxs;
+	float			d, dist, radiusSquared;
+	int				i, j, num, count;
+
+	for ( i = 0 ; i < 3 ; i++ ) {
+		mins[i] = origin[i] - radius;
+		maxs[i] = origin[i] + radius;
+	}
+
+	num = SV_AreaEntities( mins, maxs, touch, MAX_GENTITIES );
+
+	radiusSquared = radius * radius;
+	count = 0;
+	for ( i = 0 ; i < num ; i++ ) {
+		gcheck = SV_GentityNum( touch[i] );
+
+		if ( contentmask && !( gcheck->r.contents & contentmask ) ) {
+			continue;
+		}
+
+		// distance from the edge of the bounding box
+		dist = 0;
+		for ( j = 0 ; j < 3 ; j++ ) {
+			if ( origin[j] < gcheck->r.absmin[j] ) {
+				d = gcheck->r.absmin[j] - origin[j];
+			} else if ( origin[j] > gcheck->r.absmax[j] ) {
+				d = origin[j] - gcheck->r.absmax[j];
+			} else {
+				continue;
+			}
+			dist += d * d;
+		}
+		if ( dist >= radiusSquared ) {
+			continue;
+		}
+
+		sorted[count].dist = dist;
+		sorted[count].entityNum = touch[i];
+		count++;
+	}
+
+	qsort( sorted, count, sizeof( sorted[0] ), SV_CompareRadiusEntities );
+
+	if ( count > maxcount ) {
+		count = maxcount;
+	}
+	for ( i = 0 ; i < count ; i++ ) {
+		entityList[i] = sorted[i].entityNum;
+	}
+
+	return count;
+}
+
 
 //===========================================================================
 
@@ -503,21 +624,19 @@ void SV_ClipToEntity( trace_t *trace, const vec3_t start, const vec3_t mins, con
 
 /*
 ====================
-SV_ClipMoveToEntities
+SV_ClipMoveToEntityList
 
+Clips the move against the already gathered entities in touchlist
 ====================
 */
-void SV_ClipMoveToEntities( moveclip_t *clip ) {
-	int			i, num;
-	int			touchlist[MAX_GENTITIES];
+static void SV_ClipMoveToEntityList( moveclip_t *clip, const int *touchlist, int num ) {
+	int			i;
 	sharedEntity_t *touch;
 	int			passOwnerNum;
 	trace_t		trace;
 	clipHandle_t	clipHandle;
 	float		*origin, *angles;
 
-	num = SV_AreaEntities( clip->boxmins, clip->boxmaxs, touchlist, MAX_GENTITIES);
-
 	if ( clip->passEntityNum != ENTITYNUM_NONE ) {
 		passOwnerNum = ( SV_GentityNum( clip->passEntityNum ) )->r.ownerNum;
 		if ( passOwnerNum == ENTITYNUM_NONE ) {
@@ -588,6 +707,46 @@ void SV_ClipMoveToEntities( moveclip_t *clip ) {
 	}
 }
 
+/*
+====================
+SV_ClipMoveToEntities
+
+====================
+*/
+void SV_ClipMoveToEntities( moveclip_t *clip ) {
+	int			num;
+	int			touchlist[MAX_GENTITIES];
+
+	num = SV_AreaEntities( clip->boxmins, clip->boxmaxs, touchlist, MAX_GENTITIES);
+
+	SV_ClipMoveToEntityList( clip, touchlist, num );
+}
+
+
+/*
+==================
+SV_MoveClipBounds
+
+Creates the bounding box of the entire move.
+We can limit it to the part of the move not
+already clipped off by the world, which can be
+a significant savings for line of sight and shot traces
+==================
+*/
+static void SV_MoveClipBounds( moveclip_t *clip ) {
+	int			i;
+
+	for ( i=0 ; i<3 ; i++ ) {
+		if ( clip->end[i] > clip->start[i] ) {
+			clip->boxmins[i] = clip->start[i] + clip->mins[i] - 1;
+			clip->boxmaxs[i] = clip->end[i] + clip->maxs[i] + 1;
+		} else {
+			clip->boxmins[i] = clip->end[i] + clip->mins[i] - 1;
+			clip->boxmaxs[i] = clip->start[i] + clip->maxs[i] + 1;
+		}
+	}
+}
+
 
 /*
 ==================
@@ -599,7 +758,6 @@ passEntityNum and entities owned by passEntityNum are explicitly not checked.
 */
 void SV_Trace( trace_t *results, const vec3_t start, vec3_t mins, vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask, int capsule ) {
 	moveclip_t	clip;
-	int			i;
 
 	if ( !mins ) {
 		mins = vec3_origin;
@@ -627,19 +785,7 @@ void SV_Trace( trace_t *results, const vec3_t start, vec3_t mins, vec3_t maxs, c
 	clip.passEntityNum = passEntityNum;
 	clip.capsule = capsule;
 
-	// create the bounding box of the entire move
-	// we can limit it to the part of the move not
-	// already clipped off by the world, which can be
-	// a significant savings for line of sight and shot traces
-	for ( i=0 ; i<3 ; i++ ) {
-		if ( end[i] > start[i] ) {
-			clip.boxmins[i] = clip.start[i] + clip.mins[i] - 1;
-			clip.boxmaxs[i] = clip.end[i] + clip.maxs[i] + 1;
-		} else {
-			clip.boxmins[i] = clip.end[i] + clip.mins[i] - 1;
-			clip.boxmaxs[i] = clip.start[i] + clip.maxs[i] + 1;
-		}
-	}
+	SV_MoveClipBounds( &clip );
 
 	// clip to other solid entities
 	SV_ClipMoveToEntities ( &clip );
@@ -647,6 +793,98 @@ void SV_Trace( trace_t *results, const vec3_t start, vec3_t mins, vec3_t maxs, c
 	*results = clip.trace;
 }
 
+/*
+==================
+SV_TraceBatch
+
+Runs count independent traces in one call.  The entities touched by the
+whole batch are gathered from the world sectors once, after which every
+trace only clips against the gathered entities overlapping its own move.
+The results match calling SV_Trace for each request in turn.
+==================
+*/
+void SV_TraceBatch( const traceRequest_t *requests, trace_t *results, int count ) {
+	const traceRequest_t	*req;
+	moveclip_t	clip;
+	int			touchlist[MAX_GENTITIES];
+	int			cliplist[MAX_GENTITIES];
+	vec3_t		batchmins, batchmaxs;
+	sharedEntity_t *touch;
+	int			i, j, num, numClip;
+	qboolean	gather;
+
+	if ( count <= 0 ) {
+		return;
+	}
+
+	ClearBounds( batchmins, batchmaxs );
+	gather = qfalse;
+
+	// clip everything to the world first, so the entity gathering
+	// only has to cover the moves that got past it
+	for ( i = 0, req = requests ; i < count ; i++, req++ ) {
+		CM_BoxTrace( &results[i], req->start, req->end, (float *)req->mins, (float *)req->maxs, 0, req->contentmask, qfalse );
+		results[i].entityNum = results[i].fraction != 1.0 ? ENTITYNUM_WORLD : ENTITYNUM_NONE;
+		if ( results[i].fraction == 0 ) {
+			continue;	// blocked immediately by the world
+		}
+
+		Com_Memset( &clip, 0, sizeof( clip ) );
+		clip.start = req->start;
+		VectorCopy( req->end, clip.end );
+		clip.mins = req->mins;
+		clip.maxs = req->maxs;
+		SV_MoveClipBounds( &clip );
+
+		AddPointToBounds( clip.boxmins, batchmins, batchmaxs );
+		AddPointToBounds( clip.boxmaxs, batchmins, batchmaxs );
+		gather = qtrue;
+	}
+
+	if ( !gather ) {
+		return;
+	}
+
+	num = SV_AreaEntities( batchmins, batchmaxs, touchlist, MAX_GENTITIES );
+
+	for ( i = 0, req = requests ; i < count ; i++, req++ ) {
+		if ( results[i].fraction == 0 ) {
+			continue;
+		}
+
+		Com_Memset( &clip, 0, sizeof( clip ) );
+		clip.trace = results[i];
+		clip.contentmask = req->contentmask;
+		clip.start = req->start;
+		VectorCopy( req->end, clip.end );
+		clip.mins = req->mins;
+		clip.maxs = req->maxs;
+		clip.passEntityNum = req->passEntityNum;
+		clip.capsule = qfalse;
+		SV_MoveClipBounds( &clip );
+
+		// keep the gathered entities overlapping this move, in the
+		// same order SV_AreaEntities would have returned them
+		numClip = 0;
+		for ( j = 0 ; j < num ; j++ ) {
+			touch = SV_GentityNum( touchlist[j] );
+			if ( touch->r.absmin[0] > clip.boxmaxs[0]
+			|| touch->r.absmin[1] > clip.boxmaxs[1]
+			|| touch->r.absmin[2] > clip.boxmaxs[2]
+			|| touch->r.absmax[0] < clip.boxmins[0]
+			|| touch->r.absmax[1] < clip.boxmins[1]
+			|| touch->r.absmax[2] < clip.boxmins[2] ) {
+				continue;
+			}
+			cliplist[numClip++] = touchlist[j];
+		}
+
+		SV_ClipMoveToEntityList( &clip, cliplist, numClip );
+
+		results[i] = clip.trace;
+	}
+}
+
 
 
 /*
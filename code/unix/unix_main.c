@@ -37,6 +37,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include <sys/wait.h>
 #include <sys/mman.h>
 #include <errno.h>
+#include <pthread.h>
 #ifdef __linux__ // rb010123
   #include <mntent.h>
 #endif
@@ -1012,6 +1013,350 @@ void Sys_StreamSeek( fileHandle_t f, int offset, int origin ) {
 /*
 ========================================================================
 
+BACKGROUND FILE WRITING
+
+A file being written with Sys_StreamedWrite gets a thread of its own,
+so the caller only pays for a memcpy into the ring buffer and never
+waits on the disk.  The handle must not be used any other way between
+Sys_BeginStreamedWrite and Sys_EndStreamedWrite.
+
+========================================================================
+*/
+
+typedef struct {
+	qboolean		active;
+	qboolean		done;			// no more data is coming, drain and exit
+	qboolean		error;			// a write to the file came up short
+	FILE			*file;			// written directly, FS_Write may print or error
+	byte			*buffer;
+	int				bufferSize;
+	int				writePosition;	// next byte to be stored by Sys_StreamedWrite
+	int				threadPosition;	// next byte to be written to the file
+	pthread_t		thread;
+	pthread_mutex_t	mutex;
+	pthread_cond_t	wake;
+} streamedWrite_t;
+
+static streamedWrite_t	streamedWrites[MAX_FILE_HANDLES];
+
+/*
+===============
+Sys_StreamedWriteThread
+
+Writes out whatever is in the buffer, sleeping while it is empty
+===============
+*/
+static void *Sys_StreamedWriteThread( void *arg ) {
+	streamedWrite_t	*s;
+	int				bufferPoint;
+	int				count;
+	int				written;
+
+	s = (streamedWrite_t *)arg;
+
+	pthread_mutex_lock( &s->mutex );
+	while ( 1 ) {
+		if ( s->threadPosition == s->writePosition ) {
+			if ( s->done ) {
+				break;
+			}
+			pthread_cond_wait( &s->wake, &s->mutex );
+			continue;
+		}
+
+		bufferPoint = s->threadPosition % s->bufferSize;
+		count = s->writePosition - s->threadPosition;
+		if ( count > s->bufferSize - bufferPoint ) {
+			count = s->bufferSize - bufferPoint;
+		}
+
+		// Sys_StreamedWrite never touches the bytes between threadPosition
+		// and writePosition, so they can go out without holding the lock
+		pthread_mutex_unlock( &s->mutex );
+		written = fwrite( s->buffer + bufferPoint, 1, count, s->file );
+		pthread_mutex_lock( &s->mutex );
+
+		if ( written != count ) {
+			s->error = qtrue;
+		}
+		s->threadPosition += count;
+		if ( s->threadPosition == s->writePosition ) {
+			// keep the positions from ever wrapping
+			s->threadPosition = s->writePosition = 0;
+		}
+	}
+	pthread_mutex_unlock( &s->mutex );
+
+	return NULL;
+}
+
+/*
+===============
+Sys_BeginStreamedWrite
+
+Returns qfalse if no thread could be started, Sys_StreamedWrite
+then writes to the file directly
+===============
+*/
+qboolean Sys_BeginStreamedWrite( fileHandle_t f, int bufferSize ) {
+	streamedWrite_t	*s;
+	int				ret;
+
+	if ( f <= 0 || f >= MAX_FILE_HANDLES ) {
+		Com_Error( ERR_FATAL, "Sys_BeginStreamedWrite: bad file handle" );
+	}
+	s = &streamedWrites[f];
+	if ( s->active ) {
+		Com_Error( ERR_FATAL, "Sys_BeginStreamedWrite: unclosed stream" );
+	}
+
+	memset( s, 0, sizeof( *s ) );
+	s->file = FS_FileForHandle( f );
+	s->buffer = Z_Malloc( bufferSize );
+	s->bufferSize = bufferSize;
+	pthread_mutex_init( &s->mutex, NULL );
+	pthread_cond_init( &s->wake, NULL );
+
+	ret = pthread_create( &s->thread, NULL, Sys_StreamedWriteThread, s );
+	if ( ret ) {
+		Com_Printf( "Sys_BeginStreamedWrite: pthread_create returned %d: %s\n", ret, strerror( ret ) );
+		pthread_mutex_destroy( &s->mutex );
+		pthread_cond_destroy( &s->wake );
+		Z_Free( s->buffer );
+		s->buffer = NULL;
+		return qfalse;
+	}
+
+	s->active = qtrue;
+	return qtrue;
+}
+
+/*
+===============
+Sys_StreamedWrite
+
+Either all of buffer is queued or none of it, qfalse means the
+thread has fallen behind by more than the buffer size
+===============
+*/
+qboolean Sys_StreamedWrite( const void *buffer, int len, fileHandle_t f ) {
+	streamedWrite_t	*s;
+	int				bufferPoint;
+	int				copy;
+
+	s = &streamedWrites[f];
+	if ( !s->active ) {
+		return FS_Write( buffer, len, f ) == len;
+	}
+
+	pthread_mutex_lock( &s->mutex );
+
+	if ( s->writePosition - s->threadPosition + len > s->bufferSize ) {
+		pthread_mutex_unlock( &s->mutex );
+		return qfalse;
+	}
+
+	bufferPoint = s->writePosition % s->bufferSize;
+	copy = s->bufferSize - bufferPoint;
+	if ( copy > len ) {
+		copy = len;
+	}
+	memcpy( s->buffer + bufferPoint, buffer, copy );
+	memcpy( s->buffer, (const byte *)buffer + copy, len - copy );
+	s->writePosition += len;
+
+	pthread_cond_signal( &s->wake );
+	pthread_mutex_unlock( &s->mutex );
+
+	return qtrue;
+}
+
+/*
+===============
+Sys_EndStreamedWrite
+
+Waits for everything queued to reach the file, the caller still
+closes it.  Returns qfalse if any of the writes failed.
+===============
+*/
+qboolean Sys_EndStreamedWrite( fileHandle_t f ) {
+	streamedWrite_t	*s;
+	qboolean		error;
+
+	s = &streamedWrites[f];
+	if ( !s->active ) {
+		return qtrue;
+	}
+
+	pthread_mutex_lock( &s->mutex );
+	s->done = qtrue;
+	pthread_cond_signal( &s->wake );
+	pthread_mutex_unlock( &s->mutex );
+
+	pthread_join( s->thread, NULL );
+
+	error = s->error;
+	pthread_mutex_destroy( &s->mutex );
+	pthread_cond_destroy( &s->wake );
+	Z_Free( s->buffer );
+	memset( s, 0, sizeof( *s ) );
+
+	return !error;
+}
+
+/*
+========================================================================
+
+JOB THREADS
+
+Sys_RunJobs spreads independent jobs over a pool of threads that is
+started on first use and then sleeps between runs.  The calling thread
+takes jobs as well, so a run never waits on a thread that isn't there.
+
+========================================================================
+*/
+
+typedef struct {
+	void			(*job)( int index );
+	int				numJobs;
+	int				nextJob;		// next index to be taken
+	int				finishedJobs;
+	int				numActive;		// threads taking part in this run, the caller included
+	int				generation;		// bumped for every run
+	qboolean		running;
+	int				numThreads;		// job threads started so far
+	pthread_t		threads[MAX_JOB_THREADS];
+	pthread_mutex_t	mutex;
+	pthread_cond_t	wake;			// a new run started
+	pthread_cond_t	done;			// the last job of a run finished
+} jobPool_t;
+
+static jobPool_t	jobs = { NULL, 0, 0, 0, 0, 0, qfalse, 0, { 0 },
+	PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER };
+
+static Q_THREADLOCAL int	sys_threadNum;
+
+/*
+===============
+Sys_ThreadNum
+===============
+*/
+int Sys_ThreadNum( void ) {
+	return sys_threadNum;
+}
+
+/*
+===============
+Sys_TakeJobs
+
+Runs jobs of the current run until none are left, the mutex
+is held on entry and exit but not during a job
+===============
+*/
+static void Sys_TakeJobs( void ) {
+	void	(*job)( int index );
+	int		index;
+
+	while ( jobs.nextJob < jobs.numJobs ) {
+		job = jobs.job;
+		index = jobs.nextJob++;
+
+		pthread_mutex_unlock( &jobs.mutex );
+		job( index );
+		pthread_mutex_lock( &jobs.mutex );
+
+		if ( ++jobs.finishedJobs == jobs.numJobs ) {
+			pthread_cond_signal( &jobs.done );
+		}
+	}
+}
+
+/*
+===============
+Sys_JobThread
+===============
+*/
+static void *Sys_JobThread( void *arg ) {
+	int		generation;
+
+	sys_threadNum = (int)(long)arg;
+
+	pthread_mutex_lock( &jobs.mutex );
+	generation = jobs.generation;
+	while ( 1 ) {
+		while ( jobs.generation == generation ) {
+			pthread_cond_wait( &jobs.wake, &jobs.mutex );
+		}
+		generation = jobs.generation;
+		if ( sys_threadNum < jobs.numActive ) {
+			Sys_TakeJobs();
+		}
+	}
+
+	return NULL;
+}
+
+/*
+===============
+Sys_RunJobs
+===============
+*/
+void Sys_RunJobs( void (*job)( int index ), int numJobs, int numThreads ) {
+	int		i, ret;
+
+	if ( numThreads <= 0 ) {
+		numThreads = Sys_ProcessorCount();
+	}
+	if ( numThreads > MAX_JOB_THREADS ) {
+		numThreads = MAX_JOB_THREADS;
+	}
+	if ( numThreads > numJobs ) {
+		numThreads = numJobs;
+	}
+
+	// start the threads the pool is still missing
+	while ( jobs.numThreads < numThreads - 1 && !jobs.running ) {
+		ret = pthread_create( &jobs.threads[jobs.numThreads], NULL, Sys_JobThread, (void *)(long)( jobs.numThreads + 1 ) );
+		if ( ret ) {
+			Com_Printf( "Sys_RunJobs: pthread_create returned %d: %s\n", ret, strerror( ret ) );
+			break;
+		}
+		jobs.numThreads++;
+	}
+	if ( numThreads > jobs.numThreads + 1 ) {
+		numThreads = jobs.numThreads + 1;
+	}
+
+	// a job starting another run doesn't get any help
+	if ( numThreads <= 1 || jobs.running ) {
+		for ( i = 0 ; i < numJobs ; i++ ) {
+			job( i );
+		}
+		return;
+	}
+
+	pthread_mutex_lock( &jobs.mutex );
+	jobs.job = job;
+	jobs.numJobs = numJobs;
+	jobs.nextJob = 0;
+	jobs.finishedJobs = 0;
+	jobs.numActive = numThreads;
+	jobs.generation++;
+	jobs.running = qtrue;
+	pthread_cond_broadcast( &jobs.wake );
+
+	Sys_TakeJobs();
+	while ( jobs.finishedJobs < jobs.numJobs ) {
+		pthread_cond_wait( &jobs.done, &jobs.mutex );
+	}
+
+	jobs.running = qfalse;
+	pthread_mutex_unlock( &jobs.mutex );
+}
+
+/*
+========================================================================
+
 EVENT LOOP
 
 ========================================================================
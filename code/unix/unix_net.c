@@ -248,6 +248,123 @@ void	Sys_SendPacket( int length, const void *data, netadr_t to )
 	}
 }
 
+//=============================================================================
+
+/*
+==================
+Sys_TCPConnect
+
+Starts a non-blocking TCP connection for the download transports,
+returns -1 if it couldn't even be started
+==================
+*/
+int Sys_TCPConnect( netadr_t to )
+{
+	int		newsocket;
+	struct sockaddr_in	addr;
+	qboolean _qtrue = qtrue;
+
+	if ( to.type != NA_IP ) {
+		return -1;
+	}
+
+	if ((newsocket = socket (PF_INET, SOCK_STREAM, IPPROTO_TCP)) == -1)
+	{
+		Com_Printf ("WARNING: Sys_TCPConnect: socket: %s\n", NET_ErrorString());
+		return -1;
+	}
+
+	// make it non-blocking
+	if (ioctl (newsocket, FIONBIO, &_qtrue) == -1)
+	{
+		Com_Printf ("WARNING: Sys_TCPConnect: ioctl FIONBIO: %s\n", NET_ErrorString());
+		close (newsocket);
+		return -1;
+	}
+
+	NetadrToSockadr (&to, &addr);
+
+	if (connect (newsocket, (struct sockaddr *)&addr, sizeof(addr)) == -1 && errno != EINPROGRESS)
+	{
+		Com_Printf ("WARNING: Sys_TCPConnect: connect: %s\n", NET_ErrorString());
+		close (newsocket);
+		return -1;
+	}
+
+	return newsocket;
+}
+
+/*
+==================
+Sys_TCPSend
+
+Returns the number of bytes sent, 0 if the connection isn't
+established yet or would block, -1 if it failed
+==================
+*/
+int Sys_TCPSend( int sock, const void *data, int length )
+{
+	struct timeval timeout;
+	fd_set	fdset;
+	int		ret, flags;
+
+	// writable once the connection is made or has failed
+	FD_ZERO(&fdset);
+	FD_SET(sock, &fdset);
+	timeout.tv_sec = 0;
+	timeout.tv_usec = 0;
+	if (select (sock+1, NULL, &fdset, NULL, &timeout) <= 0)
+		return 0;
+
+	flags = 0;
+#ifdef MSG_NOSIGNAL
+	flags |= MSG_NOSIGNAL;
+#endif
+	ret = send (sock, data, length, flags);
+	if (ret == -1)
+	{
+		if (errno == EWOULDBLOCK || errno == EAGAIN)
+			return 0;
+		return -1;
+	}
+	return ret;
+}
+
+/*
+==================
+Sys_TCPRecv
+
+Returns the number of bytes received, 0 if there is nothing
+to read yet, TCP_CLOSED if the other end closed the connection
+and -1 if it failed
+==================
+*/
+int Sys_TCPRecv( int sock, void *data, int length )
+{
+	int		ret;
+
+	ret = recv (sock, data, length, 0);
+	if (ret == -1)
+	{
+		if (errno == EWOULDBLOCK || errno == EAGAIN)
+			return 0;
+		return -1;
+	}
+	if (ret == 0)
+		return TCP_CLOSED;
+	return ret;
+}
+
+/*
+==================
+Sys_TCPClose
+==================
+*/
+void Sys_TCPClose( int sock )
+{
+	close (sock);
+}
+
 
 //=============================================================================
 
@@ -885,6 +885,362 @@ void Sys_StreamSeek( fileHandle_t f, int offset, int origin ) {
 /*
 ========================================================================
 
+BACKGROUND FILE WRITING
+
+A file being written with Sys_StreamedWrite gets a thread of its own,
+so the caller only pays for a memcpy into the ring buffer and never
+waits on the disk.  The handle must not be used any other way between
+Sys_BeginStreamedWrite and Sys_EndStreamedWrite.
+
+========================================================================
+*/
+
+typedef struct {
+	qboolean			active;
+	qboolean			done;			// no more data is coming, drain and exit
+	qboolean			error;			// a write to the file came up short
+	FILE				*file;			// written directly, FS_Write may print or error
+	byte				*buffer;
+	int					bufferSize;
+	int					writePosition;	// next byte to be stored by Sys_StreamedWrite
+	int					threadPosition;	// next byte to be written to the file
+	HANDLE				threadHandle;
+	int					threadId;
+	CRITICAL_SECTION	crit;
+	HANDLE				wake;			// auto reset, set whenever there is new data
+} streamedWrite_t;
+
+static streamedWrite_t	streamedWrites[MAX_FILE_HANDLES];
+
+/*
+===============
+Sys_StreamedWriteThread
+
+Writes out whatever is in the buffer, sleeping while it is empty
+===============
+*/
+static DWORD WINAPI Sys_StreamedWriteThread( LPVOID arg ) {
+	streamedWrite_t	*s;
+	int				bufferPoint;
+	int				count;
+	int				written;
+
+	s = (streamedWrite_t *)arg;
+
+	EnterCriticalSection( &s->crit );
+	while ( 1 ) {
+		if ( s->threadPosition == s->writePosition ) {
+			if ( s->done ) {
+				break;
+			}
+			LeaveCriticalSection( &s->crit );
+			WaitForSingleObject( s->wake, INFINITE );
+			EnterCriticalSection( &s->crit );
+			continue;
+		}
+
+		bufferPoint = s->threadPosition % s->bufferSize;
+		count = s->writePosition - s->threadPosition;
+		if ( count > s->bufferSize - bufferPoint ) {
+			count = s->bufferSize - bufferPoint;
+		}
+
+		// Sys_StreamedWrite never touches the bytes between threadPosition
+		// and writePosition, so they can go out without holding the lock
+		LeaveCriticalSection( &s->crit );
+		written = fwrite( s->buffer + bufferPoint, 1, count, s->file );
+		EnterCriticalSection( &s->crit );
+
+		if ( written != count ) {
+			s->error = qtrue;
+		}
+		s->threadPosition += count;
+		if ( s->threadPosition == s->writePosition ) {
+			// keep the positions from ever wrapping
+			s->threadPosition = s->writePosition = 0;
+		}
+	}
+	LeaveCriticalSection( &s->crit );
+
+	return 0;
+}
+
+/*
+===============
+Sys_BeginStreamedWrite
+
+Returns qfalse if no thread could be started, Sys_StreamedWrite
+then writes to the file directly
+===============
+*/
+qboolean Sys_BeginStreamedWrite( fileHandle_t f, int bufferSize ) {
+	streamedWrite_t	*s;
+
+	if ( f <= 0 || f >= MAX_FILE_HANDLES ) {
+		Com_Error( ERR_FATAL, "Sys_BeginStreamedWrite: bad file handle" );
+	}
+	s = &streamedWrites[f];
+	if ( s->active ) {
+		Com_Error( ERR_FATAL, "Sys_BeginStreamedWrite: unclosed stream" );
+	}
+
+	memset( s, 0, sizeof( *s ) );
+	s->file = FS_FileForHandle( f );
+	s->buffer = Z_Malloc( bufferSize );
+	s->bufferSize = bufferSize;
+	InitializeCriticalSection( &s->crit );
+	s->wake = CreateEvent( NULL, FALSE, FALSE, NULL );
+
+	s->threadHandle = CreateThread(
+	   NULL,	// LPSECURITY_ATTRIBUTES lpsa,
+	   0,		// DWORD cbStack,
+	   Sys_StreamedWriteThread,	// LPTHREAD_START_ROUTINE lpStartAddr,
+	   s,		// LPVOID lpvThreadParm,
+	   0,		// DWORD fdwCreate,
+	   &s->threadId );
+	if ( !s->threadHandle ) {
+		Com_Printf( "Sys_BeginStreamedWrite: CreateThread failed\n" );
+		CloseHandle( s->wake );
+		DeleteCriticalSection( &s->crit );
+		Z_Free( s->buffer );
+		s->buffer = NULL;
+		return qfalse;
+	}
+
+	s->active = qtrue;
+	return qtrue;
+}
+
+/*
+===============
+Sys_StreamedWrite
+
+Either all of buffer is queued or none of it, qfalse means the
+thread has fallen behind by more than the buffer size
+===============
+*/
+qboolean Sys_StreamedWrite( const void *buffer, int len, fileHandle_t f ) {
+	streamedWrite_t	*s;
+	int				bufferPoint;
+	int				copy;
+
+	s = &streamedWrites[f];
+	if ( !s->active ) {
+		return FS_Write( buffer, len, f ) == len;
+	}
+
+	EnterCriticalSection( &s->crit );
+
+	if ( s->writePosition - s->threadPosition + len > s->bufferSize ) {
+		LeaveCriticalSection( &s->crit );
+		return qfalse;
+	}
+
+	bufferPoint = s->writePosition % s->bufferSize;
+	copy = s->bufferSize - bufferPoint;
+	if ( copy > len ) {
+		copy = len;
+	}
+	memcpy( s->buffer + bufferPoint, buffer, copy );
+	memcpy( s->buffer, (const byte *)buffer + copy, len - copy );
+	s->writePosition += len;
+
+	LeaveCriticalSection( &s->crit );
+	SetEvent( s->wake );
+
+	return qtrue;
+}
+
+/*
+===============
+Sys_EndStreamedWrite
+
+Waits for everything queued to reach the file, the caller still
+closes it.  Returns qfalse if any of the writes failed.
+===============
+*/
+qboolean Sys_EndStreamedWrite( fileHandle_t f ) {
+	streamedWrite_t	*s;
+	qboolean		error;
+
+	s = &streamedWrites[f];
+	if ( !s->active ) {
+		return qtrue;
+	}
+
+	EnterCriticalSection( &s->crit );
+	s->done = qtrue;
+	LeaveCriticalSection( &s->crit );
+	SetEvent( s->wake );
+
+	WaitForSingleObject( s->threadHandle, INFINITE );
+	CloseHandle( s->threadHandle );
+
+	error = s->error;
+	CloseHandle( s->wake );
+	DeleteCriticalSection( &s->crit );
+	Z_Free( s->buffer );
+	memset( s, 0, sizeof( *s ) );
+
+	return !error;
+}
+
+/*
+========================================================================
+
+JOB THREADS
+
+Sys_RunJobs spreads independent jobs over a pool of threads that is
+started on first use and then sleeps between runs.  The calling thread
+takes jobs as well, so a run never waits on a thread that isn't there.
+
+========================================================================
+*/
+
+typedef struct {
+	void				(*job)( int index );
+	int					numJobs;
+	int					nextJob;		// next index to be taken
+	int					finishedJobs;
+	qboolean			running;
+	qboolean			initialized;
+	int					numThreads;		// job threads started so far
+	HANDLE				threads[MAX_JOB_THREADS];
+	CRITICAL_SECTION	crit;
+	HANDLE				wake;			// semaphore, one count for every thread a run wants
+	HANDLE				done;			// auto reset, set when the last job of a run finished
+} jobPool_t;
+
+static jobPool_t	jobs;
+
+static Q_THREADLOCAL int	sys_threadNum;
+
+/*
+===============
+Sys_ThreadNum
+===============
+*/
+int Sys_ThreadNum( void ) {
+	return sys_threadNum;
+}
+
+/*
+===============
+Sys_TakeJobs
+
+Runs jobs of the current run until none are left, the critical
+section is held on entry and exit but not during a job
+===============
+*/
+static void Sys_TakeJobs( void ) {
+	void	(*job)( int index );
+	int		index;
+
+	while ( jobs.nextJob < jobs.numJobs ) {
+		job = jobs.job;
+		index = jobs.nextJob++;
+
+		LeaveCriticalSection( &jobs.crit );
+		job( index );
+		EnterCriticalSection( &jobs.crit );
+
+		if ( ++jobs.finishedJobs == jobs.numJobs ) {
+			SetEvent( jobs.done );
+		}
+	}
+}
+
+/*
+===============
+Sys_JobThread
+
+A thread that wakes up late finds no jobs left and goes back to sleep
+===============
+*/
+static DWORD WINAPI Sys_JobThread( LPVOID arg ) {
+	sys_threadNum = (int)arg;
+
+	while ( 1 ) {
+		WaitForSingleObject( jobs.wake, INFINITE );
+		EnterCriticalSection( &jobs.crit );
+		Sys_TakeJobs();
+		LeaveCriticalSection( &jobs.crit );
+	}
+
+	return 0;
+}
+
+/*
+===============
+Sys_RunJobs
+===============
+*/
+void Sys_RunJobs( void (*job)( int index ), int numJobs, int numThreads ) {
+	SYSTEM_INFO	info;
+	DWORD		threadId;
+	int			i;
+
+	if ( numThreads <= 0 ) {
+		GetSystemInfo( &info );
+		numThreads = info.dwNumberOfProcessors;
+	}
+	if ( numThreads > MAX_JOB_THREADS ) {
+		numThreads = MAX_JOB_THREADS;
+	}
+	if ( numThreads > numJobs ) {
+		numThreads = numJobs;
+	}
+
+	if ( !jobs.initialized && numThreads > 1 ) {
+		InitializeCriticalSection( &jobs.crit );
+		jobs.wake = CreateSemaphore( NULL, 0, 0x7fff, NULL );	// counts of late threads add up
+		jobs.done = CreateEvent( NULL, FALSE, FALSE, NULL );
+		jobs.initialized = qtrue;
+	}
+
+	// start the threads the pool is still missing
+	while ( jobs.numThreads < numThreads - 1 && !jobs.running ) {
+		jobs.threads[jobs.numThreads] = CreateThread( NULL, 0, Sys_JobThread, (LPVOID)( jobs.numThreads + 1 ), 0, &threadId );
+		if ( !jobs.threads[jobs.numThreads] ) {
+			Com_Printf( "Sys_RunJobs: CreateThread failed\n" );
+			break;
+		}
+		jobs.numThreads++;
+	}
+	if ( numThreads > jobs.numThreads + 1 ) {
+		numThreads = jobs.numThreads + 1;
+	}
+
+	// a job starting another run doesn't get any help
+	if ( numThreads <= 1 || jobs.running ) {
+		for ( i = 0 ; i < numJobs ; i++ ) {
+			job( i );
+		}
+		return;
+	}
+
+	EnterCriticalSection( &jobs.crit );
+	jobs.job = job;
+	jobs.numJobs = numJobs;
+	jobs.nextJob = 0;
+	jobs.finishedJobs = 0;
+	jobs.running = qtrue;
+	ReleaseSemaphore( jobs.wake, numThreads - 1, NULL );
+
+	Sys_TakeJobs();
+	while ( jobs.finishedJobs < jobs.numJobs ) {
+		LeaveCriticalSection( &jobs.crit );
+		WaitForSingleObject( jobs.done, INFINITE );
+		EnterCriticalSection( &jobs.crit );
+	}
+
+	jobs.running = qfalse;
+	LeaveCriticalSection( &jobs.crit );
+}
+
+/*
+========================================================================
+
 EVENT LOOP
 
 ========================================================================
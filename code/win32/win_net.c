@@ -373,6 +373,122 @@ void Sys_SendPacket( int length, const void *data, netadr_t to ) {
 	}
 }
 
+//=============================================================================
+
+/*
+==================
+Sys_TCPConnect
+
+Starts a non-blocking TCP connection for the download transports,
+returns -1 if it couldn't even be started
+==================
+*/
+int Sys_TCPConnect( netadr_t to ) {
+	SOCKET			newsocket;
+	struct sockaddr	addr;
+	u_long			_true = 1;
+
+	if( to.type != NA_IP ) {
+		return -1;
+	}
+
+	if( ( newsocket = socket( AF_INET, SOCK_STREAM, IPPROTO_TCP ) ) == INVALID_SOCKET ) {
+		Com_Printf( "WARNING: Sys_TCPConnect: socket: %s\n", NET_ErrorString() );
+		return -1;
+	}
+
+	// make it non-blocking
+	if( ioctlsocket( newsocket, FIONBIO, &_true ) == SOCKET_ERROR ) {
+		Com_Printf( "WARNING: Sys_TCPConnect: ioctl FIONBIO: %s\n", NET_ErrorString() );
+		closesocket( newsocket );
+		return -1;
+	}
+
+	NetadrToSockadr( &to, &addr );
+
+	if( connect( newsocket, &addr, sizeof(addr) ) == SOCKET_ERROR && WSAGetLastError() != WSAEWOULDBLOCK ) {
+		Com_Printf( "WARNING: Sys_TCPConnect: connect: %s\n", NET_ErrorString() );
+		closesocket( newsocket );
+		return -1;
+	}
+
+	return (int)newsocket;
+}
+
+/*
+==================
+Sys_TCPSend
+
+Returns the number of bytes sent, 0 if the connection isn't
+established yet or would block, -1 if it failed
+==================
+*/
+int Sys_TCPSend( int sock, const void *data, int length ) {
+	struct timeval	timeout;
+	fd_set			writeset, exceptset;
+	int				ret;
+
+	// winsock reports failed connections through the except set
+	FD_ZERO( &writeset );
+	FD_SET( (SOCKET)sock, &writeset );
+	FD_ZERO( &exceptset );
+	FD_SET( (SOCKET)sock, &exceptset );
+	timeout.tv_sec = 0;
+	timeout.tv_usec = 0;
+	if( select( 0, NULL, &writeset, &exceptset, &timeout ) == SOCKET_ERROR ) {
+		return -1;
+	}
+	if( FD_ISSET( (SOCKET)sock, &exceptset ) ) {
+		return -1;
+	}
+	if( !FD_ISSET( (SOCKET)sock, &writeset ) ) {
+		return 0;
+	}
+
+	ret = send( (SOCKET)sock, data, length, 0 );
+	if( ret == SOCKET_ERROR ) {
+		if( WSAGetLastError() == WSAEWOULDBLOCK ) {
+			return 0;
+		}
+		return -1;
+	}
+	return ret;
+}
+
+/*
+==================
+Sys_TCPRecv
+
+Returns the number of bytes received, 0 if there is nothing
+to read yet, TCP_CLOSED if the other end closed the connection
+and -1 if it failed
+==================
+*/
+int Sys_TCPRecv( int sock, void *data, int length ) {
+	int		ret;
+
+	ret = recv( (SOCKET)sock, data, length, 0 );
+	if( ret == SOCKET_ERROR ) {
+		if( WSAGetLastError() == WSAEWOULDBLOCK ) {
+			return 0;
+		}
+		return -1;
+	}
+	if( ret == 0 ) {
+		return TCP_CLOSED;
+	}
+	return ret;
+}
+
+/*
+==================
+Sys_TCPClose
+==================
+*/
+void Sys_TCPClose( int sock ) {
+	closesocket( (SOCKET)sock );
+}
+
 
 //=============================================================================
 